@@ -462,7 +462,7 @@ int main (int argc, char *argv[])
     }
     NS_LOG_DEBUG ("All flows generated.");
 
-    Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+    Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
     Simulator::Stop (Seconds (tStop));
 	Simulator::Run ();
 	Simulator::Destroy ();
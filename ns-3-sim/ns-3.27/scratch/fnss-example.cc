@@ -247,7 +247,7 @@ int main (int argc, char *argv[])
 	}
 	NS_LOG_DEBUG ("	-> Minibox & ratemonitor set.");
 	
-	Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+	Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
     Simulator::Stop (Seconds (tStop));
 	Simulator::Run ();
 	Simulator::Destroy ();
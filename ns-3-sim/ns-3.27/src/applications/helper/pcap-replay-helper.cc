@@ -0,0 +1,62 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pcap-replay-helper.h"
+#include "ns3/pcap-replay-application.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+PcapReplayHelper::PcapReplayHelper (std::string filename, uint16_t port)
+{
+  m_factory.SetTypeId (PcapReplayApplication::GetTypeId ());
+  SetAttribute ("TraceFilename", StringValue (filename));
+  SetAttribute ("RemotePort", UintegerValue (port));
+}
+
+void
+PcapReplayHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+void
+PcapReplayHelper::AddRemote (Address address)
+{
+  m_remotes.push_back (address);
+}
+
+ApplicationContainer
+PcapReplayHelper::Install (NodeContainer c) const
+{
+  ApplicationContainer apps;
+  for (uint32_t i = 0; i < c.GetN (); i++)
+    {
+      Ptr<PcapReplayApplication> app = m_factory.Create<PcapReplayApplication> ();
+      app->SetAttribute ("HostIndex", UintegerValue (i));
+      app->SetAttribute ("HostCount", UintegerValue (c.GetN ()));
+      for (std::vector<Address>::const_iterator j = m_remotes.begin (); j != m_remotes.end (); j++)
+        {
+          app->AddRemote (*j);
+        }
+      c.Get (i)->AddApplication (app);
+      apps.Add (app);
+    }
+  return apps;
+}
+
+} // namespace ns3
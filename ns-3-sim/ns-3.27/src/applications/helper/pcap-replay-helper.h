@@ -0,0 +1,80 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_REPLAY_HELPER_H
+#define PCAP_REPLAY_HELPER_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "ns3/application-container.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+#include "ns3/address.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ * \brief Replay a capture from a set of nodes to a set of remote hosts.
+ *
+ * The flows of the capture are shared between the nodes the applications
+ * are installed on, and sent to the remote hosts added with AddRemote.
+ */
+class PcapReplayHelper
+{
+public:
+  /**
+   * Create a PcapReplayHelper to make it easier to work with
+   * PcapReplayApplications.
+   *
+   * \param filename the pcap or pcapng file to replay
+   * \param port the port the remote hosts receive the packets on
+   */
+  PcapReplayHelper (std::string filename, uint16_t port);
+
+  /**
+   * Record an attribute to be set in each Application after it is is created.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Add a host the flows can be sent to.
+   *
+   * \param address the Ipv4Address of the host, or its InetSocketAddress
+   */
+  void AddRemote (Address address);
+
+  /**
+   * Create one PcapReplayApplication on each node of the container.  The
+   * flows of the capture are shared between the applications.
+   *
+   * \param c the nodes
+   * \returns the applications created, one application per input node.
+   */
+  ApplicationContainer Install (NodeContainer c) const;
+
+private:
+  ObjectFactory m_factory; //!< Object factory.
+  std::vector<Address> m_remotes; //!< Hosts the flows are sent to
+};
+
+} // namespace ns3
+
+#endif /* PCAP_REPLAY_HELPER_H */
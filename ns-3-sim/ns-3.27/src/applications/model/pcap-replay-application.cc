@@ -0,0 +1,362 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/hash.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/udp-socket-factory.h"
+#include "pcap-replay-application.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapReplayApplication");
+
+NS_OBJECT_ENSURE_REGISTERED (PcapReplayApplication);
+
+namespace {
+
+const uint32_t DLT_PPP = 9;          //!< PPP data link type
+const uint32_t DLT_ETHERNET = 1;     //!< Ethernet data link type
+const uint32_t DLT_RAW = 101;        //!< Raw IP data link type
+const uint32_t DLT_IPV4 = 228;       //!< Raw IPv4 data link type
+const uint32_t DLT_LINUX_SLL = 113;  //!< Linux cooked capture data link type
+
+/**
+ * \param data where to read
+ * \returns the 16 bit value at data, in network order
+ */
+uint16_t
+ReadNtoh16 (uint8_t const *data)
+{
+  return (data[0] << 8) | data[1];
+}
+
+/**
+ * \param data where to read
+ * \returns the 32 bit value at data, in network order
+ */
+uint32_t
+ReadNtoh32 (uint8_t const *data)
+{
+  return (static_cast<uint32_t> (data[0]) << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+
+} // anonymous namespace
+
+TypeId
+PcapReplayApplication::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PcapReplayApplication")
+    .SetParent<Application> ()
+    .SetGroupName("Applications")
+    .AddConstructor<PcapReplayApplication> ()
+    .AddAttribute ("TraceFilename",
+                   "The pcap or pcapng file to replay.",
+                   StringValue (""),
+                   MakeStringAccessor (&PcapReplayApplication::m_filename),
+                   MakeStringChecker ())
+    .AddAttribute ("TraceLoop",
+                   "Replay the capture again once it is over.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapReplayApplication::m_loop),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RemotePort",
+                   "The destination port of the packets, for remotes given without a port.",
+                   UintegerValue (9),
+                   MakeUintegerAccessor (&PcapReplayApplication::m_port),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("HostIndex",
+                   "The index of this application among those sharing the capture.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapReplayApplication::m_hostIndex),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("HostCount",
+                   "The number of applications sharing the flows of the capture.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PcapReplayApplication::m_hostCount),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddTraceSource ("Tx", "A new packet is created and is sent",
+                     MakeTraceSourceAccessor (&PcapReplayApplication::m_txTrace),
+                     "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+PcapReplayApplication::PcapReplayApplication ()
+  : m_nextHash (0),
+    m_nextSize (0),
+    m_nextTime (0),
+    m_firstTime (0),
+    m_readInPass (false),
+    m_totBytes (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapReplayApplication::~PcapReplayApplication ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PcapReplayApplication::AddRemote (Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  m_remotes.push_back (address);
+}
+
+uint64_t
+PcapReplayApplication::GetTotalTx (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_totBytes;
+}
+
+void
+PcapReplayApplication::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_socket = 0;
+  m_file.Close ();
+  Application::DoDispose ();
+}
+
+void
+PcapReplayApplication::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_remotes.empty (), "PcapReplayApplication has no remote host");
+  m_file.Open (m_filename);
+  NS_ABORT_MSG_IF (m_file.Fail (), "Could not read capture " << m_filename);
+  m_remoteAddresses.clear ();
+  for (std::vector<Address>::const_iterator i = m_remotes.begin (); i != m_remotes.end (); i++)
+    {
+      if (Ipv4Address::IsMatchingType (*i))
+        {
+          m_remoteAddresses.push_back (InetSocketAddress (Ipv4Address::ConvertFrom (*i), m_port));
+        }
+      else
+        {
+          m_remoteAddresses.push_back (*i);
+        }
+    }
+  if (m_socket == 0)
+    {
+      m_socket = Socket::CreateSocket (GetNode (), UdpSocketFactory::GetTypeId ());
+      if (m_socket->Bind () == -1)
+        {
+          NS_FATAL_ERROR ("Failed to bind socket");
+        }
+      m_socket->ShutdownRecv ();
+    }
+
+  MappedPcapFile::Record record;
+  if (!m_file.Read (record))
+    {
+      return;
+    }
+  m_file.Rewind ();
+  m_readInPass = false;
+  // Every application sharing the capture starts it at the same offset
+  m_firstTime = record.time;
+  m_origin = Simulator::Now ();
+  if (ReadNext ())
+    {
+      m_sendEvent = Simulator::Schedule (GetNextTime () - Simulator::Now (),
+                                         &PcapReplayApplication::SendPending, this);
+    }
+}
+
+void
+PcapReplayApplication::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_sendEvent);
+  if (m_socket != 0)
+    {
+      m_socket->Close ();
+      m_socket = 0;
+    }
+  m_file.Close ();
+}
+
+bool
+PcapReplayApplication::ParseRecord (MappedPcapFile::Record const &record, FlowKey &key, uint32_t &size) const
+{
+  uint8_t const *data = record.data;
+  uint32_t length = record.inclLen;
+  uint32_t offset;
+  switch (record.dataLinkType)
+    {
+    case DLT_ETHERNET:
+      {
+        if (length < 14)
+          {
+            return false;
+          }
+        offset = 14;
+        uint16_t type = ReadNtoh16 (data + 12);
+        // Skip the VLAN tags
+        while ((type == 0x8100 || type == 0x88a8) && length >= offset + 4)
+          {
+            type = ReadNtoh16 (data + offset + 2);
+            offset += 4;
+          }
+        if (type != 0x0800)
+          {
+            return false;
+          }
+      }
+      break;
+    case DLT_PPP:
+      if (length >= 4 && data[0] == 0xff && data[1] == 0x03)
+        {
+          offset = 4;
+        }
+      else
+        {
+          offset = 2;
+        }
+      if (length < offset || ReadNtoh16 (data + offset - 2) != 0x0021)
+        {
+          return false;
+        }
+      break;
+    case DLT_LINUX_SLL:
+      if (length < 16 || ReadNtoh16 (data + 14) != 0x0800)
+        {
+          return false;
+        }
+      offset = 16;
+      break;
+    case DLT_RAW:
+    case DLT_IPV4:
+      offset = 0;
+      break;
+    default:
+      return false;
+    }
+  if (length < offset + 20 || (data[offset] >> 4) != 4)
+    {
+      return false;
+    }
+  uint8_t const *ip = data + offset;
+  uint32_t headerSize = (ip[0] & 0x0f) * 4;
+  size = ReadNtoh16 (ip + 2);
+  key.protocol = ip[9];
+  key.source = ReadNtoh32 (ip + 12);
+  key.destination = ReadNtoh32 (ip + 16);
+  key.sourcePort = 0;
+  key.destinationPort = 0;
+  bool firstFragment = (ReadNtoh16 (ip + 6) & 0x1fff) == 0;
+  if ((key.protocol == 6 || key.protocol == 17) && firstFragment
+      && length >= offset + headerSize + 4)
+    {
+      key.sourcePort = ReadNtoh16 (ip + headerSize);
+      key.destinationPort = ReadNtoh16 (ip + headerSize + 2);
+    }
+  return true;
+}
+
+uint32_t
+PcapReplayApplication::HashFlow (FlowKey const &key) const
+{
+  uint8_t buffer[13];
+  std::memcpy (buffer, &key.source, 4);
+  std::memcpy (buffer + 4, &key.destination, 4);
+  std::memcpy (buffer + 8, &key.sourcePort, 2);
+  std::memcpy (buffer + 10, &key.destinationPort, 2);
+  buffer[12] = key.protocol;
+  return Hash32 (reinterpret_cast<char const *> (buffer), sizeof (buffer));
+}
+
+bool
+PcapReplayApplication::ReadNext (void)
+{
+  while (true)
+    {
+      MappedPcapFile::Record record;
+      if (!m_file.Read (record))
+        {
+          if (!m_loop || !m_readInPass)
+            {
+              // No record of this application in a whole pass
+              return false;
+            }
+          m_file.Rewind ();
+          m_origin = Simulator::Now ();
+          m_readInPass = false;
+          continue;
+        }
+      if (!ParseRecord (record, m_nextKey, m_nextSize))
+        {
+          continue;
+        }
+      m_nextHash = HashFlow (m_nextKey);
+      if (m_nextHash % m_hostCount != m_hostIndex)
+        {
+          continue;
+        }
+      m_nextTime = record.time;
+      m_readInPass = true;
+      return true;
+    }
+}
+
+Time
+PcapReplayApplication::GetNextTime (void) const
+{
+  // Records out of order in the capture are sent right away
+  uint64_t offset = m_nextTime > m_firstTime ? m_nextTime - m_firstTime : 0;
+  return std::max (m_origin + NanoSeconds (offset), Simulator::Now ());
+}
+
+void
+PcapReplayApplication::SendPending (void)
+{
+  NS_LOG_FUNCTION (this);
+  do
+    {
+      Address const &remote = m_remoteAddresses[(m_nextHash / m_hostCount) % m_remoteAddresses.size ()];
+      // The IPv4 and UDP headers added by the stack make up the captured size
+      Ptr<Packet> packet = Create<Packet> (m_nextSize > 28 ? m_nextSize - 28 : 0);
+      m_txTrace (packet);
+      int sent = m_socket->SendTo (packet, 0, remote);
+      if (sent > 0)
+        {
+          m_totBytes += sent;
+        }
+      if (!ReadNext ())
+        {
+          return;
+        }
+    }
+  while (GetNextTime () <= Simulator::Now ());
+  m_sendEvent = Simulator::Schedule (GetNextTime () - Simulator::Now (),
+                                     &PcapReplayApplication::SendPending, this);
+}
+
+} // namespace ns3
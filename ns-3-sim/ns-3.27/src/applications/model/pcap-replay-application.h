@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_REPLAY_APPLICATION_H
+#define PCAP_REPLAY_APPLICATION_H
+
+#include <vector>
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/address.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+#include "ns3/mapped-pcap-file.h"
+
+namespace ns3 {
+
+class Socket;
+class Packet;
+
+/**
+ * \ingroup applications
+ *
+ * \brief Replay the IPv4 packets of a capture as UDP cross traffic.
+ *
+ * The capture, a pcap or pcapng file, is mapped in memory by a
+ * MappedPcapFile and walked one record at a time: a single event is
+ * pending at any time, for the next record to send, so the memory used
+ * does not depend on the size of the capture.  The first record is sent
+ * when the application starts, and the others at the same offsets as in
+ * the capture.
+ *
+ * Each flow of the capture, identified by its IPv4 5-tuple, is mapped to
+ * a simulated pair of end hosts by a hash of the 5-tuple: the
+ * applications installed by PcapReplayHelper on several nodes each send
+ * the flows whose hash selects them, to one of the remote addresses.  An
+ * application sends all its flows from a single UDP socket, so that the
+ * number of flows of the capture is not bounded by the ephemeral ports of
+ * the node.  Each record is sent as a packet whose IPv4
+ * size, UDP and IPv4 headers included, is the IPv4 size of the captured
+ * packet.  Records which are not IPv4 packets of an Ethernet, PPP, Linux
+ * cooked or raw IP capture are skipped.
+ */
+class PcapReplayApplication : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PcapReplayApplication ();
+  virtual ~PcapReplayApplication ();
+
+  /**
+   * Add a host the flows can be sent to.
+   *
+   * \param address the Ipv4Address of the host, or its InetSocketAddress
+   */
+  void AddRemote (Address address);
+
+  /**
+   * \return the total bytes sent by this application
+   */
+  uint64_t GetTotalTx (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /// The IPv4 5-tuple of a flow of the capture
+  struct FlowKey
+  {
+    uint32_t source;       //!< source address
+    uint32_t destination;  //!< destination address
+    uint16_t sourcePort;   //!< source port, or 0
+    uint16_t destinationPort; //!< destination port, or 0
+    uint8_t protocol;      //!< IPv4 protocol number
+  };
+
+  /**
+   * Read the next record of the capture this application sends.
+   * \returns false at the end of the capture
+   */
+  bool ReadNext (void);
+  /**
+   * Extract the flow and the IPv4 size of a record.
+   * \param record the record
+   * \param key the flow of the record
+   * \param size the IPv4 size of the record
+   * \returns false if the record is not an IPv4 packet
+   */
+  bool ParseRecord (MappedPcapFile::Record const &record, FlowKey &key, uint32_t &size) const;
+  /**
+   * \param key a flow
+   * \returns the hash of the flow
+   */
+  uint32_t HashFlow (FlowKey const &key) const;
+  /**
+   * \returns the simulation time to send the pending record at
+   */
+  Time GetNextTime (void) const;
+  /**
+   * Send the pending record, and those due at the same time, then
+   * schedule the next one.
+   */
+  void SendPending (void);
+
+  std::string m_filename;      //!< the capture
+  bool m_loop;                 //!< whether to replay the capture again once over
+  uint16_t m_port;             //!< destination port of the packets
+  uint32_t m_hostIndex;        //!< index of this application among those sharing the capture
+  uint32_t m_hostCount;        //!< number of applications sharing the capture
+  std::vector<Address> m_remotes; //!< hosts the flows are sent to
+
+  MappedPcapFile m_file;       //!< the mapped capture
+  FlowKey m_nextKey;           //!< flow of the pending record
+  uint32_t m_nextHash;         //!< hash of the flow of the pending record
+  uint32_t m_nextSize;         //!< IPv4 size of the pending record
+  uint64_t m_nextTime;         //!< capture time of the pending record
+  uint64_t m_firstTime;        //!< capture time of the first record
+  Time m_origin;               //!< simulation time of the first record
+  bool m_readInPass;           //!< whether a record was read since the capture was rewound
+  EventId m_sendEvent;         //!< event to send the pending record
+  std::vector<Address> m_remoteAddresses; //!< socket addresses of the remotes
+  Ptr<Socket> m_socket;        //!< socket all the flows are sent from
+  uint64_t m_totBytes;         //!< total bytes sent
+
+  /// Traced Callback: transmitted packets.
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+};
+
+} // namespace ns3
+
+#endif /* PCAP_REPLAY_APPLICATION_H */
@@ -0,0 +1,393 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/pcap-file.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/packet-sink.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/pcap-replay-application.h"
+#include "ns3/pcap-replay-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/mac48-address.h"
+
+using namespace ns3;
+
+/**
+ * Write a raw IP capture of 60 IPv4 records of six flows, one every
+ * millisecond, followed by an IPv6 record.
+ * \param filename the capture
+ * \returns the number of UDP payload bytes of the IPv4 records, or 0 if the
+ *          capture could not be written
+ */
+static uint64_t
+WriteCapture (std::string filename)
+{
+  PcapFile capture;
+  capture.Open (filename, std::ios::out);
+  if (capture.Fail ())
+    {
+      return 0;
+    }
+  // Raw IP, with the IPv4 header and the ports only
+  capture.Init (101, 24);
+  uint64_t expected = 0;
+  for (uint32_t k = 0; k < 60; k++)
+    {
+      uint8_t ip[24];
+      std::memset (ip, 0, sizeof (ip));
+      uint32_t flow = k % 6;
+      uint16_t size = 100 + 10 * k;
+      ip[0] = 0x45;
+      ip[2] = size >> 8;
+      ip[3] = size & 0xff;
+      ip[9] = flow < 4 ? 17 : 6;
+      ip[12] = 192;
+      ip[13] = 168;
+      ip[15] = flow;
+      ip[16] = 10;
+      ip[19] = 1;
+      ip[20] = 1000 >> 8;
+      ip[21] = 1000 & 0xff;
+      ip[23] = 80;
+      capture.Write (0, 1000 * (k + 1), ip, size);
+      expected += size - 28;
+    }
+  // An IPv6 packet, which is skipped
+  uint8_t ipv6[24];
+  std::memset (ipv6, 0, sizeof (ipv6));
+  ipv6[0] = 0x60;
+  capture.Write (0, 70000, ipv6, sizeof (ipv6));
+  capture.Close ();
+  return expected;
+}
+
+/**
+ * \ingroup applications
+ * \ingroup tests
+ *
+ * Replay a raw IP capture of several flows from two nodes to two hosts,
+ * and check that every IPv4 record is sent once, at its time, with its
+ * captured IPv4 size.
+ */
+class PcapReplayTestCase : public TestCase
+{
+public:
+  PcapReplayTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Record a packet sent.
+   * \param packet the packet
+   */
+  void Tx (Ptr<const Packet> packet);
+
+  uint32_t m_sent;  //!< number of packets sent
+  Time m_firstTx;   //!< time of the first packet sent
+  Time m_lastTx;    //!< time of the last packet sent
+};
+
+PcapReplayTestCase::PcapReplayTestCase ()
+  : TestCase ("Replay the flows of a capture"),
+    m_sent (0)
+{
+}
+
+void
+PcapReplayTestCase::Tx (Ptr<const Packet> packet)
+{
+  if (m_sent == 0)
+    {
+      m_firstTx = Simulator::Now ();
+    }
+  m_lastTx = Simulator::Now ();
+  m_sent++;
+}
+
+void
+PcapReplayTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("replay.pcap");
+  uint64_t expected = WriteCapture (filename);
+  NS_TEST_ASSERT_MSG_NE (expected, 0, "Could not write " << filename);
+
+  // Keep the packets sent while the addresses of the sinks are resolved
+  Config::SetDefault ("ns3::ArpCache::PendingQueueSize", UintegerValue (60));
+  NodeContainer sources;
+  sources.Create (2);
+  NodeContainer sinks;
+  sinks.Create (2);
+  NodeContainer all (sources, sinks);
+  InternetStackHelper internet;
+  internet.Install (all);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < all.GetN (); i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetChannel (channel);
+      device->SetAddress (Mac48Address::Allocate ());
+      all.Get (i)->AddDevice (device);
+      devices.Add (device);
+    }
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  uint16_t port = 9;
+  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApps = sinkHelper.Install (sinks);
+
+  PcapReplayHelper replay (filename, port);
+  replay.AddRemote (interfaces.GetAddress (2));
+  replay.AddRemote (interfaces.GetAddress (3));
+  ApplicationContainer replayApps = replay.Install (sources);
+  replayApps.Start (Seconds (1.0));
+  for (uint32_t i = 0; i < replayApps.GetN (); i++)
+    {
+      replayApps.Get (i)->TraceConnectWithoutContext ("Tx", MakeCallback (&PcapReplayTestCase::Tx, this));
+    }
+
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+
+  uint64_t sent = 0;
+  for (uint32_t i = 0; i < replayApps.GetN (); i++)
+    {
+      sent += DynamicCast<PcapReplayApplication> (replayApps.Get (i))->GetTotalTx ();
+    }
+  uint64_t received = 0;
+  for (uint32_t i = 0; i < sinkApps.GetN (); i++)
+    {
+      received += DynamicCast<PacketSink> (sinkApps.Get (i))->GetTotalRx ();
+    }
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::ArpCache::PendingQueueSize", UintegerValue (3));
+  std::remove (filename.c_str ());
+
+  NS_TEST_EXPECT_MSG_EQ (m_sent, 60, "Every IPv4 record should be sent once");
+  NS_TEST_EXPECT_MSG_EQ (sent, expected, "Wrong number of bytes sent");
+  NS_TEST_EXPECT_MSG_EQ (received, expected, "Wrong number of bytes received");
+  NS_TEST_EXPECT_MSG_EQ (m_firstTx, Seconds (1.0), "The first record is sent when the applications start");
+  NS_TEST_EXPECT_MSG_EQ (m_lastTx, Seconds (1.0) + MilliSeconds (59), "The records keep their offsets");
+}
+
+/**
+ * \ingroup applications
+ * \ingroup tests
+ *
+ * Replay a capture twice with TraceLoop set, and check that the second
+ * pass sends every IPv4 record again, right after the first pass.
+ */
+class PcapReplayLoopTestCase : public TestCase
+{
+public:
+  PcapReplayLoopTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Record a packet sent.
+   * \param packet the packet
+   */
+  void Tx (Ptr<const Packet> packet);
+
+  std::vector<Time> m_txTimes;      //!< times of the packets sent
+  std::vector<uint32_t> m_txSizes;  //!< sizes of the packets sent
+};
+
+PcapReplayLoopTestCase::PcapReplayLoopTestCase ()
+  : TestCase ("Replay a capture in a loop")
+{
+}
+
+void
+PcapReplayLoopTestCase::Tx (Ptr<const Packet> packet)
+{
+  m_txTimes.push_back (Simulator::Now ());
+  m_txSizes.push_back (packet->GetSize ());
+}
+
+void
+PcapReplayLoopTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("replay-loop.pcap");
+  uint64_t expected = WriteCapture (filename);
+  NS_TEST_ASSERT_MSG_NE (expected, 0, "Could not write " << filename);
+
+  Config::SetDefault ("ns3::ArpCache::PendingQueueSize", UintegerValue (60));
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetChannel (channel);
+      device->SetAddress (Mac48Address::Allocate ());
+      nodes.Get (i)->AddDevice (device);
+      devices.Add (device);
+    }
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  uint16_t port = 9;
+  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  sinkHelper.Install (nodes.Get (1));
+  PcapReplayHelper replay (filename, port);
+  replay.SetAttribute ("TraceLoop", BooleanValue (true));
+  replay.AddRemote (interfaces.GetAddress (1));
+  ApplicationContainer replayApps = replay.Install (nodes.Get (0));
+  replayApps.Get (0)->TraceConnectWithoutContext ("Tx", MakeCallback (&PcapReplayLoopTestCase::Tx, this));
+  // A pass takes 59 ms; stop just before the last record of the second one
+  replayApps.Start (Seconds (1.0));
+  replayApps.Stop (Seconds (1.0) + MicroSeconds (117500));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::ArpCache::PendingQueueSize", UintegerValue (3));
+  std::remove (filename.c_str ());
+
+  // The second pass starts at the last record of the first one, so all
+  // but the last of its records are sent
+  NS_TEST_ASSERT_MSG_EQ (m_txTimes.size (), 119, "Every IPv4 record should be sent in each pass");
+  for (uint32_t i = 0; i < m_txTimes.size (); i++)
+    {
+      uint32_t pass = i / 60;
+      uint32_t k = i % 60;
+      NS_TEST_EXPECT_MSG_EQ (m_txSizes[i], 100 + 10 * k - 28, "Wrong size of record " << k << " in pass " << pass);
+      NS_TEST_EXPECT_MSG_EQ (m_txTimes[i], Seconds (1.0) + MilliSeconds (59 * pass + k),
+                             "Wrong time of record " << k << " in pass " << pass);
+    }
+}
+
+/**
+ * \ingroup applications
+ * \ingroup tests
+ *
+ * Replay a capture of more UDP flows than the ephemeral ports of a node,
+ * one record each, and check that every record is received.
+ */
+class PcapReplayManyFlowsTestCase : public TestCase
+{
+public:
+  PcapReplayManyFlowsTestCase ();
+  virtual void DoRun (void);
+};
+
+PcapReplayManyFlowsTestCase::PcapReplayManyFlowsTestCase ()
+  : TestCase ("Replay more flows than ephemeral ports")
+{
+}
+
+void
+PcapReplayManyFlowsTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("replay-flows.pcap");
+  PcapFile capture;
+  capture.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (capture.Fail (), false, "Could not write " << filename);
+  capture.Init (101, 24);
+  // The ephemeral ports of a node range from 49152 to 65535
+  uint32_t flows = 20000;
+  for (uint32_t k = 0; k < flows; k++)
+    {
+      uint8_t ip[24];
+      std::memset (ip, 0, sizeof (ip));
+      ip[0] = 0x45;
+      ip[3] = 100;
+      ip[9] = 17;
+      ip[12] = 192;
+      ip[13] = 168;
+      ip[16] = 10;
+      ip[19] = 1;
+      ip[20] = k >> 8;
+      ip[21] = k & 0xff;
+      ip[23] = 80;
+      capture.Write (0, 10 * k, ip, 100);
+    }
+  capture.Close ();
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetChannel (channel);
+      device->SetAddress (Mac48Address::Allocate ());
+      nodes.Get (i)->AddDevice (device);
+      devices.Add (device);
+    }
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  uint16_t port = 9;
+  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApps = sinkHelper.Install (nodes.Get (1));
+  PcapReplayHelper replay (filename, port);
+  replay.AddRemote (interfaces.GetAddress (1));
+  ApplicationContainer replayApps = replay.Install (nodes.Get (0));
+  replayApps.Start (Seconds (1.0));
+
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+  uint64_t sent = DynamicCast<PcapReplayApplication> (replayApps.Get (0))->GetTotalTx ();
+  uint64_t received = DynamicCast<PacketSink> (sinkApps.Get (0))->GetTotalRx ();
+  Simulator::Destroy ();
+  std::remove (filename.c_str ());
+
+  NS_TEST_EXPECT_MSG_EQ (sent, flows * (100 - 28), "Every flow should be sent");
+  // The first records wait for the address of the sink to be resolved
+  NS_TEST_EXPECT_MSG_EQ ((received + 3 * (100 - 28) >= sent), true, "Every flow should be received");
+}
+
+/**
+ * \ingroup applications
+ * \ingroup tests
+ *
+ * \brief PcapReplayApplication TestSuite
+ */
+class PcapReplayTestSuite : public TestSuite
+{
+public:
+  PcapReplayTestSuite ()
+    : TestSuite ("pcap-replay", UNIT)
+  {
+    AddTestCase (new PcapReplayTestCase (), TestCase::QUICK);
+    AddTestCase (new PcapReplayLoopTestCase (), TestCase::QUICK);
+    AddTestCase (new PcapReplayManyFlowsTestCase (), TestCase::QUICK);
+  }
+};
+
+static PcapReplayTestSuite g_pcapReplayTestSuite; //!< Static variable for test initialization
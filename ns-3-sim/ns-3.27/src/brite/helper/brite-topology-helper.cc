@@ -29,6 +29,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -312,6 +313,7 @@ BriteTopologyHelper::GetNAs (void) const
 uint32_t
 BriteTopologyHelper::GetSystemNumberForAs (uint32_t asNum) const
 {
+  NS_ABORT_MSG_IF (asNum >= m_systemForAs.size (), "AS " << asNum << " does not exist or the topology is not built");
   return m_systemForAs[asNum];
 }
 
@@ -416,6 +418,58 @@ BriteTopologyHelper::BuildBriteTopology (InternetStackHelper& stack, const uint3
   ConstructTopology ();
 }
 
+void
+BriteTopologyHelper::BuildBriteTopology (InternetStackHelper& stack, const uint32_t systemCount,
+                                         TopologyPartitioner& partitioner)
+{
+  NS_LOG_FUNCTION (this);
+  // The node numbers of the partitioner must be the BRITE ones
+  NS_ASSERT_MSG (partitioner.GetNNodes () == 0, "The partitioner already holds nodes");
+
+  GenerateBriteTopology ();
+
+  //describe the graph, nodes in the order they are created below
+  for (uint32_t i = 0; i < m_briteNodeInfoList.size (); ++i)
+    {
+      partitioner.AddNode ();
+    }
+  for (BriteTopologyHelper::BriteEdgeInfoList::iterator it = m_briteEdgeInfoList.begin (); it != m_briteEdgeInfoList.end (); ++it)
+    {
+      // The brite value for delay is given in milliseconds
+      partitioner.AddLink ((*it).srcId, (*it).destId, Seconds ((*it).delay / 1000.0));
+    }
+  std::vector<uint32_t> systemIds = partitioner.Partition (systemCount);
+  NS_LOG_LOGIC ("Partitioned " << systemIds.size () << " nodes into " << systemCount
+                               << " MPI instances, lookahead " << partitioner.GetLookAhead ());
+
+  //an AS may span several MPI instances; report the one holding most of its nodes
+  std::vector<std::vector<uint32_t> > nodesPerSystem (m_numAs, std::vector<uint32_t> (systemCount, 0));
+  for (uint32_t i = 0; i < systemIds.size (); ++i)
+    {
+      nodesPerSystem[m_briteNodeInfoList[i].asId][systemIds[i]]++;
+    }
+  for (uint32_t i = 0; i < m_numAs; ++i)
+    {
+      int val = std::max_element (nodesPerSystem[i].begin (), nodesPerSystem[i].end ()) - nodesPerSystem[i].begin ();
+      m_systemForAs.push_back (val);
+      NS_LOG_INFO ("AS: " << i << " System: " << val);
+    }
+
+  //create nodes
+  for (uint32_t i = 0; i < systemIds.size (); ++i)
+    {
+      NS_LOG_INFO ("Node: " << i << " System: " << systemIds[i]);
+      m_nodes.Add (CreateObject<Node> (systemIds[i]));
+      m_numNodes++;
+    }
+
+  NS_LOG_INFO (m_numNodes << " nodes created in BRITE topology");
+
+  stack.Install (m_nodes);
+
+  ConstructTopology ();
+}
+
 void
 BriteTopologyHelper::AssignIpv4Addresses (Ipv4AddressHelper& address)
 {
@@ -29,6 +29,7 @@
 #include "ns3/ipv6-address-helper.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/traffic-control-module.h"
+#include "ns3/topology-partitioner.h"
 
 //located in BRITE source directory
 #include "Brite.h"
@@ -105,6 +106,22 @@ public:
    */
   void BuildBriteTopology (InternetStackHelper& stack, const uint32_t systemCount);
 
+  /**
+   * Create NS3 topology using information generated from BRITE and configure topology for MPI use,
+   * with the nodes assigned to MPI instances by a TopologyPartitioner rather than by AS.
+   *
+   * \param stack Internet stack to assign to nodes in topology.
+   * \param systemCount The number of MPI instances to be used in the simulation.
+   * \param partitioner The partitioner, which must hold no node yet; the nodes and links of the
+   *        topology are added to it.  Traffic demands may be added beforehand, using the BRITE
+   *        node numbers.
+   *
+   * An AS may then span several MPI instances: GetSystemNumberForAs returns the one
+   * holding most of its nodes, and Node::GetSystemId gives the instance of each node.
+   */
+  void BuildBriteTopology (InternetStackHelper& stack, const uint32_t systemCount,
+                           TopologyPartitioner& partitioner);
+
   void SetQueue (std::string type = "RED");       //  additional patch: install tch on all internel node
 
   /**
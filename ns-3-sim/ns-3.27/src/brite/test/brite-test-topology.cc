@@ -25,6 +25,7 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/on-off-helper.h"
 #include "ns3/brite-module.h"
+#include "ns3/topology-partitioner.h"
 #include "ns3/test.h"
 #include <iostream>
 #include <fstream>
@@ -187,6 +188,89 @@ void BriteTopologyFunctionTestCase::DoRun (void)
 
 }
 
+class BriteTopologyPartitionTestCase : public TestCase
+{
+public:
+  BriteTopologyPartitionTestCase ();
+  virtual ~BriteTopologyPartitionTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+};
+
+BriteTopologyPartitionTestCase::BriteTopologyPartitionTestCase ()
+  : TestCase ("Test that a brite topology built with a partitioner assigns every node and AS to a system")
+{
+}
+
+BriteTopologyPartitionTestCase::~BriteTopologyPartitionTestCase ()
+{
+}
+
+void BriteTopologyPartitionTestCase::DoRun (void)
+{
+  std::string confFile = "src/brite/test/test.conf";
+  const uint32_t systemCount = 2;
+  BriteTopologyHelper bth (confFile);
+  InternetStackHelper stack;
+  TopologyPartitioner partitioner;
+
+  bth.BuildBriteTopology (stack, systemCount, partitioner);
+
+  NS_TEST_ASSERT_MSG_EQ (partitioner.GetNNodes (), bth.GetNNodesTopology (), "Every node should be partitioned");
+
+  std::vector<uint32_t> nodesPerSystem (systemCount, 0);
+  for (uint32_t i = 0; i < bth.GetNAs (); ++i)
+    {
+      std::vector<uint32_t> asNodesPerSystem (systemCount, 0);
+      for (uint32_t j = 0; j < bth.GetNNodesForAs (i); ++j)
+        {
+          uint32_t systemId = bth.GetNodeForAs (i, j)->GetSystemId ();
+          NS_TEST_ASSERT_MSG_LT (systemId, systemCount, "Node " << j << " of AS " << i << " has no valid system");
+          asNodesPerSystem[systemId]++;
+          nodesPerSystem[systemId]++;
+        }
+      uint32_t asSystem = bth.GetSystemNumberForAs (i);
+      NS_TEST_ASSERT_MSG_LT (asSystem, systemCount, "AS " << i << " has no valid system");
+      for (uint32_t k = 0; k < systemCount; ++k)
+        {
+          NS_TEST_ASSERT_MSG_GT_OR_EQ (asNodesPerSystem[asSystem], asNodesPerSystem[k],
+                                       "AS " << i << " should be reported on the system holding most of its nodes");
+        }
+    }
+  for (uint32_t k = 0; k < systemCount; ++k)
+    {
+      NS_TEST_ASSERT_MSG_GT (nodesPerSystem[k], 0, "System " << k << " has no node");
+    }
+
+  //links between systems bound the lookahead
+  for (uint32_t i = 0; i < bth.GetNAs (); ++i)
+    {
+      for (uint32_t j = 0; j < bth.GetNNodesForAs (i); ++j)
+        {
+          Ptr<Node> node = bth.GetNodeForAs (i, j);
+          for (uint32_t d = 0; d < node->GetNDevices (); ++d)
+            {
+              Ptr<PointToPointChannel> channel = DynamicCast<PointToPointChannel> (node->GetDevice (d)->GetChannel ());
+              if (channel == 0)
+                {
+                  continue;
+                }
+              if (channel->GetDevice (0)->GetNode ()->GetSystemId () != channel->GetDevice (1)->GetNode ()->GetSystemId ())
+                {
+                  TimeValue delay;
+                  channel->GetAttribute ("Delay", delay);
+                  NS_TEST_ASSERT_MSG_GT_OR_EQ (delay.Get (), partitioner.GetLookAhead (),
+                                               "A link between systems is shorter than the lookahead");
+                }
+            }
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
 class BriteTestSuite : public TestSuite
 {
 public:
@@ -194,5 +278,6 @@ public:
   {
     AddTestCase (new BriteTopologyStructureTestCase, TestCase::QUICK);
     AddTestCase (new BriteTopologyFunctionTestCase, TestCase::QUICK);
+    AddTestCase (new BriteTopologyPartitionTestCase, TestCase::QUICK);
   }
 } g_briteTestSuite;
@@ -24,8 +24,10 @@
 #include "object-ptr-container.h"
 #include "names.h"
 #include "pointer.h"
+#include "simple-ref-count.h"
 #include "log.h"
 
+#include <map>
 #include <sstream>
 
 /**
@@ -261,6 +263,171 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
   return !iss.bad () && !iss.fail ();
 }
 
+/**
+ * \ingroup config-impl
+ * A Config path split into its segments, with the type lookups done
+ * once for all the resolutions of the path.
+ */
+class CompiledPath : public SimpleRefCount<CompiledPath>
+{
+public:
+  /**
+   * Construct from a Config path.
+   *
+   * \param [in] path The Config path.
+   */
+  CompiledPath (std::string path);
+
+  /** A pointer or container attribute matching a segment. */
+  struct Attribute
+  {
+    std::string name;                           //!< Attribute name
+    bool container;                             //!< Whether it is a container
+    bool gettable;                              //!< Whether it can be read with accessor
+    Ptr<const AttributeAccessor> accessor;      //!< Accessor of the attribute
+  };
+  /** A segment of the path, between two slashes. */
+  struct Segment
+  {
+    std::string item;   //!< The segment
+    bool names;         //!< Whether the remaining path starts with "/Names"
+    bool getObject;     //!< Whether the segment is a $TypeId
+    bool tidFound;      //!< Whether the TypeId of a $TypeId segment exists
+    TypeId tid;         //!< The TypeId of a $TypeId segment
+    bool single;        //!< Whether the segment is a single array index
+    uint32_t index;     //!< The single array index
+    /** The matching attributes, per TypeId uid of the object. */
+    std::map<uint16_t, std::vector<Attribute> > attributes;
+  };
+
+  /** \returns The path given to the constructor. */
+  std::string GetPath (void) const;
+  /** \returns The number of segments. */
+  uint32_t GetN (void) const;
+  /**
+   * \param [in] i The index of the segment.
+   * \returns The segment.
+   */
+  const Segment & Get (uint32_t i) const;
+  /**
+   * Get the pointer and container attributes of an object type which
+   * match a segment, in the order they are visited by the Resolver.
+   *
+   * \param [in] i The index of the segment.
+   * \param [in] tid The type of the object.
+   * \returns The matching attributes.
+   */
+  const std::vector<Attribute> & GetAttributes (uint32_t i, TypeId tid);
+
+private:
+  /** The Config path. */
+  std::string m_path;
+  /** The segments of the canonical path. */
+  std::vector<Segment> m_segments;
+
+};  // class CompiledPath
+
+CompiledPath::CompiledPath (std::string path)
+  : m_path (path)
+{
+  NS_LOG_FUNCTION (this << path);
+
+  // ensure that we start and end with a '/'
+  if (path.find ("/") != 0)
+    {
+      path = "/" + path;
+    }
+  if (path.find_last_of ("/") != (path.size () - 1))
+    {
+      path = path + "/";
+    }
+
+  std::string::size_type start = 0;
+  std::string::size_type next;
+  while ((next = path.find ("/", start + 1)) != std::string::npos)
+    {
+      Segment segment;
+      segment.item = path.substr (start + 1, next - (start + 1));
+      segment.names = path.compare (start, 6, "/Names") == 0;
+      segment.getObject = segment.item.find ("$") == 0;
+      segment.tidFound = segment.getObject
+        && TypeId::LookupByNameFailSafe (segment.item.substr (1), &segment.tid);
+      // the index must print back as the item, as it is in the context
+      std::istringstream iss (segment.item);
+      segment.single = !segment.item.empty ()
+        && segment.item.find_first_not_of ("0123456789") == std::string::npos
+        && (segment.item == "0" || segment.item[0] != '0')
+        && (iss >> segment.index);
+      m_segments.push_back (segment);
+      start = next;
+    }
+}
+std::string
+CompiledPath::GetPath (void) const
+{
+  return m_path;
+}
+uint32_t
+CompiledPath::GetN (void) const
+{
+  return m_segments.size ();
+}
+const CompiledPath::Segment &
+CompiledPath::Get (uint32_t i) const
+{
+  return m_segments[i];
+}
+const std::vector<CompiledPath::Attribute> &
+CompiledPath::GetAttributes (uint32_t i, TypeId tid)
+{
+  NS_LOG_FUNCTION (this << i << tid);
+  Segment &segment = m_segments[i];
+  std::map<uint16_t, std::vector<Attribute> >::iterator found = segment.attributes.find (tid.GetUid ());
+  if (found != segment.attributes.end ())
+    {
+      return found->second;
+    }
+
+  std::vector<Attribute> &attributes = segment.attributes[tid.GetUid ()];
+  TypeId instance = tid;
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t j = 0; j < tid.GetAttributeN (); j++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (j);
+          if (info.name != segment.item && segment.item != "*")
+            {
+              continue;
+            }
+          Attribute attribute;
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.container = false;
+            }
+          else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.container = true;
+            }
+          else
+            {
+              continue;
+            }
+          // ObjectBase::GetAttribute reads the first attribute of this
+          // name, starting from the type of the instance
+          struct TypeId::AttributeInformation read;
+          instance.LookupAttributeByName (info.name, &read);
+          attribute.name = info.name;
+          attribute.gettable = (read.flags & TypeId::ATTR_GET) && read.accessor->HasGetter ();
+          attribute.accessor = read.accessor;
+          attributes.push_back (attribute);
+        }
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+  return attributes;
+}
+
 /**
  * \ingroup config-impl
  * Abstract class to parse Config paths into object references.
@@ -273,7 +440,7 @@ public:
    *
    * \param [in] path The Config path.
    */
-  Resolver (std::string path);
+  Resolver (CompiledPath &path);
   /** Destructor. */
   virtual ~Resolver ();
 
@@ -287,23 +454,22 @@ public:
   void Resolve (Ptr<Object> root);
   
 private:
-  /** Ensure the Config path starts and ends with a '/'. */
-  void Canonicalize (void);
   /**
    * Parse the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] i The index of the next segment of the Config path.
    * \param [in] root The object corresponding to the current positon
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (uint32_t i, Ptr<Object> root);
   /**
    * Parse an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
-   * \param [in,out] vector The resulting list of matching objects.
+   * \param [in] i The index of the next segment of the Config path.
+   * \param [in] root The object holding the container.
+   * \param [in] attribute The container attribute of \p root.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (uint32_t i, Ptr<Object> root, const CompiledPath::Attribute &attribute);
   /**
    * Handle one object found on the path.
    *
@@ -327,46 +493,26 @@ private:
   /** Current list of path tokens. */
   std::vector<std::string> m_workStack;
   /** The Config path. */
-  std::string m_path;
+  CompiledPath &m_path;
 
 };  // class Resolver
 
-Resolver::Resolver (std::string path)
+Resolver::Resolver (CompiledPath &path)
   : m_path (path)
 {
-  NS_LOG_FUNCTION (this << path);
-  Canonicalize ();
+  NS_LOG_FUNCTION (this << path.GetPath ());
 }
 Resolver::~Resolver ()
 {
   NS_LOG_FUNCTION (this);
 }
-void
-Resolver::Canonicalize (void)
-{
-  NS_LOG_FUNCTION (this);
-
-  // ensure that we start and end with a '/'
-  std::string::size_type tmp = m_path.find ("/");
-  if (tmp != 0)
-    {
-      // no slash at start
-      m_path = "/" + m_path;
-    }
-  tmp = m_path.find_last_of ("/");
-  if (tmp != (m_path.size () - 1))
-    {
-      // no slash at end
-      m_path = m_path + "/";
-    }
-}
 
 void 
 Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -392,13 +538,11 @@ Resolver::DoResolveOne (Ptr<Object> object)
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (uint32_t i, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << i << root);
 
-  if (next == std::string::npos)
+  if (i == m_path.GetN ())
     {
       //
       // If root is zero, we're beginning to see if we can use the object name 
@@ -414,8 +558,8 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const CompiledPath::Segment &segment = m_path.Get (i);
+  const std::string &item = segment.item;
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -424,16 +568,12 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   // the root of the "/Names" namespace, so we just ignore it and move on to 
   // the next segment.
   //
-  if (root == 0)
+  if (root == 0 && segment.names)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
-        {
-          m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
-          m_workStack.pop_back ();
-          return;
-        }
+      m_workStack.push_back (item);
+      DoResolve (i + 1, root);
+      m_workStack.pop_back ();
+      return;
     }
 
   //
@@ -447,7 +587,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (i + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -463,82 +603,62 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       return;
     }
-  std::string::size_type dollarPos = item.find ("$");
-  if (dollarPos == 0)
+  if (segment.getObject)
     {
       // This is a call to GetObject
-      std::string tidString = item.substr (1, item.size () - 1);
-      NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
+      NS_LOG_DEBUG ("GetObject="<<item.substr (1)<<" on path="<<GetResolvedPath ());
+      TypeId tid = segment.tidFound ? segment.tid : TypeId::LookupByName (item.substr (1));
       Ptr<Object> object = root->GetObject<Object> (tid);
       if (object == 0)
         {
-          NS_LOG_DEBUG ("GetObject ("<<tidString<<") failed on path="<<GetResolvedPath ());
+          NS_LOG_DEBUG ("GetObject ("<<item.substr (1)<<") failed on path="<<GetResolvedPath ());
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (i + 1, object);
       m_workStack.pop_back ();
     }
   else 
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
+      const std::vector<CompiledPath::Attribute> &attributes =
+        m_path.GetAttributes (i, root->GetInstanceTypeId ());
       bool foundMatch = false;
-      
-      do
+
+      for (std::vector<CompiledPath::Attribute>::const_iterator j = attributes.begin ();
+           j != attributes.end (); ++j)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          if (!j->container)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
-                {
-                  continue;
-                }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *ptr = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-              if (ptr != 0)
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<j->name<<" on path="<<GetResolvedPath ());
+              PointerValue ptr;
+              if (!j->gettable || !j->accessor->Get (PeekPointer (root), ptr))
                 {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue ptr;
-                  root->GetAttribute (info.name, ptr);
-                  Ptr<Object> object = ptr.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
+                  root->GetAttribute (j->name, ptr);
                 }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
+              Ptr<Object> object = ptr.Get<Object> ();
+              if (object == 0)
                 {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
+                  NS_LOG_ERROR ("Requested object name=\""<<item<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
+                  continue;
                 }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              foundMatch = true;
+              m_workStack.push_back (j->name);
+              DoResolve (i + 1, object);
+              m_workStack.pop_back ();
             }
+          else
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<j->name<<" on path="<<GetResolvedPath ());
+              foundMatch = true;
+              m_workStack.push_back (j->name);
+              DoArrayResolve (i + 1, root, *j);
+              m_workStack.pop_back ();
+            }
+        }
 
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
-      
       if (!foundMatch)
         {
           NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
@@ -548,20 +668,40 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (uint32_t i, Ptr<Object> root, const CompiledPath::Attribute &attribute)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION (this << i << root << attribute.name);
+  if (i == m_path.GetN ())
     {
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const CompiledPath::Segment &segment = m_path.Get (i);
 
-  ArrayMatcher matcher = ArrayMatcher (item);
+  //
+  // A single index is looked up at its position in the container, without
+  // reading the whole container: the position is the index in containers
+  // of the ObjectVector kind, which are the ones large enough to matter.
+  //
+  const ObjectPtrContainerAccessor *accessor =
+    dynamic_cast<const ObjectPtrContainerAccessor *> (PeekPointer (attribute.accessor));
+  uint32_t n;
+  if (segment.single && attribute.gettable && accessor != 0
+      && accessor->GetN (PeekPointer (root), &n) && segment.index < n)
+    {
+      uint32_t index;
+      Ptr<Object> object = accessor->Get (PeekPointer (root), segment.index, &index);
+      if (index == segment.index)
+        {
+          m_workStack.push_back (segment.item);
+          DoResolve (i + 1, object);
+          m_workStack.pop_back ();
+          return;
+        }
+    }
+
+  ObjectPtrContainerValue container;
+  root->GetAttribute (attribute.name, container);
+  ArrayMatcher matcher = ArrayMatcher (segment.item);
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
@@ -570,7 +710,7 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
           std::ostringstream oss;
           oss << (*it).first;
           m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
+          DoResolve (i + 1, (*it).second);
           m_workStack.pop_back ();
         }
     }
@@ -595,6 +735,11 @@ public:
   void Disconnect (std::string path, const CallbackBase &cb);
   /** \copydoc Config::LookupMatches() */
   MatchContainer LookupMatches (std::string path);
+  /**
+   * \copydoc Config::LookupMatches()
+   * \param [in] path The parsed Config path.
+   */
+  MatchContainer LookupMatches (CompiledPath &path);
 
   /** \copydoc Config::RegisterRootNamespaceObject() */
   void RegisterRootNamespaceObject (Ptr<Object> obj);
@@ -689,10 +834,18 @@ MatchContainer
 ConfigImpl::LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
+  CompiledPath compiled (path);
+  return LookupMatches (compiled);
+}
+
+MatchContainer 
+ConfigImpl::LookupMatches (CompiledPath &path)
+{
+  NS_LOG_FUNCTION (this << path.GetPath ());
   class LookupMatchesResolver : public Resolver 
   {
   public:
-    LookupMatchesResolver (std::string path)
+    LookupMatchesResolver (CompiledPath &path)
       : Resolver (path)
     {}
     virtual void DoOne (Ptr<Object> object, std::string path)
@@ -715,7 +868,7 @@ ConfigImpl::LookupMatches (std::string path)
   //
   resolver.Resolve (0);
 
-  return MatchContainer (resolver.m_objects, resolver.m_contexts, path);
+  return MatchContainer (resolver.m_objects, resolver.m_contexts, path.GetPath ());
 }
 
 void 
@@ -723,6 +876,7 @@ ConfigImpl::RegisterRootNamespaceObject (Ptr<Object> obj)
 {
   NS_LOG_FUNCTION (this << obj);
   m_roots.push_back (obj);
+  InvalidateCache ();
 }
 
 void 
@@ -735,6 +889,7 @@ ConfigImpl::UnregisterRootNamespaceObject (Ptr<Object> obj)
       if (*i == obj)
         {
           m_roots.erase (i);
+          InvalidateCache ();
           return;
         }
     }
@@ -753,6 +908,121 @@ ConfigImpl::GetRootNamespaceObject (uint32_t i) const
   return m_roots[i];
 }
 
+/**
+ * \ingroup config-impl
+ * The generation of the object graph, see Config::GetGeneration.
+ */
+static uint64_t g_generation = 1;
+
+/**
+ * \ingroup config-impl
+ * The matches of the ConfigPath lookups of the current generation, by
+ * path.
+ * \returns The cache.
+ */
+static std::map<std::string, MatchContainer> &
+GetMatchCache (void)
+{
+  static std::map<std::string, MatchContainer> cache;
+  return cache;
+}
+
+uint64_t GetGeneration (void)
+{
+  return g_generation;
+}
+
+void InvalidateCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_generation++;
+  // Released once out of the cache, as releasing an object may
+  // invalidate the cache again
+  std::map<std::string, MatchContainer> matches;
+  matches.swap (GetMatchCache ());
+}
+
+ConfigPath::ConfigPath ()
+  : m_compiled (Create<CompiledPath> ("/"))
+{
+  NS_LOG_FUNCTION (this);
+}
+ConfigPath::ConfigPath (std::string path)
+  : m_compiled (Create<CompiledPath> (path))
+{
+  NS_LOG_FUNCTION (this << path);
+}
+ConfigPath::ConfigPath (const ConfigPath &o)
+  : m_compiled (o.m_compiled)
+{
+  NS_LOG_FUNCTION (this << &o);
+}
+ConfigPath &
+ConfigPath::operator = (const ConfigPath &o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  m_compiled = o.m_compiled;
+  return *this;
+}
+ConfigPath::~ConfigPath ()
+{
+  NS_LOG_FUNCTION (this);
+}
+std::string
+ConfigPath::GetPath (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_compiled->GetPath ();
+}
+MatchContainer
+ConfigPath::LookupMatches (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::string path = m_compiled->GetPath ();
+  std::map<std::string, MatchContainer>::const_iterator it = GetMatchCache ().find (path);
+  if (it != GetMatchCache ().end ())
+    {
+      return it->second;
+    }
+  uint64_t generation = g_generation;
+  MatchContainer matches = ConfigImpl::Get ()->LookupMatches (*PeekPointer (m_compiled));
+  // Not kept if the lookup itself changed the graph
+  if (generation == g_generation)
+    {
+      GetMatchCache ()[path] = matches;
+    }
+  return matches;
+}
+void
+ConfigPath::Set (std::string name, const AttributeValue &value) const
+{
+  NS_LOG_FUNCTION (this << name << &value);
+  LookupMatches ().Set (name, value);
+}
+void
+ConfigPath::Connect (std::string name, const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << name << &cb);
+  LookupMatches ().Connect (name, cb);
+}
+void
+ConfigPath::ConnectWithoutContext (std::string name, const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << name << &cb);
+  LookupMatches ().ConnectWithoutContext (name, cb);
+}
+void
+ConfigPath::Disconnect (std::string name, const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << name << &cb);
+  LookupMatches ().Disconnect (name, cb);
+}
+void
+ConfigPath::DisconnectWithoutContext (std::string name, const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << name << &cb);
+  LookupMatches ().DisconnectWithoutContext (name, cb);
+}
 
 void Reset (void)
 {
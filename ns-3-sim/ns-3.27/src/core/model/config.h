@@ -21,6 +21,7 @@
 #define CONFIG_H
 
 #include "ptr.h"
+#include <stdint.h>
 #include <string>
 #include <vector>
 
@@ -258,6 +259,126 @@ private:
  */
 MatchContainer LookupMatches (std::string path);
 
+class CompiledPath;
+
+/**
+ * \ingroup config
+ * \brief A Config path parsed once, whose matches are kept until the
+ * object graph changes.
+ *
+ * Config::Set, Config::Connect and the other functions parse their path
+ * and walk the attributes of every object on it at each call.  A
+ * ConfigPath parses the path once, when it is constructed, and looks its
+ * matches up in a cache shared by every ConfigPath, keyed by the path and
+ * the generation of the object graph (see Config::GetGeneration).  A path
+ * is resolved again only when the graph has changed since its previous
+ * lookup, so a topology can be wired with one handle per path instead of
+ * one full resolution per call.
+ *
+ * The generation changes when nodes, devices, applications or channels
+ * are added, objects are aggregated, names are added or renamed, root
+ * namespace objects are registered, or TCP and UDP sockets are created
+ * or removed.  Each change empties the cache, which therefore never keeps
+ * alive an object removed from the graph, such as a closed socket.
+ * Other changes of the objects reached by the path, e.g. a queue disc
+ * installed after the first lookup, must be followed by a call to
+ * Config::InvalidateCache.
+ *
+ * \code
+ *   Config::ConfigPath socket ("/NodeList/3/$ns3::TcpL4Protocol/SocketList/0");
+ *   socket.Connect ("CongestionWindow", MakeCallback (&CwndChange));
+ *   socket.Connect ("RTT", MakeCallback (&RttChange));
+ * \endcode
+ */
+class ConfigPath
+{
+public:
+  ConfigPath ();
+  /**
+   * \param [in] path The path to the objects, without the name of an
+   *                  attribute or trace source, as for
+   *                  Config::LookupMatches.
+   */
+  ConfigPath (std::string path);
+  /**
+   * Copy constructor: the copy shares the parsed path.
+   * \param [in] o The ConfigPath to copy.
+   */
+  ConfigPath (const ConfigPath &o);
+  /**
+   * Assignment operator: the copy shares the parsed path.
+   * \param [in] o The ConfigPath to copy.
+   * \returns This ConfigPath.
+   */
+  ConfigPath &operator = (const ConfigPath &o);
+  ~ConfigPath ();
+
+  /**
+   * \returns The path given to the constructor.
+   */
+  std::string GetPath (void) const;
+  /**
+   * \returns The objects matching the path, resolved again only if the
+   *          object graph changed since the previous lookup of the path.
+   */
+  MatchContainer LookupMatches (void) const;
+
+  /**
+   * \param [in] name Name of attribute to set
+   * \param [in] value Value to set to the attribute
+   * \sa MatchContainer::Set
+   */
+  void Set (std::string name, const AttributeValue &value) const;
+  /**
+   * \param [in] name The name of the trace source to connect to
+   * \param [in] cb The sink to connect to the trace source
+   * \sa MatchContainer::Connect
+   */
+  void Connect (std::string name, const CallbackBase &cb) const;
+  /**
+   * \param [in] name The name of the trace source to connect to
+   * \param [in] cb The sink to connect to the trace source
+   * \sa MatchContainer::ConnectWithoutContext
+   */
+  void ConnectWithoutContext (std::string name, const CallbackBase &cb) const;
+  /**
+   * \param [in] name The name of the trace source to disconnect from
+   * \param [in] cb The sink to disconnect from the trace source
+   * \sa MatchContainer::Disconnect
+   */
+  void Disconnect (std::string name, const CallbackBase &cb) const;
+  /**
+   * \param [in] name The name of the trace source to disconnect from
+   * \param [in] cb The sink to disconnect from the trace source
+   * \sa MatchContainer::DisconnectWithoutContext
+   */
+  void DisconnectWithoutContext (std::string name, const CallbackBase &cb) const;
+
+private:
+  /** The parsed path. */
+  Ptr<CompiledPath> m_compiled;
+};
+
+/**
+ * \ingroup config
+ * \returns The generation of the object graph, which changes whenever
+ *          objects which can be reached by a Config path are added.
+ *
+ * \sa ConfigPath
+ */
+uint64_t GetGeneration (void);
+/**
+ * \ingroup config
+ * Start a new generation of the object graph, and empty the cache of the
+ * ConfigPath matches, so that every ConfigPath is resolved again at its
+ * next use.
+ *
+ * Called by the containers of the object graph when they change; a
+ * program must call it only after changes of objects which do not
+ * notify it.
+ */
+void InvalidateCache (void);
+
 /**
  * \ingroup config
  * \param [in] obj A new root object
@@ -23,6 +23,7 @@
 #include "abort.h"
 #include "names.h"
 #include "singleton.h"
+#include "config.h"
 
 /**
  * \file
@@ -311,6 +312,7 @@ NamesPriv::Clear (void)
   m_root.m_name = "Names";
   m_root.m_object = 0;
   m_root.m_nameMap.clear ();
+  Config::InvalidateCache ();
 }
 
 bool
@@ -417,6 +419,7 @@ NamesPriv::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
   NameNode *newNode = new NameNode (node, name, object);
   node->m_nameMap[name] = newNode;
   m_objectMap[object] = newNode;
+  Config::InvalidateCache ();
 
   return true;
 }
@@ -538,6 +541,7 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       NameNode *changeNode = i->second;
       node->m_nameMap.erase (i);
       changeNode->m_name = newname;
+      Config::InvalidateCache ();
       node->m_nameMap[newname] = changeNode;
       return true;
     }
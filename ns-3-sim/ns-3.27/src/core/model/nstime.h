@@ -443,6 +443,20 @@ public:
   {
     return From (int64x64_t (value), unit);
   }
+  /**
+   *  Get the number of time steps in one second at the current resolution.
+   *
+   *  This is the integer scale used by the fast paths which avoid
+   *  int64x64_t, such as DataRate::CalculateBytesTxTime().
+   *
+   *  \return The number of time steps per second, or 0 if the current
+   *          resolution is coarser than one second.
+   */
+  inline static int64_t GetStepsPerSecond (void)
+  {
+    struct Information *info = PeekInformation (Time::S);
+    return info->fromMul ? info->factor : 0;
+  }
   inline static Time From (const int64x64_t & value, enum Unit unit)
   {
     struct Information *info = PeekInformation (unit);
@@ -490,6 +504,13 @@ public:
   }
   inline double ToDouble (enum Unit unit) const
   {
+    struct Information *info = PeekInformation (unit);
+    if (!info->toMul)
+      {
+        // Integer scale, e.g. GetSeconds () at nanosecond resolution:
+        // a single correctly rounded division, no int64x64_t needed.
+        return static_cast<double> (m_data) / info->factor;
+      }
     return To (unit).GetDouble ();
   }
   inline int64x64_t To (enum Unit unit) const
@@ -633,6 +654,9 @@ private:
      ClearMarkedTimes ()
   */
   friend class Simulator;
+  /* Friend the TimeLiteral class so it can pick its steps at the current
+     resolution without a call */
+  friend class TimeLiteral;
   /**
    *  Remove all MarkedTimes.
    *
@@ -1039,6 +1063,127 @@ inline Time FemtoSeconds (int64x64_t value)
   return Time::From (value, Time::FS);
 }
 /**@}*/
+
+/**
+ * \ingroup timecivil
+ * \brief A constant duration, converted to time steps at compile time.
+ *
+ * Seconds (double) converts through int64x64_t on every call.  A
+ * TimeLiteral holds the number of steps of the duration at every
+ * resolution, rounded to the nearest step, so that its conversion to Time
+ * only picks the one of the current resolution:
+ * \code
+ *   constexpr TimeLiteral interval = MilliSecondsLiteral (0.5);
+ *   Simulator::Schedule (interval, ...);
+ * \endcode
+ * Seconds (double) truncates instead, so the two can differ by one step
+ * when the value is not exactly representable as a double.  A duration
+ * too long for the current resolution, e.g. beyond about 2.5 hours at
+ * femtosecond resolution, asserts when converted.
+ */
+class TimeLiteral
+{
+public:
+  /**
+   * \param [in] value The duration, in \p unit
+   * \param [in] unit The unit of \p value
+   */
+  constexpr TimeLiteral (double value, Time::Unit unit)
+    : m_steps { Round (Scale (value, unit, Time::Y)), Round (Scale (value, unit, Time::D)),
+                Round (Scale (value, unit, Time::H)), Round (Scale (value, unit, Time::MIN)),
+                Round (Scale (value, unit, Time::S)), Round (Scale (value, unit, Time::MS)),
+                Round (Scale (value, unit, Time::US)), Round (Scale (value, unit, Time::NS)),
+                Round (Scale (value, unit, Time::PS)), Round (Scale (value, unit, Time::FS)) }
+  {
+  }
+
+  /**
+   * \param [in] resolution A resolution
+   * \return The number of steps of the duration at \p resolution
+   */
+  constexpr int64_t GetSteps (Time::Unit resolution) const
+  {
+    return m_steps[resolution];
+  }
+
+  /**
+   * \return The duration at the current resolution
+   */
+  inline operator Time () const
+  {
+    int64_t steps = m_steps[Time::PeekResolution ()->unit];
+    NS_ASSERT_MSG (steps != std::numeric_limits<int64_t>::min (),
+                   "TimeLiteral out of range at the current resolution");
+    return Time (steps);
+  }
+
+private:
+  /**
+   * \param [in] e A non-negative exponent
+   * \return 10 to the power \p e, exact up to 1e22
+   */
+  static constexpr double Pow10 (int e)
+  {
+    return e == 0 ? 1.0 : 10.0 * Pow10 (e - 1);
+  }
+  /**
+   * \param [in] unit A unit
+   * \return The number of seconds in one \p unit
+   */
+  static constexpr double SecondsPer (int unit)
+  {
+    return unit == Time::Y ? 31536000.0
+      : unit == Time::D ? 86400.0
+      : unit == Time::H ? 3600.0
+      : unit == Time::MIN ? 60.0
+      : 1.0 / Pow10 (3 * (unit - Time::S));
+  }
+  /**
+   * Convert between units, with a single exact power of ten between the
+   * units of one second and below.
+   * \param [in] value A value in \p from
+   * \param [in] from The unit of \p value
+   * \param [in] to The unit to convert to
+   * \return The value in \p to
+   */
+  static constexpr double Scale (double value, int from, int to)
+  {
+    return from >= Time::S && to >= Time::S
+      ? (to >= from ? value * Pow10 (3 * (to - from)) : value / Pow10 (3 * (from - to)))
+      : value * SecondsPer (from) / SecondsPer (to);
+  }
+  /**
+   * \param [in] steps A number of steps
+   * \return \p steps rounded to the nearest integer, or the smallest
+   *         int64_t if it does not fit
+   */
+  static constexpr int64_t Round (double steps)
+  {
+    return steps >= 0
+      ? (steps < 9.2e18 ? static_cast<int64_t> (steps + 0.5) : std::numeric_limits<int64_t>::min ())
+      : (steps > -9.2e18 ? static_cast<int64_t> (steps - 0.5) : std::numeric_limits<int64_t>::min ());
+  }
+
+  int64_t m_steps[Time::LAST];  //!< Steps of the duration, by resolution
+};
+
+/**
+ * \ingroup timecivil
+ * \brief Construct a constant duration at compile time.
+ *
+ * \param [in] value The value
+ * \return The TimeLiteral
+ * @{
+ */
+constexpr TimeLiteral SecondsLiteral (double value)
+{
+  return TimeLiteral (value, Time::S);
+}
+constexpr TimeLiteral MilliSecondsLiteral (double value)
+{
+  return TimeLiteral (value, Time::MS);
+}
+/**@}*/
   
 
 /**
@@ -25,6 +25,7 @@
 #include "attribute.h"
 #include "log.h"
 #include "string.h"
+#include "config.h"
 #include <vector>
 #include <sstream>
 #include <cstdlib>
@@ -296,6 +297,7 @@ Object::AggregateObject (Ptr<Object> o)
       Object *current = aggregates->buffer[i];
       current->m_aggregates = aggregates;
     }
+  Config::InvalidateCache ();
 
   // Finally, call NotifyNewAggregate on all the objects aggregates together.
   // We purposely use the old aggregate buffers to iterate over the objects
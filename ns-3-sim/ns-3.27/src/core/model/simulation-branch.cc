@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "simulation-branch.h"
+#include "fatal-error.h"
+#include "assert.h"
+#include "log.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::SimulationBranch implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SimulationBranch");
+
+int32_t SimulationBranch::m_branch = -1;
+
+int32_t
+SimulationBranch::Fork (uint32_t nBranches, uint32_t maxParallel,
+                        std::vector<int> *status)
+{
+  NS_LOG_FUNCTION (nBranches << maxParallel << status);
+  NS_ASSERT_MSG (m_branch < 0, "Cannot branch again from branch " << m_branch);
+
+  if (maxParallel == 0 || maxParallel > nBranches)
+    {
+      maxParallel = nBranches;
+    }
+  if (status != 0)
+    {
+      status->assign (nBranches, -1);
+    }
+
+  // Anything still buffered would otherwise be written by every branch
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::clog.flush ();
+  std::fflush (0);
+
+  std::map<pid_t, uint32_t> running;
+  uint32_t next = 0;
+  while (next < nBranches || !running.empty ())
+    {
+      if (next < nBranches && running.size () < maxParallel)
+        {
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              NS_FATAL_ERROR ("SimulationBranch::Fork(): fork() failed: " << std::strerror (errno));
+            }
+          if (pid == 0)
+            {
+              m_branch = next;
+              NS_LOG_INFO ("Branch " << next << " started");
+              return m_branch;
+            }
+          NS_LOG_LOGIC ("Branch " << next << " is pid " << pid);
+          running[pid] = next++;
+          continue;
+        }
+
+      // Wait until a child has exited, without reaping it: it may be a
+      // child of the program, which is not ours to reap
+      siginfo_t info;
+      std::memset (&info, 0, sizeof (info));
+      if (waitid (P_ALL, 0, &info, WEXITED | WNOWAIT) < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          NS_FATAL_ERROR ("SimulationBranch::Fork(): waitid() failed: " << std::strerror (errno));
+        }
+      // Then reap the branches which have exited, if any
+      int wstatus = 0;
+      std::map<pid_t, uint32_t>::iterator it = running.begin ();
+      while (it != running.end ())
+        {
+          pid_t pid = waitpid (it->first, &wstatus, WNOHANG);
+          if (pid < 0 && errno != EINTR)
+            {
+              NS_FATAL_ERROR ("SimulationBranch::Fork(): waitpid() failed: " << std::strerror (errno));
+            }
+          if (pid == it->first)
+            {
+              break;
+            }
+          ++it;
+        }
+      if (it == running.end ())
+        {
+          // The child which exited is not a branch, and stays a zombie
+          // until the program reaps it: poll the branches meanwhile
+          usleep (1000);
+          continue;
+        }
+      int exitStatus = WIFEXITED (wstatus) ? WEXITSTATUS (wstatus) : -1;
+      NS_LOG_INFO ("Branch " << it->second << " exited with status " << exitStatus);
+      if (status != 0)
+        {
+          (*status)[it->second] = exitStatus;
+        }
+      running.erase (it);
+    }
+  return -1;
+}
+
+int32_t
+SimulationBranch::GetBranch (void)
+{
+  return m_branch;
+}
+
+} // namespace ns3
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SIMULATION_BRANCH_H
+#define SIMULATION_BRANCH_H
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::SimulationBranch declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Branch several simulation variants from one warmed-up state.
+ *
+ * Sweeps which only change a few parameters after a common warm-up
+ * (TCP slow start, RED averages settling) can run the warm-up once and
+ * then branch:
+ * \code
+ *   Simulator::Stop (Seconds (warmup));
+ *   Simulator::Run ();
+ *   int32_t branch = SimulationBranch::Fork (variants.size (), nCores);
+ *   if (branch < 0)
+ *     {
+ *       return 0;     // parent: every variant has finished
+ *     }
+ *   ApplyVariant (variants[branch]);
+ *   Simulator::Stop (Seconds (tStop - warmup));
+ *   Simulator::Run ();
+ *   Simulator::Destroy ();
+ * \endcode
+ *
+ * Each branch is a child process created with fork(), so it starts from
+ * an exact copy of the warmed-up state: simulator time, pending events,
+ * nodes, sockets, queues and the position of every random variable
+ * stream.  Unchanged variants therefore reproduce the unbranched run.
+ * Memory is shared copy-on-write, so a branch only pays for the pages it
+ * modifies.
+ *
+ * A full serialisation of the state to a file is not offered: the event
+ * queue holds bound member function closures and raw object pointers,
+ * which only have a meaning inside the process that created them.
+ *
+ * Restrictions:
+ * - only for the default (single-threaded) simulator implementation;
+ *   the realtime and distributed implementations, and any running
+ *   system thread, do not survive fork();
+ * - files opened before the branch point are shared by all branches.
+ *   The standard streams are flushed before forking; other streams must
+ *   be flushed by the caller, or their buffered data is written once per
+ *   branch.  Each branch should open its own output files.
+ */
+class SimulationBranch
+{
+public:
+  /**
+   * Fork \p nBranches child processes from the current state, running at
+   * most \p maxParallel of them at a time (all of them if zero).
+   *
+   * In each child, returns the index of that branch, in [0, nBranches).
+   * In the parent, returns -1 once every child has exited.  Only the
+   * branches are reaped: the other children of the program are left to it.
+   *
+   * \param [in] nBranches The number of branches to run.
+   * \param [in] maxParallel The maximum number of branches alive at once.
+   * \param [out] status If not null, filled with the exit status of each
+   *              branch, or -1 for a branch which did not exit normally.
+   * \return The branch index in a child, -1 in the parent.
+   */
+  static int32_t Fork (uint32_t nBranches, uint32_t maxParallel = 0,
+                       std::vector<int> *status = 0);
+
+  /**
+   * \return The index of the current branch, or -1 in a process which is
+   *         not a branch.
+   */
+  static int32_t GetBranch (void);
+
+private:
+  /** Index of the current branch, -1 in the parent. */
+  static int32_t m_branch;
+};
+
+} // namespace ns3
+
+#endif /* SIMULATION_BRANCH_H */
@@ -21,7 +21,7 @@
 #ifndef TRACED_CALLBACK_H
 #define TRACED_CALLBACK_H
 
-#include <list>
+#include <vector>
 #include "callback.h"
 
 /**
@@ -46,6 +46,12 @@ namespace ns3 {
  * calling one of the \c operator() forms with the appropriate
  * number of arguments.
  *
+ * The chain is stored contiguously and the arguments are forwarded by
+ * const reference, so firing a trace source with no Callback connected
+ * costs a single test.  When building the arguments of a trace is
+ * expensive in itself, the owner of the trace source can check IsEmpty
+ * before building them.
+ *
  * \tparam T1 \explicit Type of the first argument to the functor.
  * \tparam T2 \explicit Type of the second argument to the functor.
  * \tparam T3 \explicit Type of the third argument to the functor.
@@ -93,6 +99,12 @@ public:
    * \param [in] path Context path which was used to connect the Callback.
    */
   void Disconnect (const CallbackBase & callback, std::string path);
+  /**
+   * Check whether a Callback is connected to the chain.
+   *
+   * \returns \c true if the chain of Callbacks is empty.
+   */
+  bool IsEmpty (void) const;
   /**
    * \name Functors taking various numbers of arguments.
    *
@@ -108,7 +120,7 @@ public:
    * \tparam T1 \deduced Type of the first argument to the functor.
    * \param [in] a1 The first argument to the functor.
    */
-  void operator() (T1 a1) const;
+  void operator() (const T1 & a1) const;
   /**
    * \copybrief operator()()
    * \tparam T1 \deduced Type of the first argument to the functor.
@@ -116,7 +128,7 @@ public:
    * \param [in] a1 The first argument to the functor.
    * \param [in] a2 The second argument to the functor.
    */
-  void operator() (T1 a1, T2 a2) const;
+  void operator() (const T1 & a1, const T2 & a2) const;
   /**
    * \copybrief operator()()
    * \tparam T1 \deduced Type of the first argument to the functor.
@@ -126,7 +138,7 @@ public:
    * \param [in] a2 The second argument to the functor.
    * \param [in] a3 The third argument to the functor.
    */
-  void operator() (T1 a1, T2 a2, T3 a3) const;
+  void operator() (const T1 & a1, const T2 & a2, const T3 & a3) const;
   /**
    * \copybrief operator()()
    * \tparam T1 \deduced Type of the first argument to the functor.
@@ -138,7 +150,7 @@ public:
    * \param [in] a3 The third argument to the functor.
    * \param [in] a4 The fourth argument to the functor.
    */
-  void operator() (T1 a1, T2 a2, T3 a3, T4 a4) const;
+  void operator() (const T1 & a1, const T2 & a2, const T3 & a3, const T4 & a4) const;
   /**
    * \copybrief operator()()
    * \tparam T1 \deduced Type of the first argument to the functor.
@@ -152,7 +164,7 @@ public:
    * \param [in] a4 The fourth argument to the functor.
    * \param [in] a5 The fifth argument to the functor.
    */
-  void operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const;
+  void operator() (const T1 & a1, const T2 & a2, const T3 & a3, const T4 & a4, const T5 & a5) const;
   /**
    * \copybrief operator()()
    * \tparam T1 \deduced Type of the first argument to the functor.
@@ -168,7 +180,7 @@ public:
    * \param [in] a5 The fifth argument to the functor.
    * \param [in] a6 The sixth argument to the functor.
    */
-  void operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const;
+  void operator() (const T1 & a1, const T2 & a2, const T3 & a3, const T4 & a4, const T5 & a5, const T6 & a6) const;
   /**
    * \copybrief operator()()
    * \tparam T1 \deduced Type of the first argument to the functor.
@@ -186,7 +198,7 @@ public:
    * \param [in] a6 The sixth argument to the functor.
    * \param [in] a7 The seventh argument to the functor.
    */
-  void operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const;
+  void operator() (const T1 & a1, const T2 & a2, const T3 & a3, const T4 & a4, const T5 & a5, const T6 & a6, const T7 & a7) const;
   /**
    * \copybrief operator()()
    * \tparam T1 \deduced Type of the first argument to the functor.
@@ -206,7 +218,7 @@ public:
    * \param [in] a7 The seventh argument to the functor.
    * \param [in] a8 The eighth argument to the functor.
    */
-  void operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const;
+  void operator() (const T1 & a1, const T2 & a2, const T3 & a3, const T4 & a4, const T5 & a5, const T6 & a6, const T7 & a7, const T8 & a8) const;
   /**@}*/
 
   /**
@@ -225,6 +237,12 @@ private:
   /**
    * Container type for holding the chain of Callbacks.
    *
+   * The chain is invoked by index rather than through iterators, so a
+   * Callback may connect another one to the chain while it is invoked.
+   * A Callback disconnected while the chain is invoked is only cleared,
+   * so the following ones keep their index, and the chain is compacted
+   * once the invocation is over.
+   *
    * \tparam T1 \deduced Type of the first argument to the functor.
    * \tparam T2 \deduced Type of the second argument to the functor.
    * \tparam T3 \deduced Type of the third argument to the functor.
@@ -234,9 +252,19 @@ private:
    * \tparam T7 \deduced Type of the seventh argument to the functor.
    * \tparam T8 \deduced Type of the eighth argument to the functor.
    */
-  typedef std::list<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
+  typedef std::vector<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
+  /**
+   * Finish an invocation of the chain, and remove from the chain the
+   * Callbacks disconnected during the outermost one.
+   */
+  void EndDispatch (void) const;
+
   /** The chain of Callbacks. */
-  CallbackList m_callbackList;
+  mutable CallbackList m_callbackList;
+  /** The number of invocations of the chain in progress. */
+  mutable uint32_t m_dispatching;
+  /** Whether Callbacks were disconnected during an invocation. */
+  mutable bool m_disconnected;
 };
 
 } // namespace ns3
@@ -253,7 +281,9 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback ()
-  : m_callbackList () 
+  : m_callbackList (),
+    m_dispatching (0),
+    m_disconnected (false)
 {
 }
 template<typename T1, typename T2,
@@ -291,14 +321,21 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::DisconnectWithoutContext (const Callbac
   for (typename CallbackList::iterator i = m_callbackList.begin ();
        i != m_callbackList.end (); /* empty */)
     {
-      if ((*i).IsEqual (callback))
+      if ((*i).IsNull () || !(*i).IsEqual (callback))
         {
-          i = m_callbackList.erase (i);
+          i++;
         }
-      else
+      else if (m_dispatching > 0)
         {
+          // Erasing would shift the Callbacks not invoked yet
+          *i = Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> ();
+          m_disconnected = true;
           i++;
         }
+      else
+        {
+          i = m_callbackList.erase (i);
+        }
     }
 }
 template<typename T1, typename T2, 
@@ -314,6 +351,48 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Disconnect (const CallbackBase & callba
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
   DisconnectWithoutContext (realCb);
 }
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+bool
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::IsEmpty (void) const
+{
+  if (m_disconnected)
+    {
+      for (std::size_t i = 0; i < m_callbackList.size (); i++)
+        {
+          if (!m_callbackList[i].IsNull ())
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  return m_callbackList.empty ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::EndDispatch (void) const
+{
+  m_dispatching--;
+  if (m_dispatching == 0 && m_disconnected)
+    {
+      std::size_t kept = 0;
+      for (std::size_t i = 0; i < m_callbackList.size (); i++)
+        {
+          if (!m_callbackList[i].IsNull ())
+            {
+              m_callbackList[kept++] = m_callbackList[i];
+            }
+        }
+      m_callbackList.resize (kept);
+      m_disconnected = false;
+    }
+}
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
@@ -321,115 +400,151 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  m_dispatching++;
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)();
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i] ();
+        }
     }
+  EndDispatch ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1) const
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (const T1 & a1) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  m_dispatching++;
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(a1);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i] (a1);
+        }
     }
+  EndDispatch ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2) const
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (const T1 & a1, const T2 & a2) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  m_dispatching++;
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(a1, a2);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i] (a1, a2);
+        }
     }
+  EndDispatch ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3) const
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (const T1 & a1, const T2 & a2, const T3 & a3) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  m_dispatching++;
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(a1, a2, a3);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i] (a1, a2, a3);
+        }
     }
+  EndDispatch ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (const T1 & a1, const T2 & a2, const T3 & a3, const T4 & a4) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  m_dispatching++;
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(a1, a2, a3, a4);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i] (a1, a2, a3, a4);
+        }
     }
+  EndDispatch ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (const T1 & a1, const T2 & a2, const T3 & a3, const T4 & a4, const T5 & a5) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  m_dispatching++;
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i] (a1, a2, a3, a4, a5);
+        }
     }
+  EndDispatch ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (const T1 & a1, const T2 & a2, const T3 & a3, const T4 & a4, const T5 & a5, const T6 & a6) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  m_dispatching++;
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5, a6);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i] (a1, a2, a3, a4, a5, a6);
+        }
     }
+  EndDispatch ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (const T1 & a1, const T2 & a2, const T3 & a3, const T4 & a4, const T5 & a5, const T6 & a6, const T7 & a7) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  m_dispatching++;
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i] (a1, a2, a3, a4, a5, a6, a7);
+        }
     }
+  EndDispatch ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (const T1 & a1, const T2 & a2, const T3 & a3, const T4 & a4, const T5 & a5, const T6 & a6, const T7 & a7, const T8 & a8) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  m_dispatching++;
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7, a8);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i] (a1, a2, a3, a4, a5, a6, a7, a8);
+        }
     }
+  EndDispatch ();
 }
 
 } // namespace ns3
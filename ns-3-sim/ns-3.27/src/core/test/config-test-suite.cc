@@ -821,6 +821,103 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup config-tests
+ * Test for the parsed paths of Config::ConfigPath and their cache.
+ */
+class ConfigPathTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  ConfigPathTestCase ();
+  /** Destructor. */
+  virtual ~ConfigPathTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+ConfigPathTestCase::ConfigPathTestCase ()
+  : TestCase ("Check that a ConfigPath is resolved again only when the object graph changes")
+{
+}
+
+void
+ConfigPathTestCase::DoRun (void)
+{
+  IntegerValue iv;
+
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Ptr<ConfigTestObject> obj0 = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> obj1 = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> obj2 = CreateObject<ConfigTestObject> ();
+  root->AddNodeA (obj0);
+  root->AddNodeA (obj1);
+  root->AddNodeA (obj2);
+
+  Config::ConfigPath all ("/NodesA/*");
+  NS_TEST_ASSERT_MSG_EQ (all.LookupMatches ().GetN (), 3, "Wrong number of matches");
+  all.Set ("A", IntegerValue (-5));
+  obj2->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -5, "Object Attribute \"A\" not set as expected");
+
+  //
+  // A single index is looked up directly, and gives the same contexts as
+  // a scan of the vector.
+  //
+  Config::ConfigPath one ("NodesA/1");
+  NS_TEST_ASSERT_MSG_EQ (one.LookupMatches ().GetN (), 1, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (one.LookupMatches ().Get (0), obj1, "Wrong object matched");
+  NS_TEST_ASSERT_MSG_EQ (one.LookupMatches ().GetMatchedPath (0), "/NodesA/1/", "Wrong context");
+  Config::MatchContainer padded = Config::LookupMatches ("/NodesA/01");
+  NS_TEST_ASSERT_MSG_EQ (padded.GetN (), 1, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (padded.GetMatchedPath (0), "/NodesA/1/", "Wrong context");
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/NodesA/3").GetN (), 0, "Index out of range matched");
+
+  //
+  // The vector of the test object does not notify its changes, so the
+  // matches are kept until the cache is invalidated.
+  //
+  Ptr<ConfigTestObject> obj3 = CreateObject<ConfigTestObject> ();
+  root->AddNodeA (obj3);
+  NS_TEST_ASSERT_MSG_EQ (all.LookupMatches ().GetN (), 3, "Matches not cached");
+  Config::InvalidateCache ();
+  NS_TEST_ASSERT_MSG_EQ (all.LookupMatches ().GetN (), 4, "Matches not resolved again");
+
+  //
+  // Aggregation changes the generation.
+  //
+  uint64_t generation = Config::GetGeneration ();
+  obj3->AggregateObject (CreateObject<DerivedConfigObject> ());
+  NS_TEST_ASSERT_MSG_NE (Config::GetGeneration (), generation, "Aggregation did not change the generation");
+
+  //
+  // A copy shares the path, and the matches cached for it.
+  //
+  Config::ConfigPath copy = all;
+  NS_TEST_ASSERT_MSG_EQ (copy.GetPath (), "/NodesA/*", "Wrong path");
+  NS_TEST_ASSERT_MSG_EQ (copy.LookupMatches ().GetN (), 4, "Wrong number of matches");
+
+  //
+  // The cache is shared by the handles on the same path, and only holds
+  // the objects until the graph changes.
+  //
+  Ptr<ConfigTestObject> obj4 = CreateObject<ConfigTestObject> ();
+  root->AddNodeA (obj4);
+  Config::InvalidateCache ();
+  uint32_t references = obj4->GetReferenceCount ();
+  Config::ConfigPath other ("/NodesA/*");
+  NS_TEST_ASSERT_MSG_EQ (other.LookupMatches ().GetN (), 5, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (obj4->GetReferenceCount (), references + 1, "Matches not cached");
+  NS_TEST_ASSERT_MSG_EQ (all.LookupMatches ().GetN (), 5, "Matches not shared");
+  NS_TEST_ASSERT_MSG_EQ (obj4->GetReferenceCount (), references + 1, "Matches not shared");
+  Config::InvalidateCache ();
+  NS_TEST_ASSERT_MSG_EQ (obj4->GetReferenceCount (), references, "Matches kept after the graph changed");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -839,6 +936,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new ConfigPathTestCase);
 }
 
 /**
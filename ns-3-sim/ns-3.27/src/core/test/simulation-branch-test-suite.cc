@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simulation-branch.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/nstime.h"
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/**
+ * \ingroup core-tests
+ *
+ * Branch from a warmed-up simulation and check that every branch starts
+ * from the same time, events and random stream position, and that the
+ * branches run independently of each other.
+ */
+class SimulationBranchTestCase : public TestCase
+{
+public:
+  SimulationBranchTestCase ();
+private:
+  virtual void DoRun (void);
+  /** Periodic event, every millisecond. */
+  void Tick (void);
+  /** One-off event scheduled by a single branch. */
+  void Extra (void);
+
+  uint32_t m_ticks;                       //!< Number of events run
+  Ptr<UniformRandomVariable> m_rng;       //!< Stream shared by the branches
+};
+
+SimulationBranchTestCase::SimulationBranchTestCase ()
+  : TestCase ("Branch simulation variants from a warmed-up state")
+{
+}
+
+void
+SimulationBranchTestCase::Tick (void)
+{
+  m_ticks++;
+  m_rng->GetValue ();
+  Simulator::Schedule (MilliSeconds (1), &SimulationBranchTestCase::Tick, this);
+}
+
+void
+SimulationBranchTestCase::Extra (void)
+{
+  m_ticks++;
+}
+
+void
+SimulationBranchTestCase::DoRun (void)
+{
+  const uint32_t nBranches = 4;
+  m_ticks = 0;
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (42);
+
+  // Warm-up: ticks at 0.5, 1.5, ..., 4.5 ms
+  Simulator::Schedule (MicroSeconds (500), &SimulationBranchTestCase::Tick, this);
+  Simulator::Stop (MilliSeconds (5));
+  Simulator::Run ();
+
+  // A child of the program, which the branching must leave alone
+  pid_t other = fork ();
+  if (other == 0)
+    {
+      _exit (7);
+    }
+
+  std::vector<int> status;
+  int32_t branch = SimulationBranch::Fork (nBranches, 2, &status);
+  if (branch >= 0)
+    {
+      // Report through the exit status; assertions in a child would not
+      // reach the test framework of the parent.
+      bool ok = SimulationBranch::GetBranch () == branch
+        && Simulator::Now () == MilliSeconds (5)
+        && m_ticks == 5;
+      uint32_t draw = m_rng->GetInteger (0, 199);
+      for (int32_t i = 0; i < branch; i++)
+        {
+          Simulator::Schedule (MicroSeconds (100 * (i + 1)), &SimulationBranchTestCase::Extra, this);
+        }
+      Simulator::Stop (MilliSeconds (5));
+      Simulator::Run ();
+      ok = ok && m_ticks == 10 + static_cast<uint32_t> (branch);
+      Simulator::Destroy ();
+      _exit (ok ? draw : 255);
+    }
+
+  int otherStatus = 0;
+  NS_TEST_ASSERT_MSG_EQ (waitpid (other, &otherStatus, 0), other, "another child was reaped");
+  NS_TEST_ASSERT_MSG_EQ (WEXITSTATUS (otherStatus), 7, "wrong status of the other child");
+  NS_TEST_ASSERT_MSG_EQ (SimulationBranch::GetBranch (), -1, "parent is not a branch");
+  NS_TEST_ASSERT_MSG_EQ (status.size (), nBranches, "one status per branch");
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), MilliSeconds (5), "parent time unchanged");
+  NS_TEST_ASSERT_MSG_EQ (m_ticks, 5, "parent events unchanged");
+
+  // The parent stream has not moved either, so its next draw is the one
+  // every branch saw
+  int expected = m_rng->GetInteger (0, 199);
+  for (uint32_t i = 0; i < nBranches; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (status[i], expected, "branch " << i);
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup core-tests
+ *
+ * \brief SimulationBranch TestSuite
+ */
+class SimulationBranchTestSuite : public TestSuite
+{
+public:
+  SimulationBranchTestSuite ()
+    : TestSuite ("simulation-branch", UNIT)
+  {
+    AddTestCase (new SimulationBranchTestCase (), TestCase::QUICK);
+  }
+};
+
+static SimulationBranchTestSuite g_simulationBranchTestSuite; //!< Static variable for test initialization
@@ -229,7 +229,74 @@ TimeInputOutputTestCase::DoRun (void)
 
   std::cout << std::endl;
 }
-    
+
+class TimeFastPathTestCase : public TestCase
+{
+public:
+  TimeFastPathTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TimeFastPathTestCase::TimeFastPathTestCase ()
+  : TestCase ("Integer fast path against int64x64_t conversions")
+{
+}
+
+void
+TimeFastPathTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (Time::GetStepsPerSecond (), Seconds (1.0).GetTimeStep (),
+                         "steps per second");
+
+  // The literals are computed at compile time, for every resolution
+  static_assert (SecondsLiteral (1.5).GetSteps (Time::FS) == 1500000000000000LL, "1.5s in fs");
+  static_assert (SecondsLiteral (1.5).GetSteps (Time::S) == 2, "1.5s in s, rounded");
+  static_assert (SecondsLiteral (90).GetSteps (Time::MIN) == 2, "90s in min, rounded");
+  static_assert (MilliSecondsLiteral (0.5).GetSteps (Time::NS) == 500000, "0.5ms in ns");
+  static_assert (MilliSecondsLiteral (1e-12).GetSteps (Time::FS) == 1, "1fs in fs");
+  static_assert (MilliSecondsLiteral (1e-12).GetSteps (Time::NS) == 0, "1fs in ns");
+  static_assert (SecondsLiteral (-0.25).GetSteps (Time::MS) == -250, "-0.25s in ms");
+  static_assert (SecondsLiteral (1e5).GetSteps (Time::FS) == std::numeric_limits<int64_t>::min (),
+                 "1e5s does not fit in fs");
+
+  // Exactly representable values convert identically
+  NS_TEST_ASSERT_MSG_EQ (Time (SecondsLiteral (0.5)), Seconds (0.5), "0.5s");
+  NS_TEST_ASSERT_MSG_EQ (Time (SecondsLiteral (2.0)), Seconds (2.0), "2s");
+  NS_TEST_ASSERT_MSG_EQ (Time (SecondsLiteral (0)), Seconds (0), "0s");
+  NS_TEST_ASSERT_MSG_EQ (Time (MilliSecondsLiteral (250)), MilliSeconds (250), "250ms");
+  NS_TEST_ASSERT_MSG_EQ (Time (MilliSecondsLiteral (0.5)), MicroSeconds (500), "0.5ms");
+
+  // Others round instead of truncating, so are at most one step away
+  const double values[] = { 0.1, 0.2, 0.3, 0.001, 0.0001, 1.1, 3.7, 12.345678901 };
+  for (uint32_t i = 0; i < sizeof (values) / sizeof (values[0]); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (Time (SecondsLiteral (values[i])).GetTimeStep (),
+                             SecondsLiteral (values[i]).GetSteps (Time::GetResolution ()),
+                             "SecondsLiteral (" << values[i] << ") at the current resolution");
+      NS_TEST_ASSERT_MSG_EQ_TOL (Time (SecondsLiteral (values[i])).GetTimeStep (),
+                                 Seconds (values[i]).GetTimeStep (), 1,
+                                 "SecondsLiteral (" << values[i] << ")");
+      NS_TEST_ASSERT_MSG_EQ_TOL (Time (MilliSecondsLiteral (values[i])).GetTimeStep (),
+                                 MilliSeconds (int64x64_t (values[i])).GetTimeStep (), 1,
+                                 "MilliSecondsLiteral (" << values[i] << ")");
+    }
+
+  // Integer division in ToDouble matches the int64x64_t conversion, to
+  // within the 64 fractional bits of int64x64_t for small values
+  const int64_t steps[] = { 1, 999, 1000000, 123456789, 37000000000LL, -42424242 };
+  for (uint32_t i = 0; i < sizeof (steps) / sizeof (steps[0]); i++)
+    {
+      Time t = TimeStep (steps[i]);
+      double expected = t.To (Time::S).GetDouble ();
+      NS_TEST_ASSERT_MSG_EQ_TOL (t.GetSeconds (), expected, std::fabs (expected) * 1e-15 + 1e-18,
+                                 "GetSeconds of " << steps[i] << " steps");
+      expected = t.To (Time::US).GetDouble ();
+      NS_TEST_ASSERT_MSG_EQ_TOL (t.ToDouble (Time::US), expected, std::fabs (expected) * 1e-15 + 1e-18,
+                                 "ToDouble (US) of " << steps[i] << " steps");
+    }
+}
+
 static class TimeTestSuite : public TestSuite
 {
 public:
@@ -238,6 +305,7 @@ public:
   {
     AddTestCase (new TimeWithSignTestCase (), TestCase::QUICK);
     AddTestCase (new TimeInputOutputTestCase (), TestCase::QUICK);
+    AddTestCase (new TimeFastPathTestCase (), TestCase::QUICK);
     // This should be last, since it changes the resolution
     AddTestCase (new TimeSimpleTestCase (), TestCase::QUICK);
   }
@@ -108,6 +108,173 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+class TracedCallbackChainTestCase : public TestCase
+{
+public:
+  TracedCallbackChainTestCase ();
+  virtual ~TracedCallbackChainTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void CbConnect (uint32_t a);
+  void CbCount (uint32_t a);
+
+  TracedCallback<uint32_t> m_trace;
+  uint32_t m_count;
+};
+
+TracedCallbackChainTestCase::TracedCallbackChainTestCase ()
+  : TestCase ("Check TracedCallback IsEmpty and connections made while invoked")
+{
+}
+
+void
+TracedCallbackChainTestCase::CbConnect (uint32_t a)
+{
+  m_trace.ConnectWithoutContext (MakeCallback (&TracedCallbackChainTestCase::CbCount, this));
+}
+
+void
+TracedCallbackChainTestCase::CbCount (uint32_t a)
+{
+  m_count += a;
+}
+
+void
+TracedCallbackChainTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "No callback connected yet");
+  m_count = 0;
+  m_trace (1);
+  NS_TEST_ASSERT_MSG_EQ (m_count, 0, "Empty chain invoked something");
+
+  //
+  // A callback connecting another one while the chain is invoked: the
+  // chain may grow under the loop, and the new callback is invoked too.
+  //
+  m_trace.ConnectWithoutContext (MakeCallback (&TracedCallbackChainTestCase::CbConnect, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), false, "Callback not connected");
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      m_trace (1);
+    }
+  // Invocation i runs the i callbacks CbCount connected by the previous ones
+  NS_TEST_ASSERT_MSG_EQ (m_count, 55, "Callbacks connected while invoked not called");
+
+  //
+  // Disconnecting every callback empties the chain again.
+  //
+  m_trace.DisconnectWithoutContext (MakeCallback (&TracedCallbackChainTestCase::CbConnect, this));
+  m_trace.DisconnectWithoutContext (MakeCallback (&TracedCallbackChainTestCase::CbCount, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "Callbacks not disconnected");
+}
+
+class TracedCallbackDisconnectTestCase : public TestCase
+{
+public:
+  TracedCallbackDisconnectTestCase ();
+  virtual ~TracedCallbackDisconnectTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void CbSelf (uint32_t a);
+  void CbOne (uint32_t a);
+  void CbEarlier (uint32_t a);
+  void CbTwo (uint32_t a);
+  void CbAll (uint32_t a);
+
+  TracedCallback<uint32_t> m_trace;
+  uint32_t m_self;
+  uint32_t m_one;
+  uint32_t m_earlier;
+  uint32_t m_two;
+  bool m_emptyInside;
+};
+
+TracedCallbackDisconnectTestCase::TracedCallbackDisconnectTestCase ()
+  : TestCase ("Check TracedCallback disconnections made while invoked")
+{
+}
+
+void
+TracedCallbackDisconnectTestCase::CbSelf (uint32_t a)
+{
+  m_self++;
+  m_trace.DisconnectWithoutContext (MakeCallback (&TracedCallbackDisconnectTestCase::CbSelf, this));
+}
+
+void
+TracedCallbackDisconnectTestCase::CbOne (uint32_t a)
+{
+  m_one++;
+}
+
+void
+TracedCallbackDisconnectTestCase::CbEarlier (uint32_t a)
+{
+  m_earlier++;
+  m_trace.DisconnectWithoutContext (MakeCallback (&TracedCallbackDisconnectTestCase::CbOne, this));
+}
+
+void
+TracedCallbackDisconnectTestCase::CbTwo (uint32_t a)
+{
+  m_two++;
+}
+
+void
+TracedCallbackDisconnectTestCase::CbAll (uint32_t a)
+{
+  m_trace.DisconnectWithoutContext (MakeCallback (&TracedCallbackDisconnectTestCase::CbEarlier, this));
+  m_trace.DisconnectWithoutContext (MakeCallback (&TracedCallbackDisconnectTestCase::CbTwo, this));
+  m_trace.DisconnectWithoutContext (MakeCallback (&TracedCallbackDisconnectTestCase::CbAll, this));
+  m_emptyInside = m_trace.IsEmpty ();
+}
+
+void
+TracedCallbackDisconnectTestCase::DoRun (void)
+{
+  m_self = m_one = m_earlier = m_two = 0;
+  m_emptyInside = false;
+
+  //
+  // A callback disconnecting itself, and another one disconnecting an
+  // earlier callback: the callbacks after them must still be invoked.
+  //
+  m_trace.ConnectWithoutContext (MakeCallback (&TracedCallbackDisconnectTestCase::CbSelf, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&TracedCallbackDisconnectTestCase::CbOne, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&TracedCallbackDisconnectTestCase::CbEarlier, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&TracedCallbackDisconnectTestCase::CbTwo, this));
+  m_trace (1);
+  NS_TEST_ASSERT_MSG_EQ (m_self, 1, "Callback CbSelf not called");
+  NS_TEST_ASSERT_MSG_EQ (m_one, 1, "Callback CbOne not called");
+  NS_TEST_ASSERT_MSG_EQ (m_earlier, 1, "Callback after a disconnected one skipped");
+  NS_TEST_ASSERT_MSG_EQ (m_two, 1, "Callback after a disconnected one skipped");
+
+  //
+  // The disconnected callbacks are gone from the next invocation.
+  //
+  m_trace (1);
+  NS_TEST_ASSERT_MSG_EQ (m_self, 1, "Callback CbSelf still connected");
+  NS_TEST_ASSERT_MSG_EQ (m_one, 1, "Callback CbOne still connected");
+  NS_TEST_ASSERT_MSG_EQ (m_earlier, 2, "Callback CbEarlier not called");
+  NS_TEST_ASSERT_MSG_EQ (m_two, 2, "Callback CbTwo not called");
+
+  //
+  // A callback disconnecting every callback while invoked, itself last:
+  // the chain is seen empty at once, and stays so.
+  //
+  m_trace.ConnectWithoutContext (MakeCallback (&TracedCallbackDisconnectTestCase::CbAll, this));
+  m_trace (1);
+  NS_TEST_ASSERT_MSG_EQ (m_emptyInside, true, "Chain not empty once every callback is disconnected");
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "Callbacks not disconnected");
+  m_trace (1);
+  NS_TEST_ASSERT_MSG_EQ (m_earlier, 3, "Callback CbEarlier called after being disconnected");
+  NS_TEST_ASSERT_MSG_EQ (m_two, 3, "Callback CbTwo called after being disconnected");
+}
+
 class TracedCallbackTestSuite : public TestSuite
 {
 public:
@@ -118,6 +285,8 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new TracedCallbackChainTestCase, TestCase::QUICK);
+  AddTestCase (new TracedCallbackDisconnectTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
@@ -499,6 +499,11 @@ private:
    */
   DataRate m_bps;
 
+  /**
+   * The transmission times of the last packet sizes sent
+   */
+  DataRateTxTimeCache m_txTimeCache;
+
   /**
    * The interframe gap that the Net Device uses insert time between packet
    * transmission
@@ -0,0 +1,337 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef FLOW_HASH_TABLE_H
+#define FLOW_HASH_TABLE_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+/// \brief Mix the bits of a key into a hash value.
+///
+/// This is the finalizer of MurmurHash3: every bit of the key affects
+/// every bit of the result.
+/// \param key the key
+/// \returns the hash value of the key
+inline uint64_t
+FlowHashMix (uint64_t key)
+{
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return key;
+}
+
+/// \brief Hash table with open addressing, for the per-packet lookups of
+/// the flow classifiers and of the FlowMonitor.
+///
+/// The entries are kept in a single array, at the first free slot from
+/// the hash of their key.  Removing an entry moves the entries that
+/// follow it back, instead of leaving a marker, so that lookups never
+/// slow down as packets come and go.  The array doubles when it gets
+/// half full; once it is large enough, inserting and removing entries
+/// allocates no memory.
+///
+/// Adding or removing an entry invalidates the pointers to the values.
+///
+/// \tparam Key the type of the keys, which must have operator ==
+/// \tparam Value the type of the values
+/// \tparam Hash a function object returning the hash of a key
+template <typename Key, typename Value, typename Hash>
+class FlowHashTable
+{
+public:
+  FlowHashTable ();
+
+  /// Make room for some entries, so that adding them allocates no memory
+  /// \param n the number of entries
+  void Reserve (uint32_t n);
+
+  /// \returns the number of entries
+  uint32_t GetSize (void) const;
+
+  /// Find the value of a key
+  /// \param key the key
+  /// \returns the value of the key, or 0 if the key has no entry
+  Value* Find (const Key &key);
+
+  /// Find the value of a key
+  /// \param key the key
+  /// \returns the value of the key, or 0 if the key has no entry
+  const Value* Find (const Key &key) const;
+
+  /// Find the value of a key, adding an entry for the key if it has none
+  /// \param key the key
+  /// \param inserted set to true if the entry was added, with a
+  /// default-constructed value, and to false if it already existed
+  /// \returns the value of the key
+  Value* Insert (const Key &key, bool *inserted);
+
+  /// Remove the entry of a key
+  /// \param key the key
+  /// \returns true if the key had an entry
+  bool Remove (const Key &key);
+
+  /// Remove every entry, and keep the memory
+  void Clear (void);
+
+  /// \returns the number of slots, to visit the entries
+  uint32_t GetNSlots (void) const;
+
+  /// \param slot a slot
+  /// \returns true if an entry is in the slot
+  bool IsUsed (uint32_t slot) const;
+
+  /// \param slot a used slot
+  /// \returns the key of the entry in the slot
+  const Key& GetKey (uint32_t slot) const;
+
+  /// \param slot a used slot
+  /// \returns the value of the entry in the slot
+  Value& GetValue (uint32_t slot);
+
+  /// \param slot a used slot
+  /// \returns the value of the entry in the slot
+  const Value& GetValue (uint32_t slot) const;
+
+  /// Remove the entry in a slot, while visiting the entries.
+  ///
+  /// An entry which follows may move into the slot, which must then be
+  /// visited again.  An entry visited before may also move into a slot
+  /// which was not visited yet, and be visited twice.
+  /// \param slot a used slot
+  void RemoveSlot (uint32_t slot);
+
+private:
+  /// An entry of the table
+  struct Entry
+  {
+    Key key;     //!< the key
+    Value value; //!< the value
+    bool used;   //!< whether the slot holds an entry
+  };
+
+  /// \param key a key
+  /// \returns the slot of the entry of the key, or the free slot where
+  /// it would go
+  uint32_t FindSlot (const Key &key) const;
+
+  /// Move the entries to an array of some number of slots
+  /// \param nSlots the number of slots, a power of two
+  void Resize (uint32_t nSlots);
+
+  std::vector<Entry> m_entries; //!< the slots
+  uint32_t m_size;              //!< the number of entries
+  Hash m_hash;                  //!< the hash function
+};
+
+template <typename Key, typename Value, typename Hash>
+FlowHashTable<Key, Value, Hash>::FlowHashTable ()
+  : m_size (0)
+{
+  Resize (16);
+}
+
+template <typename Key, typename Value, typename Hash>
+void
+FlowHashTable<Key, Value, Hash>::Reserve (uint32_t n)
+{
+  uint32_t nSlots = m_entries.size ();
+  while (nSlots < 2 * n)
+    {
+      nSlots *= 2;
+    }
+  if (nSlots != m_entries.size ())
+    {
+      Resize (nSlots);
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+uint32_t
+FlowHashTable<Key, Value, Hash>::GetSize (void) const
+{
+  return m_size;
+}
+
+template <typename Key, typename Value, typename Hash>
+uint32_t
+FlowHashTable<Key, Value, Hash>::FindSlot (const Key &key) const
+{
+  uint32_t mask = m_entries.size () - 1;
+  uint32_t slot = m_hash (key) & mask;
+  while (m_entries[slot].used && !(m_entries[slot].key == key))
+    {
+      slot = (slot + 1) & mask;
+    }
+  return slot;
+}
+
+template <typename Key, typename Value, typename Hash>
+Value*
+FlowHashTable<Key, Value, Hash>::Find (const Key &key)
+{
+  uint32_t slot = FindSlot (key);
+  return m_entries[slot].used ? &m_entries[slot].value : 0;
+}
+
+template <typename Key, typename Value, typename Hash>
+const Value*
+FlowHashTable<Key, Value, Hash>::Find (const Key &key) const
+{
+  uint32_t slot = FindSlot (key);
+  return m_entries[slot].used ? &m_entries[slot].value : 0;
+}
+
+template <typename Key, typename Value, typename Hash>
+Value*
+FlowHashTable<Key, Value, Hash>::Insert (const Key &key, bool *inserted)
+{
+  uint32_t slot = FindSlot (key);
+  *inserted = !m_entries[slot].used;
+  if (*inserted)
+    {
+      if (2 * (m_size + 1) > m_entries.size ())
+        {
+          Resize (2 * m_entries.size ());
+          slot = FindSlot (key);
+        }
+      Entry &entry = m_entries[slot];
+      entry.key = key;
+      entry.value = Value ();
+      entry.used = true;
+      m_size++;
+    }
+  return &m_entries[slot].value;
+}
+
+template <typename Key, typename Value, typename Hash>
+bool
+FlowHashTable<Key, Value, Hash>::Remove (const Key &key)
+{
+  uint32_t slot = FindSlot (key);
+  if (!m_entries[slot].used)
+    {
+      return false;
+    }
+  RemoveSlot (slot);
+  return true;
+}
+
+template <typename Key, typename Value, typename Hash>
+void
+FlowHashTable<Key, Value, Hash>::RemoveSlot (uint32_t slot)
+{
+  NS_ASSERT (m_entries[slot].used);
+  uint32_t mask = m_entries.size () - 1;
+  uint32_t hole = slot;
+  uint32_t next = (hole + 1) & mask;
+  // Move back every entry of the run which would no longer be found
+  // across the hole, that is whose home slot is not between the hole and
+  // the entry
+  while (m_entries[next].used)
+    {
+      uint32_t home = m_hash (m_entries[next].key) & mask;
+      if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+          m_entries[hole] = m_entries[next];
+          hole = next;
+        }
+      next = (next + 1) & mask;
+    }
+  m_entries[hole].used = false;
+  m_entries[hole].value = Value ();
+  m_size--;
+}
+
+template <typename Key, typename Value, typename Hash>
+void
+FlowHashTable<Key, Value, Hash>::Clear (void)
+{
+  for (uint32_t i = 0; i < m_entries.size (); i++)
+    {
+      m_entries[i].used = false;
+      m_entries[i].value = Value ();
+    }
+  m_size = 0;
+}
+
+template <typename Key, typename Value, typename Hash>
+uint32_t
+FlowHashTable<Key, Value, Hash>::GetNSlots (void) const
+{
+  return m_entries.size ();
+}
+
+template <typename Key, typename Value, typename Hash>
+bool
+FlowHashTable<Key, Value, Hash>::IsUsed (uint32_t slot) const
+{
+  return m_entries[slot].used;
+}
+
+template <typename Key, typename Value, typename Hash>
+const Key&
+FlowHashTable<Key, Value, Hash>::GetKey (uint32_t slot) const
+{
+  NS_ASSERT (m_entries[slot].used);
+  return m_entries[slot].key;
+}
+
+template <typename Key, typename Value, typename Hash>
+Value&
+FlowHashTable<Key, Value, Hash>::GetValue (uint32_t slot)
+{
+  NS_ASSERT (m_entries[slot].used);
+  return m_entries[slot].value;
+}
+
+template <typename Key, typename Value, typename Hash>
+const Value&
+FlowHashTable<Key, Value, Hash>::GetValue (uint32_t slot) const
+{
+  NS_ASSERT (m_entries[slot].used);
+  return m_entries[slot].value;
+}
+
+template <typename Key, typename Value, typename Hash>
+void
+FlowHashTable<Key, Value, Hash>::Resize (uint32_t nSlots)
+{
+  std::vector<Entry> entries (nSlots);
+  for (uint32_t i = 0; i < nSlots; i++)
+    {
+      entries[i].used = false;
+    }
+  entries.swap (m_entries);
+  for (uint32_t i = 0; i < entries.size (); i++)
+    {
+      if (entries[i].used)
+        {
+          m_entries[FindSlot (entries[i].key)] = entries[i];
+        }
+    }
+}
+
+} // namespace ns3
+
+#endif /* FLOW_HASH_TABLE_H */
@@ -80,14 +80,22 @@ FlowMonitor::GetInstanceTypeId (void) const
 }
 
 FlowMonitor::FlowMonitor ()
-  : m_enabled (false)
+  : m_snapshotsEnabled (false),
+    m_enabled (false)
 {
   // m_histogramBinWidth=DEFAULT_BIN_WIDTH;
+  m_trackedPackets.Reserve (1024);
 }
 
 void
 FlowMonitor::DoDispose (void)
 {
+  Simulator::Cancel (m_snapshotEvent);
+  if (m_snapshotsEnabled)
+    {
+      m_snapshotFile.close ();
+      m_snapshotsEnabled = false;
+    }
   for (std::list<Ptr<FlowClassifier> >::iterator iter = m_classifiers.begin ();
       iter != m_classifiers.end ();
       iter ++)
@@ -140,7 +148,8 @@ FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t pack
       return;
     }
   Time now = Simulator::Now ();
-  TrackedPacket &tracked = m_trackedPackets[std::make_pair (flowId, packetId)];
+  bool inserted;
+  TrackedPacket &tracked = *m_trackedPackets.Insert (std::make_pair (flowId, packetId), &inserted);
   tracked.firstSeenTime = now;
   tracked.lastSeenTime = tracked.firstSeenTime;
   tracked.timesForwarded = 0;
@@ -168,18 +177,18 @@ FlowMonitor::ReportForwarding (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t p
       return;
     }
   std::pair<FlowId, FlowPacketId> key (flowId, packetId);
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (key);
-  if (tracked == m_trackedPackets.end ())
+  TrackedPacket *tracked = m_trackedPackets.Find (key);
+  if (tracked == 0)
     {
       NS_LOG_WARN ("Received packet forward report (flowId=" << flowId << ", packetId=" << packetId
                                                              << ") but not known to be transmitted.");
       return;
     }
 
-  tracked->second.timesForwarded++;
-  tracked->second.lastSeenTime = Simulator::Now ();
+  tracked->timesForwarded++;
+  tracked->lastSeenTime = Simulator::Now ();
 
-  Time delay = (Simulator::Now () - tracked->second.firstSeenTime);
+  Time delay = (Simulator::Now () - tracked->firstSeenTime);
   probe->AddPacketStats (flowId, packetSize, delay);
 }
 
@@ -191,8 +200,9 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
     {
       return;
     }
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
-  if (tracked == m_trackedPackets.end ())
+  std::pair<FlowId, FlowPacketId> key (flowId, packetId);
+  TrackedPacket *tracked = m_trackedPackets.Find (key);
+  if (tracked == 0)
     {
       NS_LOG_WARN ("Received packet last-tx report (flowId=" << flowId << ", packetId=" << packetId
                                                              << ") but not known to be transmitted.");
@@ -200,7 +210,7 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
     }
 
   Time now = Simulator::Now ();
-  Time delay = (now - tracked->second.firstSeenTime);
+  Time delay = (now - tracked->firstSeenTime);
   probe->AddPacketStats (flowId, packetSize, delay);
 
   FlowStats &stats = GetStatsForFlow (flowId);
@@ -239,12 +249,16 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
         }
     }
   stats.timeLastRxPacket = now;
-  stats.timesForwarded += tracked->second.timesForwarded;
+  stats.timesForwarded += tracked->timesForwarded;
+  if (m_snapshotsEnabled)
+    {
+      GetSnapshotForFlow (flowId).delays.AddValue (delay.GetNanoSeconds ());
+    }
 
   NS_LOG_DEBUG ("ReportLastTx: removing tracked packet (flowId="
                 << flowId << ", packetId=" << packetId << ").");
 
-  m_trackedPackets.erase (tracked); // we don't need to track this packet anymore
+  m_trackedPackets.Remove (key); // we don't need to track this packet anymore
 }
 
 void
@@ -269,14 +283,12 @@ FlowMonitor::ReportDrop (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetI
   stats.bytesDropped[reasonCode] += packetSize;
   NS_LOG_DEBUG ("++stats.packetsDropped[" << reasonCode<< "]; // becomes: " << stats.packetsDropped[reasonCode]);
 
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
-  if (tracked != m_trackedPackets.end ())
+  if (m_trackedPackets.Remove (std::make_pair (flowId, packetId)))
     {
       // we don't need to track this packet anymore
       // FIXME: this will not necessarily be true with broadcast/multicast
-      NS_LOG_DEBUG ("ReportDrop: removing tracked packet (flowId="
+      NS_LOG_DEBUG ("ReportDrop: removed tracked packet (flowId="
                     << flowId << ", packetId=" << packetId << ").");
-      m_trackedPackets.erase (tracked);
     }
 }
 
@@ -292,22 +304,22 @@ FlowMonitor::CheckForLostPackets (Time maxDelay)
 {
   Time now = Simulator::Now ();
 
-  for (TrackedPacketMap::iterator iter = m_trackedPackets.begin ();
-       iter != m_trackedPackets.end (); )
+  for (uint32_t slot = 0; slot < m_trackedPackets.GetNSlots (); )
     {
-      if (now - iter->second.lastSeenTime >= maxDelay)
+      if (m_trackedPackets.IsUsed (slot)
+          && now - m_trackedPackets.GetValue (slot).lastSeenTime >= maxDelay)
         {
           // packet is considered lost, add it to the loss statistics
-          FlowStatsContainerI flow = m_flowStats.find (iter->first.first);
+          FlowStatsContainerI flow = m_flowStats.find (m_trackedPackets.GetKey (slot).first);
           NS_ASSERT (flow != m_flowStats.end ());
           flow->second.lostPackets++;
 
-          // we won't track it anymore
-          m_trackedPackets.erase (iter++);
+          // we won't track it anymore; another packet may take its slot
+          m_trackedPackets.RemoveSlot (slot);
         }
       else
         {
-          iter++;
+          slot++;
         }
     }
 }
@@ -325,6 +337,129 @@ FlowMonitor::PeriodicCheckForLostPackets ()
   Simulator::Schedule (PERIODIC_CHECK_INTERVAL, &FlowMonitor::PeriodicCheckForLostPackets, this);
 }
 
+FlowMonitor::FlowSnapshot&
+FlowMonitor::GetSnapshotForFlow (FlowId flowId)
+{
+  if (flowId >= m_snapshots.size ())
+    {
+      FlowSnapshot start;
+      start.txBytes = 0;
+      start.rxBytes = 0;
+      start.txPackets = 0;
+      start.rxPackets = 0;
+      start.lostPackets = 0;
+      m_snapshots.resize (flowId + 1, start);
+    }
+  return m_snapshots[flowId];
+}
+
+void
+FlowMonitor::SetSnapshot (FlowSnapshot &snapshot, const FlowStats &stats)
+{
+  snapshot.txBytes = stats.txBytes;
+  snapshot.rxBytes = stats.rxBytes;
+  snapshot.txPackets = stats.txPackets;
+  snapshot.rxPackets = stats.rxPackets;
+  snapshot.lostPackets = stats.lostPackets;
+  snapshot.delaySum = stats.delaySum;
+  snapshot.jitterSum = stats.jitterSum;
+  snapshot.delays.Reset ();
+}
+
+void
+FlowMonitor::EnableSnapshots (std::string fileName, Time interval)
+{
+  NS_ASSERT_MSG (interval.IsStrictlyPositive (), "The snapshot interval must be positive");
+  Simulator::Cancel (m_snapshotEvent);
+  if (m_snapshotsEnabled)
+    {
+      m_snapshotFile.close ();
+    }
+  m_snapshotFile.open (fileName.c_str (), std::ios::out | std::ios::trunc);
+  if (!m_snapshotFile.is_open ())
+    {
+      NS_FATAL_ERROR ("Could not open the snapshot file " << fileName);
+    }
+  m_snapshotFile << "time,flowId,txPackets,txBytes,rxPackets,rxBytes,lostPackets,"
+                 << "rxRate,delayMean,delayP50,delayP90,delayP99,jitterMean\n";
+  // the first snapshot only counts what happens from now on
+  for (FlowStatsContainerCI flowI = m_flowStats.begin (); flowI != m_flowStats.end (); flowI++)
+    {
+      SetSnapshot (GetSnapshotForFlow (flowI->first), flowI->second);
+    }
+  m_snapshotsEnabled = true;
+  m_snapshotInterval = interval;
+  m_lastSnapshot = Simulator::Now ();
+  m_snapshotEvent = Simulator::Schedule (interval, &FlowMonitor::PeriodicSnapshot, this);
+}
+
+void
+FlowMonitor::DisableSnapshots ()
+{
+  if (!m_snapshotsEnabled)
+    {
+      return;
+    }
+  Simulator::Cancel (m_snapshotEvent);
+  WriteSnapshot ();
+  m_snapshotFile.close ();
+  m_snapshotsEnabled = false;
+}
+
+void
+FlowMonitor::PeriodicSnapshot ()
+{
+  WriteSnapshot ();
+  m_snapshotEvent = Simulator::Schedule (m_snapshotInterval, &FlowMonitor::PeriodicSnapshot, this);
+}
+
+void
+FlowMonitor::WriteSnapshot ()
+{
+  if (!m_snapshotsEnabled)
+    {
+      return;
+    }
+  Time now = Simulator::Now ();
+  double interval = (now - m_lastSnapshot).GetSeconds ();
+  for (FlowStatsContainerCI flowI = m_flowStats.begin (); flowI != m_flowStats.end (); flowI++)
+    {
+      const FlowStats &stats = flowI->second;
+      FlowSnapshot &last = GetSnapshotForFlow (flowI->first);
+      uint32_t txPackets = stats.txPackets - last.txPackets;
+      uint32_t rxPackets = stats.rxPackets - last.rxPackets;
+      uint32_t lostPackets = stats.lostPackets - last.lostPackets;
+      if (txPackets == 0 && rxPackets == 0 && lostPackets == 0)
+        {
+          continue;
+        }
+      uint64_t rxBytes = stats.rxBytes - last.rxBytes;
+      m_snapshotFile << now.GetSeconds ()
+                     << "," << flowI->first
+                     << "," << txPackets
+                     << "," << stats.txBytes - last.txBytes
+                     << "," << rxPackets
+                     << "," << rxBytes
+                     << "," << lostPackets
+                     << "," << (interval > 0 ? rxBytes * 8 / interval : 0);
+      if (rxPackets > 0)
+        {
+          m_snapshotFile << "," << (stats.delaySum - last.delaySum).GetSeconds () / rxPackets
+                         << "," << last.delays.GetQuantile (0.5) / 1e9
+                         << "," << last.delays.GetQuantile (0.9) / 1e9
+                         << "," << last.delays.GetQuantile (0.99) / 1e9
+                         << "," << (stats.jitterSum - last.jitterSum).GetSeconds () / rxPackets
+                         << "\n";
+        }
+      else
+        {
+          m_snapshotFile << ",,,,,\n";
+        }
+      SetSnapshot (last, stats);
+    }
+  m_lastSnapshot = now;
+}
+
 void
 FlowMonitor::NotifyConstructionCompleted ()
 {
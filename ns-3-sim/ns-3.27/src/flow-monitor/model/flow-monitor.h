@@ -23,12 +23,15 @@
 
 #include <vector>
 #include <map>
+#include <fstream>
 
 #include "ns3/ptr.h"
 #include "ns3/object.h"
 #include "ns3/flow-probe.h"
 #include "ns3/flow-classifier.h"
+#include "ns3/flow-hash-table.h"
 #include "ns3/histogram.h"
+#include "ns3/log-linear-histogram.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
 
@@ -46,6 +49,9 @@ namespace ns3 {
  * The FlowMonitor class is responsible for coordinating efforts
  * regarding probes, and collects end-to-end flow statistics.
  *
+ * Besides the statistics of the whole run, the FlowMonitor can write
+ * snapshots of what each flow did in each interval of time, see
+ * EnableSnapshots.
  */
 class FlowMonitor : public Object
 {
@@ -256,6 +262,31 @@ public:
   /// \param enableProbes if true, include also the per-probe/flow pair statistics in the output
   void SerializeToXmlFile (std::string fileName, bool enableHistograms, bool enableProbes);
 
+  /// \brief Write the changes of the flow statistics to a file, at a
+  /// fixed interval from now on.
+  ///
+  /// Each snapshot writes one line of comma-separated values for each
+  /// flow which sent, received or lost packets since the last one:
+  ///
+  /// time,flowId,txPackets,txBytes,rxPackets,rxBytes,lostPackets,rxRate,delayMean,delayP50,delayP90,delayP99,jitterMean
+  ///
+  /// where the counts are those of the interval, rxRate is in bit/s, and
+  /// the delays and jitter are in seconds, over the packets received in
+  /// the interval.  The file starts with this line of column names.  The
+  /// delay percentiles come from a LogLinearHistogram of each flow, which
+  /// is reset at each snapshot; they are within 1/32 of the exact value.
+  /// Lost packets are counted when CheckForLostPackets finds them.
+  ///
+  /// \param fileName name or path of the output file that will be created
+  /// \param interval the time between snapshots
+  void EnableSnapshots (std::string fileName, Time interval);
+
+  /// Write a last snapshot right now, and stop writing snapshots
+  void DisableSnapshots ();
+
+  /// Write a snapshot right now, of the changes since the last one
+  void WriteSnapshot ();
+
 
 protected:
 
@@ -275,8 +306,40 @@ private:
   /// FlowId --> FlowStats
   FlowStatsContainer m_flowStats;
 
+  /// The statistics of a flow at the last snapshot, and the delays of
+  /// the packets it received since
+  struct FlowSnapshot
+  {
+    uint64_t txBytes;          //!< transmitted bytes
+    uint64_t rxBytes;          //!< received bytes
+    uint32_t txPackets;        //!< transmitted packets
+    uint32_t rxPackets;        //!< received packets
+    uint32_t lostPackets;      //!< lost packets
+    Time delaySum;             //!< sum of the delays
+    Time jitterSum;            //!< sum of the jitters
+    LogLinearHistogram delays; //!< delays of the packets received since, in nanoseconds
+  };
+
+  std::vector<FlowSnapshot> m_snapshots; //!< snapshot of each flow, indexed by FlowId
+  bool m_snapshotsEnabled;    //!< whether snapshots are written
+  std::ofstream m_snapshotFile; //!< the file snapshots are written to
+  Time m_snapshotInterval;    //!< time between snapshots
+  Time m_lastSnapshot;        //!< time of the last snapshot
+  EventId m_snapshotEvent;    //!< next snapshot event
+
+  /// Hash of a (FlowId,PacketId) pair
+  struct TrackedPacketHash
+  {
+    /// \param key the (FlowId,PacketId) pair
+    /// \returns the hash value of the pair
+    uint32_t operator() (const std::pair<FlowId, FlowPacketId> &key) const
+    {
+      return FlowHashMix ((uint64_t (key.first) << 32) | key.second);
+    }
+  };
+
   /// (FlowId,PacketId) --> TrackedPacket
-  typedef std::map< std::pair<FlowId, FlowPacketId>, TrackedPacket> TrackedPacketMap;
+  typedef FlowHashTable<std::pair<FlowId, FlowPacketId>, TrackedPacket, TrackedPacketHash> TrackedPacketMap;
   TrackedPacketMap m_trackedPackets; //!< Tracked packets
   Time m_maxPerHopDelay; //!< Minimum per-hop delay
   FlowProbeContainer m_flowProbes; //!< all the FlowProbes
@@ -300,6 +363,20 @@ private:
 
   /// Periodic function to check for lost packets and prune statistics
   void PeriodicCheckForLostPackets ();
+
+  /// Get the snapshot of a flow, with no change since its start if it
+  /// had none
+  /// \param flowId the Flow identification
+  /// \returns the snapshot of the flow
+  FlowSnapshot& GetSnapshotForFlow (FlowId flowId);
+
+  /// Record the statistics of a flow in its snapshot
+  /// \param snapshot the snapshot
+  /// \param stats the statistics of the flow
+  static void SetSnapshot (FlowSnapshot &snapshot, const FlowStats &stats);
+
+  /// Periodic function to write the snapshots
+  void PeriodicSnapshot ();
 };
 
 
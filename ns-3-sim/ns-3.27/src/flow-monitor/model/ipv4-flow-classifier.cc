@@ -96,6 +96,15 @@ bool operator == (const Ipv4FlowClassifier::FiveTuple &t1,
 
 
 
+uint32_t
+Ipv4FlowClassifier::FiveTupleHash::operator() (const FiveTuple &tuple) const
+{
+  uint64_t addresses = (uint64_t (tuple.sourceAddress.Get ()) << 32) | tuple.destinationAddress.Get ();
+  uint64_t ports = (uint64_t (tuple.protocol) << 32) | (uint32_t (tuple.sourcePort) << 16) | tuple.destinationPort;
+  return FlowHashMix (FlowHashMix (addresses) ^ ports);
+}
+
+
 Ipv4FlowClassifier::Ipv4FlowClassifier ()
 {
 }
@@ -148,54 +157,61 @@ Ipv4FlowClassifier::Classify (const Ipv4Header &ipHeader, Ptr<const Packet> ipPa
   tuple.destinationPort = dstPort;
 
   // try to insert the tuple, but check if it already exists
-  std::pair<std::map<FiveTuple, FlowId>::iterator, bool> insert
-    = m_flowMap.insert (std::pair<FiveTuple, FlowId> (tuple, 0));
+  bool inserted;
+  uint32_t *index = m_flowIndices.Insert (tuple, &inserted);
 
   // if the insertion succeeded, we need to assign this tuple a new flow identifier
-  if (insert.second)
+  if (inserted)
     {
-      FlowId newFlowId = GetNewFlowId ();
-      insert.first->second = newFlowId;
-      m_flowPktIdMap[newFlowId] = 0;
-      m_flowDscpMap[newFlowId];
+      *index = m_flows.size ();
+      Flow flow;
+      flow.tuple = tuple;
+      flow.flowId = GetNewFlowId ();
+      flow.lastPacketId = 0;
+      m_flows.push_back (flow);
     }
   else
     {
-      m_flowPktIdMap[insert.first->second] ++;
+      m_flows[*index].lastPacketId++;
     }
+  Flow &flow = m_flows[*index];
 
   // increment the counter of packets with the same DSCP value
   Ipv4Header::DscpType dscp = ipHeader.GetDscp ();
-  std::pair<std::map<Ipv4Header::DscpType, uint32_t>::iterator, bool> dscpInserter
-    = m_flowDscpMap[insert.first->second].insert (std::pair<Ipv4Header::DscpType, uint32_t> (dscp, 1));
-
-  // if the insertion did not succeed, we need to increment the counter
-  if (!dscpInserter.second)
+  uint32_t i = 0;
+  while (i < flow.dscpCounts.size () && flow.dscpCounts[i].first != dscp)
+    {
+      i++;
+    }
+  if (i == flow.dscpCounts.size ())
     {
-      m_flowDscpMap[insert.first->second][dscp] ++;
+      flow.dscpCounts.push_back (std::pair<Ipv4Header::DscpType, uint32_t> (dscp, 0));
     }
+  flow.dscpCounts[i].second++;
 
-  *out_flowId = insert.first->second;
-  *out_packetId = m_flowPktIdMap[*out_flowId];
+  *out_flowId = flow.flowId;
+  *out_packetId = flow.lastPacketId;
 
   return true;
 }
 
 
-Ipv4FlowClassifier::FiveTuple
-Ipv4FlowClassifier::FindFlow (FlowId flowId) const
+const Ipv4FlowClassifier::Flow&
+Ipv4FlowClassifier::GetFlow (FlowId flowId) const
 {
-  for (std::map<FiveTuple, FlowId>::const_iterator
-       iter = m_flowMap.begin (); iter != m_flowMap.end (); iter++)
+  // the flow identifiers are handed out in sequence, from 1
+  if (flowId == 0 || flowId > m_flows.size ())
     {
-      if (iter->second == flowId)
-        {
-          return iter->first;
-        }
+      NS_FATAL_ERROR ("Could not find the flow with ID " << flowId);
     }
-  NS_FATAL_ERROR ("Could not find the flow with ID " << flowId);
-  FiveTuple retval = { Ipv4Address::GetZero (), Ipv4Address::GetZero (), 0, 0, 0 };
-  return retval;
+  NS_ASSERT (m_flows[flowId - 1].flowId == flowId);
+  return m_flows[flowId - 1];
+}
+
+Ipv4FlowClassifier::FiveTuple
+Ipv4FlowClassifier::FindFlow (FlowId flowId) const
+{
+  return GetFlow (flowId).tuple;
 }
 
 bool
@@ -206,17 +222,17 @@ Ipv4FlowClassifier::SortByCount::operator() (std::pair<Ipv4Header::DscpType, uin
 }
 
 std::vector<std::pair<Ipv4Header::DscpType, uint32_t> >
-Ipv4FlowClassifier::GetDscpCounts (FlowId flowId) const
+Ipv4FlowClassifier::GetSortedDscps (const Flow &flow)
 {
-  std::map<FlowId, std::map<Ipv4Header::DscpType, uint32_t> >::const_iterator flow
-    = m_flowDscpMap.find (flowId);
-
-  if (flow == m_flowDscpMap.end ())
-    {
-      NS_FATAL_ERROR ("Could not find the flow with ID " << flowId);
-    }
+  std::vector<std::pair<Ipv4Header::DscpType, uint32_t> > v = flow.dscpCounts;
+  std::sort (v.begin (), v.end ());
+  return v;
+}
 
-  std::vector<std::pair<Ipv4Header::DscpType, uint32_t> > v (flow->second.begin (), flow->second.end ());
+std::vector<std::pair<Ipv4Header::DscpType, uint32_t> >
+Ipv4FlowClassifier::GetDscpCounts (FlowId flowId) const
+{
+  std::vector<std::pair<Ipv4Header::DscpType, uint32_t> > v = GetSortedDscps (GetFlow (flowId));
   std::sort (v.begin (), v.end (), SortByCount ());
   return v;
 }
@@ -226,12 +242,21 @@ Ipv4FlowClassifier::SerializeToXmlStream (std::ostream &os, uint16_t indent) con
 {
   Indent (os, indent); os << "<Ipv4FlowClassifier>\n";
 
+  // the flows are listed in the order of their tuples
+  std::vector<std::pair<FiveTuple, uint32_t> > tuples;
+  for (uint32_t i = 0; i < m_flows.size (); i++)
+    {
+      tuples.push_back (std::make_pair (m_flows[i].tuple, i));
+    }
+  std::sort (tuples.begin (), tuples.end ());
+
   indent += 2;
-  for (std::map<FiveTuple, FlowId>::const_iterator
-       iter = m_flowMap.begin (); iter != m_flowMap.end (); iter++)
+  for (std::vector<std::pair<FiveTuple, uint32_t> >::const_iterator
+       iter = tuples.begin (); iter != tuples.end (); iter++)
     {
+      const Flow &flow = m_flows[iter->second];
       Indent (os, indent);
-      os << "<Flow flowId=\"" << iter->second << "\""
+      os << "<Flow flowId=\"" << flow.flowId << "\""
          << " sourceAddress=\"" << iter->first.sourceAddress << "\""
          << " destinationAddress=\"" << iter->first.destinationAddress << "\""
          << " protocol=\"" << int(iter->first.protocol) << "\""
@@ -239,17 +264,12 @@ Ipv4FlowClassifier::SerializeToXmlStream (std::ostream &os, uint16_t indent) con
          << " destinationPort=\"" << iter->first.destinationPort << "\">\n";
 
       indent += 2;
-      std::map<FlowId, std::map<Ipv4Header::DscpType, uint32_t> >::const_iterator flow
-        = m_flowDscpMap.find (iter->second);
-
-      if (flow != m_flowDscpMap.end ())
+      std::vector<std::pair<Ipv4Header::DscpType, uint32_t> > dscps = GetSortedDscps (flow);
+      for (std::vector<std::pair<Ipv4Header::DscpType, uint32_t> >::const_iterator i = dscps.begin (); i != dscps.end (); i++)
         {
-          for (std::map<Ipv4Header::DscpType, uint32_t>::const_iterator i = flow->second.begin (); i != flow->second.end (); i++)
-            {
-              Indent (os, indent);
-              os << "<Dscp value=\"0x" << std::hex << static_cast<uint32_t> (i->first) << "\""
-                 << " packets=\"" << std::dec << i->second << "\" />\n";
-            }
+          Indent (os, indent);
+          os << "<Dscp value=\"0x" << std::hex << static_cast<uint32_t> (i->first) << "\""
+             << " packets=\"" << std::dec << i->second << "\" />\n";
         }
 
       indent -= 2;
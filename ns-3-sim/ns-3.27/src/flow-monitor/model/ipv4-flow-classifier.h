@@ -22,10 +22,11 @@
 #define IPV4_FLOW_CLASSIFIER_H
 
 #include <stdint.h>
-#include <map>
+#include <vector>
 
 #include "ns3/ipv4-header.h"
 #include "ns3/flow-classifier.h"
+#include "ns3/flow-hash-table.h"
 
 namespace ns3 {
 
@@ -34,7 +35,10 @@ class Packet;
 /// Classifies packets by looking at their IP and TCP/UDP headers.
 /// From these packet headers, a tuple (source-ip, destination-ip,
 /// protocol, source-port, destination-port) is created, and a unique
-/// flow identifier is assigned for each different tuple combination
+/// flow identifier is assigned for each different tuple combination.
+///
+/// The flows are found from their tuple in a hash table, so that
+/// classifying a packet allocates no memory, except for a new flow.
 class Ipv4FlowClassifier : public FlowClassifier
 {
 public:
@@ -92,12 +96,37 @@ public:
 
 private:
 
-  /// Map to Flows Identifiers to FlowIds
-  std::map<FiveTuple, FlowId> m_flowMap;
-  /// Map to FlowIds to FlowPacketId
-  std::map<FlowId, FlowPacketId> m_flowPktIdMap;
-  /// Map FlowIds to (DSCP value, packet count) pairs
-  std::map<FlowId, std::map<Ipv4Header::DscpType, uint32_t> > m_flowDscpMap;
+  /// The state of a flow
+  struct Flow
+  {
+    FiveTuple tuple;              //!< the five-tuple of the flow
+    FlowId flowId;                //!< the identifier of the flow
+    FlowPacketId lastPacketId;    //!< the identifier of the last packet
+    /// (DSCP value, packet count) pairs, in the order the values were seen
+    std::vector<std::pair<Ipv4Header::DscpType, uint32_t> > dscpCounts;
+  };
+
+  /// Hash of a five-tuple
+  struct FiveTupleHash
+  {
+    /// \param tuple the five-tuple
+    /// \returns the hash value of the five-tuple
+    uint32_t operator() (const FiveTuple &tuple) const;
+  };
+
+  /// \param flowId a FlowId
+  /// \returns the flow of the FlowId
+  const Flow& GetFlow (FlowId flowId) const;
+
+  /// \param flow a flow
+  /// \returns the (DSCP value, packet count) pairs of the flow, in
+  /// increasing order of DSCP value
+  static std::vector<std::pair<Ipv4Header::DscpType, uint32_t> > GetSortedDscps (const Flow &flow);
+
+  /// Map FiveTuples to the index of their flow in m_flows
+  FlowHashTable<FiveTuple, uint32_t, FiveTupleHash> m_flowIndices;
+  /// The flows, in the order of their FlowIds
+  std::vector<Flow> m_flows;
 
 };
 
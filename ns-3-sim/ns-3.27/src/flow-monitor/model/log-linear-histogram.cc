@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "log-linear-histogram.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+const uint32_t LogLinearHistogram::SUB_BINS;
+const uint32_t LogLinearHistogram::N_BINS;
+
+LogLinearHistogram::LogLinearHistogram ()
+  : m_bins (N_BINS, 0),
+    m_count (0)
+{
+}
+
+uint32_t
+LogLinearHistogram::GetBinIndex (uint64_t value)
+{
+  if (value < SUB_BINS)
+    {
+      return value;
+    }
+  // value is in [2^e, 2^(e+1)), with e >= 4; its bin within that power of
+  // two is given by the 4 bits below the leading one
+  uint32_t e = 63;
+  while ((value >> e) == 0)
+    {
+      e--;
+    }
+  return (e - 3) * SUB_BINS + ((value >> (e - 4)) & (SUB_BINS - 1));
+}
+
+uint64_t
+LogLinearHistogram::GetBinStart (uint32_t index)
+{
+  NS_ASSERT (index < N_BINS);
+  if (index < SUB_BINS)
+    {
+      return index;
+    }
+  uint32_t e = index / SUB_BINS + 3;
+  return uint64_t (SUB_BINS + index % SUB_BINS) << (e - 4);
+}
+
+void
+LogLinearHistogram::AddValue (uint64_t value)
+{
+  m_bins[GetBinIndex (value)]++;
+  m_count++;
+}
+
+void
+LogLinearHistogram::Reset (void)
+{
+  if (m_count > 0)
+    {
+      std::fill (m_bins.begin (), m_bins.end (), 0);
+      m_count = 0;
+    }
+}
+
+uint64_t
+LogLinearHistogram::GetCount (void) const
+{
+  return m_count;
+}
+
+uint32_t
+LogLinearHistogram::GetBinCount (uint32_t index) const
+{
+  NS_ASSERT (index < N_BINS);
+  return m_bins[index];
+}
+
+uint64_t
+LogLinearHistogram::GetQuantile (double fraction) const
+{
+  if (m_count == 0)
+    {
+      return 0;
+    }
+  uint64_t rank = std::max<uint64_t> (1, std::ceil (fraction * m_count));
+  uint64_t seen = 0;
+  uint32_t index = 0;
+  for (; index + 1 < N_BINS; index++)
+    {
+      seen += m_bins[index];
+      if (seen >= rank)
+        {
+          break;
+        }
+    }
+  uint64_t start = GetBinStart (index);
+  uint64_t end = index + 1 < N_BINS ? GetBinStart (index + 1) : start;
+  return start + (end - start) / 2;
+}
+
+} // namespace ns3
@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef LOG_LINEAR_HISTOGRAM_H
+#define LOG_LINEAR_HISTOGRAM_H
+
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \brief Histogram of non-negative integers with a fixed number of bins.
+ *
+ * The values below SUB_BINS have one bin each.  Above, each power of two
+ * [2^e, 2^(e+1)) is split into SUB_BINS bins of equal width, so that a
+ * value is known to within 1/SUB_BINS of itself whatever its magnitude,
+ * and the histogram never grows: it holds N_BINS counters, unlike
+ * Histogram whose bins grow with the largest value.
+ *
+ * The FlowMonitor keeps one per flow, of the packet delays in
+ * nanoseconds, to write the delay percentiles of its snapshots.
+ */
+class LogLinearHistogram
+{
+public:
+  /// Number of bins per power of two
+  static const uint32_t SUB_BINS = 16;
+  /// Number of bins, enough for any 64 bit value
+  static const uint32_t N_BINS = (64 - 4 + 1) * SUB_BINS;
+
+  LogLinearHistogram ();
+
+  /**
+   * \brief Add a value to the histogram
+   * \param value the value to add
+   */
+  void AddValue (uint64_t value);
+
+  /// \brief Remove every value from the histogram
+  void Reset (void);
+
+  /**
+   * \brief Get the number of values added since the last reset
+   * \return the number of values
+   */
+  uint64_t GetCount (void) const;
+
+  /**
+   * \brief Get the bin of a value
+   * \param value the value
+   * \return the index of its bin
+   */
+  static uint32_t GetBinIndex (uint64_t value);
+
+  /**
+   * \brief Get the smallest value of a bin
+   * \param index the bin index
+   * \return the bin start
+   */
+  static uint64_t GetBinStart (uint32_t index);
+
+  /**
+   * \brief Get the number of values of a bin
+   * \param index the bin index
+   * \return the number of values added to the bin
+   */
+  uint32_t GetBinCount (uint32_t index) const;
+
+  /**
+   * \brief Estimate a quantile of the values
+   *
+   * \param fraction the fraction of the values, from 0 to 1, which are
+   * at most the quantile
+   * \return the middle of the bin of the quantile, or 0 if the histogram
+   * is empty
+   */
+  uint64_t GetQuantile (double fraction) const;
+
+private:
+  std::vector<uint32_t> m_bins; //!< the count of each bin
+  uint64_t m_count; //!< the number of values
+};
+
+} // namespace ns3
+
+#endif /* LOG_LINEAR_HISTOGRAM_H */
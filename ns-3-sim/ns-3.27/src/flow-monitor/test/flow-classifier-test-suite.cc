@@ -0,0 +1,236 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "ns3/flow-hash-table.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/packet.h"
+#include "ns3/udp-header.h"
+#include "ns3/test.h"
+#include <map>
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Hash of the keys of the FlowHashTable test, crowding them in a
+ * few slots so that they collide and wrap around the end of the table.
+ */
+struct CollidingHash
+{
+  /**
+   * \param key a key
+   * \returns the hash value of the key
+   */
+  uint32_t operator() (uint32_t key) const
+  {
+    return (key % 7) * 0x10000001;
+  }
+};
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowHashTable Test, against a std::map
+ */
+class FlowHashTableTestCase : public TestCase
+{
+public:
+  FlowHashTableTestCase ();
+  virtual void DoRun (void);
+};
+
+FlowHashTableTestCase::FlowHashTableTestCase ()
+  : TestCase ("FlowHashTable")
+{
+}
+
+void
+FlowHashTableTestCase::DoRun (void)
+{
+  FlowHashTable<uint32_t, uint32_t, CollidingHash> table;
+  std::map<uint32_t, uint32_t> reference;
+  uint32_t state = 12345;
+  for (uint32_t i = 0; i < 20000; i++)
+    {
+      state = state * 1103515245 + 12345;
+      uint32_t key = (state >> 8) % 100;
+      bool inserted;
+      switch ((state >> 24) % 3)
+        {
+        case 0:
+          *table.Insert (key, &inserted) = i;
+          NS_TEST_ASSERT_MSG_EQ (inserted, (reference.find (key) == reference.end ()), "Insert of key " << key);
+          reference[key] = i;
+          break;
+        case 1:
+          NS_TEST_ASSERT_MSG_EQ (table.Remove (key), (reference.erase (key) == 1), "Remove of key " << key);
+          break;
+        default:
+          NS_TEST_ASSERT_MSG_EQ ((table.Find (key) != 0), (reference.find (key) != reference.end ()),
+                                 "Find of key " << key);
+          if (table.Find (key) != 0)
+            {
+              NS_TEST_ASSERT_MSG_EQ (*table.Find (key), reference[key], "Value of key " << key);
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (table.GetSize (), reference.size (), "Size after step " << i);
+    }
+
+  // Remove the even keys while visiting the slots: every key is seen
+  std::map<uint32_t, uint32_t> seen;
+  uint32_t size = table.GetSize ();
+  for (uint32_t slot = 0; slot < table.GetNSlots (); )
+    {
+      if (table.IsUsed (slot))
+        {
+          uint32_t key = table.GetKey (slot);
+          seen[key] = table.GetValue (slot);
+          if (key % 2 == 0)
+            {
+              table.RemoveSlot (slot);
+              reference.erase (key);
+              continue;
+            }
+        }
+      slot++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (seen.size (), size, "Keys seen");
+  for (std::map<uint32_t, uint32_t>::const_iterator i = reference.begin (); i != reference.end (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (seen.count (i->first), 1, "Key " << i->first << " seen");
+      NS_TEST_ASSERT_MSG_NE (table.Find (i->first), 0, "Key " << i->first << " kept");
+    }
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), reference.size (), "Size after removing the even keys");
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Ipv4FlowClassifier Test
+ */
+class Ipv4FlowClassifierTestCase : public TestCase
+{
+public:
+  Ipv4FlowClassifierTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Classify a UDP packet
+   * \param classifier the classifier
+   * \param source the source address
+   * \param sourcePort the source port
+   * \param dscp the DSCP value
+   * \param packetId set to the identifier of the packet
+   * \returns the FlowId of the packet
+   */
+  static FlowId Classify (Ptr<Ipv4FlowClassifier> classifier, const char *source, uint16_t sourcePort,
+                          Ipv4Header::DscpType dscp, FlowPacketId *packetId);
+};
+
+Ipv4FlowClassifierTestCase::Ipv4FlowClassifierTestCase ()
+  : TestCase ("Ipv4FlowClassifier")
+{
+}
+
+FlowId
+Ipv4FlowClassifierTestCase::Classify (Ptr<Ipv4FlowClassifier> classifier, const char *source, uint16_t sourcePort,
+                                      Ipv4Header::DscpType dscp, FlowPacketId *packetId)
+{
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address (source));
+  ipHeader.SetDestination (Ipv4Address ("10.0.0.1"));
+  ipHeader.SetProtocol (17);
+  ipHeader.SetDscp (dscp);
+  Ptr<Packet> payload = Create<Packet> (100);
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (sourcePort);
+  udpHeader.SetDestinationPort (9);
+  payload->AddHeader (udpHeader);
+  FlowId flowId = 0;
+  classifier->Classify (ipHeader, payload, &flowId, packetId);
+  return flowId;
+}
+
+void
+Ipv4FlowClassifierTestCase::DoRun (void)
+{
+  Ptr<Ipv4FlowClassifier> classifier = Create<Ipv4FlowClassifier> ();
+  FlowPacketId packetId;
+  NS_TEST_ASSERT_MSG_EQ (Classify (classifier, "10.0.0.3", 50, Ipv4Header::DSCP_AF11, &packetId), 1, "First flow");
+  NS_TEST_ASSERT_MSG_EQ (packetId, 0, "First packet");
+  NS_TEST_ASSERT_MSG_EQ (Classify (classifier, "10.0.0.2", 60, Ipv4Header::DscpDefault, &packetId), 2, "Second flow");
+  NS_TEST_ASSERT_MSG_EQ (Classify (classifier, "10.0.0.3", 50, Ipv4Header::DscpDefault, &packetId), 1, "First flow again");
+  NS_TEST_ASSERT_MSG_EQ (packetId, 1, "Second packet of the first flow");
+  NS_TEST_ASSERT_MSG_EQ (Classify (classifier, "10.0.0.3", 50, Ipv4Header::DscpDefault, &packetId), 1, "First flow again");
+  NS_TEST_ASSERT_MSG_EQ (packetId, 2, "Third packet of the first flow");
+  NS_TEST_ASSERT_MSG_EQ (Classify (classifier, "10.0.0.3", 40, Ipv4Header::DscpDefault, &packetId), 3, "Third flow");
+
+  Ipv4FlowClassifier::FiveTuple tuple = classifier->FindFlow (2);
+  NS_TEST_ASSERT_MSG_EQ (tuple.sourceAddress, Ipv4Address ("10.0.0.2"), "Source of the second flow");
+  NS_TEST_ASSERT_MSG_EQ (tuple.sourcePort, 60, "Source port of the second flow");
+
+  std::vector<std::pair<Ipv4Header::DscpType, uint32_t> > dscps = classifier->GetDscpCounts (1);
+  NS_TEST_ASSERT_MSG_EQ (dscps.size (), 2, "DSCP values of the first flow");
+  NS_TEST_ASSERT_MSG_EQ (dscps[0].first, Ipv4Header::DscpDefault, "Most frequent DSCP value");
+  NS_TEST_ASSERT_MSG_EQ (dscps[0].second, 2, "Packets with the most frequent DSCP value");
+  NS_TEST_ASSERT_MSG_EQ (dscps[1].first, Ipv4Header::DSCP_AF11, "Least frequent DSCP value");
+
+  // The flows are written in the order of their tuples, and their DSCP
+  // values in increasing order
+  std::ostringstream xml;
+  classifier->SerializeToXmlStream (xml, 0);
+  std::string expected =
+    "<Ipv4FlowClassifier>\n"
+    "  <Flow flowId=\"2\" sourceAddress=\"10.0.0.2\" destinationAddress=\"10.0.0.1\" protocol=\"17\" sourcePort=\"60\" destinationPort=\"9\">\n"
+    "    <Dscp value=\"0x0\" packets=\"1\" />\n"
+    "  </Flow>\n"
+    "  <Flow flowId=\"3\" sourceAddress=\"10.0.0.3\" destinationAddress=\"10.0.0.1\" protocol=\"17\" sourcePort=\"40\" destinationPort=\"9\">\n"
+    "    <Dscp value=\"0x0\" packets=\"1\" />\n"
+    "  </Flow>\n"
+    "  <Flow flowId=\"1\" sourceAddress=\"10.0.0.3\" destinationAddress=\"10.0.0.1\" protocol=\"17\" sourcePort=\"50\" destinationPort=\"9\">\n"
+    "    <Dscp value=\"0x0\" packets=\"2\" />\n"
+    "    <Dscp value=\"0xa\" packets=\"1\" />\n"
+    "  </Flow>\n"
+    "</Ipv4FlowClassifier>\n";
+  NS_TEST_ASSERT_MSG_EQ (xml.str (), expected, "XML output");
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Flow classifier TestSuite
+ */
+class FlowClassifierTestSuite : public TestSuite
+{
+public:
+  FlowClassifierTestSuite ();
+};
+
+FlowClassifierTestSuite::FlowClassifierTestSuite ()
+  : TestSuite ("flow-classifier", UNIT)
+{
+  AddTestCase (new FlowHashTableTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4FlowClassifierTestCase, TestCase::QUICK);
+}
+
+static FlowClassifierTestSuite g_flowClassifierTestSuite; //!< Static variable for test initialization
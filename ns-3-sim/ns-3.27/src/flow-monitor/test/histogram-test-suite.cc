@@ -19,6 +19,7 @@
 //
 
 #include "ns3/histogram.h"
+#include "ns3/log-linear-histogram.h"
 #include "ns3/test.h"
 
 using namespace ns3;
@@ -80,6 +81,59 @@ HistogramTestCase::DoRun (void)
   }
 }
 
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor LogLinearHistogram Test
+ */
+class LogLinearHistogramTestCase : public ns3::TestCase {
+public:
+  LogLinearHistogramTestCase ();
+  virtual void DoRun (void);
+};
+
+LogLinearHistogramTestCase::LogLinearHistogramTestCase ()
+  : ns3::TestCase ("LogLinearHistogram")
+{
+}
+
+void
+LogLinearHistogramTestCase::DoRun (void)
+{
+  // Every value falls in the bin which starts at most 1/16 below it
+  uint64_t values[] = { 0, 1, 15, 16, 17, 31, 32, 33, 1000, 123456789, 0xffffffffffffffffULL };
+  for (uint32_t i = 0; i < sizeof (values) / sizeof (values[0]); i++)
+    {
+      uint32_t index = LogLinearHistogram::GetBinIndex (values[i]);
+      NS_TEST_ASSERT_MSG_LT (index, LogLinearHistogram::N_BINS, "Bin of " << values[i]);
+      uint64_t start = LogLinearHistogram::GetBinStart (index);
+      NS_TEST_ASSERT_MSG_EQ ((start <= values[i]), true, "Start of the bin of " << values[i]);
+      NS_TEST_ASSERT_MSG_EQ ((values[i] - start <= values[i] / 16), true, "Width of the bin of " << values[i]);
+      if (index + 1 < LogLinearHistogram::N_BINS)
+        {
+          NS_TEST_ASSERT_MSG_GT (LogLinearHistogram::GetBinStart (index + 1), values[i], "End of the bin of " << values[i]);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (LogLinearHistogram::GetBinIndex (16), 16, "First bin of a power of two");
+  NS_TEST_ASSERT_MSG_EQ (LogLinearHistogram::GetBinIndex (32), 32, "Next power of two");
+
+  LogLinearHistogram h;
+  NS_TEST_ASSERT_MSG_EQ (h.GetQuantile (0.5), 0, "Empty histogram");
+  for (uint64_t v = 1; v <= 1000; v++)
+    {
+      h.AddValue (v * 1000);
+    }
+  NS_TEST_ASSERT_MSG_EQ (h.GetCount (), 1000, "Count");
+  NS_TEST_ASSERT_MSG_EQ_TOL (h.GetQuantile (0.5), 500000, 500000 / 32, "Median");
+  NS_TEST_ASSERT_MSG_EQ_TOL (h.GetQuantile (0.99), 990000, 990000 / 32, "99th percentile");
+  NS_TEST_ASSERT_MSG_EQ_TOL (h.GetQuantile (1), 1000000, 1000000 / 32, "Maximum");
+  h.Reset ();
+  NS_TEST_ASSERT_MSG_EQ (h.GetCount (), 0, "Count after a reset");
+  h.AddValue (7);
+  NS_TEST_ASSERT_MSG_EQ (h.GetQuantile (0.5), 7, "Small values are exact");
+}
+
 /**
  * \ingroup flow-monitor-test
  * \ingroup tests
@@ -96,6 +150,7 @@ HistogramTestSuite::HistogramTestSuite ()
   : TestSuite ("histogram", UNIT)
 {
   AddTestCase (new HistogramTestCase, TestCase::QUICK);
+  AddTestCase (new LogLinearHistogramTestCase, TestCase::QUICK);
 }
 
 static HistogramTestSuite g_HistogramTestSuite; //!< Static variable for test initialization
@@ -6,6 +6,7 @@
 #include "ns3/node.h"
 #include "ns3/fnss-node.h"
 #include "ns3/fnss-event.h"
+#include "ns3/fnss-link-event.h"
 #include "ns3/quantity.h"
 #include "ns3/traffic-control-module.h"
 
@@ -13,10 +14,19 @@ NS_LOG_COMPONENT_DEFINE ("FNSSSimulation");
 
 namespace ns3 {
 
+//Packet size in bytes assumed to turn the bit rates of a traffic matrix into packet rates.
+static const double DEMAND_PACKET_SIZE = 1500;
+
 FNSSSimulation::FNSSSimulation(const fnss::Topology &topology) {
 	this->buildTopology(topology);
 }
 
+FNSSSimulation::FNSSSimulation(const fnss::Topology &topology, uint32_t systemCount,
+		const fnss::TrafficMatrix *traffic) {
+	this->partition(topology, systemCount, traffic);
+	this->buildTopology(topology);
+}
+
 FNSSSimulation::FNSSSimulation(const std::string &file) {
 	fnss::Topology topology = fnss::Parser::parseTopology(file);
 	this->buildTopology(topology);
@@ -69,6 +79,10 @@ Ptr<Node> FNSSSimulation::getNodeByIp (Ipv4Address addr) const {
 	return m_map.at(addr);
 }
 
+const TopologyPartitioner& FNSSSimulation::getPartitioner() const {
+	return this->m_partitioner;
+}
+
 std::map <std::string, Ptr <Application> >  FNSSSimulation::getApplications(const std::string &id) const {
 	NodesMap::const_iterator it = this->m_nodes.find(id);
 	return it->second.m_applications;
@@ -93,7 +107,8 @@ void FNSSSimulation::buildTopology(const fnss::Topology &topology) {
 	std::set<std::string> nodeIds = topology.getAllNodes();
 	for(std::set<std::string>::iterator it = nodeIds.begin(); it != nodeIds.end(); it++) {
 		NodesValue val;
-		val.m_ptr = CreateObject <Node>();
+		std::map<std::string, uint32_t>::const_iterator sys = this->m_systemIds.find(*it);
+		val.m_ptr = sys == this->m_systemIds.end() ? CreateObject <Node>() : CreateObject <Node>(sys->second);
 		this->m_nodes[*it] = val;
 	}
 	NS_LOG_INFO("Created " << this->m_nodes.size() << " nodes.");
@@ -155,19 +170,68 @@ void FNSSSimulation::buildTopology(const fnss::Topology &topology) {
 	}
 }
 
+void FNSSSimulation::partition(const fnss::Topology &topology, uint32_t systemCount,
+		const fnss::TrafficMatrix *traffic) {
+	//Nodes are indexed in the order of their ids, as buildTopology creates them.
+	std::set<std::string> nodeIds = topology.getAllNodes();
+	std::map<std::string, uint32_t> index;
+	for(std::set<std::string>::iterator it = nodeIds.begin(); it != nodeIds.end(); it++) {
+		index[*it] = this->m_partitioner.AddNode();
+	}
+
+	std::set<std::pair < std::string, std::string > > edges = topology.getAllEdges();
+	for(std::set<std::pair <std::string, std::string> >::iterator it = edges.begin();
+		it != edges.end(); it++) {
+		fnss::Quantity delay = topology.getEdge(*it).getDelay();
+		delay.convert("s");
+		this->m_partitioner.AddLink(index[(*it).first], index[(*it).second], Seconds(delay.getValue()));
+	}
+
+	if(traffic != 0) {
+		std::set<std::pair<std::string, std::string> > pairs = traffic->getPairs();
+		for(std::set<std::pair<std::string, std::string> >::iterator it = pairs.begin();
+			it != pairs.end(); it++) {
+			//The partitioner expects packet rates, the traffic matrix holds bit rates.
+			fnss::Quantity volume = traffic->getFlow(*it);
+			volume.convert("bps");
+			this->m_partitioner.AddDemand(index[(*it).first], index[(*it).second],
+				volume.getValue() / (8.0 * DEMAND_PACKET_SIZE));
+		}
+	}
+
+	std::vector<uint32_t> systemIds = this->m_partitioner.Partition(systemCount);
+	for(std::map<std::string, uint32_t>::iterator it = index.begin(); it != index.end(); it++) {
+		this->m_systemIds[it->first] = systemIds[it->second];
+	}
+	NS_LOG_INFO("Partitioned " << nodeIds.size() << " nodes into " << systemCount
+		<< " ranks, lookahead " << this->m_partitioner.GetLookAhead());
+}
+
 void FNSSSimulation::doEvents(const fnss::EventSchedule &schedule) {
 	ObjectFactory factory;
 
 	for(uint32_t i = 0; i < schedule.size(); i++) {
 		fnss::Event e = schedule.getEvent(i);
 
-		//Create the event.
+		//Create the event, of the class named by its type.
+		factory.SetTypeId(e.hasProperty("event_type") ? e.getProperty("event_type") : "ns3::FNSSEvent");
 		e.removeProperty("event_type");
-		Ptr<FNSSEvent> fnssEvent = CreateObject <FNSSEvent> ();
-  		this->applyProperties(fnssEvent, e);
+		Ptr<Object> object = factory.Create();
+		FNSSEvent *fnssEvent = dynamic_cast<FNSSEvent *> (PeekPointer(object));
+		NS_ABORT_MSG_IF(fnssEvent == 0, object->GetInstanceTypeId().GetName()
+			<< " does not derive from ns3::FNSSEvent");
+  		this->applyProperties(object, e);
+
+		//A link event acts on the devices of its link.
+		FNSSLinkEvent *linkEvent = dynamic_cast<FNSSLinkEvent *> (fnssEvent);
+		if(linkEvent != 0) {
+			this->findLink(linkEvent);
+		}
 
-  		//Schedule the event.
-  		Ptr<EventImpl> downcastEvent = DynamicCast <EventImpl, FNSSEvent> (fnssEvent);
+  		//Schedule the event. The simulator owns it through its EventImpl
+  		//reference, and deletes it once run: the Object one is never released.
+  		object->Ref();
+  		Ptr<EventImpl> downcastEvent (fnssEvent, false);
   		fnss::Quantity t = e.getTime();
   		t.convert("ms");
   		std::string str = t.toString();
@@ -178,4 +242,23 @@ void FNSSSimulation::doEvents(const fnss::EventSchedule &schedule) {
 	NS_LOG_INFO("Scheduled events.");
 }
 
+void FNSSSimulation::findLink(FNSSLinkEvent *event) const {
+	NodesMap::const_iterator source = this->m_nodes.find(event->getSource());
+	NodesMap::const_iterator target = this->m_nodes.find(event->getTarget());
+	NS_ABORT_MSG_IF(source == this->m_nodes.end() || target == this->m_nodes.end(),
+		"No node " << (source == this->m_nodes.end() ? event->getSource() : event->getTarget()));
+
+	for(std::list<NetDeviceContainer>::const_iterator it = this->m_links.begin();
+		it != this->m_links.end(); it++) {
+		Ptr<Node> first = it->Get(0)->GetNode();
+		Ptr<Node> second = it->Get(1)->GetNode();
+		if((first == source->second.m_ptr && second == target->second.m_ptr)
+			|| (first == target->second.m_ptr && second == source->second.m_ptr)) {
+			event->setDevices(it->Get(0), it->Get(1));
+			return;
+		}
+	}
+	NS_FATAL_ERROR("No link between " << event->getSource() << " and " << event->getTarget());
+}
+
 } //namespace
@@ -3,12 +3,15 @@
 	
 #include "ns3/topology.h"
 #include "ns3/event-schedule.h"
+#include "ns3/traffic-matrix.h"
 #include "ns3/fnss-event.h"
+#include "ns3/fnss-link-event.h"
 
 #include "ns3/core-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/point-to-point-module.h"
+#include "ns3/topology-partitioner.h"
 
 #include <string>
 #include <map>
@@ -35,10 +38,26 @@ public:
 	 */
 	FNSSSimulation(const fnss::Topology &topology);
 
+	/**
+	 * Create the simulation from a fnss::Topology object for a parallel run.
+	 * The nodes are assigned to systemCount ranks by a TopologyPartitioner
+	 * before any device is created. Every rank must pass the same arguments.
+	 *
+	 * @param topology the fnss::Topology object to use.
+	 * @param systemCount the number of ranks.
+	 * @param traffic expected traffic between nodes, or 0 to balance the
+	 * number of nodes only. Its bit rates are passed to the partitioner as
+	 * packet rates of 1500 byte packets.
+	 */
+	FNSSSimulation(const fnss::Topology &topology, uint32_t systemCount,
+		const fnss::TrafficMatrix *traffic = 0);
+
 	/**
 	 * Create events from a XML event schedule file.
-	 * Every event must have a event_type property that must match an existing
-	 * class name deriving from ns3::FNSSEvent.
+	 * Each event is an instance of the class named by its event_type property,
+	 * which must derive from ns3::FNSSEvent, or ns3::FNSSEvent if it has none.
+	 * An ns3::FNSSLinkEvent takes the link between its source and target
+	 * nodes down or up, and updates the global routes.
 	 *
 	 * @param file the XML event schedule file to parse.
 	 */
@@ -46,8 +65,10 @@ public:
 	
 	/**
 	 * Create events from a fnss::EventSchedule object.
-	 * Every event must have a event_type property that must match an existing
-	 * class name deriving from ns3::FNSSEvent.
+	 * Each event is an instance of the class named by its event_type property,
+	 * which must derive from ns3::FNSSEvent, or ns3::FNSSEvent if it has none.
+	 * An ns3::FNSSLinkEvent takes the link between its source and target
+	 * nodes down or up, and updates the global routes.
 	 *
 	 * @param schedule the fnss::EventSchedule object to use.
 	 */
@@ -97,6 +118,14 @@ public:
 	std::map <Ipv4Address, Ptr<Node>> getIpMap () const;
 	Ptr<Node> getNodeByIp (Ipv4Address addr) const;
 
+	/**
+	 * Get the partitioner used to assign the nodes to ranks, to read the
+	 * lookahead and load imbalance of the partition.
+	 *
+	 * @return reference to the partitioner.
+	 */
+	const TopologyPartitioner& getPartitioner() const;
+
 private:
 	void applyProperties(Ptr <Object> target, const fnss::PropertyContainer &properties);
 
@@ -104,6 +133,16 @@ private:
 
 	void doEvents(const fnss::EventSchedule &schedule);
 
+	/**
+	 * Give a link event the devices of the link between its nodes.
+	 *
+	 * @param event the link event.
+	 */
+	void findLink(FNSSLinkEvent *event) const;
+
+	void partition(const fnss::Topology &topology, uint32_t systemCount,
+		const fnss::TrafficMatrix *traffic);
+
 	typedef struct {
 		Ptr <Node> m_ptr;
 		std::map <std::string, Ptr <Application> > m_applications;
@@ -118,6 +157,9 @@ private:
 
 	PointToPointHelper m_p2p;
 
+	TopologyPartitioner m_partitioner;
+	std::map<std::string, uint32_t> m_systemIds;	// rank of every node, empty if sequential
+
 	std::list<Ptr<EventImpl> > track;
 	std::list<Ptr<FNSSEvent> > track2;
 
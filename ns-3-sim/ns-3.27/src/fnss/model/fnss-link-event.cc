@@ -0,0 +1,83 @@
+#include "fnss-link-event.h"
+
+#include "ns3/string.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/node.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-global-routing-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FNSSLinkEvent");
+NS_OBJECT_ENSURE_REGISTERED (FNSSLinkEvent);
+
+TypeId FNSSLinkEvent::GetTypeId (void) {
+  static TypeId tid = TypeId ("ns3::FNSSLinkEvent")
+    .SetParent<FNSSEvent> ()
+    .AddConstructor<FNSSLinkEvent> ()
+    .AddAttribute ("source",
+                   "ID of the node at one end of the link",
+                   StringValue (""),
+                   MakeStringAccessor (&FNSSLinkEvent::m_source),
+                   MakeStringChecker())
+    .AddAttribute ("target",
+                   "ID of the node at the other end of the link",
+                   StringValue (""),
+                   MakeStringAccessor (&FNSSLinkEvent::m_target),
+                   MakeStringChecker())
+    .AddAttribute ("status",
+                   "New status of the link, down or up",
+                   StringValue ("down"),
+                   MakeStringAccessor (&FNSSLinkEvent::m_status),
+                   MakeStringChecker());
+
+  return tid;
+}
+
+FNSSLinkEvent::FNSSLinkEvent() {
+
+}
+
+FNSSLinkEvent::~FNSSLinkEvent() {
+
+}
+
+std::string FNSSLinkEvent::getSource() const {
+	return this->m_source;
+}
+
+std::string FNSSLinkEvent::getTarget() const {
+	return this->m_target;
+}
+
+void FNSSLinkEvent::setDevices(Ptr<NetDevice> first, Ptr<NetDevice> second) {
+	this->m_devices[0] = first;
+	this->m_devices[1] = second;
+}
+
+void FNSSLinkEvent::Notify() {
+	FNSSEvent::Notify();
+	NS_ABORT_MSG_IF(this->m_status != "down" && this->m_status != "up",
+		"Unknown link status " << this->m_status);
+	NS_ABORT_MSG_IF(this->m_devices[0] == 0, "No link between " << this->m_source
+		<< " and " << this->m_target);
+
+	for(uint32_t i = 0; i < 2; i++) {
+		Ptr<Ipv4> ipv4 = this->m_devices[i]->GetNode()->GetObject<Ipv4>();
+		int32_t interface = ipv4->GetInterfaceForDevice(this->m_devices[i]);
+		NS_ABORT_MSG_IF(interface < 0, "No IPv4 address on the link between "
+			<< this->m_source << " and " << this->m_target);
+		if(this->m_status == "down") {
+			ipv4->SetDown(interface);
+		} else {
+			ipv4->SetUp(interface);
+		}
+	}
+	NS_LOG_INFO("Link " << this->m_source << " - " << this->m_target << " " << this->m_status);
+
+	//Only the routers whose shortest paths cross the link change their routes.
+	Ipv4GlobalRoutingHelper::UpdateRoutingTables();
+}
+
+}
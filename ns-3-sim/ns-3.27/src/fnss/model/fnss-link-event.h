@@ -0,0 +1,58 @@
+#ifndef FNSS_LINK_EVENT_H
+#define FNSS_LINK_EVENT_H
+
+#include "fnss-event.h"
+
+#include "ns3/net-device.h"
+
+#include <string>
+
+namespace ns3 {
+
+/**
+ * Takes a link of the topology down or up, then updates the global routes.
+ *
+ * The link is given by the ids of its end nodes, in the source and target
+ * properties of the event, and the status property is either "down" or
+ * "up". The IPv4 interfaces of both ends of the link are set down or up,
+ * and Ipv4GlobalRoutingHelper::UpdateRoutingTables repairs the routes of
+ * the routers the link affects.
+ */
+class FNSSLinkEvent : public FNSSEvent {
+public:
+	static TypeId GetTypeId (void);
+
+	FNSSLinkEvent();
+
+	virtual ~FNSSLinkEvent();
+
+	virtual void Notify();
+
+	/**
+	 * @return the id of the node at one end of the link.
+	 */
+	std::string getSource() const;
+
+	/**
+	 * @return the id of the node at the other end of the link.
+	 */
+	std::string getTarget() const;
+
+	/**
+	 * Set the devices of the link, as found by FNSSSimulation.
+	 *
+	 * @param first the device of one end of the link.
+	 * @param second the device of the other end.
+	 */
+	void setDevices(Ptr<NetDevice> first, Ptr<NetDevice> second);
+
+private:
+	std::string m_source;
+	std::string m_target;
+	std::string m_status;
+	Ptr<NetDevice> m_devices[2];
+};
+
+}
+
+#endif
@@ -5,6 +5,8 @@
 
 // An essential include is test.h
 #include "ns3/test.h"
+#include "ns3/fnss-simulation.h"
+#include "ns3/simulator.h"
 
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
@@ -46,6 +48,123 @@ FnssTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+/**
+ * Take a link of a ring down then up with FNSSLinkEvent, and check the
+ * next hop of a route across the link.
+ */
+class FnssLinkEventTestCase : public TestCase
+{
+public:
+  FnssLinkEventTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param node a node
+   * \param peer a neighbor of the node
+   * \returns the address of the node on its link to the peer
+   */
+  static Ipv4Address GetLinkAddress (Ptr<Node> node, Ptr<Node> peer);
+  /**
+   * Record the gateway of the route of a node to an address.
+   * \param node the node
+   * \param destination the address
+   */
+  void CheckGateway (Ptr<Node> node, Ipv4Address destination);
+
+  std::vector<Ipv4Address> m_gateways; //!< the gateways, in the order they were checked
+};
+
+FnssLinkEventTestCase::FnssLinkEventTestCase ()
+  : TestCase ("Link events take links down and up, and update the global routes")
+{
+}
+
+Ipv4Address
+FnssLinkEventTestCase::GetLinkAddress (Ptr<Node> node, Ptr<Node> peer)
+{
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      Ptr<Channel> channel = node->GetDevice (i)->GetChannel ();
+      if (channel == 0)
+        {
+          continue;
+        }
+      for (uint32_t j = 0; j < channel->GetNDevices (); j++)
+        {
+          if (channel->GetDevice (j)->GetNode () == peer)
+            {
+              return ipv4->GetAddress (ipv4->GetInterfaceForDevice (node->GetDevice (i)), 0).GetLocal ();
+            }
+        }
+    }
+  return Ipv4Address ();
+}
+
+void
+FnssLinkEventTestCase::CheckGateway (Ptr<Node> node, Ipv4Address destination)
+{
+  Ipv4Header header;
+  header.SetDestination (destination);
+  Socket::SocketErrno error;
+  Ptr<Ipv4Route> route = node->GetObject<Ipv4> ()->GetRoutingProtocol ()
+    ->RouteOutput (Create<Packet> (), header, 0, error);
+  m_gateways.push_back (route == 0 ? Ipv4Address () : route->GetGateway ());
+}
+
+void
+FnssLinkEventTestCase::DoRun (void)
+{
+  // A ring a - b - c - d - a
+  fnss::Topology topology;
+  std::string ids[4] = { "a", "b", "c", "d" };
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      topology.addNode (ids[i], fnss::Node ());
+    }
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      topology.addEdge (ids[i], ids[(i + 1) % 4], fnss::Edge ());
+    }
+  FNSSSimulation sim (topology);
+  sim.assignIPv4Addresses ();
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  fnss::EventSchedule schedule;
+  std::string status[2] = { "down", "up" };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      fnss::Event event (fnss::Quantity (i + 1, "s", fnss::Units::Time));
+      event.setProperty ("event_type", "ns3::FNSSLinkEvent");
+      event.setProperty ("source", "b");
+      event.setProperty ("target", "a");
+      event.setProperty ("status", status[i]);
+      schedule.addEvent (event);
+    }
+  sim.scheduleEvents (schedule);
+
+  Ptr<Node> a = sim.getNode ("a");
+  Ptr<Node> b = sim.getNode ("b");
+  Ptr<Node> c = sim.getNode ("c");
+  Ptr<Node> d = sim.getNode ("d");
+  // The address of b away from a, reached through d once a - b is down
+  Ipv4Address destination = GetLinkAddress (b, c);
+  Ipv4Address direct = GetLinkAddress (b, a);
+  Ipv4Address around = GetLinkAddress (d, a);
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::Schedule (Seconds (0.5 + i), &FnssLinkEventTestCase::CheckGateway, this, a, destination);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_gateways.size (), 3, "Every check should have run");
+  NS_TEST_EXPECT_MSG_EQ (m_gateways[0], direct, "b should be reached over a - b");
+  NS_TEST_EXPECT_MSG_EQ (m_gateways[1], around, "b should be reached through d once a - b is down");
+  NS_TEST_EXPECT_MSG_EQ (m_gateways[2], direct, "b should be reached over a - b once it is up again");
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -60,6 +179,7 @@ FnssTestSuite::FnssTestSuite ()
   : TestSuite ("fnss", UNIT)
 {
   AddTestCase (new FnssTestCase1);
+  AddTestCase (new FnssLinkEventTestCase);
 }
 
 // Do not forget to allocate an instance of this TestSuite
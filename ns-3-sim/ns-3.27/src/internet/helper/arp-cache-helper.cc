@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <set>
+#include <vector>
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/channel-list.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/arp-cache.h"
+#include "arp-cache-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ArpCacheHelper");
+
+ArpCacheHelper::ArpCacheHelper ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ArpCacheHelper::PopulateArpCache (void) const
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < ChannelList::GetNChannels (); ++i)
+    {
+      PopulateArpCache (ChannelList::GetChannel (i));
+    }
+}
+
+void
+ArpCacheHelper::PopulateArpCache (const NetDeviceContainer &devices) const
+{
+  NS_LOG_FUNCTION (this);
+  std::set<Ptr<Channel> > channels;
+  for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); ++i)
+    {
+      Ptr<Channel> channel = (*i)->GetChannel ();
+      if (channel != 0 && channels.insert (channel).second)
+        {
+          PopulateArpCache (channel);
+        }
+    }
+}
+
+void
+ArpCacheHelper::PopulateArpCache (Ptr<Channel> channel) const
+{
+  NS_LOG_FUNCTION (this << channel);
+  // The IPv4 interfaces on the channel
+  std::vector<Ptr<Ipv4Interface> > interfaces;
+  for (uint32_t i = 0; i < channel->GetNDevices (); ++i)
+    {
+      Ptr<NetDevice> device = channel->GetDevice (i);
+      Ptr<Ipv4L3Protocol> ipv4 = device->GetNode ()->GetObject<Ipv4L3Protocol> ();
+      if (ipv4 == 0)
+        {
+          continue;
+        }
+      int32_t interface = ipv4->GetInterfaceForDevice (device);
+      if (interface != -1)
+        {
+          interfaces.push_back (ipv4->GetInterface (interface));
+        }
+    }
+
+  for (std::vector<Ptr<Ipv4Interface> >::const_iterator i = interfaces.begin ();
+       i != interfaces.end (); ++i)
+    {
+      Ptr<ArpCache> cache = (*i)->GetArpCache ();
+      if (cache == 0)
+        {
+          continue;
+        }
+      for (std::vector<Ptr<Ipv4Interface> >::const_iterator j = interfaces.begin ();
+           j != interfaces.end (); ++j)
+        {
+          if (i == j)
+            {
+              continue;
+            }
+          Address mac = (*j)->GetDevice ()->GetAddress ();
+          for (uint32_t k = 0; k < (*j)->GetNAddresses (); ++k)
+            {
+              Ipv4Address address = (*j)->GetAddress (k).GetLocal ();
+              ArpCache::Entry *entry = cache->Lookup (address);
+              if (entry == 0)
+                {
+                  entry = cache->Add (address);
+                }
+              else if (entry->IsWaitReply ())
+                {
+                  continue;
+                }
+              NS_LOG_LOGIC ("Add " << address << " at " << mac << " to the cache of "
+                                   << (*i)->GetDevice ());
+              entry->SetMacAddress (mac);
+              entry->MarkPermanent ();
+            }
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,70 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARP_CACHE_HELPER_H
+#define ARP_CACHE_HELPER_H
+
+#include "ns3/ptr.h"
+#include "ns3/channel.h"
+#include "ns3/net-device-container.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Helpers
+ *
+ * \brief Fill the ARP caches from the address assignment
+ *
+ * In a simulation the addresses of all the interfaces are known once they
+ * are assigned, so the ARP request and reply exchanged before the first
+ * packet to each neighbour only cost events, pending queues and timers.
+ * This helper walks the channels once, and adds to the ARP cache of each
+ * IPv4 interface a permanent entry for every address of the other IPv4
+ * interfaces on the same channel.  Permanent entries never expire, so no
+ * ARP request is ever sent to those neighbours.
+ *
+ * Call it after the addresses are assigned; the interfaces created or the
+ * addresses added later are not known to the caches.  Devices that do not
+ * need ARP, such as point-to-point ones, have no cache and are skipped.
+ * An entry already waiting for a reply is left alone.
+ */
+class ArpCacheHelper
+{
+public:
+  ArpCacheHelper ();
+
+  /**
+   * \brief Fill the ARP caches of the interfaces on all the channels
+   */
+  void PopulateArpCache (void) const;
+
+  /**
+   * \brief Fill the ARP caches of the interfaces on the channels of some
+   * devices
+   * \param devices the devices, whose channel neighbours are all filled in
+   */
+  void PopulateArpCache (const NetDeviceContainer &devices) const;
+
+  /**
+   * \brief Fill the ARP caches of the interfaces on a channel
+   * \param channel the channel
+   */
+  void PopulateArpCache (Ptr<Channel> channel) const;
+};
+
+} // namespace ns3
+
+#endif /* ARP_CACHE_HELPER_H */
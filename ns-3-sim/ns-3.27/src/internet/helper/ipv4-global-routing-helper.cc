@@ -70,6 +70,10 @@ Ipv4GlobalRoutingHelper::RecomputeRoutingTables (void)
   GlobalRouteManager::BuildGlobalRoutingDatabase ();
   GlobalRouteManager::InitializeRoutes ();
 }
-
+void
+Ipv4GlobalRoutingHelper::UpdateRoutingTables (void)
+{
+  GlobalRouteManager::UpdateRoutes ();
+}
 
 } // namespace ns3
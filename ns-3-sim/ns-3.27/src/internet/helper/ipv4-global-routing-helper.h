@@ -84,6 +84,21 @@ public:
    *
    */
   static void RecomputeRoutingTables (void);
+  /**
+   * \brief Update the routes after links went up or down, or changed
+   * their metric, since the last update.
+   *
+   * The routing tables end up with the same routes to each destination as
+   * after RecomputeRoutingTables().  The Link State Advertisements are
+   * diffed against those of the last update, and the shortest path tree
+   * of each router is repaired below the changed links instead of being
+   * computed again.  The routers only replace their routes to the
+   * addresses and networks of the routers whose links changed, or which
+   * moved in their tree.  The first call computes every route.
+   *
+   * \see GlobalRouteManager::UpdateRoutes
+   */
+  static void UpdateRoutingTables (void);
 private:
   /**
    * \brief Assignment operator declared private and not implemented to disallow
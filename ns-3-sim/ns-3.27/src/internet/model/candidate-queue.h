@@ -22,7 +22,7 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -47,6 +47,13 @@ class SPFVertex;
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The queue is a binary heap, which records in each vertex its position
+ * in the heap so that Update () moves a vertex whose distance changed in
+ * logarithmic time.  Vertices at the same distance and of the same type
+ * are popped in the order they were pushed or last updated, as when the
+ * queue was a sorted list, so that the routes computed do not depend on
+ * the queue implementation.
  */
 class CandidateQueue
 {
@@ -154,6 +161,17 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Move a vertex of the queue to its place after its distance changed.
+ *
+ * The vertex is ordered after the vertices already at its new distance,
+ * as if it had just been pushed.
+ *
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose distance changed.
+ */
+  void Update (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -184,8 +202,40 @@ private:
  */
   static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+/**
+ * \brief return true if v1 is popped before v2
+ *
+ * The vertices equal by CompareSPFVertex are ordered by the time they
+ * were pushed or updated.
+ *
+ * \param v1 first operand
+ * \param v2 second operand
+ * \return True if v1 should be popped before v2; false otherwise
+ */
+  static bool CompareCandidates (const SPFVertex* v1, const SPFVertex* v2);
+
+/**
+ * \brief Move a vertex up the heap to its place.
+ * \param position the position of the vertex
+ */
+  void SiftUp (uint32_t position);
+
+/**
+ * \brief Move a vertex down the heap to its place.
+ * \param position the position of the vertex
+ */
+  void SiftDown (uint32_t position);
+
+/**
+ * \brief Put a vertex at a position of the heap.
+ * \param v the vertex
+ * \param position the position
+ */
+  void Place (SPFVertex* v, uint32_t position);
+
+  typedef std::vector<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
+  CandidateList_t m_candidates;  //!< SPFVertex candidates, as a binary heap
+  uint64_t m_order;              //!< order of the next vertex pushed or updated
 
   /**
    * \brief Stream insertion operator.
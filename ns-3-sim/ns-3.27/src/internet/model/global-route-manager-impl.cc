@@ -22,6 +22,7 @@
  * of the quagga 0.99.7/src/ospfd/ospf_spf.c code which was ported here
  */
 
+#include <set>
 #include <utility>
 #include <vector>
 #include <queue>
@@ -35,6 +36,12 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/mpi-interface.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
 #include "global-router-interface.h"
 #include "global-route-manager-impl.h"
 #include "candidate-queue.h"
@@ -94,7 +101,10 @@ SPFVertex::SPFVertex () :
   m_nextHop ("0.0.0.0"),
   m_parents (),
   m_children (),
-  m_vertexProcessed (false)
+  m_vertexProcessed (false),
+  m_vertexIndex (0),
+  m_candidatePosition (0),
+  m_candidateOrder (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -107,7 +117,10 @@ SPFVertex::SPFVertex (GlobalRoutingLSA* lsa) :
   m_nextHop ("0.0.0.0"),
   m_parents (),
   m_children (),
-  m_vertexProcessed (false)
+  m_vertexProcessed (false),
+  m_vertexIndex (0),
+  m_candidatePosition (0),
+  m_candidateOrder (0)
 {
   NS_LOG_FUNCTION (this << lsa);
 
@@ -414,6 +427,20 @@ SPFVertex::ClearVertexProcessed (void)
   this->SetVertexProcessed (false);
 }
 
+void
+SPFVertex::SetVertexIndex (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  m_vertexIndex = index;
+}
+
+uint32_t
+SPFVertex::GetVertexIndex (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_vertexIndex;
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerLSDB Implementation
@@ -423,7 +450,8 @@ SPFVertex::ClearVertexProcessed (void)
 GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
   :
     m_database (),
-    m_extdatabase ()
+    m_extdatabase (),
+    m_adjacencyValid (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -471,6 +499,7 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
   else
     {
       m_database.insert (LSDBPair_t (addr, lsa));
+      m_adjacencyValid = false;
     }
 }
 
@@ -495,13 +524,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -531,15 +557,270 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
   return 0;
 }
 
+void
+GlobalRouteManagerLSDB::BuildAdjacency (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_adjacencyValid)
+    {
+      return;
+    }
+  m_vertices.clear ();
+  m_vertexIndex.clear ();
+  m_adjacencyBegin.clear ();
+  m_adjacentVertices.clear ();
+  m_adjacentLinks.clear ();
+  m_adjacencySources.clear ();
+  m_incomingBegin.clear ();
+  m_incomingAdjacencies.clear ();
+//
+// Number the LSAs, and find the router LSA which GetLSAByLinkData () returns
+// for the link data of each transit network link record.
+//
+  std::map<Ipv4Address, uint32_t> transitIndex;
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      uint32_t index = m_vertices.size ();
+      m_vertexIndex[i->first] = index;
+      m_vertices.push_back (i->second);
+      for (uint32_t j = 0; j < i->second->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = i->second->GetLinkRecord (j);
+          if (lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              transitIndex.insert (std::make_pair (lr->GetLinkData (), index));
+            }
+        }
+    }
+
+  for (uint32_t index = 0; index < m_vertices.size (); index++)
+    {
+      m_adjacencyBegin.push_back (m_adjacentVertices.size ());
+      GlobalRoutingLSA *lsa = m_vertices[index];
+      if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (j);
+//
+// Links to stub networks are only considered in the second stage of the
+// shortest path calculation.  The other links lead to a transit vertex,
+// whose link state ID is the link ID of the record.
+//
+              if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+                {
+                  continue;
+                }
+              NS_ASSERT_MSG (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+                             || l->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork,
+                             "illegal Link Type");
+              std::map<Ipv4Address, uint32_t>::const_iterator w = m_vertexIndex.find (l->GetLinkId ());
+              NS_ASSERT (w != m_vertexIndex.end ());
+              m_adjacentVertices.push_back (w->second);
+              m_adjacentLinks.push_back (l);
+              m_adjacencySources.push_back (index);
+            }
+        }
+      else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNAttachedRouters (); j++)
+            {
+              std::map<Ipv4Address, uint32_t>::const_iterator w = transitIndex.find (lsa->GetAttachedRouter (j));
+              if (w == transitIndex.end ())
+                {
+                  continue;
+                }
+              m_adjacentVertices.push_back (w->second);
+              m_adjacentLinks.push_back (0);
+              m_adjacencySources.push_back (index);
+            }
+        }
+    }
+  m_adjacencyBegin.push_back (m_adjacentVertices.size ());
+//
+// Group the adjacencies by the vertex they lead to, keeping their order.
+//
+  m_incomingBegin.assign (m_vertices.size () + 1, 0);
+  for (uint32_t adjacency = 0; adjacency < m_adjacentVertices.size (); adjacency++)
+    {
+      m_incomingBegin[m_adjacentVertices[adjacency] + 1]++;
+    }
+  for (uint32_t index = 0; index < m_vertices.size (); index++)
+    {
+      m_incomingBegin[index + 1] += m_incomingBegin[index];
+    }
+  m_incomingAdjacencies.resize (m_adjacentVertices.size ());
+  std::vector<uint32_t> position (m_incomingBegin.begin (), m_incomingBegin.end () - 1);
+  for (uint32_t adjacency = 0; adjacency < m_adjacentVertices.size (); adjacency++)
+    {
+      m_incomingAdjacencies[position[m_adjacentVertices[adjacency]]++] = adjacency;
+    }
+  m_adjacencyValid = true;
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetNVertices (void) const
+{
+  NS_ASSERT (m_adjacencyValid);
+  return m_vertices.size ();
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetVertexIndex (Ipv4Address addr) const
+{
+  NS_ASSERT (m_adjacencyValid);
+  std::map<Ipv4Address, uint32_t>::const_iterator i = m_vertexIndex.find (addr);
+  if (i == m_vertexIndex.end ())
+    {
+      return m_vertices.size ();
+    }
+  return i->second;
+}
+
+GlobalRoutingLSA*
+GlobalRouteManagerLSDB::GetVertexLSA (uint32_t index) const
+{
+  return m_vertices[index];
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetAdjacencyBegin (uint32_t index) const
+{
+  return m_adjacencyBegin[index];
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetAdjacencyEnd (uint32_t index) const
+{
+  return m_adjacencyBegin[index + 1];
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetAdjacentVertex (uint32_t adjacency) const
+{
+  return m_adjacentVertices[adjacency];
+}
+
+GlobalRoutingLinkRecord*
+GlobalRouteManagerLSDB::GetAdjacentLink (uint32_t adjacency) const
+{
+  return m_adjacentLinks[adjacency];
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetAdjacencySource (uint32_t adjacency) const
+{
+  return m_adjacencySources[adjacency];
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetIncomingBegin (uint32_t index) const
+{
+  return m_incomingBegin[index];
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetIncomingEnd (uint32_t index) const
+{
+  return m_incomingBegin[index + 1];
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetIncomingAdjacency (uint32_t position) const
+{
+  return m_incomingAdjacencies[position];
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerImpl Implementation
 //
 // ---------------------------------------------------------------------------
 
+/// The number of threads computing the routes of the global routers
+static GlobalValue g_globalRoutingThreads ("GlobalRoutingThreads",
+                                           "The number of threads computing the global routes, "
+                                           "each for a share of the routers",
+                                           UintegerValue (1),
+                                           MakeUintegerChecker<uint32_t> (1));
+
+/**
+ * \param a an LSA
+ * \param b another LSA
+ * \returns true if both LSAs advertise the same links
+ */
+static bool
+SameLSA (GlobalRoutingLSA *a, GlobalRoutingLSA *b)
+{
+  if (a->GetLSType () != b->GetLSType ()
+      || a->GetLinkStateId () != b->GetLinkStateId ()
+      || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+      || a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ()
+      || a->GetNLinkRecords () != b->GetNLinkRecords ()
+      || a->GetNAttachedRouters () != b->GetNAttachedRouters ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < a->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *la = a->GetLinkRecord (i);
+      GlobalRoutingLinkRecord *lb = b->GetLinkRecord (i);
+      if (la->GetLinkType () != lb->GetLinkType ()
+          || la->GetLinkId () != lb->GetLinkId ()
+          || la->GetLinkData () != lb->GetLinkData ()
+          || la->GetMetric () != lb->GetMetric ())
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < a->GetNAttachedRouters (); i++)
+    {
+      if (a->GetAttachedRouter (i) != b->GetAttachedRouter (i))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+/**
+ * \param lsa a router LSA
+ * \param router a router ID
+ * \returns the local addresses of the point-to-point links of the LSA to
+ * the router, in order
+ */
+static std::vector<uint32_t>
+GetLinksTo (GlobalRoutingLSA *lsa, Ipv4Address router)
+{
+  std::vector<uint32_t> links;
+  for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (i);
+      if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+          && l->GetLinkId () == router)
+        {
+          links.push_back (l->GetLinkData ().Get ());
+        }
+    }
+  return links;
+}
+
+/**
+ * \param l the link of an adjacency
+ * \returns true if the repair of a shortest path tree can follow the link:
+ * a point-to-point link of some cost
+ */
+static bool
+IsRepairableLink (GlobalRoutingLinkRecord *l)
+{
+  return l != 0 && l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint && l->GetMetric () > 0;
+}
+
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_spfResult (0),
+    m_updateValid (false)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -598,6 +879,8 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
       delete m_lsdb;
       m_lsdb = new GlobalRouteManagerLSDB ();
     }
+  m_updateResults.clear ();
+  m_updateValid = false;
 }
 
 //
@@ -613,6 +896,7 @@ void
 GlobalRouteManagerImpl::BuildGlobalRoutingDatabase () 
 {
   NS_LOG_FUNCTION (this);
+  m_updateValid = false;
 //
 // Walk the list of nodes looking for the GlobalRouter Interface.  Nodes with
 // global router interfaces are, not too surprisingly, our routers.
@@ -694,12 +978,24 @@ GlobalRouteManagerImpl::BuildGlobalRoutingDatabase ()
 //
 void
 GlobalRouteManagerImpl::InitializeRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  m_updateValid = false;
+  NS_LOG_INFO ("About to start SPF calculation");
+  std::vector<SPFRoot> roots;
+  GetSPFRoots (roots);
+  m_lsdb->BuildAdjacency ();
+  CalculateRoots (roots);
+  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+void
+GlobalRouteManagerImpl::GetSPFRoots (std::vector<SPFRoot> &roots) const
 {
   NS_LOG_FUNCTION (this);
 //
 // Walk the list of nodes in the system.
 //
-  NS_LOG_INFO ("About to start SPF calculation");
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -720,113 +1016,1017 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 
 //
 // if the node has a global router interface, then run the global routing
-// algorithms.
+// algorithms.  The node and its interfaces are looked up here once, and not
+// by every step of the SPF calculation.
 //
       if (rtr && rtr->GetNumLSAs () )
         {
-          SPFCalculate (rtr->GetRouterId ());
+          SPFRoot root;
+          root.routerId = rtr->GetRouterId ();
+          root.ipv4 = node->GetObject<Ipv4> ();
+          NS_ASSERT_MSG (root.ipv4, 
+                         "GlobalRouteManagerImpl::InitializeRoutes (): "
+                         "GetObject for <Ipv4> interface failed");
+          root.routing = rtr->GetRoutingProtocol ();
+          NS_ASSERT (root.routing);
+          root.result = 0;
+          roots.push_back (root);
         }
     }
-  NS_LOG_INFO ("Finished SPF calculation");
 }
 
+void
+GlobalRouteManagerImpl::CalculateRoots (std::vector<SPFRoot> const &roots)
+{
+  NS_LOG_FUNCTION (this << roots.size ());
+  UintegerValue threadsValue;
+  g_globalRoutingThreads.GetValue (threadsValue);
+  uint32_t nThreads = std::min<uint32_t> (threadsValue.Get (), roots.size ());
+#ifdef HAVE_PTHREAD_H
+  if (nThreads > 1)
+    {
 //
-// This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
-// 16.1 (2) for further details.
+// Each worker computes the routes of every nThreads-th router, sharing the
+// LSDB, which is only read from now on.
 //
-// We're passed a parameter <v> that is a vertex which is already in the SPF
-// tree.  A vertex represents a router node.  We also get a reference to the
-// SPF candidate queue, which is a priority queue containing the shortest paths
-// to the networks we know about.
+      std::vector<GlobalRouteManagerImpl *> workers;
+      std::vector<Ptr<SystemThread> > threads;
+      for (uint32_t t = 0; t < nThreads; t++)
+        {
+          GlobalRouteManagerImpl *worker = new GlobalRouteManagerImpl ();
+          delete worker->m_lsdb;
+          worker->m_lsdb = m_lsdb;
+          for (uint32_t i = t; i < roots.size (); i += nThreads)
+            {
+              worker->m_spfRoots.push_back (roots[i]);
+            }
+          workers.push_back (worker);
+          threads.push_back (Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::SPFCalculateRoots, worker)));
+          threads.back ()->Start ();
+        }
+      for (uint32_t t = 0; t < nThreads; t++)
+        {
+          threads[t]->Join ();
+          workers[t]->m_lsdb = 0;
+          delete workers[t];
+        }
+      return;
+    }
+#endif /* HAVE_PTHREAD_H */
+  m_spfRoots = roots;
+  SPFCalculateRoots ();
+  m_spfRoots.clear ();
+}
+
 //
-// We examine the links in v's LSA and update the list of candidates with any
-// vertices not already on the list.  If a lower-cost path is found to a
-// vertex already on the candidate list, store the new (lower) cost.
+// The routes of a router only depend on its shortest path tree, and on the
+// LSAs of the vertices of the tree: each vertex contributes routes to its
+// own addresses and stub networks, through the root exits of the vertex.
+// A changed LSA changes the routes to the destinations it advertised before
+// or now and, if it changes the tree, the routes to the destinations of the
+// vertices that joined or left the tree, or got other root exits.  The tree
+// of each router is repaired below the changed links, and those routes are
+// replaced in the order the SPF computation adds them in.  Each destination
+// then has the same routes, in the same order, as after a full computation,
+// which is what the lookups depend on.
 //
-void
-GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
+uint32_t
+GlobalRouteManagerImpl::UpdateRoutes ()
 {
-  NS_LOG_FUNCTION (this << v << &candidate);
+  NS_LOG_FUNCTION (this);
+  bool valid = m_updateValid;
+  GlobalRouteManagerLSDB *previous = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  m_lsdb->BuildAdjacency ();
+  std::vector<SPFRoot> roots;
+  GetSPFRoots (roots);
 
-  SPFVertex* w = 0;
-  GlobalRoutingLSA* w_lsa = 0;
-  GlobalRoutingLinkRecord *l = 0;
-  uint32_t distance = 0;
-  uint32_t numRecordsInVertex = 0;
-//
-// V points to a Router-LSA or Network-LSA
-// Loop over the links in router LSA or attached routers in Network LSA
-//
-  if (v->GetVertexType () == SPFVertex::VertexRouter)
+  bool partial = valid && roots.size () == m_updateResults.size ();
+  for (uint32_t i = 0; partial && i < roots.size (); i++)
+    {
+      partial = roots[i].routerId == m_updateResults[i].routerId;
+    }
+  std::vector<uint32_t> changed;
+  Destinations destinations;
+  if (partial)
     {
-      numRecordsInVertex = v->GetLSA ()->GetNLinkRecords (); 
+      partial = FindChangedVertices (previous, changed, destinations);
     }
-  if (v->GetVertexType () == SPFVertex::VertexNetwork)
+  if (!partial)
     {
-      numRecordsInVertex = v->GetLSA ()->GetNAttachedRouters (); 
+      NS_LOG_INFO ("Computing every route again");
+      delete previous;
+      // Delete the routes, and keep the new LSDB
+      GlobalRouteManagerLSDB *lsdb = m_lsdb;
+      m_lsdb = 0;
+      DeleteGlobalRoutes ();
+      m_lsdb = lsdb;
+      m_updateResults.assign (roots.size (), SPFResult ());
+      for (uint32_t i = 0; i < roots.size (); i++)
+        {
+          m_updateResults[i].routerId = roots[i].routerId;
+          roots[i].result = &m_updateResults[i];
+        }
+      CalculateRoots (roots);
+      m_updateValid = true;
+      return roots.size ();
     }
 
-  for (uint32_t i = 0; i < numRecordsInVertex; i++)
+  NS_LOG_INFO (changed.size () << " LSAs changed");
+  std::vector<SPFRoot> recompute;
+  uint32_t repaired = 0;
+  std::vector<uint32_t> moved;
+  for (uint32_t i = 0; i < roots.size (); i++)
     {
-// Get w_lsa:  In case of V is Router-LSA
-      if (v->GetVertexType () == SPFVertex::VertexRouter) 
+      roots[i].result = &m_updateResults[i];
+      SPFResult &result = m_updateResults[i];
+      if (SPFRootChanged (result, previous, changed))
         {
-          NS_LOG_LOGIC ("Examining link " << i << " of " << 
-                        v->GetVertexId () << "'s " <<
-                        v->GetLSA ()->GetNLinkRecords () << " link records");
+          recompute.push_back (roots[i]);
+          continue;
+        }
+      if (result.stub)
+        {
+          continue;
+        }
+      moved.clear ();
+      if (!SPFRepair (roots[i], result, previous, changed, moved))
+        {
+          recompute.push_back (roots[i]);
+          continue;
+        }
+      if (!moved.empty ())
+        {
+          // The external routes follow the tree, and are not replaced
+          if (m_lsdb->GetNumExtLSAs () > 0)
+            {
+              recompute.push_back (roots[i]);
+              continue;
+            }
+          repaired++;
+        }
+      SPFUpdateDestinations (roots[i], result, moved, destinations);
+    }
+  delete previous;
+
+  NS_LOG_INFO ("Repaired the trees of " << repaired << " routers, computing every route of " <<
+               recompute.size () << " of " << roots.size () << " routers again");
+  for (uint32_t i = 0; i < recompute.size (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = recompute[i].routing;
+      uint32_t nRoutes = routing->GetNRoutes ();
+      for (uint32_t j = 0; j < nRoutes; j++)
+        {
+          routing->RemoveRoute (0);
+        }
+    }
+  CalculateRoots (recompute);
+  m_updateValid = true;
+  return recompute.size () + repaired;
+}
+
+bool
+GlobalRouteManagerImpl::FindChangedVertices (GlobalRouteManagerLSDB *previous, std::vector<uint32_t> &changed,
+                                             Destinations &destinations) const
+{
+  NS_LOG_FUNCTION (this << previous);
+  uint32_t nVertices = m_lsdb->GetNVertices ();
+  if (previous->GetNVertices () != nVertices
+      || previous->GetNumExtLSAs () != m_lsdb->GetNumExtLSAs ())
+    {
+      NS_LOG_LOGIC ("The routers, networks or external routes changed");
+      return false;
+    }
+  for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
+    {
+      if (!SameLSA (previous->GetExtLSA (i), m_lsdb->GetExtLSA (i)))
+        {
+          NS_LOG_LOGIC ("External LSA " << m_lsdb->GetExtLSA (i)->GetLinkStateId () << " changed");
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < nVertices; i++)
+    {
+      GlobalRoutingLSA *before = previous->GetVertexLSA (i);
+      GlobalRoutingLSA *after = m_lsdb->GetVertexLSA (i);
+      if (before->GetLinkStateId () != after->GetLinkStateId ())
+        {
+          NS_LOG_LOGIC ("The routers or networks changed");
+          return false;
+        }
+      if (SameLSA (before, after))
+        {
+          continue;
+        }
+      NS_LOG_LOGIC ("LSA " << after->GetLinkStateId () << " changed");
 //
-// (a) If this is a link to a stub network, examine the next link in V's LSA.
-// Links to stub networks will be considered in the second stage of the
-// shortest path calculation.
+// Only the point-to-point links and stub networks of routers are followed
+// by the diff; the routes through transit networks are all computed
+// again.
 //
-          l = v->GetLSA ()->GetLinkRecord (i);
-          NS_ASSERT (l != 0);
-          if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+      GlobalRoutingLSA *lsas[2] = { before, after };
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          if (lsas[k]->GetLSType () != GlobalRoutingLSA::RouterLSA)
+            {
+              return false;
+            }
+          for (uint32_t j = 0; j < lsas[k]->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord::LinkType type = lsas[k]->GetLinkRecord (j)->GetLinkType ();
+              if (type != GlobalRoutingLinkRecord::PointToPoint
+                  && type != GlobalRoutingLinkRecord::StubNetwork)
+                {
+                  return false;
+                }
+            }
+        }
+      changed.push_back (i);
+    }
+//
+// Find the vertices advertising each destination now, and the destinations
+// the changed LSAs advertised before or advertise now.
+//
+  std::set<Destination> transits;
+  for (uint32_t i = 0; i < nVertices; i++)
+    {
+      GlobalRoutingLSA *lsa = m_lsdb->GetVertexLSA (i);
+      if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          Ipv4Mask mask = lsa->GetNetworkLSANetworkMask ();
+          transits.insert (Destination (lsa->GetLinkStateId ().CombineMask (mask).Get (), mask.Get ()));
+          continue;
+        }
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (j);
+          Advertisers *d;
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+            {
+              d = &destinations.hosts[Destination (l->GetLinkData ().Get (), 0xffffffff)];
+            }
+          else if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              Ipv4Mask mask (l->GetLinkData ().Get ());
+              d = &destinations.networks[Destination (l->GetLinkId ().CombineMask (mask).Get (), mask.Get ())];
+            }
+          else
             {
-              NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
               continue;
             }
+          if (d->vertices.empty ())
+            {
+              d->changed = false;
+            }
+          if (d->vertices.empty () || d->vertices.back () != i)
+            {
+              d->vertices.push_back (i);
+            }
+        }
+    }
+  for (uint32_t i = 0; i < changed.size (); i++)
+    {
+      GlobalRoutingLSA *lsas[2] = { previous->GetVertexLSA (changed[i]), m_lsdb->GetVertexLSA (changed[i]) };
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          for (uint32_t j = 0; j < lsas[k]->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *l = lsas[k]->GetLinkRecord (j);
+              if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+                {
+                  destinations.hosts[Destination (l->GetLinkData ().Get (), 0xffffffff)].changed = true;
+                }
+              else
+                {
+                  Ipv4Mask mask (l->GetLinkData ().Get ());
+                  destinations.networks[Destination (l->GetLinkId ().CombineMask (mask).Get (), mask.Get ())].changed = true;
+                }
+            }
+        }
+    }
+  for (std::set<Destination>::const_iterator i = transits.begin (); i != transits.end (); i++)
+    {
+      if (destinations.networks.find (*i) != destinations.networks.end ())
+        {
+          NS_LOG_LOGIC ("Network " << Ipv4Address (i->first) << " is also a transit network");
+          return false;
+        }
+    }
+  for (AdvertiserMap::const_iterator i = destinations.hosts.begin (); i != destinations.hosts.end (); i++)
+    {
+      if (i->second.changed)
+        {
+          destinations.changedHosts.push_back (i->first);
+        }
+    }
+  for (AdvertiserMap::const_iterator i = destinations.networks.begin (); i != destinations.networks.end (); i++)
+    {
+      if (i->second.changed)
+        {
+          destinations.changedNetworks.push_back (i->first);
+        }
+    }
+  return true;
+}
+
+bool
+GlobalRouteManagerImpl::SPFRootChanged (SPFResult const &result, GlobalRouteManagerLSDB *previous,
+                                        std::vector<uint32_t> const &changed) const
+{
+  uint32_t rootIndex = m_lsdb->GetVertexIndex (result.routerId);
+  for (uint32_t i = 0; i < changed.size (); i++)
+    {
+      uint32_t u = changed[i];
+      if (u == rootIndex)
+        {
+          return true;
+        }
+//
+// The next hops to the neighbors of the root are the addresses of their
+// links back to it, and a stub root only has a default route to its
+// neighbor.
+//
+      if (GetLinksTo (previous->GetVertexLSA (u), result.routerId)
+          != GetLinksTo (m_lsdb->GetVertexLSA (u), result.routerId))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+GlobalRouteManagerImpl::SPFRepairMark (uint32_t v, uint8_t flag)
+{
+  if (m_repairFlags[v] == 0)
+    {
+      m_repairTouched.push_back (v);
+    }
+  m_repairFlags[v] |= flag;
+}
+
+uint32_t
+GlobalRouteManagerImpl::SPFRepairDistance (SPFResult const &result, uint32_t v) const
+{
+  if (m_repairFlags[v] & REPAIR_DISTANCE)
+    {
+      return m_repairDistance[v];
+    }
+  return result.distance[v];
+}
+
+bool
+GlobalRouteManagerImpl::SPFRepair (SPFRoot const &root, SPFResult &result, GlobalRouteManagerLSDB *previous,
+                                   std::vector<uint32_t> const &changed, std::vector<uint32_t> &moved)
+{
+  NS_LOG_FUNCTION (this << root.routerId);
+  uint32_t nVertices = m_lsdb->GetNVertices ();
+  uint32_t rootIndex = m_lsdb->GetVertexIndex (root.routerId);
+  if (m_repairFlags.size () != nVertices)
+    {
+      m_repairFlags.assign (nVertices, 0);
+      m_repairDistance.assign (nVertices, SPF_INFINITY);
+    }
+  m_spfIpv4 = root.ipv4;
+  bool repaired = SPFRepairTree (rootIndex, result, previous, changed, moved);
+  m_spfIpv4 = 0;
+  for (uint32_t i = 0; i < m_repairTouched.size (); i++)
+    {
+      m_repairFlags[m_repairTouched[i]] = 0;
+      m_repairDistance[m_repairTouched[i]] = SPF_INFINITY;
+    }
+  m_repairTouched.clear ();
+  return repaired;
+}
+
+bool
+GlobalRouteManagerImpl::SPFRepairTree (uint32_t rootIndex, SPFResult &result, GlobalRouteManagerLSDB *previous,
+                                       std::vector<uint32_t> const &changed, std::vector<uint32_t> &moved)
+{
+  typedef std::pair<uint64_t, uint32_t> Entry;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+//
+// A vertex lost its shortest paths if none of the vertices which kept
+// theirs leads to it at the same distance.  The vertices are checked
+// nearest first, from the ends of the shortest links of the changed LSAs
+// down the tree, so that their parents were checked before them.
+//
+  for (uint32_t i = 0; i < changed.size (); i++)
+    {
+      uint32_t u = changed[i];
+      if (result.distance[u] == SPF_INFINITY)
+        {
+          continue;
+        }
+      for (uint32_t a = previous->GetAdjacencyBegin (u); a < previous->GetAdjacencyEnd (u); a++)
+        {
+          uint32_t w = previous->GetAdjacentVertex (a);
+          GlobalRoutingLinkRecord *l = previous->GetAdjacentLink (a);
+          if (l == 0)
+            {
+              return false;
+            }
+          if (uint64_t (result.distance[u]) + l->GetMetric () == result.distance[w])
+            {
+              queue.push (Entry (result.distance[w], w));
+            }
+        }
+    }
+  std::vector<uint32_t> lost;
+  while (!queue.empty ())
+    {
+      uint32_t x = queue.top ().second;
+      queue.pop ();
+      if (x == rootIndex || (m_repairFlags[x] & REPAIR_CHECKED))
+        {
+          continue;
+        }
+      SPFRepairMark (x, REPAIR_CHECKED);
+      bool kept = false;
+      for (uint32_t p = m_lsdb->GetIncomingBegin (x); !kept && p < m_lsdb->GetIncomingEnd (x); p++)
+        {
+          uint32_t a = m_lsdb->GetIncomingAdjacency (p);
+          uint32_t u = m_lsdb->GetAdjacencySource (a);
+          GlobalRoutingLinkRecord *l = m_lsdb->GetAdjacentLink (a);
+          if (!IsRepairableLink (l))
+            {
+              return false;
+            }
+          kept = result.distance[u] != SPF_INFINITY && !(m_repairFlags[u] & REPAIR_LOST)
+            && uint64_t (result.distance[u]) + l->GetMetric () == result.distance[x];
+        }
+      if (kept)
+        {
+          continue;
+        }
+      NS_LOG_LOGIC ("Vertex " << m_lsdb->GetVertexLSA (x)->GetLinkStateId () << " lost its shortest paths");
+      SPFRepairMark (x, REPAIR_LOST);
+      lost.push_back (x);
+      for (uint32_t a = m_lsdb->GetAdjacencyBegin (x); a < m_lsdb->GetAdjacencyEnd (x); a++)
+        {
+          uint32_t y = m_lsdb->GetAdjacentVertex (a);
+          GlobalRoutingLinkRecord *l = m_lsdb->GetAdjacentLink (a);
+          if (!IsRepairableLink (l))
+            {
+              return false;
+            }
+          if (uint64_t (result.distance[x]) + l->GetMetric () == result.distance[y])
+            {
+              queue.push (Entry (result.distance[y], y));
+            }
+        }
+    }
+//
+// The vertices which lost their shortest paths get a distance from their
+// neighbors which kept theirs, and the changed LSAs offer their neighbors
+// shorter paths.  The shorter paths are then followed as in SPFCalculate,
+// from these vertices only.
+//
+  for (uint32_t i = 0; i < lost.size (); i++)
+    {
+      uint32_t x = lost[i];
+      uint64_t distance = SPF_INFINITY;
+      for (uint32_t p = m_lsdb->GetIncomingBegin (x); p < m_lsdb->GetIncomingEnd (x); p++)
+        {
+          uint32_t a = m_lsdb->GetIncomingAdjacency (p);
+          uint32_t u = m_lsdb->GetAdjacencySource (a);
+          if (result.distance[u] != SPF_INFINITY && !(m_repairFlags[u] & REPAIR_LOST))
+            {
+              distance = std::min (distance, uint64_t (result.distance[u]) + m_lsdb->GetAdjacentLink (a)->GetMetric ());
+            }
+        }
+      m_repairDistance[x] = distance;
+      SPFRepairMark (x, REPAIR_DISTANCE);
+      if (distance != SPF_INFINITY)
+        {
+          queue.push (Entry (distance, x));
+        }
+    }
+  for (uint32_t i = 0; i < changed.size (); i++)
+    {
+      uint32_t u = changed[i];
+      if (result.distance[u] == SPF_INFINITY || (m_repairFlags[u] & REPAIR_LOST))
+        {
+          continue;
+        }
+      for (uint32_t a = m_lsdb->GetAdjacencyBegin (u); a < m_lsdb->GetAdjacencyEnd (u); a++)
+        {
+          uint32_t w = m_lsdb->GetAdjacentVertex (a);
+          GlobalRoutingLinkRecord *l = m_lsdb->GetAdjacentLink (a);
+          if (!IsRepairableLink (l))
+            {
+              return false;
+            }
+          uint64_t distance = uint64_t (result.distance[u]) + l->GetMetric ();
+          if (distance < SPFRepairDistance (result, w))
+            {
+              m_repairDistance[w] = distance;
+              SPFRepairMark (w, REPAIR_DISTANCE);
+              queue.push (Entry (distance, w));
+            }
+        }
+    }
+  while (!queue.empty ())
+    {
+      uint64_t distance = queue.top ().first;
+      uint32_t x = queue.top ().second;
+      queue.pop ();
+      if ((m_repairFlags[x] & REPAIR_DONE) || distance != SPFRepairDistance (result, x))
+        {
+          continue;
+        }
+      SPFRepairMark (x, REPAIR_DONE);
+      for (uint32_t a = m_lsdb->GetAdjacencyBegin (x); a < m_lsdb->GetAdjacencyEnd (x); a++)
+        {
+          uint32_t y = m_lsdb->GetAdjacentVertex (a);
+          GlobalRoutingLinkRecord *l = m_lsdb->GetAdjacentLink (a);
+          if (!IsRepairableLink (l))
+            {
+              return false;
+            }
+          if (distance + l->GetMetric () < SPFRepairDistance (result, y))
+            {
+              m_repairDistance[y] = distance + l->GetMetric ();
+              SPFRepairMark (y, REPAIR_DISTANCE);
+              queue.push (Entry (m_repairDistance[y], y));
+            }
+        }
+    }
+//
+// The parents of a vertex are those at its distance through one of their
+// links.  The vertices whose distance changed, those which lost their
+// shortest paths, their neighbors, and the vertices a changed LSA leads to
+// through a shortest link, before or now, may have other parents; the
+// vertices below them in the tree inherit their root exits and their
+// orders.
+//
+  std::vector<uint32_t> affected;
+  for (uint32_t i = 0; i < changed.size (); i++)
+    {
+      uint32_t u = changed[i];
+      for (uint32_t a = previous->GetAdjacencyBegin (u); a < previous->GetAdjacencyEnd (u); a++)
+        {
+          uint32_t w = previous->GetAdjacentVertex (a);
+          if (result.distance[u] != SPF_INFINITY
+              && uint64_t (result.distance[u]) + previous->GetAdjacentLink (a)->GetMetric () == result.distance[w])
+            {
+              SPFRepairAffect (rootIndex, w, affected);
+            }
+        }
+      uint64_t distance = SPFRepairDistance (result, u);
+      for (uint32_t a = m_lsdb->GetAdjacencyBegin (u); a < m_lsdb->GetAdjacencyEnd (u); a++)
+        {
+          uint32_t w = m_lsdb->GetAdjacentVertex (a);
+          if (distance != SPF_INFINITY
+              && distance + m_lsdb->GetAdjacentLink (a)->GetMetric () == SPFRepairDistance (result, w))
+            {
+              SPFRepairAffect (rootIndex, w, affected);
+            }
+        }
+    }
+  for (uint32_t i = 0; i < m_repairTouched.size (); i++)
+    {
+      uint32_t x = m_repairTouched[i];
+      if ((m_repairFlags[x] & REPAIR_LOST)
+          || ((m_repairFlags[x] & REPAIR_DISTANCE) && m_repairDistance[x] != result.distance[x]))
+        {
+          SPFRepairAffect (rootIndex, x, affected);
+          for (uint32_t a = m_lsdb->GetAdjacencyBegin (x); a < m_lsdb->GetAdjacencyEnd (x); a++)
+            {
+              SPFRepairAffect (rootIndex, m_lsdb->GetAdjacentVertex (a), affected);
+            }
+        }
+    }
+  for (uint32_t i = 0; i < affected.size (); i++)
+    {
+      uint32_t x = affected[i];
+      uint64_t distance = SPFRepairDistance (result, x);
+      if (distance == SPF_INFINITY)
+        {
+          continue;
+        }
+      for (uint32_t a = m_lsdb->GetAdjacencyBegin (x); a < m_lsdb->GetAdjacencyEnd (x); a++)
+        {
+          uint32_t y = m_lsdb->GetAdjacentVertex (a);
+          GlobalRoutingLinkRecord *l = m_lsdb->GetAdjacentLink (a);
+          if (!IsRepairableLink (l))
+            {
+              return false;
+            }
+          if (distance + l->GetMetric () == SPFRepairDistance (result, y))
+            {
+              SPFRepairAffect (rootIndex, y, affected);
+            }
+        }
+    }
+  NS_LOG_LOGIC (affected.size () << " vertices affected");
+//
+// Find the parents, root exits and orders of the affected vertices again,
+// nearest first, so that those of their parents are known.
+//
+  std::vector<std::pair<uint32_t, uint32_t> > order;
+  for (uint32_t i = 0; i < affected.size (); i++)
+    {
+      order.push_back (std::make_pair (SPFRepairDistance (result, affected[i]), affected[i]));
+    }
+  std::sort (order.begin (), order.end ());
+  Ipv4Address rootId = m_lsdb->GetVertexLSA (rootIndex)->GetLinkStateId ();
+  std::vector<uint32_t> parents;
+  std::vector<SPFVertex::NodeExit_t> exits;
+  std::vector<uint32_t> path;
+  std::vector<uint32_t> bestPath;
+  for (uint32_t i = 0; i < order.size (); i++)
+    {
+      uint32_t distance = order[i].first;
+      uint32_t x = order[i].second;
+      moved.push_back (x);
+      result.staleExits += result.exitEnd[x] - result.exitBegin[x];
+      result.distance[x] = distance;
+      result.joinParent[x] = SPF_INFINITY;
+      result.joinLink[x] = 0;
+      result.stubParent[x] = SPF_INFINITY;
+      result.exitBegin[x] = result.exits.size ();
+      result.exitEnd[x] = result.exits.size ();
+      if (distance == SPF_INFINITY)
+        {
+          continue;
+        }
+//
+// The join parent is the first parent to join the tree, through its first
+// link at the distance.  The root exits are those of all the parents; the
+// root itself leads to a neighbor through each of its links at the
+// distance, towards the address of the first link of the neighbor back to
+// it, as in SPFNexthopCalculation.
+//
+      parents.clear ();
+      exits.clear ();
+      for (uint32_t p = m_lsdb->GetIncomingBegin (x); p < m_lsdb->GetIncomingEnd (x); p++)
+        {
+          uint32_t a = m_lsdb->GetIncomingAdjacency (p);
+          uint32_t u = m_lsdb->GetAdjacencySource (a);
+          GlobalRoutingLinkRecord *l = m_lsdb->GetAdjacentLink (a);
+          if (!IsRepairableLink (l))
+            {
+              return false;
+            }
+          uint64_t parentDistance = SPFRepairDistance (result, u);
+          if (parentDistance == SPF_INFINITY || parentDistance + l->GetMetric () != distance)
+            {
+              continue;
+            }
+          if (parents.empty () || parents.back () != u)
+            {
+              parents.push_back (u);
+              if (result.joinParent[x] == SPF_INFINITY || SPFJoinedBefore (result, u, result.joinParent[x]))
+                {
+                  result.joinParent[x] = u;
+                  result.joinLink[x] = a - m_lsdb->GetAdjacencyBegin (u);
+                }
+            }
+          if (u == rootIndex)
+            {
+              GlobalRoutingLSA *lsa = m_lsdb->GetVertexLSA (x);
+              GlobalRoutingLinkRecord *linkRemote = 0;
+              for (uint32_t j = 0; linkRemote == 0 && j < lsa->GetNLinkRecords (); j++)
+                {
+                  if (lsa->GetLinkRecord (j)->GetLinkId () == rootId)
+                    {
+                      linkRemote = lsa->GetLinkRecord (j);
+                    }
+                }
+              if (linkRemote == 0)
+                {
+                  return false;
+                }
+              exits.push_back (SPFVertex::NodeExit_t (linkRemote->GetLinkData (),
+                                                      FindOutgoingInterfaceId (l->GetLinkData ())));
+            }
+          else
+            {
+              exits.insert (exits.end (), result.exits.begin () + result.exitBegin[u],
+                            result.exits.begin () + result.exitEnd[u]);
+            }
+        }
+      NS_ASSERT (!parents.empty ());
+      std::sort (exits.begin (), exits.end ());
+      exits.erase (std::unique (exits.begin (), exits.end ()), exits.end ());
+      result.exits.insert (result.exits.end (), exits.begin (), exits.end ());
+      result.exitEnd[x] = result.exits.size ();
+//
+// The walk of the stubs reaches the vertex from the parent it reaches
+// first.
+//
+      for (uint32_t j = 0; j < parents.size (); j++)
+        {
+          SPFGetStubPath (result, parents[j], path);
+          path.push_back (x);
+          if (j == 0 || SPFStubPathBefore (result, path, bestPath))
+            {
+              result.stubParent[x] = parents[j];
+              bestPath.swap (path);
+            }
+        }
+    }
+//
+// Drop the exits no vertex refers to any longer once they are most of them.
+//
+  if (2 * result.staleExits > result.exits.size ())
+    {
+      exits.clear ();
+      exits.reserve (result.exits.size () - result.staleExits);
+      for (uint32_t v = 0; v < result.exitBegin.size (); v++)
+        {
+          uint32_t begin = exits.size ();
+          exits.insert (exits.end (), result.exits.begin () + result.exitBegin[v],
+                        result.exits.begin () + result.exitEnd[v]);
+          result.exitBegin[v] = begin;
+          result.exitEnd[v] = exits.size ();
+        }
+      result.exits.swap (exits);
+      result.staleExits = 0;
+    }
+  return true;
+}
+
+void
+GlobalRouteManagerImpl::SPFRepairAffect (uint32_t rootIndex, uint32_t v, std::vector<uint32_t> &affected)
+{
+  if (v != rootIndex && !(m_repairFlags[v] & REPAIR_AFFECTED))
+    {
+      SPFRepairMark (v, REPAIR_AFFECTED);
+      affected.push_back (v);
+    }
+}
+
+bool
+GlobalRouteManagerImpl::SPFJoinedBefore (SPFResult const &result, uint32_t a, uint32_t b) const
+{
+//
+// The candidate queue orders the vertices by distance, the networks first,
+// then in the order the links of the vertices already in the tree reached
+// them at that distance.
+//
+  while (a != b)
+    {
+      if (result.distance[a] != result.distance[b])
+        {
+          return result.distance[a] < result.distance[b];
+        }
+      bool aNetwork = m_lsdb->GetVertexLSA (a)->GetLSType () == GlobalRoutingLSA::NetworkLSA;
+      bool bNetwork = m_lsdb->GetVertexLSA (b)->GetLSType () == GlobalRoutingLSA::NetworkLSA;
+      if (aNetwork != bNetwork)
+        {
+          return aNetwork;
+        }
+      uint32_t aParent = result.joinParent[a];
+      uint32_t bParent = result.joinParent[b];
+      if (aParent == SPF_INFINITY || bParent == SPF_INFINITY)
+        {
+          // Only the root has no join parent
+          return aParent == SPF_INFINITY;
+        }
+      if (aParent == bParent)
+        {
+          return result.joinLink[a] < result.joinLink[b];
+        }
+      a = aParent;
+      b = bParent;
+    }
+  return false;
+}
+
+bool
+GlobalRouteManagerImpl::SPFStubsBefore (SPFResult const &result, uint32_t a, uint32_t b) const
+{
+  std::vector<uint32_t> aPath;
+  std::vector<uint32_t> bPath;
+  SPFGetStubPath (result, a, aPath);
+  SPFGetStubPath (result, b, bPath);
+  return SPFStubPathBefore (result, aPath, bPath);
+}
+
+bool
+GlobalRouteManagerImpl::SPFStubPathBefore (SPFResult const &result, std::vector<uint32_t> const &a,
+                                           std::vector<uint32_t> const &b) const
+{
+//
+// The walk follows the children of a vertex in the order they joined the
+// tree, and reaches a vertex first on the path which comes first.
+//
+  for (uint32_t i = 0; i < a.size () && i < b.size (); i++)
+    {
+      if (a[i] != b[i])
+        {
+          return SPFJoinedBefore (result, a[i], b[i]);
+        }
+    }
+  return a.size () < b.size ();
+}
+
+void
+GlobalRouteManagerImpl::SPFGetStubPath (SPFResult const &result, uint32_t v, std::vector<uint32_t> &path)
+{
+  path.clear ();
+  for (; v != SPF_INFINITY; v = result.stubParent[v])
+    {
+      path.push_back (v);
+    }
+  std::reverse (path.begin (), path.end ());
+}
+
+void
+GlobalRouteManagerImpl::SPFUpdateDestinations (SPFRoot const &root, SPFResult const &result,
+                                               std::vector<uint32_t> const &moved,
+                                               Destinations const &destinations) const
+{
+  NS_LOG_FUNCTION (this << root.routerId);
+  uint32_t rootIndex = m_lsdb->GetVertexIndex (root.routerId);
+//
+// The destinations of the changed LSAs, and those of the vertices which
+// moved, get their routes again.
+//
+  std::set<Destination> hosts (destinations.changedHosts.begin (), destinations.changedHosts.end ());
+  std::set<Destination> networks (destinations.changedNetworks.begin (), destinations.changedNetworks.end ());
+  for (uint32_t i = 0; i < moved.size (); i++)
+    {
+      GlobalRoutingLSA *lsa = m_lsdb->GetVertexLSA (moved[i]);
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (j);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+            {
+              hosts.insert (Destination (l->GetLinkData ().Get (), 0xffffffff));
+            }
+          else if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              Ipv4Mask mask (l->GetLinkData ().Get ());
+              networks.insert (Destination (l->GetLinkId ().CombineMask (mask).Get (), mask.Get ()));
+            }
+        }
+    }
+  std::set<Ipv4Address> removeHosts;
+  for (std::set<Destination>::const_iterator i = hosts.begin (); i != hosts.end (); i++)
+    {
+      removeHosts.insert (Ipv4Address (i->first));
+    }
+  std::set<std::pair<Ipv4Address, uint32_t> > removeNetworks;
+  for (std::set<Destination>::const_iterator i = networks.begin (); i != networks.end (); i++)
+    {
+      removeNetworks.insert (std::make_pair (Ipv4Address (i->first), i->second));
+    }
+  root.routing->RemoveRoutesTo (removeHosts, removeNetworks);
+
+  std::vector<uint32_t> order;
+  for (std::set<Destination>::const_iterator i = hosts.begin (); i != hosts.end (); i++)
+    {
+      Ipv4Address dest (i->first);
+      AdvertiserMap::const_iterator advertisers = destinations.hosts.find (*i);
+      NS_ASSERT (advertisers != destinations.hosts.end ());
+      std::vector<uint32_t> const &vertices = advertisers->second.vertices;
+//
+// The host routes of the vertices are added as they join the tree.
+//
+      order.clear ();
+      for (uint32_t j = 0; j < vertices.size (); j++)
+        {
+          uint32_t v = vertices[j];
+          if (v == rootIndex || result.distance[v] == SPF_INFINITY)
+            {
+              continue;
+            }
+          order.push_back (v);
+          for (uint32_t k = order.size () - 1; k > 0 && SPFJoinedBefore (result, order[k], order[k - 1]); k--)
+            {
+              std::swap (order[k], order[k - 1]);
+            }
+        }
+      for (uint32_t j = 0; j < order.size (); j++)
+        {
+          uint32_t v = order[j];
+          GlobalRoutingLSA *lsa = m_lsdb->GetVertexLSA (v);
+          for (uint32_t k = 0; k < lsa->GetNLinkRecords (); k++)
+            {
+              GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (k);
+              if (l->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint
+                  || l->GetLinkData () != dest)
+                {
+                  continue;
+                }
+              for (uint32_t e = result.exitBegin[v]; e < result.exitEnd[v]; e++)
+                {
+                  if (result.exits[e].second >= 0)
+                    {
+                      root.routing->AddHostRouteTo (dest, result.exits[e].first, result.exits[e].second);
+                    }
+                }
+            }
+        }
+    }
+  for (std::set<Destination>::const_iterator i = networks.begin (); i != networks.end (); i++)
+    {
+      Ipv4Address network (i->first);
+      Ipv4Mask mask (i->second);
+      AdvertiserMap::const_iterator advertisers = destinations.networks.find (*i);
+      NS_ASSERT (advertisers != destinations.networks.end ());
+      std::vector<uint32_t> const &vertices = advertisers->second.vertices;
+//
+// The stub networks of the vertices are added in the order SPFProcessStubs
+// visits them.
+//
+      order.clear ();
+      for (uint32_t j = 0; j < vertices.size (); j++)
+        {
+          uint32_t v = vertices[j];
+          if (v == rootIndex || result.distance[v] == SPF_INFINITY)
+            {
+              continue;
+            }
+          order.push_back (v);
+          for (uint32_t k = order.size () - 1; k > 0 && SPFStubsBefore (result, order[k], order[k - 1]); k--)
+            {
+              std::swap (order[k], order[k - 1]);
+            }
+        }
+      for (uint32_t j = 0; j < order.size (); j++)
+        {
+          uint32_t v = order[j];
+          GlobalRoutingLSA *lsa = m_lsdb->GetVertexLSA (v);
+          for (uint32_t k = 0; k < lsa->GetNLinkRecords (); k++)
+            {
+              GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (k);
+              if (l->GetLinkType () != GlobalRoutingLinkRecord::StubNetwork
+                  || l->GetLinkData ().Get () != mask.Get ()
+                  || l->GetLinkId ().CombineMask (mask) != network)
+                {
+                  continue;
+                }
+              for (uint32_t e = result.exitBegin[v]; e < result.exitEnd[v]; e++)
+                {
+                  if (result.exits[e].second >= 0)
+                    {
+                      root.routing->AddNetworkRouteTo (network, mask, result.exits[e].first, result.exits[e].second);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculateRoots (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_spfRoots.size (); i++)
+    {
+      m_spfIpv4 = m_spfRoots[i].ipv4;
+      m_spfRouting = m_spfRoots[i].routing;
+      m_spfResult = m_spfRoots[i].result;
+      SPFCalculate (m_spfRoots[i].routerId);
+    }
+  m_spfIpv4 = 0;
+  m_spfRouting = 0;
+  m_spfResult = 0;
+}
+
 //
-// (b) Otherwise, W is a transit vertex (router or transit network).  Look up
-// the vertex W's LSA (router-LSA or network-LSA) in Area A's link state
-// database. 
+// This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
+// 16.1 (2) for further details.
 //
-          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
-            {
+// We're passed a parameter <v> that is a vertex which is already in the SPF
+// tree.  A vertex represents a router node.  We also get a reference to the
+// SPF candidate queue, which is a priority queue containing the shortest paths
+// to the networks we know about.
 //
-// Lookup the link state advertisement of the new link -- we call it <w> in
-// the link state database.
+// We examine the links in v's LSA and update the list of candidates with any
+// vertices not already on the list.  If a lower-cost path is found to a
+// vertex already on the candidate list, store the new (lower) cost.
 //
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
-              NS_LOG_LOGIC ("Found a P2P record from " << 
-                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
-            }
-          else if (l->GetLinkType () == 
-                   GlobalRoutingLinkRecord::TransitNetwork)
-            {
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
-              NS_LOG_LOGIC ("Found a Transit record from " << 
-                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
-            }
-          else 
-            {
-              NS_ASSERT_MSG (0, "illegal Link Type");
-            }
-        }
-// Get w_lsa:  In case of V is Network-LSA
-      if (v->GetVertexType () == SPFVertex::VertexNetwork) 
-        {
-          w_lsa = m_lsdb->GetLSAByLinkData 
-              (v->GetLSA ()->GetAttachedRouter (i));
-          if (!w_lsa)
-            {
-              continue;
-            }
-          NS_LOG_LOGIC ("Found a Network LSA from " << 
-                        v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
-        }
+void
+GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
+{
+  NS_LOG_FUNCTION (this << v << &candidate);
+
+  SPFVertex* w = 0;
+  GlobalRoutingLSA* w_lsa = 0;
+  GlobalRoutingLinkRecord *l = 0;
+  uint32_t distance = 0;
+//
+// V points to a Router-LSA or Network-LSA
+// Loop over the transit vertices adjacent to V in the LSDB: the vertices
+// the point-to-point and transit network links in a router LSA lead to, or
+// the attached routers in a network LSA.  Links to stub networks are
+// considered in the second stage of the shortest path calculation.
+//
+  uint32_t vIndex = v->GetVertexIndex ();
+  uint32_t adjacencyEnd = m_lsdb->GetAdjacencyEnd (vIndex);
+  for (uint32_t adjacency = m_lsdb->GetAdjacencyBegin (vIndex); adjacency < adjacencyEnd; adjacency++)
+    {
+      uint32_t wIndex = m_lsdb->GetAdjacentVertex (adjacency);
+      w_lsa = m_lsdb->GetVertexLSA (wIndex);
+      l = m_lsdb->GetAdjacentLink (adjacency);
+      NS_LOG_LOGIC ("Found a record from " << 
+                    v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
 
 // Note:  w_lsa at this point may be either RouterLSA or NetworkLSA
 //
@@ -836,7 +2036,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If the link is to a router that is already in the shortest path first tree
 // then we have it covered -- ignore it.
 //
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+      if (m_spfStatus[wIndex] == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
         {
           NS_LOG_LOGIC ("Skipping ->  LSA "<< 
                         w_lsa->GetLinkStateId () << " already in SPF tree");
@@ -861,7 +2061,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
       NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
 
 // Is there already vertex w in candidate list?
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+      if (m_spfStatus[wIndex] == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
         {
 // Calculate nexthop to w
 // We need to figure out how to actually get to the new router represented
@@ -871,14 +2071,21 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 
 // prepare vertex w
           w = new SPFVertex (w_lsa);
+          w->SetVertexIndex (wIndex);
           if (SPFNexthopCalculation (v, w, l, distance))
             {
-              w_lsa->SetStatus (GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+              m_spfStatus[wIndex] = GlobalRoutingLSA::LSA_SPF_CANDIDATE;
+              m_spfCandidates[wIndex] = w;
 //
 // Push this new vertex onto the priority queue (ordered by distance from the
 // root node).
 //
               candidate.Push (w);
+              if (m_spfResult)
+                {
+                  m_spfResult->joinParent[wIndex] = vIndex;
+                  m_spfResult->joinLink[wIndex] = adjacency - m_lsdb->GetAdjacencyBegin (vIndex);
+                }
               NS_LOG_LOGIC ("Pushing " << 
                             w->GetVertexId () << ", parent vertexId: " <<
                             v->GetVertexId () << ", distance: " <<
@@ -888,7 +2095,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
             NS_ASSERT_MSG (0, "SPFNexthopCalculation never " 
                            << "return false, but it does now!");
         }
-      else if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+      else if (m_spfStatus[wIndex] == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
 //
 // We have already considered the link represented by <w>.  What wse have to
@@ -903,8 +2110,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 * with the cost we just determined (w->distance) to see
 * if we've found a shorter path.
 */
-          SPFVertex* cw;
-          cw = candidate.Find (w_lsa->GetLinkStateId ());
+          SPFVertex* cw = m_spfCandidates[wIndex];
           if (cw->GetDistanceFromRoot () < distance)
             {
 //
@@ -935,6 +2141,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 
 // prepare vertex w
               w = new SPFVertex (w_lsa);
+              w->SetVertexIndex (wIndex);
               SPFNexthopCalculation (v, w, l, distance);
               cw->MergeRootExitDirections (w);
               cw->MergeParent (w);
@@ -958,9 +2165,14 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
                 {
 //
 // If we've changed the cost to get to the vertex represented by <w>, we 
-// must reorder the priority queue keyed to that cost.
+// must move it in the priority queue keyed to that cost.
 //
-                  candidate.Reorder ();
+                  candidate.Update (cw);
+                  if (m_spfResult)
+                    {
+                      m_spfResult->joinParent[wIndex] = vIndex;
+                      m_spfResult->joinLink[wIndex] = adjacency - m_lsdb->GetAdjacencyBegin (vIndex);
+                    }
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -1247,7 +2459,21 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr && rtr->GetRouterId () == root)
+        {
+          m_spfIpv4 = (*i)->GetObject<Ipv4> ();
+          m_spfRouting = rtr->GetRoutingProtocol ();
+          break;
+        }
+    }
+  m_lsdb->BuildAdjacency ();
   SPFCalculate (root);
+  m_spfIpv4 = 0;
+  m_spfRouting = 0;
 }
 
 //
@@ -1320,11 +2546,8 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-                  NS_ASSERT (gr);
-                  gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
+                  NS_ASSERT (m_spfRouting);
+                  m_spfRouting->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
                                          FindOutgoingInterfaceId (transitLink->GetLinkData ()));
                   NS_LOG_LOGIC ("Inserting default route for node " << myRouterId << " to next hop " << 
                                 lr->GetLinkData () << " via interface " << 
@@ -1345,9 +2568,12 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 
   SPFVertex *v;
 //
-// Initialize the Link State Database.
+// Initialize the SPF status of the vertices of the Link State Database.  The
+// status is kept here, and not in the LSAs, so that the LSDB is left alone
+// by the calculations of several roots at once.
 //
-  m_lsdb->Initialize ();
+  m_spfStatus.assign (m_lsdb->GetNVertices (), GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED);
+  m_spfCandidates.assign (m_lsdb->GetNVertices (), 0);
 //
 // The candidate queue is a priority queue of SPFVertex objects, with the top
 // of the queue being the closest vertex in terms of distance from the root
@@ -1360,14 +2586,17 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // calculation.  Each router (and corresponding network) is a vertex in the
 // shortest path first (SPF) tree.
 //
-  v = new SPFVertex (m_lsdb->GetLSA (root));
+  uint32_t rootIndex = m_lsdb->GetVertexIndex (root);
+  NS_ASSERT_MSG (rootIndex < m_lsdb->GetNVertices (), "No LSA for root " << root);
+  v = new SPFVertex (m_lsdb->GetVertexLSA (rootIndex));
+  v->SetVertexIndex (rootIndex);
 // 
 // This vertex is the root of the SPF tree and it is distance 0 from the root.
 // We also mark this vertex as being in the SPF tree.
 //
   m_spfroot= v;
   v->SetDistanceFromRoot (0);
-  v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  m_spfStatus[rootIndex] = GlobalRoutingLSA::LSA_SPF_IN_SPFTREE;
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
 
 //
@@ -1377,12 +2606,41 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (m_spfRouting && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
+      if (m_spfResult)
+        {
+          m_spfResult->stub = true;
+          m_spfResult->distance.clear ();
+          m_spfResult->joinParent.clear ();
+          m_spfResult->joinLink.clear ();
+          m_spfResult->stubParent.clear ();
+          m_spfResult->exitBegin.clear ();
+          m_spfResult->exitEnd.clear ();
+          m_spfResult->exits.clear ();
+          m_spfResult->staleExits = 0;
+        }
       delete m_spfroot;
       return;
     }
+//
+// Keep the distance, the parents and the root exits of the vertices, for
+// UpdateRoutes to repair the tree when the LSDB changes.
+//
+  if (m_spfResult)
+    {
+      m_spfResult->stub = false;
+      m_spfResult->distance.assign (m_lsdb->GetNVertices (), SPF_INFINITY);
+      m_spfResult->joinParent.assign (m_lsdb->GetNVertices (), SPF_INFINITY);
+      m_spfResult->joinLink.assign (m_lsdb->GetNVertices (), 0);
+      m_spfResult->stubParent.assign (m_lsdb->GetNVertices (), SPF_INFINITY);
+      m_spfResult->exitBegin.assign (m_lsdb->GetNVertices (), 0);
+      m_spfResult->exitEnd.assign (m_lsdb->GetNVertices (), 0);
+      m_spfResult->exits.clear ();
+      m_spfResult->staleExits = 0;
+      m_spfResult->distance[rootIndex] = 0;
+    }
 
   for (;;)
     {
@@ -1428,7 +2686,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // Update the status field of the vertex to indicate that it is in the SPF
 // tree.
 //
-      v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      m_spfStatus[v->GetVertexIndex ()] = GlobalRoutingLSA::LSA_SPF_IN_SPFTREE;
 //
 // The current vertex has a parent pointer.  By calling this rather oddly 
 // named method (blame quagga) we add the current vertex to the list of 
@@ -1437,6 +2695,17 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // to now.
 //
       SPFVertexAddParent (v);
+      if (m_spfResult)
+        {
+          uint32_t index = v->GetVertexIndex ();
+          m_spfResult->distance[index] = v->GetDistanceFromRoot ();
+          m_spfResult->exitBegin[index] = m_spfResult->exits.size ();
+          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+            {
+              m_spfResult->exits.push_back (v->GetRootExitDirection (i));
+            }
+          m_spfResult->exitEnd[index] = m_spfResult->exits.size ();
+        }
 //
 // Note that when there is a choice of vertices closest to the root, network
 // vertices must be chosen before router vertices in order to necessarily
@@ -1556,64 +2825,26 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
   NS_LOG_LOGIC ("External is on remote host: " 
                 << extlsa->GetAdvertisingRouter () << "; installing");
 
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  NS_LOG_LOGIC ("Vertex ID = " << m_spfroot->GetVertexId ());
+// The routing protocol of the node at the root of the SPF tree, which we are
+// going to write the routing information to, was found before the
+// calculation started.
+  if (m_spfRouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
+      NS_LOG_LOGIC ("No routing protocol for root " << m_spfroot->GetVertexId ());
+      return;
+    }
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 
-//
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
 // record.  In the case of a point-to-point link, this is the local IP address
@@ -1625,40 +2856,30 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // root node should send packets to be forwarded to these IP addresses.
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
-//
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<Ipv4GlobalRouting> gr = m_spfRouting;
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Root " << m_spfroot->GetVertexId () <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Root " << m_spfroot->GetVertexId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1692,6 +2913,10 @@ GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
     {
       if (!v->GetChild (i)->IsVertexProcessed ())
         {
+          if (m_spfResult)
+            {
+              m_spfResult->stubParent[v->GetChild (i)->GetVertexIndex ()] = v->GetVertexIndex ();
+            }
           SPFProcessStubs (v->GetChild (i));
           v->GetChild (i)->SetVertexProcessed (true);
         }
@@ -1720,69 +2945,27 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
   NS_LOG_LOGIC ("Stub is on remote host: " << v->GetVertexId () << "; installing");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// going to write the actual routing table entries.  Its routing protocol
+// was found before the calculation started.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  NS_LOG_LOGIC ("Vertex ID = " << m_spfroot->GetVertexId ());
+  if (m_spfRouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("No routing protocol for root " << m_spfroot->GetVertexId ());
+      return;
+    }
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -1796,40 +2979,30 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<Ipv4GlobalRouting> gr = m_spfRouting;
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Root " << m_spfroot->GetVertexId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Root " << m_spfroot->GetVertexId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
@@ -1844,70 +3017,22 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 {
   NS_LOG_FUNCTION (this << a << amask);
 //
-// We have an IP address <a> and a vertex ID of the root of the SPF tree.
-// The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+// We have an IP address <a> and the Ipv4 interface of the node at the root of
+// the SPF tree, found before the calculation started.  The question is what
+// interface index does this address correspond to.
 //
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfIpv4 == 0)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
-//
-// This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
+// Couldn't find it.
+      NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << m_spfroot->GetVertexId ());
+      return -1;
+    }
 //
 // Look through the interfaces on this node for one that has the IP address
 // we're looking for.  If we find one, return the corresponding interface
 // index, or -1 if not found.
 //
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
-
-#if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
-        }
-    }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
-  return -1;
+  return m_spfIpv4->GetInterfaceForPrefix (a, amask);
 }
 
 //
@@ -1935,69 +3060,27 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries.  Its routing protocol
+// was found before the calculation started.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  NS_LOG_LOGIC ("Vertex ID = " << m_spfroot->GetVertexId ());
+  if (m_spfRouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("No routing protocol for root " << m_spfroot->GetVertexId ());
+      return;
+    }
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2006,18 +3089,19 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Root " << m_spfroot->GetVertexId () <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  Ptr<Ipv4GlobalRouting> gr = m_spfRouting;
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2031,44 +3115,31 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
+                                  outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Root " << m_spfroot->GetVertexId () <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
-//
-// Done adding the routes for the selected node.
-//
-          return;
-        }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Root " << m_spfroot->GetVertexId () <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
 void
@@ -2080,104 +3151,54 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
                  "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries.  Its routing protocol
+// was found before the calculation started.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  NS_LOG_LOGIC ("Vertex ID = " << m_spfroot->GetVertexId ());
+  if (m_spfRouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("No routing protocol for root " << m_spfroot->GetVertexId ());
+      return;
+    }
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  Ptr<Ipv4GlobalRouting> gr = m_spfRouting;
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+      if (outIf >= 0)
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Root " << m_spfroot->GetVertexId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-    } 
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Root " << m_spfroot->GetVertexId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
+        }
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
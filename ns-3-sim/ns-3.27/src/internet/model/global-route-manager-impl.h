@@ -30,6 +30,7 @@
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/ipv4.h"
 #include "global-router-interface.h"
 
 namespace ns3 {
@@ -525,6 +526,22 @@ public:
    */
   void ClearVertexProcessed (void);
 
+/**
+ * @brief Set the index of the LSA of this vertex in the Link State Database.
+ *
+ * @see GlobalRouteManagerLSDB::GetVertexIndex
+ * @param index The index of the LSA among the vertices of the LSDB.
+ */
+  void SetVertexIndex (uint32_t index);
+
+/**
+ * @brief Get the index of the LSA of this vertex in the Link State Database.
+ *
+ * @see GlobalRouteManagerLSDB::GetVertexIndex
+ * @returns The index of the LSA among the vertices of the LSDB.
+ */
+  uint32_t GetVertexIndex (void) const;
+
 private:
   VertexType m_vertexType; //!< Vertex type
   Ipv4Address m_vertexId; //!< Vertex ID
@@ -538,6 +555,11 @@ private:
   ListOfSPFVertex_t m_parents; //!< parent list
   ListOfSPFVertex_t m_children; //!< Children list
   bool m_vertexProcessed; //!< Flag to note whether vertex has been processed in stage two of SPF computation
+  uint32_t m_vertexIndex; //!< index of the LSA in the LSDB
+  uint32_t m_candidatePosition; //!< position in the heap of the CandidateQueue
+  uint64_t m_candidateOrder; //!< order of the vertex among the equal candidates
+
+  friend class CandidateQueue;
 
 /**
  * @brief The SPFVertex copy construction is disallowed.  There's no need for
@@ -674,6 +696,123 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+/**
+ * @brief Build the adjacency of the transit vertices of the database.
+ *
+ * The router and network LSAs are numbered in the order of their link
+ * state IDs, and the transit vertices adjacent to each of them, those the
+ * SPF calculation examines, are stored contiguously in the order of its
+ * link records or attached routers, together with the link record leading
+ * to them.  The adjacencies leading to each vertex are also grouped, in
+ * the order of their vertex then of their position, for the repair of the
+ * shortest path trees.  The adjacency is built again only after an LSA
+ * was inserted, and is then read only, so that several SPF calculations
+ * may share it.
+ */
+  void BuildAdjacency (void);
+
+/**
+ * @brief Get the number of router and network LSAs in the adjacency.
+ *
+ * @see BuildAdjacency
+ * @returns the number of vertices
+ */
+  uint32_t GetNVertices (void) const;
+
+/**
+ * @brief Get the index of the LSA with the given link state ID.
+ *
+ * @see BuildAdjacency
+ * @param addr The link state ID of the LSA.
+ * @returns the index of the LSA, or GetNVertices () if there is none.
+ */
+  uint32_t GetVertexIndex (Ipv4Address addr) const;
+
+/**
+ * @brief Get the LSA with the given index.
+ *
+ * @see BuildAdjacency
+ * @param index the index of the LSA
+ * @returns A pointer to the Link State Advertisement.
+ */
+  GlobalRoutingLSA* GetVertexLSA (uint32_t index) const;
+
+/**
+ * @brief Get the first adjacency of a vertex.
+ *
+ * @see BuildAdjacency
+ * @param index the index of the vertex
+ * @returns the index of the first adjacency of the vertex
+ */
+  uint32_t GetAdjacencyBegin (uint32_t index) const;
+
+/**
+ * @brief Get the end of the adjacencies of a vertex.
+ *
+ * @see BuildAdjacency
+ * @param index the index of the vertex
+ * @returns the index following the last adjacency of the vertex
+ */
+  uint32_t GetAdjacencyEnd (uint32_t index) const;
+
+/**
+ * @brief Get the vertex an adjacency leads to.
+ *
+ * @see BuildAdjacency
+ * @param adjacency the index of the adjacency
+ * @returns the index of the adjacent vertex
+ */
+  uint32_t GetAdjacentVertex (uint32_t adjacency) const;
+
+/**
+ * @brief Get the link record of an adjacency.
+ *
+ * @see BuildAdjacency
+ * @param adjacency the index of the adjacency
+ * @returns the link record from a router to the adjacent vertex, or 0
+ * for the adjacencies of a network
+ */
+  GlobalRoutingLinkRecord* GetAdjacentLink (uint32_t adjacency) const;
+
+/**
+ * @brief Get the vertex an adjacency leads from.
+ *
+ * @see BuildAdjacency
+ * @param adjacency the index of the adjacency
+ * @returns the index of the vertex whose LSA has the adjacency
+ */
+  uint32_t GetAdjacencySource (uint32_t adjacency) const;
+
+/**
+ * @brief Get the first adjacency leading to a vertex.
+ *
+ * The adjacencies leading to each vertex are stored contiguously, in
+ * increasing order, and are found with GetIncomingAdjacency ().
+ *
+ * @see BuildAdjacency
+ * @param index the index of the vertex
+ * @returns the position of the first adjacency leading to the vertex
+ */
+  uint32_t GetIncomingBegin (uint32_t index) const;
+
+/**
+ * @brief Get the end of the adjacencies leading to a vertex.
+ *
+ * @see BuildAdjacency
+ * @param index the index of the vertex
+ * @returns the position following the last adjacency leading to the vertex
+ */
+  uint32_t GetIncomingEnd (uint32_t index) const;
+
+/**
+ * @brief Get an adjacency leading to a vertex.
+ *
+ * @see GetIncomingBegin
+ * @param position the position of the adjacency, between the
+ * GetIncomingBegin () and GetIncomingEnd () of the vertex
+ * @returns the index of the adjacency
+ */
+  uint32_t GetIncomingAdjacency (uint32_t position) const;
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -682,6 +821,16 @@ private:
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
 
+  bool m_adjacencyValid; //!< whether the adjacency matches the database
+  std::vector<GlobalRoutingLSA*> m_vertices; //!< LSA of each vertex
+  std::map<Ipv4Address, uint32_t> m_vertexIndex; //!< index of the vertex of each link state ID
+  std::vector<uint32_t> m_adjacencyBegin; //!< first adjacency of each vertex, and the end of the last one
+  std::vector<uint32_t> m_adjacentVertices; //!< vertex of each adjacency
+  std::vector<GlobalRoutingLinkRecord*> m_adjacentLinks; //!< link record of each adjacency
+  std::vector<uint32_t> m_adjacencySources; //!< vertex of the LSA of each adjacency
+  std::vector<uint32_t> m_incomingBegin; //!< first incoming adjacency of each vertex, and the end of the last one
+  std::vector<uint32_t> m_incomingAdjacencies; //!< adjacencies leading to each vertex, grouped by vertex
+
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
  * need for it and a compiler provided shallow copy would be wrong.
@@ -735,6 +884,26 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Bring the per-node forwarding tables up to date with the Link
+ * State Advertisements of the routers: diff the LSAs against those of the
+ * last update, then repair the shortest path trees they affect.
+ *
+ * The shortest path tree of each router is kept, so that the next update
+ * can repair it in place with SPFRepair, visiting only the vertices below
+ * the changed links.  The routers then replace only their routes to the
+ * addresses and networks of the changed LSAs, and to those of the
+ * vertices that moved in their tree.  A router whose own LSA or next hops
+ * changed, or whose tree cannot be repaired, computes it again with the
+ * same full Dijkstra computation as InitializeRoutes.  Every route is
+ * computed again if there were no kept results, or if network or external
+ * LSAs changed.
+ *
+ * @returns the number of routers whose shortest path tree was computed
+ * again or repaired
+ */
+  virtual uint32_t UpdateRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -766,8 +935,266 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+  /**
+   * The outcome of the SPF computation of a router: its shortest path
+   * tree, to repair it and update its routes.
+   *
+   * The vertices join the tree in the order of their distance, the network
+   * vertices first, then in the order the candidate queue got them at that
+   * distance: the order in which their join parents joined the tree, then
+   * the order of the links of a join parent.  The stubs are added in a
+   * depth first walk of the tree, which reaches each vertex from its stub
+   * parent.  These are kept so that both orders can be found again for any
+   * vertex, see SPFJoinedBefore and SPFStubsBefore.
+   */
+  struct SPFResult
+  {
+    Ipv4Address routerId; //!< the router ID of the router
+    bool stub; //!< whether the router only got a default route
+    std::vector<uint32_t> distance; //!< distance of each vertex, or SPF_INFINITY
+    std::vector<uint32_t> joinParent; //!< first parent of each vertex to join the tree, or SPF_INFINITY
+    std::vector<uint32_t> joinLink; //!< link of the join parent to each vertex, from its first adjacency
+    std::vector<uint32_t> stubParent; //!< vertex each vertex is reached from by the walk of the stubs, or SPF_INFINITY
+    std::vector<uint32_t> exitBegin; //!< first exit of each vertex in exits
+    std::vector<uint32_t> exitEnd; //!< end of the exits of each vertex in exits
+    std::vector<SPFVertex::NodeExit_t> exits; //!< root exits of the vertices
+    uint32_t staleExits; //!< exits no vertex refers to any longer, since the last repair
+  };
+
+  /// A router to compute the routes of, and where to install them
+  struct SPFRoot
+  {
+    Ipv4Address routerId; //!< the router ID of the router
+    Ptr<Ipv4> ipv4; //!< the IPv4 stack of the router
+    Ptr<Ipv4GlobalRouting> routing; //!< the routing protocol of the router
+    SPFResult *result; //!< where to keep the outcome of the computation, or 0
+  };
+
+  /// A host or network address, and its mask
+  typedef std::pair<uint32_t, uint32_t> Destination;
+  /// The vertices contributing routes to a destination
+  struct Advertisers
+  {
+    bool changed; //!< whether a changed LSA advertises the destination, before or now
+    std::vector<uint32_t> vertices; //!< the vertices advertising the destination now
+  };
+  /// The advertisers of each destination
+  typedef std::map<Destination, Advertisers> AdvertiserMap;
+  /// The destinations of the router LSAs
+  struct Destinations
+  {
+    AdvertiserMap hosts; //!< the addresses of the router LSAs, before and now
+    AdvertiserMap networks; //!< the stub networks of the router LSAs, before and now
+    std::vector<Destination> changedHosts; //!< the addresses of the changed LSAs, before and now
+    std::vector<Destination> changedNetworks; //!< the stub networks of the changed LSAs, before and now
+  };
+
+  /// The state of a vertex in the repair of a shortest path tree
+  enum RepairFlag
+  {
+    REPAIR_DISTANCE = 1, //!< the vertex has a new distance
+    REPAIR_CHECKED = 2, //!< the shortest paths of the vertex were checked
+    REPAIR_LOST = 4, //!< the vertex lost every shortest path
+    REPAIR_DONE = 8, //!< the new distance of the vertex is final
+    REPAIR_AFFECTED = 16 //!< the parents, exits and orders of the vertex are found again
+  };
+
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  Ptr<Ipv4> m_spfIpv4; //!< the IPv4 stack of the root node
+  Ptr<Ipv4GlobalRouting> m_spfRouting; //!< the routing protocol of the root node
+  std::vector<GlobalRoutingLSA::SPFStatus> m_spfStatus; //!< SPF status of each vertex of the LSDB
+  std::vector<SPFVertex*> m_spfCandidates; //!< candidate vertex of each vertex of the LSDB
+  std::vector<SPFRoot> m_spfRoots; //!< the routers to compute the routes of
+  SPFResult *m_spfResult; //!< where to keep the outcome of the current computation, or 0
+  std::vector<SPFResult> m_updateResults; //!< outcome of the computation of each router, for UpdateRoutes
+  bool m_updateValid; //!< whether m_updateResults match the LSDB and the routing tables
+  std::vector<uint32_t> m_repairDistance; //!< new distance of the vertices a repair reached
+  std::vector<uint8_t> m_repairFlags; //!< state of each vertex in a repair, see RepairFlag
+  std::vector<uint32_t> m_repairTouched; //!< the vertices with flags or a new distance in a repair
+
+  /**
+   * \brief Find the routers to compute the routes of.
+   *
+   * \param roots the routers, in the order of the node list
+   */
+  void GetSPFRoots (std::vector<SPFRoot> &roots) const;
+
+  /**
+   * \brief Compute the routes of some routers, with one or more threads.
+   *
+   * \param roots the routers
+   */
+  void CalculateRoots (std::vector<SPFRoot> const &roots);
+
+  /**
+   * \brief Find the router and network vertices whose LSA changed.
+   *
+   * \param previous the LSDB of the last update, with the same vertices
+   * \param changed the indices of the vertices whose LSA changed
+   * \param destinations the addresses and stub networks of the router
+   * LSAs, before and now, with the vertices advertising each of them now,
+   * and those of the changed LSAs
+   * \returns false if every route must be computed again
+   */
+  bool FindChangedVertices (GlobalRouteManagerLSDB *previous, std::vector<uint32_t> &changed,
+                            Destinations &destinations) const;
+
+  /**
+   * \brief Test if a router must compute all of its routes again.
+   *
+   * A router only keeps its routes if its own LSA is the same, and the
+   * LSAs of its neighbors describe the same links back to it: these set
+   * the next hops to the neighbors, and whether the router is a stub.
+   *
+   * \param result the outcome of the last computation of the router
+   * \param previous the LSDB of the last update
+   * \param changed the indices of the vertices whose LSA changed
+   * \returns true if the router must compute all of its routes again
+   */
+  bool SPFRootChanged (SPFResult const &result, GlobalRouteManagerLSDB *previous,
+                       std::vector<uint32_t> const &changed) const;
+
+  /**
+   * \brief Repair the shortest path tree of a router after some LSAs
+   * changed.
+   *
+   * Only the subtrees below the changed links are visited.  The vertices
+   * which lost every shortest path get their distance again from their
+   * other neighbors, and the shorter paths of the changed links are
+   * followed from them, as in a Dijkstra computation started from the
+   * changed vertices.  The vertices whose distance changed, and the
+   * neighbors of the changed LSAs, are then the affected vertices, with
+   * every vertex below them in the tree.  Their parents, root exits and
+   * orders are found again from their parents, nearest first.
+   *
+   * \param root the router
+   * \param result the outcome of the last computation of the router,
+   * repaired
+   * \param previous the LSDB of the last update
+   * \param changed the indices of the vertices whose LSA changed
+   * \param moved the affected vertices, which may have other routes or
+   * add them in another order
+   * \returns false if the tree has network vertices, or links of zero
+   * cost on shortest paths, and the router must compute all of its routes
+   * again
+   */
+  bool SPFRepair (SPFRoot const &root, SPFResult &result, GlobalRouteManagerLSDB *previous,
+                  std::vector<uint32_t> const &changed, std::vector<uint32_t> &moved);
+
+  /**
+   * \brief Repair the shortest path tree of a router, see SPFRepair.
+   *
+   * \param rootIndex the vertex of the router
+   * \param result the outcome of the last computation of the router,
+   * repaired
+   * \param previous the LSDB of the last update
+   * \param changed the indices of the vertices whose LSA changed
+   * \param moved the affected vertices
+   * \returns false if the router must compute all of its routes again
+   */
+  bool SPFRepairTree (uint32_t rootIndex, SPFResult &result, GlobalRouteManagerLSDB *previous,
+                      std::vector<uint32_t> const &changed, std::vector<uint32_t> &moved);
+
+  /**
+   * \brief Set a flag of a vertex in a repair.
+   *
+   * \param v the vertex
+   * \param flag the RepairFlag
+   */
+  void SPFRepairMark (uint32_t v, uint8_t flag);
+
+  /**
+   * \brief Add a vertex to the affected vertices of a repair, once.
+   *
+   * \param rootIndex the vertex of the router, which is never affected
+   * \param v the vertex
+   * \param affected the affected vertices
+   */
+  void SPFRepairAffect (uint32_t rootIndex, uint32_t v, std::vector<uint32_t> &affected);
+
+  /**
+   * \brief Find the new distance of a vertex in a repair.
+   *
+   * \param result the outcome of the last computation
+   * \param v the vertex
+   * \returns the distance of the vertex
+   */
+  uint32_t SPFRepairDistance (SPFResult const &result, uint32_t v) const;
+
+  /**
+   * \brief Test if a vertex joined the shortest path tree of a router
+   * before another one.
+   *
+   * \param result the outcome of the computation of the router
+   * \param a a vertex of the tree
+   * \param b another vertex of the tree
+   * \returns true if a joined the tree before b
+   */
+  bool SPFJoinedBefore (SPFResult const &result, uint32_t a, uint32_t b) const;
+
+  /**
+   * \brief Test if the stubs of a vertex are added before those of another
+   * one.
+   *
+   * The walk of the stubs reaches the vertices in the order of their paths
+   * from the root through their stub parents, each vertex of a path
+   * compared with SPFJoinedBefore.
+   *
+   * \param result the outcome of the computation of the router
+   * \param a a vertex of the tree
+   * \param b another vertex of the tree
+   * \returns true if the stubs of a are added before those of b
+   */
+  bool SPFStubsBefore (SPFResult const &result, uint32_t a, uint32_t b) const;
+
+  /**
+   * \brief Compare two paths of the walk of the stubs.
+   *
+   * \param result the outcome of the computation of the router
+   * \param a a path from the root
+   * \param b another path from the root
+   * \returns true if the walk follows a before b
+   */
+  bool SPFStubPathBefore (SPFResult const &result, std::vector<uint32_t> const &a,
+                          std::vector<uint32_t> const &b) const;
+
+  /**
+   * \brief Find the path of the walk of the stubs to a vertex.
+   *
+   * \param result the outcome of the computation of the router
+   * \param v a vertex of the tree
+   * \param path the vertices from the root to v, through their stub
+   * parents
+   */
+  static void SPFGetStubPath (SPFResult const &result, uint32_t v, std::vector<uint32_t> &path);
+
+  /**
+   * \brief Replace the routes of a router to the destinations of the
+   * changed LSAs, and to those of the vertices which moved in its tree.
+   *
+   * The routes to each destination are added in the order the SPF
+   * computation adds them in.
+   *
+   * \param root the router
+   * \param result the outcome of its computation, or of its repair
+   * \param moved the vertices which may have other routes, or add them in
+   * another order
+   * \param destinations the destinations of the router LSAs, and their
+   * advertisers
+   */
+  void SPFUpdateDestinations (SPFRoot const &root, SPFResult const &result,
+                              std::vector<uint32_t> const &moved,
+                              Destinations const &destinations) const;
+
+  /**
+   * \brief Compute the routes of each router of m_spfRoots.
+   *
+   * Several GlobalRouteManagerImpl sharing the LSDB of the global route
+   * manager may each run this method in its own thread, as it only reads
+   * the LSDB and writes the routing tables of its routers.
+   */
+  void SPFCalculateRoots (void);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
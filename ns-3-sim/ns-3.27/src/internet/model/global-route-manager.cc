@@ -58,6 +58,14 @@ GlobalRouteManager::InitializeRoutes (void)
   InitializeRoutes ();
 }
 
+uint32_t
+GlobalRouteManager::UpdateRoutes (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+         UpdateRoutes ();
+}
+
 uint32_t
 GlobalRouteManager::AllocateRouterId (void)
 {
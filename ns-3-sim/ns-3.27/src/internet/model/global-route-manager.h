@@ -65,6 +65,26 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Bring the per-node forwarding tables up to date with the links
+ * of the routers, by diffing the Link State Advertisements and repairing
+ * the shortest path trees below the changed links.
+ *
+ * The first update computes every route, as RecomputeRoutingTables of
+ * Ipv4GlobalRoutingHelper does.  The next ones compare the new Link State
+ * Advertisements of the routers with those of the last update, and each
+ * router repairs its shortest path tree in place: only the vertices below
+ * the changed links are visited.  A router whose own links changed, or
+ * whose tree has transit networks or links of zero cost, runs a full SPF
+ * computation again.  Every router then only replaces its routes to the
+ * destinations of the changed Link State Advertisements, and to those of
+ * the routers that moved in its tree.
+ *
+ * @returns the number of routers whose shortest path tree was computed
+ * again or repaired
+ */
+  static uint32_t UpdateRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
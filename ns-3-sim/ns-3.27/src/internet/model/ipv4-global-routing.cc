@@ -17,6 +17,7 @@
 //
 
 #include <vector>
+#include <algorithm>
 #include <iomanip>
 #include "ns3/names.h"
 #include "ns3/log.h"
@@ -37,6 +38,33 @@ NS_LOG_COMPONENT_DEFINE ("Ipv4GlobalRouting");
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4GlobalRouting);
 
+const uint32_t Ipv4GlobalRouting::FIB_NONE;
+
+namespace {
+
+/**
+ * \param length a prefix length
+ * \return the mask of the first length bits
+ */
+inline uint32_t
+PrefixMask (uint32_t length)
+{
+  return length == 0 ? 0 : 0xffffffff << (32 - length);
+}
+
+/**
+ * \param address an address
+ * \param index the index of a bit, from the most significant
+ * \return the bit of address at index
+ */
+inline uint32_t
+PrefixBit (uint32_t address, uint32_t index)
+{
+  return (address >> (31 - index)) & 1;
+}
+
+} // anonymous namespace
+
 TypeId 
 Ipv4GlobalRouting::GetTypeId (void)
 { 
@@ -59,7 +87,8 @@ Ipv4GlobalRouting::GetTypeId (void)
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_fibValid (false)
 {
   NS_LOG_FUNCTION (this);
 
@@ -80,6 +109,8 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_fibValid = false;
+  NotifyRoutesChanged ();
 }
 
 void 
@@ -90,6 +121,8 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_fibValid = false;
+  NotifyRoutesChanged ();
 }
 
 void 
@@ -105,6 +138,8 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_fibValid = false;
+  NotifyRoutesChanged ();
 }
 
 void 
@@ -118,6 +153,8 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_fibValid = false;
+  NotifyRoutesChanged ();
 }
 
 void 
@@ -133,64 +170,211 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  m_fibValid = false;
+  NotifyRoutesChanged ();
 }
 
 
-Ptr<Ipv4Route>
-Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
+uint32_t
+Ipv4GlobalRouting::InsertFib (uint32_t prefix, uint32_t length)
 {
-  NS_LOG_FUNCTION (this << dest << oif);
-  NS_LOG_LOGIC ("Looking for route for destination " << dest);
-  Ptr<Ipv4Route> rtentry = 0;
-  // store all available routes that bring packets to their destination
-  typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-  RouteVec_t allRoutes;
-
-  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  NS_LOG_FUNCTION (this << prefix << length);
+  uint32_t current = 0;
+  while (true)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
+      if (m_fibNodes[current].length == length)
+        {
+          return current;
+        }
+      uint32_t bit = PrefixBit (prefix, m_fibNodes[current].length);
+      uint32_t next = m_fibNodes[current].child[bit];
+      FibNode node;
+      node.prefix = prefix;
+      node.length = length;
+      node.child[0] = FIB_NONE;
+      node.child[1] = FIB_NONE;
+      node.hostGroup = FIB_NONE;
+      node.networkGroup = FIB_NONE;
+      if (next == FIB_NONE)
         {
-          if (oif != 0)
+          m_fibNodes[current].child[bit] = m_fibNodes.size ();
+          m_fibNodes.push_back (node);
+          return m_fibNodes.size () - 1;
+        }
+      // Length of the prefix common to the new prefix and the child
+      uint32_t childLength = m_fibNodes[next].length;
+      uint32_t common = std::min (length, childLength);
+      uint32_t differ = (prefix ^ m_fibNodes[next].prefix) & PrefixMask (common);
+      if (differ != 0)
+        {
+          common = 0;
+          while (PrefixBit (differ, common) == 0)
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
+              common++;
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
         }
+      if (common == childLength)
+        {
+          current = next;
+          continue;
+        }
+      // Split the path to the child at the common prefix
+      uint32_t split = m_fibNodes.size ();
+      FibNode middle = node;
+      middle.prefix = prefix & PrefixMask (common);
+      middle.length = common;
+      middle.child[PrefixBit (m_fibNodes[next].prefix, common)] = next;
+      if (common == length)
+        {
+          m_fibNodes.push_back (middle);
+        }
+      else
+        {
+          middle.child[PrefixBit (prefix, common)] = split + 1;
+          m_fibNodes.push_back (middle);
+          m_fibNodes.push_back (node);
+        }
+      m_fibNodes[current].child[bit] = split;
+      return m_fibNodes.size () - 1;
+    }
+}
+
+void
+Ipv4GlobalRouting::BuildFib (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_fibNodes.clear ();
+  m_fibGroups.clear ();
+  FibNode root;
+  root.prefix = 0;
+  root.length = 0;
+  root.child[0] = FIB_NONE;
+  root.child[1] = FIB_NONE;
+  root.hostGroup = FIB_NONE;
+  root.networkGroup = FIB_NONE;
+  m_fibNodes.push_back (root);
+  for (HostRoutesCI i = m_hostRoutes.begin (); i != m_hostRoutes.end (); i++)
+    {
+      NS_ASSERT ((*i)->IsHost ());
+      uint32_t node = InsertFib ((*i)->GetDest ().Get (), 32);
+      if (m_fibNodes[node].hostGroup == FIB_NONE)
+        {
+          m_fibNodes[node].hostGroup = m_fibGroups.size ();
+          m_fibGroups.push_back (std::vector<Ipv4RoutingTableEntry *> ());
+        }
+      m_fibGroups[m_fibNodes[node].hostGroup].push_back (*i);
+    }
+  for (NetworkRoutesCI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+    {
+      uint32_t length = (*j)->GetDestNetworkMask ().GetPrefixLength ();
+      uint32_t prefix = (*j)->GetDestNetwork ().Get () & PrefixMask (length);
+      uint32_t node = InsertFib (prefix, length);
+      if (m_fibNodes[node].networkGroup == FIB_NONE)
+        {
+          m_fibNodes[node].networkGroup = m_fibGroups.size ();
+          m_fibGroups.push_back (std::vector<Ipv4RoutingTableEntry *> ());
+        }
+      m_fibGroups[m_fibNodes[node].networkGroup].push_back (*j);
     }
-  if (allRoutes.size () == 0) // if no host route is found
+  m_fibValid = true;
+  NS_LOG_LOGIC ("Forwarding table of " << m_fibNodes.size () << " nodes, "
+                << m_fibGroups.size () << " destinations");
+}
+
+Ipv4RoutingTableEntry *
+Ipv4GlobalRouting::SelectRoute (uint32_t group, Ptr<NetDevice> oif)
+{
+  const std::vector<Ipv4RoutingTableEntry *> &routes = m_fibGroups[group];
+  uint32_t count = routes.size ();
+  if (oif != 0)
     {
-      NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      count = 0;
+      for (uint32_t i = 0; i < routes.size (); i++)
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          if (oif == m_ipv4->GetNetDevice (routes[i]->GetInterface ()))
             {
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+              count++;
             }
         }
+      if (count == 0)
+        {
+          NS_LOG_LOGIC ("Not on requested interface, skipping");
+          return 0;
+        }
     }
-  if (allRoutes.size () == 0)  // consider external if no host/network found
+  // pick up one of the routes uniformly at random if random
+  // ECMP routing is enabled, or always select the first route
+  // consistently if random ECMP routing is disabled
+  uint32_t selectIndex = 0;
+  if (m_randomEcmpRouting)
+    {
+      selectIndex = m_rand->GetInteger (0, count - 1);
+    }
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      if (oif != 0 && oif != m_ipv4->GetNetDevice (routes[i]->GetInterface ()))
+        {
+          continue;
+        }
+      if (selectIndex == 0)
+        {
+          NS_LOG_LOGIC ("Found global route " << routes[i]);
+          return routes[i];
+        }
+      selectIndex--;
+    }
+  NS_ASSERT (false);
+  return 0;
+}
+
+Ptr<Ipv4Route>
+Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
+{
+  NS_LOG_FUNCTION (this << dest << oif);
+  NS_LOG_LOGIC ("Looking for route for destination " << dest);
+  if (!m_fibValid)
+    {
+      BuildFib ();
+    }
+  Ipv4RoutingTableEntry* route = 0;
+
+  // Walk down the trie, keeping the nodes of the prefixes matching dest
+  uint32_t address = dest.Get ();
+  uint32_t matches[33];
+  uint32_t nMatches = 0;
+  uint32_t current = 0;
+  while (current != FIB_NONE)
+    {
+      const FibNode &node = m_fibNodes[current];
+      if (((address ^ node.prefix) & PrefixMask (node.length)) != 0)
+        {
+          break;
+        }
+      if (node.hostGroup != FIB_NONE || node.networkGroup != FIB_NONE)
+        {
+          matches[nMatches++] = current;
+        }
+      if (node.length == 32)
+        {
+          break;
+        }
+      current = node.child[PrefixBit (address, node.length)];
+    }
+
+  if (nMatches > 0 && m_fibNodes[matches[nMatches - 1]].hostGroup != FIB_NONE)
+    {
+      route = SelectRoute (m_fibNodes[matches[nMatches - 1]].hostGroup, oif);
+    }
+  // if no host route is found, try the longest matching networks first
+  while (route == 0 && nMatches > 0)
+    {
+      uint32_t group = m_fibNodes[matches[--nMatches]].networkGroup;
+      if (group != FIB_NONE)
+        {
+          route = SelectRoute (group, oif);
+        }
+    }
+  if (route == 0)  // consider external if no host/network found
     {
       for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
            k != m_ASexternalRoutes.end ();
@@ -209,28 +393,15 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
                       continue;
                     }
                 }
-              allRoutes.push_back (*k);
+              route = *k;
               break;
             }
         }
     }
-  if (allRoutes.size () > 0 ) // if route(s) is found
+  if (route != 0) // if route is found
     {
-      // pick up one of the routes uniformly at random if random
-      // ECMP routing is enabled, or always select the first route
-      // consistently if random ECMP routing is disabled
-      uint32_t selectIndex;
-      if (m_randomEcmpRouting)
-        {
-          selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
-        }
-      else 
-        {
-          selectIndex = 0;
-        }
-      Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex); 
       // create a Ipv4Route object from the selected routing table entry
-      rtentry = Create<Ipv4Route> ();
+      Ptr<Ipv4Route> rtentry = Create<Ipv4Route> ();
       rtentry->SetDestination (route->GetDest ());
       /// \todo handle multi-address case
       rtentry->SetSource (m_ipv4->GetAddress (route->GetInterface (), 0).GetLocal ());
@@ -309,6 +480,8 @@ void
 Ipv4GlobalRouting::RemoveRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
+  m_fibValid = false;
+  NotifyRoutesChanged ();
   if (index < m_hostRoutes.size ())
     {
       uint32_t tmp = 0;
@@ -362,6 +535,46 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
   NS_ASSERT (false);
 }
 
+uint32_t
+Ipv4GlobalRouting::RemoveRoutesTo (std::set<Ipv4Address> const &hosts,
+                                   std::set<std::pair<Ipv4Address, uint32_t> > const &networks)
+{
+  NS_LOG_FUNCTION (this << hosts.size () << networks.size ());
+  m_fibValid = false;
+  NotifyRoutesChanged ();
+  uint32_t removed = 0;
+  HostRoutesI i = m_hostRoutes.begin ();
+  while (!hosts.empty () && i != m_hostRoutes.end ())
+    {
+      if (hosts.find ((*i)->GetDest ()) != hosts.end ())
+        {
+          delete *i;
+          i = m_hostRoutes.erase (i);
+          removed++;
+        }
+      else
+        {
+          i++;
+        }
+    }
+  NetworkRoutesI j = m_networkRoutes.begin ();
+  while (!networks.empty () && j != m_networkRoutes.end ())
+    {
+      std::pair<Ipv4Address, uint32_t> network ((*j)->GetDestNetwork (), (*j)->GetDestNetworkMask ().Get ());
+      if (networks.find (network) != networks.end ())
+        {
+          delete *j;
+          j = m_networkRoutes.erase (j);
+          removed++;
+        }
+      else
+        {
+          j++;
+        }
+    }
+  return removed;
+}
+
 int64_t
 Ipv4GlobalRouting::AssignStreams (int64_t stream)
 {
@@ -392,6 +605,10 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_fibNodes.clear ();
+  m_fibGroups.clear ();
+  m_fibValid = false;
+  NotifyRoutesChanged ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
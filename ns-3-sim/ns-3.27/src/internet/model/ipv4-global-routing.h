@@ -21,6 +21,9 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <set>
+#include <utility>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -65,6 +68,15 @@ class Node;
  *
  * This class deals with Ipv4 unicast routes only.
  *
+ * Lookups do not walk the lists of routes: the host and network routes
+ * are compiled into a path-compressed binary trie, the forwarding table,
+ * which is rebuilt on the first lookup after the routes change (e.g.
+ * after GlobalRouteManager::PopulateRoutingTables or RecomputeRoutingTables).
+ * Host routes are preferred, then the network route with the longest
+ * matching prefix.  The routes to the same destination are kept in the
+ * order they were added, as one equal-cost group which
+ * RandomEcmpRouting picks from.
+ *
  * \see Ipv4RoutingProtocol
  * \see GlobalRouteManager
  */
@@ -218,6 +230,20 @@ public:
    */
   void RemoveRoute (uint32_t i);
 
+  /**
+   * \brief Remove every route to some hosts and networks from the global
+   * unicast routing table, in a single pass over the routes.
+   *
+   * The routes to other destinations keep their order.
+   *
+   * \param hosts The host addresses of the routes to remove.
+   * \param networks The networks of the routes to remove, each with the
+   * value of its mask.
+   * \returns the number of routes removed
+   */
+  uint32_t RemoveRoutesTo (std::set<Ipv4Address> const &hosts,
+                           std::set<std::pair<Ipv4Address, uint32_t> > const &networks);
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -268,10 +294,46 @@ private:
    */
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
+  /// A node of the forwarding table trie
+  struct FibNode
+  {
+    uint32_t prefix;       //!< the prefix, with the bits past length cleared
+    uint32_t length;       //!< the prefix length
+    uint32_t child[2];     //!< index of the child for the next bit, or FIB_NONE
+    uint32_t hostGroup;    //!< index of the host routes to this /32, or FIB_NONE
+    uint32_t networkGroup; //!< index of the network routes to this prefix, or FIB_NONE
+  };
+
+  /// Value of the FibNode indexes for no child or no routes
+  static const uint32_t FIB_NONE = 0xffffffff;
+
+  /**
+   * \brief Compile the host and network routes into the forwarding table.
+   */
+  void BuildFib (void);
+  /**
+   * \brief Find or add the node of a prefix in the forwarding table.
+   * \param prefix the prefix
+   * \param length the prefix length
+   * \return the index of the node
+   */
+  uint32_t InsertFib (uint32_t prefix, uint32_t length);
+  /**
+   * \brief Pick one of the routes of an equal-cost group.
+   * \param group index of the group in m_fibGroups
+   * \param oif output interface if any (put 0 otherwise)
+   * \return the route, or 0 if no route of the group uses oif
+   */
+  Ipv4RoutingTableEntry *SelectRoute (uint32_t group, Ptr<NetDevice> oif);
+
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  std::vector<FibNode> m_fibNodes;     //!< Forwarding table trie, rooted at index 0
+  std::vector<std::vector<Ipv4RoutingTableEntry *> > m_fibGroups; //!< Equal-cost groups of the forwarding table
+  bool m_fibValid;                     //!< Whether the forwarding table matches the routes
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
@@ -41,6 +41,7 @@ Ipv4Header::Ipv4Header ()
     m_fragmentOffset (0),
     m_checksum (0),
     m_goodChecksum (true),
+    m_checksumUpdated (false),
     m_headerSize(5*4)
 {
 }
@@ -56,6 +57,7 @@ void
 Ipv4Header::SetPayloadSize (uint16_t size)
 {
   NS_LOG_FUNCTION (this << size);
+  m_checksumUpdated = false;
   m_payloadSize = size;
 }
 uint16_t
@@ -75,6 +77,7 @@ void
 Ipv4Header::SetIdentification (uint16_t identification)
 {
   NS_LOG_FUNCTION (this << identification);
+  m_checksumUpdated = false;
   m_identification = identification;
 }
 
@@ -82,6 +85,7 @@ void
 Ipv4Header::SetTos (uint8_t tos)
 {
   NS_LOG_FUNCTION (this << static_cast<uint32_t> (tos));
+  m_checksumUpdated = false;
   m_tos = tos;
 }
 
@@ -89,6 +93,7 @@ void
 Ipv4Header::SetDscp (DscpType dscp)
 {
   NS_LOG_FUNCTION (this << dscp);
+  m_checksumUpdated = false;
   m_tos &= 0x3; // Clear out the DSCP part, retain 2 bits of ECN
   m_tos |= (dscp << 2);
 }
@@ -97,6 +102,7 @@ void
 Ipv4Header::SetEcn (EcnType ecn)
 {
   NS_LOG_FUNCTION (this << ecn);
+  m_checksumUpdated = false;
   m_tos &= 0xFC; // Clear out the ECN part, retain 6 bits of DSCP
   m_tos |= ecn;
 }
@@ -200,12 +206,14 @@ void
 Ipv4Header::SetMoreFragments (void)
 {
   NS_LOG_FUNCTION (this);
+  m_checksumUpdated = false;
   m_flags |= MORE_FRAGMENTS;
 }
 void
 Ipv4Header::SetLastFragment (void)
 {
   NS_LOG_FUNCTION (this);
+  m_checksumUpdated = false;
   m_flags &= ~MORE_FRAGMENTS;
 }
 bool 
@@ -219,12 +227,14 @@ void
 Ipv4Header::SetDontFragment (void)
 {
   NS_LOG_FUNCTION (this);
+  m_checksumUpdated = false;
   m_flags |= DONT_FRAGMENT;
 }
 void 
 Ipv4Header::SetMayFragment (void)
 {
   NS_LOG_FUNCTION (this);
+  m_checksumUpdated = false;
   m_flags &= ~DONT_FRAGMENT;
 }
 bool 
@@ -238,6 +248,7 @@ void
 Ipv4Header::SetFragmentOffset (uint16_t offsetBytes)
 {
   NS_LOG_FUNCTION (this << offsetBytes);
+  m_checksumUpdated = false;
   // check if the user is trying to set an invalid offset
   NS_ABORT_MSG_IF ((offsetBytes & 0x7), "offsetBytes must be multiple of 8 bytes");
   m_fragmentOffset = offsetBytes;
@@ -259,8 +270,31 @@ void
 Ipv4Header::SetTtl (uint8_t ttl)
 {
   NS_LOG_FUNCTION (this << static_cast<uint32_t> (ttl));
+  m_checksumUpdated = false;
   m_ttl = ttl;
 }
+void
+Ipv4Header::DecrementTtl (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_ttl > 0);
+  if (!m_calcChecksum || !m_goodChecksum)
+    {
+      SetTtl (m_ttl - 1);
+      return;
+    }
+  // RFC 1624, eqn. 3: HC' = ~(~HC + ~m + m'), where m is the 16 bit word
+  // holding the TTL and the protocol.  The checksum is kept in the byte
+  // order of Buffer::Iterator::ReadU16, that of the words below.
+  uint32_t oldWord = m_ttl | (m_protocol << 8);
+  m_ttl--;
+  uint32_t newWord = m_ttl | (m_protocol << 8);
+  uint32_t sum = (~m_checksum & 0xffff) + (~oldWord & 0xffff) + newWord;
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  m_checksum = ~sum & 0xffff;
+  m_checksumUpdated = true;
+}
 uint8_t 
 Ipv4Header::GetTtl (void) const
 {
@@ -278,6 +312,7 @@ void
 Ipv4Header::SetProtocol (uint8_t protocol)
 {
   NS_LOG_FUNCTION (this << static_cast<uint32_t> (protocol));
+  m_checksumUpdated = false;
   m_protocol = protocol;
 }
 
@@ -285,6 +320,7 @@ void
 Ipv4Header::SetSource (Ipv4Address source)
 {
   NS_LOG_FUNCTION (this << source);
+  m_checksumUpdated = false;
   m_source = source;
 }
 Ipv4Address
@@ -298,6 +334,7 @@ void
 Ipv4Header::SetDestination (Ipv4Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
+  m_checksumUpdated = false;
   m_destination = dst;
 }
 Ipv4Address
@@ -409,7 +446,13 @@ Ipv4Header::Serialize (Buffer::Iterator start) const
   i.WriteHtonU32 (m_source.Get ());
   i.WriteHtonU32 (m_destination.Get ());
 
-  if (m_calcChecksum) 
+  if (m_calcChecksum && m_checksumUpdated)
+    {
+      i = start;
+      i.Next (10);
+      i.WriteU16 (m_checksum);
+    }
+  else if (m_calcChecksum) 
     {
       i = start;
       uint16_t checksum = i.CalculateIpChecksum (20);
@@ -461,6 +504,7 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
   m_source.Set (i.ReadNtohU32 ());
   m_destination.Set (i.ReadNtohU32 ());
   m_headerSize = headerSize;
+  m_checksumUpdated = false;
 
   if (m_calcChecksum) 
     {
@@ -22,6 +22,7 @@
 #define IPV4_HEADER_H
 
 #include "ns3/header.h"
+#include "ns3/header-view.h"
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -146,6 +147,14 @@ public:
    * \param ttl the ipv4 TTL
    */
   void SetTtl (uint8_t ttl);
+  /**
+   * \brief Decrement the TTL of a forwarded packet.
+   *
+   * If this header was deserialized with its checksum enabled and found
+   * correct, the checksum is updated incrementally (RFC 1624) instead of
+   * being computed again by Serialize, until another field is set.
+   */
+  void DecrementTtl (void);
   /**
    * \param num the ipv4 protocol field
    */
@@ -256,9 +265,159 @@ private:
   Ipv4Address m_destination; //!< destination address
   uint16_t m_checksum; //!< checksum
   bool m_goodChecksum; //!< true if checksum is correct
+  bool m_checksumUpdated; //!< true if m_checksum is that of the current fields
   uint16_t m_headerSize; //!< IP header size
 };
 
+/**
+ * \ingroup ipv4
+ *
+ * \brief Read-only view of the fixed part of an IPv4 header stored in the
+ * buffer of a packet.
+ *
+ * The options, if any, are not decoded; GetSerializedSize gives the
+ * offset of the next header.  The checksum is not verified.
+ *
+ * \see HeaderView
+ */
+class Ipv4HeaderView : public HeaderView
+{
+public:
+  /**
+   * \param packet the packet
+   * \param offset the offset of the header from the start of \p packet
+   * \returns true if the fixed part of an IPv4 header is stored
+   *          contiguously at \p offset
+   */
+  bool Peek (Ptr<const Packet> packet, uint32_t offset = 0);
+  /**
+   * \returns the size of the header, options included
+   */
+  uint32_t GetSerializedSize (void) const;
+  /**
+   * \returns the TOS field of this header.
+   */
+  uint8_t GetTos (void) const;
+  /**
+   * \returns the size of the payload in bytes
+   */
+  uint16_t GetPayloadSize (void) const;
+  /**
+   * \returns the identification field of this packet.
+   */
+  uint16_t GetIdentification (void) const;
+  /**
+   * \returns true if this is the last fragment of a packet, false otherwise.
+   */
+  bool IsLastFragment (void) const;
+  /**
+   * \returns true if this is this packet can be fragmented.
+   */
+  bool IsDontFragment (void) const;
+  /**
+   * \returns the offset of this fragment measured in bytes from the start.
+   */
+  uint16_t GetFragmentOffset (void) const;
+  /**
+   * \returns the TTL field of this packet
+   */
+  uint8_t GetTtl (void) const;
+  /**
+   * \returns the protocol field of this packet
+   */
+  uint8_t GetProtocol (void) const;
+  /**
+   * \returns the source address of this packet
+   */
+  Ipv4Address GetSource (void) const;
+  /**
+   * \returns the destination address of this packet
+   */
+  Ipv4Address GetDestination (void) const;
+
+  static const uint32_t SIZE = 20; //!< size of the fixed part of the header
+};
+
+inline bool
+Ipv4HeaderView::Peek (Ptr<const Packet> packet, uint32_t offset)
+{
+  if (!DoPeek (packet, offset, SIZE))
+    {
+      return false;
+    }
+  if ((ReadU8 (0) >> 4) != 4 || GetSerializedSize () < SIZE)
+    {
+      m_data = 0;
+    }
+  return IsValid ();
+}
+
+inline uint32_t
+Ipv4HeaderView::GetSerializedSize (void) const
+{
+  return (ReadU8 (0) & 0x0f) * 4;
+}
+
+inline uint8_t
+Ipv4HeaderView::GetTos (void) const
+{
+  return ReadU8 (1);
+}
+
+inline uint16_t
+Ipv4HeaderView::GetPayloadSize (void) const
+{
+  return ReadNtohU16 (2) - GetSerializedSize ();
+}
+
+inline uint16_t
+Ipv4HeaderView::GetIdentification (void) const
+{
+  return ReadNtohU16 (4);
+}
+
+inline bool
+Ipv4HeaderView::IsLastFragment (void) const
+{
+  return (ReadU8 (6) & (1 << 5)) == 0;
+}
+
+inline bool
+Ipv4HeaderView::IsDontFragment (void) const
+{
+  return (ReadU8 (6) & (1 << 6)) != 0;
+}
+
+inline uint16_t
+Ipv4HeaderView::GetFragmentOffset (void) const
+{
+  return (ReadNtohU16 (6) & 0x1fff) << 3;
+}
+
+inline uint8_t
+Ipv4HeaderView::GetTtl (void) const
+{
+  return ReadU8 (8);
+}
+
+inline uint8_t
+Ipv4HeaderView::GetProtocol (void) const
+{
+  return ReadU8 (9);
+}
+
+inline Ipv4Address
+Ipv4HeaderView::GetSource (void) const
+{
+  return Ipv4Address (ReadNtohU32 (12));
+}
+
+inline Ipv4Address
+Ipv4HeaderView::GetDestination (void) const
+{
+  return Ipv4Address (ReadNtohU32 (16));
+}
+
 } // namespace ns3
 
 
@@ -41,6 +41,9 @@
 #include "icmpv4-l4-protocol.h"
 #include "ipv4-interface.h"
 #include "ipv4-raw-socket-impl.h"
+#include "ipv4-list-routing.h"
+#include "ipv4-static-routing.h"
+#include "ipv4-global-routing.h"
 
 namespace ns3 {
 
@@ -69,6 +72,13 @@ Ipv4L3Protocol::GetTypeId (void)
                    TimeValue (Seconds (30)),
                    MakeTimeAccessor (&Ipv4L3Protocol::m_fragmentExpirationTimeout),
                    MakeTimeChecker ())
+    .AddAttribute ("FastForwarding",
+                   "Forward the unicast packets in transit on a shorter path, "
+                   "as long as no raw socket is open on this node.  The "
+                   "traces are called as on the normal path.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4L3Protocol::m_fastForwarding),
+                   MakeBooleanChecker ())
     .AddTraceSource ("Tx",
                      "Send ipv4 packet to outgoing interface.",
                      MakeTraceSourceAccessor (&Ipv4L3Protocol::m_txTrace),
@@ -108,6 +118,13 @@ Ipv4L3Protocol::GetTypeId (void)
 }
 
 Ipv4L3Protocol::Ipv4L3Protocol()
+  : m_forwardingCacheVersion (0),
+    m_cacheRoutes (false),
+    m_ipForwardCallback (MakeCallback (&Ipv4L3Protocol::IpForward, this)),
+    m_fastForwardCallback (MakeCallback (&Ipv4L3Protocol::FastForwardOut, this)),
+    m_ipMulticastForwardCallback (MakeCallback (&Ipv4L3Protocol::IpMulticastForward, this)),
+    m_localDeliverCallback (MakeCallback (&Ipv4L3Protocol::LocalDeliver, this)),
+    m_routeInputErrorCallback (MakeCallback (&Ipv4L3Protocol::RouteInputError, this))
 {
   NS_LOG_FUNCTION (this);
 }
@@ -271,6 +288,7 @@ Ipv4L3Protocol::SetRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol)
   NS_LOG_FUNCTION (this << routingProtocol);
   m_routingProtocol = routingProtocol;
   m_routingProtocol->SetIpv4 (this);
+  InvalidateForwardingCache ();
 }
 
 
@@ -299,6 +317,7 @@ Ipv4L3Protocol::DoDispose (void)
   m_reverseInterfacesContainer.clear ();
 
   m_sockets.clear ();
+  m_forwardingCache.clear ();
   m_node = 0;
   m_routingProtocol = 0;
 
@@ -556,13 +575,21 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
   int32_t interface = GetInterfaceForDevice(device);
   NS_ASSERT_MSG (interface != -1, "Received a packet from an interface that is not known to IPv4");
 
+  if (m_fastForwarding && m_sockets.empty () && FastForward (device, p, interface, from))
+    {
+      return;
+    }
+
   Ptr<Packet> packet = p->Copy ();
 
   Ptr<Ipv4Interface> ipv4Interface = m_interfaces[interface];
 
   if (ipv4Interface->IsUp ())
     {
-      m_rxTrace (packet, m_node->GetObject<Ipv4> (), interface);
+      if (!m_rxTrace.IsEmpty ())
+        {
+          m_rxTrace (packet, m_node->GetObject<Ipv4> (), interface);
+        }
     }
   else
     {
@@ -594,11 +621,164 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
     }
 
   // the packet is valid, we update the ARP cache entry (if present)
+  UpdateArpCache (ipv4Interface, ipHeader.GetSource (), from);
+
+  for (SocketList::iterator i = m_sockets.begin (); i != m_sockets.end (); ++i)
+    {
+      NS_LOG_LOGIC ("Forwarding to raw socket"); 
+      Ptr<Ipv4RawSocketImpl> socket = *i;
+      socket->ForwardUp (packet, ipHeader, ipv4Interface);
+    }
+
+  NS_ASSERT_MSG (m_routingProtocol != 0, "Need a routing protocol object to process packets");
+  if (!m_routingProtocol->RouteInput (packet, ipHeader, device,
+                                      m_ipForwardCallback,
+                                      m_ipMulticastForwardCallback,
+                                      m_localDeliverCallback,
+                                      m_routeInputErrorCallback))
+    {
+      NS_LOG_WARN ("No route found for forwarding packet.  Drop.");
+      m_dropTrace (ipHeader, packet, DROP_NO_ROUTE, m_node->GetObject<Ipv4> (), interface);
+    }
+}
+
+bool
+Ipv4L3Protocol::FastForward (Ptr<NetDevice> device, Ptr<const Packet> p,
+                             uint32_t interface, const Address &from)
+{
+  NS_LOG_FUNCTION (this << device << p << interface << from);
+
+  // Read the header in place to leave to the normal path the packets
+  // with options, those for this node and those whose TTL expires here
+  Ipv4HeaderView view;
+  if (!view.Peek (p)
+      || view.GetSerializedSize () != Ipv4HeaderView::SIZE
+      || view.GetTtl () <= 1
+      || IsDestinationAddress (view.GetDestination (), interface))
+    {
+      return false;
+    }
+  Ptr<Ipv4Interface> ipv4Interface = m_interfaces[interface];
+  if (!ipv4Interface->IsUp ())
+    {
+      return false;
+    }
+
+  Ptr<Packet> packet = p->Copy ();
+  if (!m_rxTrace.IsEmpty ())
+    {
+      m_rxTrace (packet, m_node->GetObject<Ipv4> (), interface);
+    }
+  Ipv4Header ipHeader;
+  if (Node::ChecksumEnabled ())
+    {
+      ipHeader.EnableChecksum ();
+    }
+  packet->RemoveHeader (ipHeader);
+  // Trim any residual frame padding from underlying devices
+  if (ipHeader.GetPayloadSize () < packet->GetSize ())
+    {
+      packet->RemoveAtEnd (packet->GetSize () - ipHeader.GetPayloadSize ());
+    }
+  if (!ipHeader.IsChecksumOk ())
+    {
+      NS_LOG_LOGIC ("Dropping received packet -- checksum not ok");
+      m_dropTrace (ipHeader, packet, DROP_BAD_CHECKSUM, m_node->GetObject<Ipv4> (), interface);
+      return true;
+    }
+  UpdateArpCache (ipv4Interface, ipHeader.GetSource (), from);
+
+  NS_ASSERT_MSG (m_routingProtocol != 0, "Need a routing protocol object to process packets");
+  if (IsForwarding (interface))
+    {
+      Ptr<Ipv4Route> route = LookupForwardingCache (ipHeader.GetDestination ());
+      if (route != 0)
+        {
+          FastForwardOut (route, packet, ipHeader);
+          return true;
+        }
+    }
+  if (!m_routingProtocol->RouteInput (packet, ipHeader, device,
+                                      m_fastForwardCallback,
+                                      m_ipMulticastForwardCallback,
+                                      m_localDeliverCallback,
+                                      m_routeInputErrorCallback))
+    {
+      NS_LOG_WARN ("No route found for forwarding packet.  Drop.");
+      m_dropTrace (ipHeader, packet, DROP_NO_ROUTE, m_node->GetObject<Ipv4> (), interface);
+    }
+  return true;
+}
+
+Ptr<Ipv4Route>
+Ipv4L3Protocol::LookupForwardingCache (Ipv4Address destination)
+{
+  NS_LOG_FUNCTION (this << destination);
+  uint32_t version = m_routingProtocol->GetRoutesVersion ();
+  if (version != m_forwardingCacheVersion)
+    {
+      m_forwardingCache.clear ();
+      m_forwardingCacheVersion = version;
+      m_cacheRoutes = CanCacheRoutes (m_routingProtocol);
+    }
+  ForwardingCache::const_iterator it = m_forwardingCache.find (destination);
+  if (it != m_forwardingCache.end ())
+    {
+      return it->second;
+    }
+  return 0;
+}
+
+bool
+Ipv4L3Protocol::CanCacheRoutes (Ptr<Ipv4RoutingProtocol> routing) const
+{
+  NS_LOG_FUNCTION (this << routing);
+  TypeId tid = routing->GetInstanceTypeId ();
+  if (tid == Ipv4ListRouting::GetTypeId ())
+    {
+      Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (routing);
+      for (uint32_t i = 0; i < list->GetNRoutingProtocols (); i++)
+        {
+          int16_t priority;
+          if (!CanCacheRoutes (list->GetRoutingProtocol (i, priority)))
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  if (tid == Ipv4StaticRouting::GetTypeId ())
+    {
+      return true;
+    }
+  if (tid == Ipv4GlobalRouting::GetTypeId ())
+    {
+      // A route picked at random for each packet cannot be kept
+      BooleanValue randomEcmp;
+      routing->GetAttribute ("RandomEcmpRouting", randomEcmp);
+      return !randomEcmp.Get ();
+    }
+  return false;
+}
+
+void
+Ipv4L3Protocol::InvalidateForwardingCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_forwardingCache.clear ();
+  m_forwardingCacheVersion = m_routingProtocol ? m_routingProtocol->GetRoutesVersion () - 1 : 0;
+  m_cacheRoutes = false;
+}
+
+void
+Ipv4L3Protocol::UpdateArpCache (Ptr<Ipv4Interface> ipv4Interface, Ipv4Address source, const Address &from)
+{
+  NS_LOG_FUNCTION (this << ipv4Interface << source << from);
   Ptr<ArpCache> arpCache = ipv4Interface->GetArpCache ();
   if (arpCache)
     {
       // case one, it's a a direct routing.
-      ArpCache::Entry *entry = arpCache->Lookup (ipHeader.GetSource ());
+      ArpCache::Entry *entry = arpCache->Lookup (source);
       if (entry)
         {
           if (entry->IsAlive ())
@@ -622,25 +802,6 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
             }
         }
     }
-
-  for (SocketList::iterator i = m_sockets.begin (); i != m_sockets.end (); ++i)
-    {
-      NS_LOG_LOGIC ("Forwarding to raw socket"); 
-      Ptr<Ipv4RawSocketImpl> socket = *i;
-      socket->ForwardUp (packet, ipHeader, ipv4Interface);
-    }
-
-  NS_ASSERT_MSG (m_routingProtocol != 0, "Need a routing protocol object to process packets");
-  if (!m_routingProtocol->RouteInput (packet, ipHeader, device,
-                                      MakeCallback (&Ipv4L3Protocol::IpForward, this),
-                                      MakeCallback (&Ipv4L3Protocol::IpMulticastForward, this),
-                                      MakeCallback (&Ipv4L3Protocol::LocalDeliver, this),
-                                      MakeCallback (&Ipv4L3Protocol::RouteInputError, this)
-                                      ))
-    {
-      NS_LOG_WARN ("No route found for forwarding packet.  Drop.");
-      m_dropTrace (ipHeader, packet, DROP_NO_ROUTE, m_node->GetObject<Ipv4> (), interface);
-    }
 }
 
 Ptr<Icmpv4L4Protocol> 
@@ -711,6 +872,10 @@ void
 Ipv4L3Protocol::CallTxTrace (const Ipv4Header & ipHeader, Ptr<Packet> packet,
                                     Ptr<Ipv4> ipv4, uint32_t interface)
 {
+  if (m_txTrace.IsEmpty ())
+    {
+      return;
+    }
   Ptr<Packet> packetCopy = packet->Copy ();
   packetCopy->AddHeader (ipHeader);
   m_txTrace (packetCopy, ipv4, interface);
@@ -925,7 +1090,7 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   Ptr<Ipv4Interface> outInterface = GetInterface (interface);
   NS_LOG_LOGIC ("Send via NetDevice ifIndex " << outDev->GetIfIndex () << " ipv4InterfaceIndex " << interface);
 
-  if (!route->GetGateway ().IsEqual (Ipv4Address ("0.0.0.0")))
+  if (!route->GetGateway ().IsEqual (Ipv4Address::GetZero ()))
     {
       if (outInterface->IsUp ())
         {
@@ -1057,6 +1222,51 @@ Ipv4L3Protocol::IpForward (Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, const Ip
   SendRealOut (rtentry, packet, ipHeader);
 }
 
+void
+Ipv4L3Protocol::FastForwardOut (Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, const Ipv4Header &header)
+{
+  NS_LOG_FUNCTION (this << rtentry << p << header);
+  Ptr<NetDevice> outDev = rtentry->GetOutputDevice ();
+  int32_t interface = GetInterfaceForDevice (outDev);
+  NS_ASSERT (interface >= 0);
+  Ptr<Ipv4Interface> outInterface = m_interfaces[interface];
+  if (header.GetTtl () <= 1 || !outInterface->IsUp ()
+      || p->GetSize () + header.GetSerializedSize () > outDev->GetMtu ())
+    {
+      IpForward (rtentry, p, header);
+      return;
+    }
+
+  if (m_cacheRoutes && m_forwardingCacheVersion == m_routingProtocol->GetRoutesVersion ())
+    {
+      m_forwardingCache[header.GetDestination ()] = rtentry;
+    }
+
+  Ipv4Header ipHeader = header;
+  // Updates the checksum verified by FastForward, if any, incrementally
+  ipHeader.DecrementTtl ();
+  Ptr<Packet> packet = p->Copy ();
+  // in case the packet still has a priority tag attached, remove it
+  SocketPriorityTag priorityTag;
+  packet->RemovePacketTag (priorityTag);
+  uint8_t priority = Socket::IpTos2Priority (ipHeader.GetTos ());
+  // add a priority tag if the priority is not null
+  if (priority)
+    {
+      priorityTag.SetPriority (priority);
+      packet->AddPacketTag (priorityTag);
+    }
+
+  m_unicastForwardTrace (ipHeader, packet, interface);
+  if (!m_txTrace.IsEmpty ())
+    {
+      CallTxTrace (ipHeader, packet, m_node->GetObject<Ipv4> (), interface);
+    }
+  Ipv4Address gateway = rtentry->GetGateway ();
+  outInterface->Send (packet, ipHeader,
+                      gateway == Ipv4Address::GetZero () ? ipHeader.GetDestination () : gateway);
+}
+
 void
 Ipv4L3Protocol::LocalDeliver (Ptr<const Packet> packet, Ipv4Header const&ip, uint32_t iif)
 {
@@ -1126,6 +1336,7 @@ Ipv4L3Protocol::AddAddress (uint32_t i, Ipv4InterfaceAddress address)
   NS_LOG_FUNCTION (this << i << address);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   bool retVal = interface->AddAddress (address);
+  InvalidateForwardingCache ();
   if (m_routingProtocol != 0)
     {
       m_routingProtocol->NotifyAddAddress (i, address);
@@ -1157,6 +1368,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, uint32_t addressIndex)
   Ipv4InterfaceAddress address = interface->RemoveAddress (addressIndex);
   if (address != Ipv4InterfaceAddress ())
     {
+      InvalidateForwardingCache ();
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, address);
@@ -1180,6 +1392,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, Ipv4Address address)
   Ipv4InterfaceAddress ifAddr = interface->RemoveAddress (address);
   if (ifAddr != Ipv4InterfaceAddress ())
     {
+      InvalidateForwardingCache ();
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, ifAddr);
@@ -1314,6 +1527,7 @@ Ipv4L3Protocol::SetUp (uint32_t i)
   if (interface->GetDevice ()->GetMtu () >= 68)
     {
       interface->SetUp ();
+      InvalidateForwardingCache ();
 
       if (m_routingProtocol != 0)
         {
@@ -1332,6 +1546,7 @@ Ipv4L3Protocol::SetDown (uint32_t ifaceIndex)
   NS_LOG_FUNCTION (this << ifaceIndex);
   Ptr<Ipv4Interface> interface = GetInterface (ifaceIndex);
   interface->SetDown ();
+  InvalidateForwardingCache ();
 
   if (m_routingProtocol != 0)
     {
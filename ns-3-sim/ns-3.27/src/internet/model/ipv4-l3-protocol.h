@@ -338,6 +338,76 @@ private:
              Ptr<const Packet> p, 
              const Ipv4Header &header);
 
+  /**
+   * \brief Forward a unicast packet in transit on the fast path, if it can be.
+   *
+   * Only the packets with no IP options, whose TTL does not expire on this
+   * node and which are not for this node take the fast path.  They skip the
+   * raw sockets, and the route found for them is given to FastForwardOut.
+   * When the checksums are enabled, the checksum is verified as on the
+   * normal path, and FastForwardOut updates it for the TTL decrement
+   * instead of computing it again.
+   *
+   * \param device network device the packet was received on
+   * \param p the packet, with its IPv4 header
+   * \param interface the interface index of the device
+   * \param from the hardware address of the previous hop
+   * \returns true if the packet was handled, false if it must take the
+   *          normal path
+   */
+  bool FastForward (Ptr<NetDevice> device, Ptr<const Packet> p,
+                    uint32_t interface, const Address &from);
+
+  /**
+   * \brief Send a packet forwarded on the fast path.
+   *
+   * The packet is handed to the output interface right away; the packets
+   * that need to be fragmented, or whose output interface is down, are
+   * given to IpForward instead.
+   *
+   * \param rtentry route
+   * \param p packet to forward
+   * \param header IPv4 header to add to the packet
+   */
+  void FastForwardOut (Ptr<Ipv4Route> rtentry,
+                       Ptr<const Packet> p,
+                       const Ipv4Header &header);
+
+  /**
+   * \brief Find the route of a packet in transit in the forwarding cache.
+   *
+   * The cache is emptied whenever the routes of the node change; it is only
+   * used when the routing protocol of the node is made of Ipv4StaticRouting
+   * and Ipv4GlobalRouting without random ECMP, whose routes only depend on
+   * the destination and whose changes are told by
+   * Ipv4RoutingProtocol::GetRoutesVersion.
+   *
+   * \param destination the destination of the packet
+   * \returns the route, or 0 if the routing protocol has to find it
+   */
+  Ptr<Ipv4Route> LookupForwardingCache (Ipv4Address destination);
+
+  /**
+   * \brief Check whether the routes of a routing protocol can be cached.
+   * \param routing the routing protocol
+   * \returns true if its routes can be kept in the forwarding cache
+   */
+  bool CanCacheRoutes (Ptr<Ipv4RoutingProtocol> routing) const;
+
+  /**
+   * \brief Empty the forwarding cache, and check again whether the routes
+   * can be cached at the next lookup.
+   */
+  void InvalidateForwardingCache (void);
+
+  /**
+   * \brief Refresh the ARP cache entries of the sender of a received packet.
+   * \param ipv4Interface the interface the packet was received on
+   * \param source the source address of the packet
+   * \param from the hardware address of the previous hop
+   */
+  void UpdateArpCache (Ptr<Ipv4Interface> ipv4Interface, Ipv4Address source, const Address &from);
+
   /**
    * \brief Forward a multicast packet.
    * \param mrtentry route
@@ -429,8 +499,7 @@ private:
    * \param ipv4 the Ipv4 protocol
    * \param interface the interface index
    *
-   * Note: If the TracedCallback API ever is extended, we could consider
-   * to check for connected functions before adding the header
+   * Nothing is copied when no function is connected to the trace.
    */
   void CallTxTrace (const Ipv4Header & ipHeader, Ptr<Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
 
@@ -458,6 +527,7 @@ private:
   typedef std::map<L4ListKey_t, Ptr<IpL4Protocol> > L4List_t;
 
   bool m_ipForward;      //!< Forwarding packets (i.e. router mode) state.
+  bool m_fastForwarding; //!< Forward the packets in transit on the fast path
   bool m_weakEsModel;    //!< Weak ES model state
   L4List_t m_protocols;  //!< List of transport protocol.
   Ipv4InterfaceList m_interfaces; //!< List of IPv4 interfaces.
@@ -492,6 +562,22 @@ private:
 
   SocketList m_sockets; //!< List of IPv4 raw sockets.
 
+  /**
+   * \brief Container of the routes of the fast path, by destination
+   */
+  typedef std::map<Ipv4Address, Ptr<Ipv4Route> > ForwardingCache;
+
+  ForwardingCache m_forwardingCache;   //!< Routes of the fast path, by destination
+  uint32_t m_forwardingCacheVersion;   //!< Version of the routes in the forwarding cache
+  bool m_cacheRoutes;                  //!< Whether the routes can be kept in the forwarding cache
+
+  // The callbacks given to the routing protocol for each received packet
+  Ipv4RoutingProtocol::UnicastForwardCallback m_ipForwardCallback;             //!< IpForward
+  Ipv4RoutingProtocol::UnicastForwardCallback m_fastForwardCallback;           //!< FastForwardOut
+  Ipv4RoutingProtocol::MulticastForwardCallback m_ipMulticastForwardCallback;  //!< IpMulticastForward
+  Ipv4RoutingProtocol::LocalDeliverCallback m_localDeliverCallback;            //!< LocalDeliver
+  Ipv4RoutingProtocol::ErrorCallback m_routeInputErrorCallback;                //!< RouteInputError
+
   /**
    * \brief A Set of Fragment belonging to the same packet (src, dst, identification and proto)
    */
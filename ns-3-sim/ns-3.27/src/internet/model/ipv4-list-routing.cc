@@ -85,6 +85,19 @@ Ipv4ListRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit
     }
 }
 
+uint32_t
+Ipv4ListRouting::GetRoutesVersion (void) const
+{
+  // Each version only grows, so the sum changes with any of them
+  uint32_t version = Ipv4RoutingProtocol::GetRoutesVersion ();
+  for (Ipv4RoutingProtocolList::const_iterator i = m_routingProtocols.begin ();
+       i != m_routingProtocols.end (); i++)
+    {
+      version += (*i).second->GetRoutesVersion ();
+    }
+  return version;
+}
+
 void
 Ipv4ListRouting::DoInitialize (void)
 {
@@ -259,6 +272,7 @@ Ipv4ListRouting::AddRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol, i
     {
       routingProtocol->SetIpv4 (m_ipv4);
     }
+  NotifyRoutesChanged ();
 }
 
 uint32_t 
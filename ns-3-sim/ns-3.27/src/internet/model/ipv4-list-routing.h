@@ -90,6 +90,11 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+  /**
+   * \returns the version of the list, changed when a routing protocol is
+   * added to it or when the routes of one of them change
+   */
+  virtual uint32_t GetRoutesVersion (void) const;
 
 protected:
   virtual void DoDispose (void);
@@ -36,4 +36,21 @@ TypeId Ipv4RoutingProtocol::GetTypeId (void)
   return tid;
 }
 
+Ipv4RoutingProtocol::Ipv4RoutingProtocol ()
+  : m_routesVersion (0)
+{
+}
+
+void
+Ipv4RoutingProtocol::NotifyRoutesChanged (void)
+{
+  m_routesVersion++;
+}
+
+uint32_t
+Ipv4RoutingProtocol::GetRoutesVersion (void) const
+{
+  return m_routesVersion;
+}
+
 } // namespace ns3
@@ -171,6 +171,32 @@ public:
    */
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const = 0;
 
+  /**
+   * \brief Get the version of the routes
+   *
+   * Ipv4L3Protocol keeps the routes found for its fast forwarding path
+   * (see its FastForwarding attribute) only for the routing protocols which
+   * call NotifyRoutesChanged each time their routes change, that is
+   * Ipv4StaticRouting, Ipv4GlobalRouting and Ipv4ListRouting, and drops
+   * them when the version of its routing protocol changes.
+   *
+   * \returns the number of calls to NotifyRoutesChanged so far
+   */
+  virtual uint32_t GetRoutesVersion (void) const;
+
+protected:
+  Ipv4RoutingProtocol ();
+
+  /**
+   * \brief Tell the node that the routes of this routing protocol changed
+   *
+   * The version is kept by each routing protocol, which is only changed by
+   * the thread computing the routes of its node.
+   */
+  void NotifyRoutesChanged (void);
+
+private:
+  uint32_t m_routesVersion; //!< Number of calls to NotifyRoutesChanged
 };
 
 } // namespace ns3
@@ -73,6 +73,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  NotifyRoutesChanged ();
 }
 
 void 
@@ -87,6 +88,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  NotifyRoutesChanged ();
 }
 
 void 
@@ -144,6 +146,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  NotifyRoutesChanged ();
 }
 
 uint32_t 
@@ -449,6 +452,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
         {
           delete j->first;
           m_networkRoutes.erase (j);
+          NotifyRoutesChanged ();
           return;
         }
       tmp++;
@@ -615,6 +619,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          NotifyRoutesChanged ();
         }
       else
         {
@@ -662,6 +667,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          NotifyRoutesChanged ();
         }
       else
         {
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include "ns3/header.h"
+#include "ns3/header-view.h"
 #include "ns3/tcp-option.h"
 #include "ns3/buffer.h"
 #include "ns3/tcp-socket-factory.h"
@@ -353,6 +354,117 @@ private:
   uint8_t m_optionsLen;        //!< Tcp options length.
 };
 
+/**
+ * \ingroup tcp
+ *
+ * \brief Read-only view of the fixed part of a TCP header stored in the
+ * buffer of a packet.
+ *
+ * The options, if any, are not decoded; GetLength gives the size of the
+ * header with its options.  The checksum is not verified.
+ *
+ * \see HeaderView
+ */
+class TcpHeaderView : public HeaderView
+{
+public:
+  /**
+   * \param packet the packet
+   * \param offset the offset of the header from the start of \p packet
+   * \returns true if the fixed part of a TCP header is stored
+   *          contiguously at \p offset
+   */
+  bool Peek (Ptr<const Packet> packet, uint32_t offset = 0);
+  /**
+   * \return The source port for this TcpHeader
+   */
+  uint16_t GetSourcePort (void) const;
+  /**
+   * \return the destination port for this TcpHeader
+   */
+  uint16_t GetDestinationPort (void) const;
+  /**
+   * \return the sequence number for this TcpHeader
+   */
+  SequenceNumber32 GetSequenceNumber (void) const;
+  /**
+   * \return the ACK number for this TcpHeader
+   */
+  SequenceNumber32 GetAckNumber (void) const;
+  /**
+   * \return the length of this TcpHeader in 32-bit words
+   */
+  uint8_t GetLength (void) const;
+  /**
+   * \return the flags for this TcpHeader
+   */
+  uint8_t GetFlags (void) const;
+  /**
+   * \return the window size for this TcpHeader
+   */
+  uint16_t GetWindowSize (void) const;
+  /**
+   * \return the urgent pointer for this TcpHeader
+   */
+  uint16_t GetUrgentPointer (void) const;
+
+  static const uint32_t SIZE = 20; //!< size of the fixed part of the header
+};
+
+inline bool
+TcpHeaderView::Peek (Ptr<const Packet> packet, uint32_t offset)
+{
+  return DoPeek (packet, offset, SIZE);
+}
+
+inline uint16_t
+TcpHeaderView::GetSourcePort (void) const
+{
+  return ReadNtohU16 (0);
+}
+
+inline uint16_t
+TcpHeaderView::GetDestinationPort (void) const
+{
+  return ReadNtohU16 (2);
+}
+
+inline SequenceNumber32
+TcpHeaderView::GetSequenceNumber (void) const
+{
+  return SequenceNumber32 (ReadNtohU32 (4));
+}
+
+inline SequenceNumber32
+TcpHeaderView::GetAckNumber (void) const
+{
+  return SequenceNumber32 (ReadNtohU32 (8));
+}
+
+inline uint8_t
+TcpHeaderView::GetLength (void) const
+{
+  return ReadU8 (12) >> 4;
+}
+
+inline uint8_t
+TcpHeaderView::GetFlags (void) const
+{
+  return ReadU8 (13) & 0x3f;
+}
+
+inline uint16_t
+TcpHeaderView::GetWindowSize (void) const
+{
+  return ReadNtohU16 (14);
+}
+
+inline uint16_t
+TcpHeaderView::GetUrgentPointer (void) const
+{
+  return ReadNtohU16 (18);
+}
+
 } // namespace ns3
 
 #endif /* TCP_HEADER */
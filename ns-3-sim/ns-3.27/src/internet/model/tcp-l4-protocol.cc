@@ -23,6 +23,7 @@
 #include "ns3/nstime.h"
 #include "ns3/boolean.h"
 #include "ns3/object-vector.h"
+#include "ns3/config.h"
 
 #include "ns3/packet.h"
 #include "ns3/node.h"
@@ -193,6 +194,7 @@ TcpL4Protocol::CreateSocket (TypeId congestionTypeId)
   socket->SetCongestionControlAlgorithm (algo);
 
   m_sockets.push_back (socket);
+  Config::InvalidateCache ();
   return socket;
 }
 
@@ -703,6 +705,7 @@ TcpL4Protocol::AddSocket (Ptr<TcpSocketBase> socket)
     }
 
   m_sockets.push_back (socket);
+  Config::InvalidateCache ();
 }
 
 bool
@@ -716,6 +719,7 @@ TcpL4Protocol::RemoveSocket (Ptr<TcpSocketBase> socket)
       if (*it == socket)
         {
           m_sockets.erase (it);
+          Config::InvalidateCache ();
           return true;
         }
 
@@ -725,6 +729,19 @@ TcpL4Protocol::RemoveSocket (Ptr<TcpSocketBase> socket)
   return false;
 }
 
+uint32_t
+TcpL4Protocol::GetNSockets (void) const
+{
+  return m_sockets.size ();
+}
+
+Ptr<TcpSocketBase>
+TcpL4Protocol::GetSocket (uint32_t i) const
+{
+  NS_ASSERT (i < m_sockets.size ());
+  return m_sockets[i];
+}
+
 void
 TcpL4Protocol::SetDownTarget (IpL4Protocol::DownTargetCallback callback)
 {
@@ -222,6 +222,21 @@ public:
    */
   bool RemoveSocket (Ptr<TcpSocketBase> socket);
 
+  /**
+   * \brief Get the number of sockets in the internal list
+   *
+   * \return the number of sockets made operational by AddSocket
+   */
+  uint32_t GetNSockets (void) const;
+
+  /**
+   * \brief Get a socket of the internal list
+   *
+   * \param i index of the socket, lower than GetNSockets
+   * \return the socket
+   */
+  Ptr<TcpSocketBase> GetSocket (uint32_t i) const;
+
   /**
    * \brief Remove an IPv4 Endpoint.
    * \param endPoint the end point to remove
@@ -156,29 +156,32 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
-  while (i != m_data.end () && i->first <= tailSeq)
+  // Remove overlapped bytes from packet: the head is trimmed to the end of
+  // the block that holds it, the tail to the start of the block that holds
+  // it, and the blocks fully embedded in between are replaced
+  if (headSeq < tailSeq)
     {
-      SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      if (lastByteSeq > headSeq)
+      BlockMap::iterator i = m_blocks.upper_bound (headSeq);
+      if (i != m_blocks.begin ())
         {
-          if (i->first > headSeq && lastByteSeq < tailSeq)
-            { // Rare case: Existing packet is embedded fully in the new packet
-              m_size -= i->second->GetSize ();
-              m_data.erase (i++);
-              continue;
-            }
-          if (i->first <= headSeq)
+          BlockMap::iterator prev = i;
+          --prev;
+          if (prev->second > headSeq)
             { // Incoming head is overlapped
-              headSeq = lastByteSeq;
+              headSeq = prev->second;
             }
-          if (lastByteSeq >= tailSeq)
+        }
+      while (i != m_blocks.end () && i->first < tailSeq)
+        {
+          if (i->second >= tailSeq)
             { // Incoming tail is overlapped
               tailSeq = i->first;
+              break;
             }
+          // Rare case: Existing block is embedded fully in the new packet
+          RemoveBlock (i->first, i->second);
+          m_blocks.erase (i++);
         }
-      ++i;
     }
   // We now know how much we are going to store, trim the packet
   if (headSeq >= tailSeq)
@@ -196,28 +199,41 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   // Insert packet into buffer
   NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
   m_data [ headSeq ] = p;
+  m_size += p->GetSize ();      // Occupancy
+  NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
 
-  if (headSeq > m_nextRxSeq)
+  // Join the packet with the blocks it touches
+  SequenceNumber32 blockHead = headSeq;
+  SequenceNumber32 blockTail = tailSeq;
+  BlockMap::iterator next = m_blocks.lower_bound (headSeq);
+  if (next != m_blocks.end () && next->first == tailSeq)
     {
-      // Generate a new SACK block
-      UpdateSackList (headSeq, tailSeq);
+      blockTail = next->second;
+      m_blocks.erase (next++);
     }
-
-  NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
-  // Update variables
-  m_size += p->GetSize ();      // Occupancy
-  for (i = m_data.begin (); i != m_data.end (); ++i)
+  if (next != m_blocks.begin ())
     {
-      if (i->first < m_nextRxSeq)
+      BlockMap::iterator prev = next;
+      --prev;
+      if (prev->second == headSeq)
         {
-          continue;
+          blockHead = prev->first;
+          m_blocks.erase (prev);
         }
-      else if (i->first > m_nextRxSeq)
-        {
-          break;
-        };
-      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      m_availBytes += i->second->GetSize ();
+    }
+
+  if (headSeq > m_nextRxSeq)
+    {
+      // Generate a new SACK block, for the whole block holding the packet
+      UpdateSackList (blockHead, blockTail);
+      m_blocks.insert (next, std::make_pair (blockHead, blockTail));
+    }
+  else
+    {
+      // The block is now in sequence
+      NS_ASSERT (blockHead == m_nextRxSeq);
+      m_availBytes += blockTail - m_nextRxSeq;
+      m_nextRxSeq = blockTail;
       ClearSackList (m_nextRxSeq);
     }
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
@@ -228,6 +244,19 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   return true;
 }
 
+void
+TcpRxBuffer::RemoveBlock (const SequenceNumber32 &head, const SequenceNumber32 &tail)
+{
+  NS_LOG_FUNCTION (this << head << tail);
+
+  BufIterator i = m_data.lower_bound (head);
+  while (i != m_data.end () && i->first < tail)
+    {
+      m_size -= i->second->GetSize ();
+      m_data.erase (i++);
+    }
+}
+
 uint32_t
 TcpRxBuffer::GetSackListSize () const
 {
@@ -274,50 +303,22 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
 
   m_sackList.push_front (current);
 
-  // We have inserted the block at the beginning of the list. Now, we should
-  // check if any existing blocks overlap with that.
-  bool updated = false;
+  // The block is the whole contiguous block held around the segment: the
+  // blocks already in the list that it spans are subsets of it, and point
+  // (c) above asks to drop them.
   TcpOptionSack::SackList::iterator it = m_sackList.begin ();
-  TcpOptionSack::SackBlock begin = *it;
-  TcpOptionSack::SackBlock merged;
   ++it;
-
-  // Iterates until we examined all blocks in the list (maximum 4)
   while (it != m_sackList.end ())
     {
-      current = *it;
-
-      // This is a left merge:
-      // [current_first; current_second] [beg_first; beg_second]
-      if (begin.first == current.second)
-        {
-          NS_ASSERT (current.first < begin.second);
-          merged = TcpOptionSack::SackBlock (current.first, begin.second);
-          updated = true;
-        }
-      // while this is a right merge
-      // [begin_first; begin_second] [current_first; current_second]
-      else if (begin.second == current.first)
+      if (it->first >= head && it->second <= tail)
         {
-          NS_ASSERT (begin.first < current.second);
-          merged = TcpOptionSack::SackBlock (begin.first, current.second);
-          updated = true;
+          it = m_sackList.erase (it);
         }
-
-      // If we have merged the blocks (and the result is in merged) we should
-      // delete the current block (it), the first block, and insert the merged
-      // one at the beginning.
-      if (updated)
+      else
         {
-          m_sackList.erase (it);
-          m_sackList.pop_front ();
-          m_sackList.push_front (merged);
-          it = m_sackList.begin ();
-          begin = *it;
-          updated = false;
+          NS_ASSERT (it->second < head || it->first > tail);
+          ++it;
         }
-
-      ++it;
     }
 
   // Since the maximum blocks that fits into a TCP header are 4, there's no
@@ -326,11 +327,6 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
     {
       m_sackList.pop_back ();
     }
-
-  // Please note that, if a block b is discarded and then a block contiguos
-  // to b is received, only that new block (without the b part) is reported.
-  // This is perfectly fine for the RFC point (a), given that we do not report any
-  // overlapping blocks shortly after.
 }
 
 void
@@ -370,30 +366,38 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return 0;  // No contiguous block to return
   NS_ASSERT (m_data.size ()); // At least we have something to extract
-  Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
+  Ptr<Packet> outPkt; // A copy of the first packet extracted, with the others appended
   BufIterator i;
   while (extractSize)
     { // Check the buffered data for delivery
       i = m_data.begin ();
       NS_ASSERT (i->first <= m_nextRxSeq); // in-sequence data expected
       // Check if we send the whole pkt or just a partial
-      uint32_t pktSize = i->second->GetSize ();
+      Ptr<Packet> pkt = i->second;
+      uint32_t pktSize = pkt->GetSize ();
       if (pktSize <= extractSize)
         { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
           m_data.erase (i);
-          m_size -= pktSize;
-          m_availBytes -= pktSize;
-          extractSize -= pktSize;
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
-          m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
+          SequenceNumber32 restSeq = i->first + SequenceNumber32 (extractSize);
+          Ptr<Packet> rest = pkt->CreateFragment (extractSize, pktSize - extractSize);
+          pkt = pkt->CreateFragment (0, extractSize);
           m_data.erase (i);
-          m_size -= extractSize;
-          m_availBytes -= extractSize;
-          extractSize = 0;
+          m_data.insert (m_data.begin (), std::make_pair (restSeq, rest));
+          pktSize = extractSize;
+        }
+      m_size -= pktSize;
+      m_availBytes -= pktSize;
+      extractSize -= pktSize;
+      if (outPkt == 0)
+        { // The stored packet may be referenced elsewhere: copy-on-write
+          outPkt = pkt->Copy ();
+        }
+      else
+        {
+          outPkt->AddAtEnd (pkt);
         }
     }
   if (outPkt->GetSize () == 0)
@@ -401,6 +405,8 @@ TcpRxBuffer::Extract (uint32_t maxSize)
       NS_LOG_LOGIC ("Nothing extracted.");
       return 0;
     }
+  // The packet tags of the segment do not belong to the data delivered
+  outPkt->RemoveAllPacketTags ();
   NS_LOG_LOGIC ("Extracted " << outPkt->GetSize ( ) << " bytes, bufsize=" << m_size
                              << ", num pkts in buffer=" << m_data.size ());
   return outPkt;
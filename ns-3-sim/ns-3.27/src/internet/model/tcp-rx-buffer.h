@@ -53,6 +53,19 @@ class Packet;
  * To store data, use Add; for retrieving a certain amount of ordered data, use
  * the method Extract.
  *
+ * Reassembly
+ * ----------
+ *
+ * The data is kept as the packets received, trimmed of the bytes already
+ * held, in a map indexed by their first sequence number. Next to them, the
+ * blocks of contiguous data held beyond NextRxSequence are kept as an
+ * interval set, so that Add finds the bytes it overlaps, and the block it
+ * joins, with a lookup instead of a walk over every packet stored.
+ *
+ * Extract delivers the first packet held as it is, and appends the
+ * following ones to it; the buffer owns the packets it stores, so no
+ * intermediate copy is made, and zero-filled payloads stay virtual.
+ *
  * SACK list
  * ---------
  *
@@ -179,6 +192,10 @@ private:
   /**
    * \brief Update the sack list, with the block seq starting at the beginning
    *
+   * The block given is the whole block of contiguous data held around the
+   * segment just received, as RFC 2018 asks for the first SACK block; the
+   * blocks of the list it spans are removed.
+   *
    * Note: the maximum size of the block list is 4. Caller is free to
    * drop blocks at the end to accomodate header size; from RFC 2018:
    *
@@ -211,8 +228,19 @@ private:
 
   TcpOptionSack::SackList m_sackList; //!< Sack list (updated constantly)
 
+  /**
+   * \brief Remove the packets stored in a block of data
+   *
+   * \param head sequence number of the first byte of the block
+   * \param tail sequence number following the last byte of the block
+   */
+  void RemoveBlock (const SequenceNumber32 &head, const SequenceNumber32 &tail);
+
   /// container for data stored in the buffer
   typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
+  /// blocks of contiguous data, from their first sequence number to the one following their last byte
+  typedef std::map<SequenceNumber32, SequenceNumber32> BlockMap;
+  BlockMap m_blocks;                         //!< Blocks of data held beyond m_nextRxSeq
   TracedValue<SequenceNumber32> m_nextRxSeq; //!< Seqnum of the first missing byte in data (RCV.NXT)
   SequenceNumber32 m_finSeq;                 //!< Seqnum of the FIN packet
   bool m_gotFin;                             //!< Did I received FIN packet?
@@ -308,6 +308,7 @@ TcpSocketBase::TcpSocketBase (void)
     m_synRetries (0),
     m_dataRetrCount (0),
     m_dataRetries (0),
+    m_retransmits (0),
     m_rto (Seconds (0.0)),
     m_minRto (Time::Max ()),
     m_clockGranularity (Seconds (0.001)),
@@ -398,6 +399,7 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_synRetries (sock.m_synRetries),
     m_dataRetrCount (sock.m_dataRetrCount),
     m_dataRetries (sock.m_dataRetries),
+    m_retransmits (0),
     m_rto (sock.m_rto),
     m_minRto (sock.m_minRto),
     m_clockGranularity (sock.m_clockGranularity),
@@ -2775,6 +2777,7 @@ TcpSocketBase::SendDataPacketReal (SequenceNumber32 seq, uint32_t maxSize, bool
   if (seq != m_tcb->m_highTxMark)
     {
       isRetransmission = true;
+      m_retransmits++;
     }
 
   ////////////////////////////////////////////////////////
@@ -359,6 +359,12 @@ public:
    */
   friend class TcpGeneralTest;
 
+  /**
+   * \brief TcpStateSampler friend class, to read the state it samples.
+   * \relates TcpStateSampler
+   */
+  friend class TcpStateSampler;
+
   /**
    * Create an unbound TCP socket
    */
@@ -1142,6 +1148,7 @@ protected:
   uint32_t          m_synRetries;      //!< Number of connection attempts
   uint32_t          m_dataRetrCount;   //!< Count of remaining data retransmission attempts
   uint32_t          m_dataRetries;     //!< Number of data retransmission attempts
+  uint32_t          m_retransmits;     //!< Number of data segments retransmitted
   TracedValue<Time> m_rto;             //!< Retransmit timeout
   Time              m_minRto;          //!< minimum value of the Retransmit timeout
   Time              m_clockGranularity; //!< Clock Granularity used in RTO calcs
@@ -0,0 +1,328 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-state-sampler.h"
+#include "tcp-l4-protocol.h"
+#include "tcp-socket-base.h"
+#include "rtt-estimator.h"
+#include "ipv4-end-point.h"
+#include "ipv6-end-point.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/node-list.h"
+#include "ns3/simulator.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpStateSampler");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpStateSampler);
+
+TypeId
+TcpStateSampler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpStateSampler")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpStateSampler> ()
+    .AddAttribute ("Interval",
+                   "The time between samples.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&TcpStateSampler::m_interval),
+                   MakeTimeChecker (Time (1)))
+  ;
+  return tid;
+}
+
+TcpStateSampler::TcpStateSampler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpStateSampler::~TcpStateSampler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TcpStateSampler::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_sampleEvent);
+  Simulator::Cancel (m_stopEvent);
+  DisableStreaming ();
+  m_protocols.clear ();
+  Object::DoDispose ();
+}
+
+bool
+TcpStateSampler::FlowLess::operator() (const Flow &a, const Flow &b) const
+{
+  if (a.node != b.node)
+    {
+      return a.node < b.node;
+    }
+  if (a.local != b.local)
+    {
+      return a.local < b.local;
+    }
+  return a.peer < b.peer;
+}
+
+void
+TcpStateSampler::Install (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  Ptr<TcpL4Protocol> tcp = node->GetObject<TcpL4Protocol> ();
+  NS_ASSERT_MSG (tcp != 0, "TcpStateSampler needs TCP on node " << node->GetId ());
+  m_protocols.push_back (tcp);
+}
+
+void
+TcpStateSampler::Install (NodeContainer nodes)
+{
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      Install (*i);
+    }
+}
+
+void
+TcpStateSampler::InstallAll (void)
+{
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      if ((*i)->GetObject<TcpL4Protocol> () != 0)
+        {
+          Install (*i);
+        }
+    }
+}
+
+void
+TcpStateSampler::Start (const Time &time)
+{
+  NS_LOG_FUNCTION (this << time);
+  Simulator::Cancel (m_sampleEvent);
+  m_sampleEvent = Simulator::Schedule (time, &TcpStateSampler::PeriodicSample, this);
+}
+
+void
+TcpStateSampler::Stop (const Time &time)
+{
+  NS_LOG_FUNCTION (this << time);
+  Simulator::Cancel (m_stopEvent);
+  m_stopEvent = Simulator::Schedule (time, &TcpStateSampler::StopNow, this);
+}
+
+void
+TcpStateSampler::StopNow (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_sampleEvent);
+}
+
+void
+TcpStateSampler::PeriodicSample (void)
+{
+  Sample ();
+  m_sampleEvent = Simulator::Schedule (m_interval, &TcpStateSampler::PeriodicSample, this);
+}
+
+uint32_t
+TcpStateSampler::GetFlowId (Ptr<TcpSocketBase> socket)
+{
+  Flow flow;
+  flow.node = socket->m_node->GetId ();
+  if (socket->m_endPoint != 0)
+    {
+      flow.local = InetSocketAddress (socket->m_endPoint->GetLocalAddress (),
+                                      socket->m_endPoint->GetLocalPort ());
+      flow.peer = InetSocketAddress (socket->m_endPoint->GetPeerAddress (),
+                                     socket->m_endPoint->GetPeerPort ());
+    }
+  else
+    {
+      flow.local = Inet6SocketAddress (socket->m_endPoint6->GetLocalAddress (),
+                                       socket->m_endPoint6->GetLocalPort ());
+      flow.peer = Inet6SocketAddress (socket->m_endPoint6->GetPeerAddress (),
+                                      socket->m_endPoint6->GetPeerPort ());
+    }
+  std::pair<std::map<Flow, uint32_t, FlowLess>::iterator, bool> inserted =
+    m_flowIds.insert (std::make_pair (flow, m_flows.size ()));
+  if (inserted.second)
+    {
+      m_flows.push_back (flow);
+    }
+  return inserted.first->second;
+}
+
+void
+TcpStateSampler::Sample (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_stream.is_open ())
+    {
+      Clear ();
+    }
+  Time now = Simulator::Now ();
+  for (std::vector<Ptr<TcpL4Protocol> >::const_iterator i = m_protocols.begin ();
+       i != m_protocols.end (); ++i)
+    {
+      uint32_t n = (*i)->GetNSockets ();
+      for (uint32_t j = 0; j < n; ++j)
+        {
+          Ptr<TcpSocketBase> socket = (*i)->GetSocket (j);
+          // Only the sockets with a peer have a state worth sampling
+          if (socket->m_state == TcpSocket::LISTEN
+              || (socket->m_endPoint == 0 && socket->m_endPoint6 == 0))
+            {
+              continue;
+            }
+          m_samples.time.push_back (now);
+          m_samples.flowId.push_back (GetFlowId (socket));
+          m_samples.cWnd.push_back (socket->m_tcb->m_cWnd);
+          m_samples.ssThresh.push_back (socket->m_tcb->m_ssThresh);
+          m_samples.srtt.push_back (socket->m_rtt->GetEstimate ());
+          m_samples.rttVar.push_back (socket->m_rtt->GetVariation ());
+          m_samples.bytesInFlight.push_back (socket->BytesInFlight ());
+          m_samples.retransmits.push_back (socket->m_retransmits);
+          m_samples.pacingRate.push_back (socket->m_tcb->GetPacingRate ());
+        }
+    }
+  if (m_stream.is_open ())
+    {
+      WriteRows (m_stream);
+      m_stream.flush ();
+    }
+}
+
+void
+TcpStateSampler::EnableStreaming (std::string fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  DisableStreaming ();
+  m_stream.open (fileName.c_str (), std::ios::out | std::ios::trunc);
+  NS_ABORT_MSG_UNLESS (m_stream.is_open (), "Cannot open " << fileName);
+  m_stream << "time,flowId,node,local,peer,cWnd,ssThresh,srtt,rttVar,bytesInFlight,retransmits,pacingRate"
+           << std::endl;
+}
+
+void
+TcpStateSampler::DisableStreaming (void)
+{
+  if (m_stream.is_open ())
+    {
+      m_stream.close ();
+    }
+}
+
+/**
+ * \brief Write an address and port as address:port
+ * \param os the stream to write to
+ * \param address an InetSocketAddress or an Inet6SocketAddress
+ */
+static void
+WriteSocketAddress (std::ostream &os, const Address &address)
+{
+  if (InetSocketAddress::IsMatchingType (address))
+    {
+      InetSocketAddress inet = InetSocketAddress::ConvertFrom (address);
+      os << inet.GetIpv4 () << ":" << inet.GetPort ();
+    }
+  else
+    {
+      Inet6SocketAddress inet6 = Inet6SocketAddress::ConvertFrom (address);
+      os << inet6.GetIpv6 () << ":" << inet6.GetPort ();
+    }
+}
+
+void
+TcpStateSampler::WriteRows (std::ostream &os) const
+{
+  for (uint32_t i = 0; i < m_samples.time.size (); ++i)
+    {
+      const Flow &flow = m_flows[m_samples.flowId[i]];
+      os << m_samples.time[i].GetSeconds () << ","
+         << m_samples.flowId[i] << ","
+         << flow.node << ",";
+      WriteSocketAddress (os, flow.local);
+      os << ",";
+      WriteSocketAddress (os, flow.peer);
+      os << "," << m_samples.cWnd[i]
+         << "," << m_samples.ssThresh[i]
+         << "," << m_samples.srtt[i].GetSeconds ()
+         << "," << m_samples.rttVar[i].GetSeconds ()
+         << "," << m_samples.bytesInFlight[i]
+         << "," << m_samples.retransmits[i]
+         << "," << m_samples.pacingRate[i]
+         << "\n";
+    }
+}
+
+void
+TcpStateSampler::SerializeToCsvFile (std::string fileName) const
+{
+  NS_LOG_FUNCTION (this << fileName);
+  std::ofstream os (fileName.c_str (), std::ios::out | std::ios::trunc);
+  NS_ABORT_MSG_UNLESS (os.is_open (), "Cannot open " << fileName);
+  os << "time,flowId,node,local,peer,cWnd,ssThresh,srtt,rttVar,bytesInFlight,retransmits,pacingRate"
+     << std::endl;
+  WriteRows (os);
+}
+
+const TcpStateSampler::Samples &
+TcpStateSampler::GetSamples (void) const
+{
+  return m_samples;
+}
+
+uint32_t
+TcpStateSampler::GetNRows (void) const
+{
+  return m_samples.time.size ();
+}
+
+uint32_t
+TcpStateSampler::GetNFlows (void) const
+{
+  return m_flows.size ();
+}
+
+const TcpStateSampler::Flow &
+TcpStateSampler::GetFlow (uint32_t flowId) const
+{
+  NS_ASSERT (flowId < m_flows.size ());
+  return m_flows[flowId];
+}
+
+void
+TcpStateSampler::Clear (void)
+{
+  m_samples.time.clear ();
+  m_samples.flowId.clear ();
+  m_samples.cWnd.clear ();
+  m_samples.ssThresh.clear ();
+  m_samples.srtt.clear ();
+  m_samples.rttVar.clear ();
+  m_samples.bytesInFlight.clear ();
+  m_samples.retransmits.clear ();
+  m_samples.pacingRate.clear ();
+}
+
+} // namespace ns3
@@ -0,0 +1,211 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STATE_SAMPLER_H
+#define TCP_STATE_SAMPLER_H
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/address.h"
+#include "ns3/node-container.h"
+
+namespace ns3 {
+
+class TcpL4Protocol;
+class TcpSocketBase;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Periodic samples of the state of TCP sockets
+ *
+ * Every Interval, the sampler reads the state of each connected socket of
+ * the nodes it is installed on, and appends it to a table kept in memory
+ * one column per quantity: the congestion window, the slow start
+ * threshold, the smoothed RTT and its variation, the bytes in flight, the
+ * number of segments retransmitted so far and the pacing rate.  It costs
+ * one event per interval for all the sockets, where the trace sources of
+ * TcpSocketBase fire a callback at each change of each socket.
+ *
+ * Each socket is identified by a flow id, given the first time the
+ * sampler sees its node, local and peer address; see GetFlow.
+ *
+ * The table can be read with GetSamples, or written to a file of
+ * comma-separated values with SerializeToCsvFile.  With EnableStreaming,
+ * the rows of each sample are written to the file right away instead,
+ * and the table only holds those of the last sample.
+ */
+class TcpStateSampler : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  TcpStateSampler ();
+  virtual ~TcpStateSampler ();
+
+  /// The node and the addresses of a socket
+  struct Flow
+  {
+    uint32_t node;  //!< Id of the node of the socket
+    Address local;  //!< Local address and port of the socket
+    Address peer;   //!< Peer address and port of the socket
+  };
+
+  /// The samples, one row per socket in each sample
+  struct Samples
+  {
+    std::vector<Time> time;              //!< Time of the sample
+    std::vector<uint32_t> flowId;        //!< Flow id of the socket
+    std::vector<uint32_t> cWnd;          //!< Congestion window, in bytes
+    std::vector<uint32_t> ssThresh;      //!< Slow start threshold, in bytes
+    std::vector<Time> srtt;              //!< Smoothed RTT
+    std::vector<Time> rttVar;            //!< Variation of the RTT
+    std::vector<uint32_t> bytesInFlight; //!< Bytes in flight
+    std::vector<uint32_t> retransmits;   //!< Data segments retransmitted so far
+    std::vector<double> pacingRate;      //!< Pacing rate, in Mb/s
+  };
+
+  /**
+   * \brief Sample the sockets of a node
+   * \param node the node, with an internet stack
+   */
+  void Install (Ptr<Node> node);
+  /**
+   * \brief Sample the sockets of some nodes
+   * \param nodes the nodes, with an internet stack
+   */
+  void Install (NodeContainer nodes);
+  /// Sample the sockets of all the nodes with an internet stack
+  void InstallAll (void);
+
+  /**
+   * \brief Start sampling at a given time
+   * \param time the time of the first sample, counting from now
+   */
+  void Start (const Time &time);
+  /**
+   * \brief Stop sampling at a given time
+   * \param time the time after which no sample is taken, counting from now
+   */
+  void Stop (const Time &time);
+
+  /// Take a sample right now
+  void Sample (void);
+
+  /**
+   * \brief Write the rows of each sample to a file as soon as it is taken
+   *
+   * The file is written as by SerializeToCsvFile; it is closed when the
+   * sampler is disposed of, or when DisableStreaming is called.
+   *
+   * \param fileName name or path of the output file that will be created
+   */
+  void EnableStreaming (std::string fileName);
+  /// Close the file the samples are streamed to
+  void DisableStreaming (void);
+
+  /**
+   * \brief Write the table to a file of comma-separated values
+   *
+   * The file starts with the line of column names:
+   *
+   * time,flowId,node,local,peer,cWnd,ssThresh,srtt,rttVar,bytesInFlight,retransmits,pacingRate
+   *
+   * where time, srtt and rttVar are in seconds, and local and peer are an
+   * address and a port separated by a colon.
+   *
+   * \param fileName name or path of the output file that will be created
+   */
+  void SerializeToCsvFile (std::string fileName) const;
+
+  /**
+   * \brief Get the table of samples
+   * \return the samples taken, or the last one only when streaming
+   */
+  const Samples &GetSamples (void) const;
+  /**
+   * \brief Get the number of rows in the table
+   * \return the number of rows in the table
+   */
+  uint32_t GetNRows (void) const;
+  /**
+   * \brief Get the number of flows seen so far
+   * \return the number of flows seen so far
+   */
+  uint32_t GetNFlows (void) const;
+  /**
+   * \brief Get the node and the addresses of a flow
+   * \param flowId the flow id, lower than GetNFlows
+   * \return the node and the addresses of the flow
+   */
+  const Flow &GetFlow (uint32_t flowId) const;
+  /// Remove all the rows of the table
+  void Clear (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// Take a sample, and schedule the next one
+  void PeriodicSample (void);
+  /// Stop sampling right now
+  void StopNow (void);
+  /**
+   * \brief Get the flow id of a socket, giving it one if it has none yet
+   * \param socket the socket
+   * \return the flow id
+   */
+  uint32_t GetFlowId (Ptr<TcpSocketBase> socket);
+  /**
+   * \brief Write the rows of the table
+   * \param os the stream to write to
+   */
+  void WriteRows (std::ostream &os) const;
+
+  /// Ordering of the flows, by node and addresses
+  struct FlowLess
+  {
+    /**
+     * \param a a flow
+     * \param b another flow
+     * \return true if a comes before b
+     */
+    bool operator() (const Flow &a, const Flow &b) const;
+  };
+
+  Time m_interval;                               //!< Time between samples
+  std::vector<Ptr<TcpL4Protocol> > m_protocols;  //!< TCP of the nodes sampled
+  std::vector<Flow> m_flows;                     //!< The flows, indexed by flow id
+  std::map<Flow, uint32_t, FlowLess> m_flowIds;  //!< Flow id of each flow
+  Samples m_samples;                             //!< The table of samples
+  EventId m_sampleEvent;                         //!< Next sample
+  EventId m_stopEvent;                           //!< Stop of the sampling
+  std::ofstream m_stream;                        //!< File the samples are streamed to
+};
+
+} // namespace ns3
+
+#endif /* TCP_STATE_SAMPLER_H */
@@ -38,7 +38,8 @@ TcpTxItem::TcpTxItem ()
     m_lost (false),
     m_retrans (false),
     m_lastSent (Time::Min ()),
-    m_sacked (false)
+    m_sacked (false),
+    m_startSeq (0)
 {
 }
 
@@ -47,7 +48,8 @@ TcpTxItem::TcpTxItem (const TcpTxItem &other)
     m_lost (other.m_lost),
     m_retrans (other.m_retrans),
     m_lastSent (other.m_lastSent),
-    m_sacked (other.m_sacked)
+    m_sacked (other.m_sacked),
+    m_startSeq (other.m_startSeq)
 {
 }
 
@@ -112,7 +114,10 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
+  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n),
+    m_retransCount (0), m_lostCount (0), m_outstandingBytes (0), m_holeBytes (0),
+    m_lossBoundary (n), m_lossBoundaryValid (false), m_lossDupThresh (0),
+    m_lossSegmentSize (0), m_retransHint (n)
 {
 }
 
@@ -179,7 +184,9 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
 
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lossBoundary = seq;
+  m_lossBoundaryValid = false;
+  m_retransHint = seq;
 }
 
 bool
@@ -243,13 +250,14 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
     }
 
   TcpTxItem *outItem = 0;
+  bool retrans = false;
 
   if (m_firstByteSeq + m_sentSize >= seq + s)
     {
       // already sent this block completely
       outItem = GetTransmittedSegment (s, seq);
       NS_ASSERT (outItem != 0);
-      outItem->m_retrans = true;
+      retrans = true;
 
       NS_LOG_DEBUG ("Retransmitting [" << seq << ";" << seq + s << "|" << s <<
                     "] from " << *this);
@@ -284,8 +292,14 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
       return CopyFromSequence (numBytes, seq);
     }
 
+  RemoveFromScoreboard (outItem);
+  if (retrans)
+    {
+      outItem->m_retrans = true;
+    }
   outItem->m_lost = false;
   outItem->m_lastSent = Simulator::Now ();
+  AddToScoreboard (outItem);
   Ptr<Packet> toRet = outItem->m_packet->Copy ();
 
   NS_ASSERT (toRet->GetSize () == s);
@@ -306,13 +320,14 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
 
   (void) listEdited;
 
-  // Move item from AppList to SentList (should be the first, not too complex)
-  PacketList::iterator it = std::find (m_appList.begin (), m_appList.end (), item);
-  NS_ASSERT (it != m_appList.end ());
+  // Move item from AppList to SentList (it is the first)
+  NS_ASSERT (m_appList.front () == item);
 
-  m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  m_appList.pop_front ();
+  m_sentList.push_back (item);
   m_sentSize += item->m_packet->GetSize ();
+  item->m_startSeq = startOfAppList;
+  AddToScoreboard (item);
 
   return item;
 }
@@ -328,38 +343,207 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
 
   TcpTxItem *item = GetPacketFromList (m_sentList, m_firstByteSeq, numBytes, seq, &listEdited);
 
-  if (listEdited && m_highestSack.second >= m_firstByteSeq)
-    {
-      m_highestSack = GetHighestSacked ();
-    }
+  (void) listEdited;
 
   return item;
 }
 
-std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
-TcpTxBuffer::GetHighestSacked () const
+/**
+ * \brief Compare the start of a segment with a sequence number
+ * \param item the segment
+ * \param seq the sequence number
+ * \return true if the segment starts before seq
+ */
+static bool
+StartsBefore (const TcpTxItem *item, const SequenceNumber32 &seq)
 {
-  NS_LOG_FUNCTION (this);
+  return item->m_startSeq < seq;
+}
 
-  PacketList::const_iterator it;
-  std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32> ret;
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
+uint32_t
+TcpTxBuffer::FindSegment (const SequenceNumber32 &seq) const
+{
+  return std::lower_bound (m_sentList.begin (), m_sentList.end (), seq, StartsBefore)
+         - m_sentList.begin ();
+}
 
-  ret = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+void
+TcpTxBuffer::AddToScoreboard (const TcpTxItem *item)
+{
+  uint32_t size = item->m_packet->GetSize ();
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  if (item->m_retrans)
     {
-      const TcpTxItem *item = *it;
-      if (item->m_sacked)
+      ++m_retransCount;
+    }
+  if (item->m_lost)
+    {
+      ++m_lostCount;
+    }
+
+  if (item->m_sacked)
+    {
+      // Join the ranges which end where the segment starts, and start where
+      // it ends
+      SequenceNumber32 start = item->m_startSeq;
+      SequenceNumber32 end = start + size;
+      SackedRanges::iterator next = m_sackedRanges.lower_bound (start);
+      NS_ASSERT (next == m_sackedRanges.end () || next->first >= end);
+      if (next != m_sackedRanges.end () && next->first == end)
+        {
+          end = next->second;
+          m_sackedRanges.erase (next++);
+        }
+      if (next != m_sackedRanges.begin ())
         {
-          ret = std::make_pair (it, beginOfCurrentPacket);
+          SackedRanges::iterator previous = next;
+          --previous;
+          NS_ASSERT (previous->second <= start);
+          if (previous->second == start)
+            {
+              previous->second = end;
+              m_lossBoundaryValid = false;
+              return;
+            }
         }
-      beginOfCurrentPacket += item->m_packet->GetSize ();
+      m_sackedRanges.insert (next, std::make_pair (start, end));
+      m_lossBoundaryValid = false;
+      return;
     }
 
-  return ret;
+  if (!item->m_retrans && item->m_startSeq < m_retransHint)
+    {
+      m_retransHint = item->m_startSeq;
+    }
+  if (!item->m_lost)
+    {
+      m_outstandingBytes += size;
+      if (!item->m_retrans && item->m_startSeq < m_lossBoundary)
+        {
+          m_holeBytes += size;
+        }
+    }
 }
 
+void
+TcpTxBuffer::RemoveFromScoreboard (const TcpTxItem *item)
+{
+  uint32_t size = item->m_packet->GetSize ();
+
+  if (item->m_retrans)
+    {
+      --m_retransCount;
+    }
+  if (item->m_lost)
+    {
+      --m_lostCount;
+    }
+
+  if (item->m_sacked)
+    {
+      // Cut the segment out of its range
+      SequenceNumber32 start = item->m_startSeq;
+      SequenceNumber32 end = start + size;
+      SackedRanges::iterator range = m_sackedRanges.upper_bound (start);
+      NS_ASSERT (range != m_sackedRanges.begin ());
+      --range;
+      SequenceNumber32 rangeEnd = range->second;
+      NS_ASSERT (range->first <= start && end <= rangeEnd);
+      if (range->first < start)
+        {
+          range->second = start;
+        }
+      else
+        {
+          m_sackedRanges.erase (range);
+        }
+      if (end < rangeEnd)
+        {
+          m_sackedRanges.insert (std::make_pair (end, rangeEnd));
+        }
+      m_lossBoundaryValid = false;
+      return;
+    }
+
+  if (!item->m_lost)
+    {
+      m_outstandingBytes -= size;
+      if (!item->m_retrans && item->m_startSeq < m_lossBoundary)
+        {
+          m_holeBytes -= size;
+        }
+    }
+}
+
+void
+TcpTxBuffer::UpdateLossBoundary (uint32_t dupThresh, uint32_t segmentSize) const
+{
+  if (m_lossBoundaryValid && m_lossDupThresh == dupThresh
+      && m_lossSegmentSize == segmentSize)
+    {
+      return;
+    }
+
+  // From RFC 6675:
+  // > The routine returns true when either dupThresh discontiguous SACKed
+  // > sequences have arrived above 'seq' or more than (dupThresh - 1) * SMSS bytes
+  // > with sequence numbers greater than 'SeqNum' have been SACKed.  Otherwise, the
+  // > routine returns false.
+  // Walk down the SACKed segments from the highest one, until either
+  // condition holds: it holds for the segments below the last one walked.
+  SequenceNumber32 boundary = m_firstByteSeq;
+  uint32_t count = 0;
+  uint32_t bytes = 0;
+  bool found = false;
+  SackedRanges::const_reverse_iterator range;
+  for (range = m_sackedRanges.rbegin (); range != m_sackedRanges.rend () && !found; ++range)
+    {
+      uint32_t i = FindSegment (range->second);
+      while (i > 0 && m_sentList[i - 1]->m_startSeq >= range->first)
+        {
+          const TcpTxItem *item = m_sentList[--i];
+          NS_ASSERT (item->m_sacked);
+          ++count;
+          bytes += item->m_packet->GetSize ();
+          if ((count >= dupThresh) || (bytes > (dupThresh - 1) * segmentSize))
+            {
+              boundary = item->m_startSeq;
+              found = true;
+              break;
+            }
+        }
+    }
+
+  // Count the holes between the old and the new boundary in, or out
+  if (boundary != m_lossBoundary)
+    {
+      bool up = boundary > m_lossBoundary;
+      SequenceNumber32 low = up ? m_lossBoundary : boundary;
+      SequenceNumber32 high = up ? boundary : m_lossBoundary;
+      for (uint32_t i = FindSegment (low);
+           i < m_sentList.size () && m_sentList[i]->m_startSeq < high; ++i)
+        {
+          const TcpTxItem *item = m_sentList[i];
+          if (!item->m_sacked && !item->m_lost && !item->m_retrans)
+            {
+              if (up)
+                {
+                  m_holeBytes += item->m_packet->GetSize ();
+                }
+              else
+                {
+                  m_holeBytes -= item->m_packet->GetSize ();
+                }
+            }
+        }
+      NS_LOG_LOGIC ("Loss boundary moved from " << m_lossBoundary << " to " << boundary);
+      m_lossBoundary = boundary;
+    }
+
+  m_lossBoundaryValid = true;
+  m_lossDupThresh = dupThresh;
+  m_lossSegmentSize = segmentSize;
+}
 
 void
 TcpTxBuffer::SplitItems (TcpTxItem &t1, TcpTxItem &t2, uint32_t size) const
@@ -373,12 +557,14 @@ TcpTxBuffer::SplitItems (TcpTxItem &t1, TcpTxItem &t2, uint32_t size) const
   t1.m_lastSent = t2.m_lastSent;
   t1.m_retrans = t2.m_retrans;
   t1.m_lost = t2.m_lost;
+  t1.m_startSeq = t2.m_startSeq;
+  t2.m_startSeq += size;
 }
 
 TcpTxItem*
 TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listStartFrom,
                                 uint32_t numBytes, const SequenceNumber32 &seq,
-                                bool *listEdited) const
+                                bool *listEdited)
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
 
@@ -401,148 +587,113 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
    *
    * We can have mixed case (e.g. seq over the boundary while numBytes not).
    *
-   * If we discover that we are in (2) or in a mixed case, we split
-   * packets accordingly to the requested bounds and re-run the function.
-   *
-   * In (1), things are pretty easy, it's just a matter of walking the list and
-   * defragment packets, if needed (e.g. seq is the beginning of the first packet
-   * while maxBytes is the end of some packet next in the list).
+   * If we discover that we are in (2) or in a mixed case, we split the
+   * packet which contains seq, so that a packet begins with seq, and then
+   * merge the packets which follow into it, or split it again, so that it
+   * ends after numBytes.
    */
 
-  Ptr<Packet> currentPacket = 0;
-  TcpTxItem *currentItem = 0;
-  TcpTxItem *outItem = 0;
-  PacketList::iterator it = list.begin ();
-  SequenceNumber32 beginOfCurrentPacket = listStartFrom;
+  // The segments of the sent list are in the scoreboard: take them out of
+  // it before editing them, and put the results back
+  bool scored = &list == &m_sentList;
 
-  while (it != list.end ())
+  uint32_t i = 0;
+  SequenceNumber32 beginOfCurrentPacket = listStartFrom;
+  if (scored)
     {
-      currentItem = *it;
-      currentPacket = currentItem->m_packet;
+      // Jump to the last segment which starts at or before seq
+      i = FindSegment (seq + 1) - 1;
+      beginOfCurrentPacket = list[i]->m_startSeq;
+    }
 
-      // The objective of this snippet is to find (or to create) the packet
-      // that begin with the sequence seq
+  // Walk the list, until the current packet contains seq
+  while (seq >= beginOfCurrentPacket + list[i]->m_packet->GetSize ())
+    {
+      beginOfCurrentPacket += list[i]->m_packet->GetSize ();
+      ++i;
+      NS_ABORT_MSG_IF (i == list.size (), "Requested a sequence beyond the list");
+    }
 
-      if (seq < beginOfCurrentPacket + currentPacket->GetSize ())
+  if (seq > beginOfCurrentPacket)
+    {
+      // seq is inside the current packet but seq is not the beginning,
+      // it's somewhere in the middle. Just fragment the beginning.
+      NS_LOG_INFO ("we are at " << beginOfCurrentPacket <<
+                   " searching for " << seq <<
+                   " and now we fragment because packet ends at "
+                                << beginOfCurrentPacket + list[i]->m_packet->GetSize ());
+      TcpTxItem *firstPart = new TcpTxItem ();
+      if (scored)
         {
-          // seq is inside the current packet
-          if (seq == beginOfCurrentPacket)
-            {
-              // seq is the beginning of the current packet. Hurray!
-              outItem = currentItem;
-              NS_LOG_INFO ("Current packet starts at seq " << seq <<
-                           " ends at " << seq + currentPacket->GetSize ());
-            }
-          else if (seq > beginOfCurrentPacket)
-            {
-              // seq is inside the current packet but seq is not the beginning,
-              // it's somewhere in the middle. Just fragment the beginning and
-              // start again.
-              NS_LOG_INFO ("we are at " << beginOfCurrentPacket <<
-                           " searching for " << seq <<
-                           " and now we recurse because packet ends at "
-                                        << beginOfCurrentPacket + currentPacket->GetSize ());
-              TcpTxItem *firstPart = new TcpTxItem ();
-              SplitItems (*firstPart, *currentItem, seq - beginOfCurrentPacket);
-
-              // insert firstPart before currentItem
-              list.insert (it, firstPart);
-              *listEdited = true;
-
-              return GetPacketFromList (list, listStartFrom, numBytes, seq, listEdited);
-            }
-          else
-            {
-              NS_FATAL_ERROR ("seq < beginOfCurrentPacket: our data is before");
-            }
+          RemoveFromScoreboard (list[i]);
         }
-      else
+      SplitItems (*firstPart, *list[i], seq - beginOfCurrentPacket);
+      if (scored)
         {
-          // Walk the list, the current packet does not contain seq
-          beginOfCurrentPacket += currentPacket->GetSize ();
-          it++;
-          continue;
+          AddToScoreboard (firstPart);
+          AddToScoreboard (list[i]);
         }
 
-      NS_ASSERT (outItem != 0);
-
-      // The objective of this snippet is to find (or to create) the packet
-      // that ends after numBytes bytes. We are sure that outPacket starts
-      // at seq.
+      // insert firstPart before the current packet
+      list.insert (list.begin () + i, firstPart);
+      ++i;
+      *listEdited = true;
+    }
 
-      if (seq + numBytes <= beginOfCurrentPacket + currentPacket->GetSize ())
+  // The current packet starts with seq. While it does not contain the
+  // requested end, merge the packet that follows into it
+  TcpTxItem *outItem = list[i];
+  while (outItem->m_packet->GetSize () < numBytes && i + 1 < list.size ())
+    {
+      TcpTxItem *next = list[i + 1];
+      if (scored)
         {
-          // the end boundary is inside the current packet
-          if (numBytes == currentPacket->GetSize ())
-            {
-              // the end boundary is exactly the end of the current packet. Hurray!
-              if (currentItem->m_packet == outItem->m_packet)
-                {
-                  // A perfect match!
-                  return outItem;
-                }
-              else
-                {
-                  // the end is exactly the end of current packet, but
-                  // current > outPacket in the list. Merge current with the
-                  // previous, and recurse.
-                  NS_ASSERT (it != list.begin ());
-                  TcpTxItem *previous = *(--it);
-
-                  list.erase (it);
-
-                  MergeItems (*previous, *currentItem);
-                  delete currentItem;
-                  *listEdited = true;
-
-                  return GetPacketFromList (list, listStartFrom, numBytes, seq, listEdited);
-                }
-            }
-          else if (numBytes < currentPacket->GetSize ())
-            {
-              // the end is inside the current packet, but it isn't exactly
-              // the packet end. Just fragment, fix the list, and return.
-              TcpTxItem *firstPart = new TcpTxItem ();
-              SplitItems (*firstPart, *currentItem, numBytes);
-
-              // insert firstPart before currentItem
-              list.insert (it, firstPart);
-              *listEdited = true;
-
-              return firstPart;
-            }
+          RemoveFromScoreboard (outItem);
+          RemoveFromScoreboard (next);
         }
-      else
+      MergeItems (*outItem, *next);
+      if (scored)
         {
-          // The end isn't inside current packet, but there is an exception for
-          // the merge and recurse strategy...
-          if (++it == list.end ())
-            {
-              // ...current is the last packet we sent. We have not more data;
-              // Go for this one.
-              NS_LOG_WARN ("Cannot reach the end, but this case is covered "
-                           "with conditional statements inside CopyFromSequence."
-                           "Something has gone wrong, report a bug");
-              return outItem;
-            }
-
-          // The current packet does not contain the requested end. Merge current
-          // with the packet that follows, and recurse
-          TcpTxItem *next = (*it); // Please remember we have incremented it
-                                   // in the previous if
-
-          MergeItems (*currentItem, *next);
-          list.erase (it);
-
-          delete next;
-
-          *listEdited = true;
+          AddToScoreboard (outItem);
+        }
+      list.erase (list.begin () + i + 1);
+      delete next;
+      *listEdited = true;
+    }
 
-          return GetPacketFromList (list, listStartFrom, numBytes, seq, listEdited);
+  if (outItem->m_packet->GetSize () < numBytes)
+    {
+      // ...current is the last packet we sent. We have not more data;
+      // Go for this one.
+      NS_LOG_WARN ("Cannot reach the end, but this case is covered "
+                   "with conditional statements inside CopyFromSequence."
+                   "Something has gone wrong, report a bug");
+    }
+  else if (outItem->m_packet->GetSize () > numBytes)
+    {
+      // the end is inside the current packet, but it isn't exactly
+      // the packet end. Just fragment, fix the list, and return.
+      TcpTxItem *firstPart = new TcpTxItem ();
+      if (scored)
+        {
+          RemoveFromScoreboard (outItem);
+        }
+      SplitItems (*firstPart, *outItem, numBytes);
+      if (scored)
+        {
+          AddToScoreboard (firstPart);
+          AddToScoreboard (outItem);
         }
+
+      // insert firstPart before the current packet
+      list.insert (list.begin () + i, firstPart);
+      *listEdited = true;
+      outItem = firstPart;
     }
 
-  NS_FATAL_ERROR ("This point is not reachable");
+  NS_LOG_INFO ("Current packet starts at seq " << seq <<
+               " ends at " << seq + outItem->m_packet->GetSize ());
+  return outItem;
 }
 
 void
@@ -589,27 +740,26 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   // Scan the buffer and discard packets
   uint32_t offset = seq - m_firstByteSeq.Get ();  // Number of bytes to remove
   uint32_t pktSize;
-  PacketList::iterator i = m_sentList.begin ();
   while (m_size > 0 && offset > 0)
     {
-      if (i == m_sentList.end ())
+      if (m_sentList.empty ())
         {
           Ptr<Packet> p = CopyFromSequence (offset, m_firstByteSeq);
           NS_ASSERT (p != 0);
-          i = m_sentList.begin ();
-          NS_ASSERT (i != m_sentList.end ());
+          NS_ASSERT (!m_sentList.empty ());
         }
-      TcpTxItem *item = *i;
+      TcpTxItem *item = m_sentList.front ();
       Ptr<Packet> p = item->m_packet;
       pktSize = p->GetSize ();
 
+      RemoveFromScoreboard (item);
       if (offset >= pktSize)
         { // This packet is behind the seqnum. Remove this packet from the buffer
           m_size -= pktSize;
           m_sentSize -= pktSize;
           offset -= pktSize;
           m_firstByteSeq += pktSize;
-          i = m_sentList.erase (i);
+          m_sentList.pop_front ();
           delete item;
           NS_LOG_INFO ("While removing up to " << seq <<
                        ".Removed one packet of size " << pktSize <<
@@ -621,6 +771,8 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           pktSize -= offset;
           // PacketTags are preserved when fragmenting
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
+          item->m_startSeq += offset;
+          AddToScoreboard (item);
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
@@ -643,15 +795,12 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           // It is not possible to have the UNA sacked; otherwise, it would
           // have been ACKed. This is, most likely, our wrong guessing
           // when crafting the SACK option for a non-SACK receiver.
+          RemoveFromScoreboard (head);
           head->m_sacked = false;
+          AddToScoreboard (head);
         }
     }
 
-  if (m_highestSack.second <= m_firstByteSeq)
-    {
-      m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
-    }
-
   NS_LOG_DEBUG ("Discarded up to " << seq);
   NS_LOG_LOGIC ("Buffer status after discarding data " << *this);
   NS_ASSERT (m_firstByteSeq >= seq);
@@ -667,126 +816,73 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
   NS_LOG_INFO ("Updating scoreboard, got " << list.size () << " blocks to analyze");
   for (option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      Ptr<Packet> current;
-      TcpTxItem *item;
       const TcpOptionSack::SackBlock b = (*option_it);
 
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
-      while (item_it != m_sentList.end ())
+      // Walk the segments which begin in the block
+      uint32_t i = FindSegment (b.first);
+      while (i < m_sentList.size ())
         {
-          item = *item_it;
-          current = item->m_packet;
+          TcpTxItem *item = m_sentList[i];
+          SequenceNumber32 beginOfCurrentPacket = item->m_startSeq;
+          SequenceNumber32 endOfCurrentPacket = beginOfCurrentPacket + item->m_packet->GetSize ();
 
           // Check the boundary of this packet ... only mark as sacked if
           // it is precisely mapped over the option
-          if (beginOfCurrentPacket >= b.first
-              && beginOfCurrentPacket + current->GetSize () <= b.second)
-            {
-              if (item->m_sacked)
-                {
-                  NS_LOG_INFO ("Received block [" << b.first << ";" << b.second <<
-                               ", checking sentList for block " << beginOfCurrentPacket <<
-                               ";" << beginOfCurrentPacket + current->GetSize () <<
-                               "], found in the sackboard already sacked");
-                }
-              else
-                {
-                  item->m_sacked = true;
-                  NS_LOG_INFO ("Received block [" << b.first << ";" << b.second <<
-                               ", checking sentList for block " << beginOfCurrentPacket <<
-                               ";" << beginOfCurrentPacket + current->GetSize () <<
-                               "], found in the sackboard, sacking");
-                  if (m_highestSack.second <= beginOfCurrentPacket + current->GetSize ())
-                    {
-                      PacketList::iterator new_it = item_it;
-                      m_highestSack = std::make_pair (++new_it, beginOfCurrentPacket+current->GetSize ());
-                    }
-                }
-              modified = true;
-            }
-          else if (beginOfCurrentPacket + current->GetSize () > b.second)
+          if (endOfCurrentPacket > b.second)
             {
               // we missed the block. It's useless to iterate again; Say "ciao"
               // to the loop for optimization purposes
               NS_LOG_INFO ("Received block [" << b.first << ";" << b.second <<
                            ", checking sentList for block " << beginOfCurrentPacket <<
-                           ";" << beginOfCurrentPacket + current->GetSize () <<
-                           "], not found, breaking loop");
+                           ";" << endOfCurrentPacket << "], not found, breaking loop");
               break;
             }
 
-          beginOfCurrentPacket += current->GetSize ();
-          ++item_it;
+          modified = true;
+          if (item->m_sacked)
+            {
+              // Skip the whole range SACKed before
+              SackedRanges::const_iterator range = m_sackedRanges.upper_bound (beginOfCurrentPacket);
+              --range;
+              NS_LOG_INFO ("Received block [" << b.first << ";" << b.second <<
+                           ", checking sentList for block " << beginOfCurrentPacket <<
+                           ";" << endOfCurrentPacket << "], found in the sackboard "
+                           "already sacked up to " << range->second);
+              i = FindSegment (range->second);
+              continue;
+            }
+
+          NS_LOG_INFO ("Received block [" << b.first << ";" << b.second <<
+                       ", checking sentList for block " << beginOfCurrentPacket <<
+                       ";" << endOfCurrentPacket << "], found in the sackboard, sacking");
+          RemoveFromScoreboard (item);
+          item->m_sacked = true;
+          AddToScoreboard (item);
+          ++i;
         }
     }
 
-  NS_ASSERT ((*(m_sentList.begin ()))->m_sacked == false);
+  NS_ASSERT (m_sentList.empty () || m_sentList.front ()->m_sacked == false);
 
   return modified;
 }
 
 bool
-TcpTxBuffer::IsLost (const SequenceNumber32 &seq, const PacketList::const_iterator &segment,
-                     uint32_t dupThresh, uint32_t segmentSize) const
+TcpTxBuffer::IsLost (const TcpTxItem *item) const
 {
-  NS_LOG_FUNCTION (this << seq << dupThresh << segmentSize);
-  uint32_t count = 0;
-  uint32_t bytes = 0;
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  Ptr<const Packet> current;
-  SequenceNumber32 beginOfCurrentPacket = seq;
-
-  NS_LOG_INFO ("Checking if seq=" << seq << " is lost from the buffer ");
-
-  if ((*segment)->m_lost == true)
+  if (item->m_lost == true)
     {
-      NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+      NS_LOG_INFO ("seq=" << item->m_startSeq << " is lost because of lost flag");
       return true;
     }
 
-  if ((*segment)->m_sacked == true)
+  if (item->m_sacked == true)
     {
-      NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
+      NS_LOG_INFO ("seq=" << item->m_startSeq << " is not lost because of sacked flag");
       return false;
     }
 
-  // From RFC 6675:
-  // > The routine returns true when either dupThresh discontiguous SACKed
-  // > sequences have arrived above 'seq' or more than (dupThresh - 1) * SMSS bytes
-  // > with sequence numbers greater than 'SeqNum' have been SACKed.  Otherwise, the
-  // > routine returns false.
-  for (it = segment; it != m_highestSack.first; ++it)
-    {
-      if (beginOfCurrentPacket >= m_highestSack.second)
-        {
-          NS_LOG_INFO ("seq=" << seq << " is not lost because there are no sacked segment ahead");
-          return false;
-        }
-
-      item = *it;
-      current = item->m_packet;
-
-      if (item->m_sacked)
-        {
-          NS_LOG_INFO ("Segment [" << beginOfCurrentPacket << ", " <<
-                       beginOfCurrentPacket+item->m_packet->GetSize () <<
-                       "] found to be SACKed");
-          ++count;
-          bytes += current->GetSize ();
-          if ((count >= dupThresh) || (bytes > (dupThresh-1) * segmentSize))
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of 3 sacked blocks ahead");
-              return true;
-            }
-        }
-
-      beginOfCurrentPacket += current->GetSize ();
-    }
-
-  return false;
+  return item->m_startSeq < m_lossBoundary;
 }
 
 bool
@@ -795,28 +891,20 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq, uint32_t dupThresh,
 {
   NS_LOG_FUNCTION (this << seq << dupThresh);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
-  if (seq >= m_highestSack.second)
+  if (m_sackedRanges.empty () || seq >= m_sackedRanges.rbegin ()->second)
     {
       return false;
     }
 
-  // This O(n) method is called only once, and outside this class.
-  // It should not harm the performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // Check the first segment which starts at or after seq
+  uint32_t i = FindSegment (seq);
+  if (i == m_sentList.size ())
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
-        {
-          return IsLost (beginOfCurrentPacket, it, dupThresh, segmentSize);
-        }
-
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+      return false;
     }
 
-  return false;
+  UpdateLossBoundary (dupThresh, segmentSize);
+  return IsLost (m_sentList[i]);
 }
 
 bool
@@ -839,33 +927,44 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, uint32_t dupThresh,
    *
    *     (1.c) IsLost (S2) returns true.
    */
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  SequenceNumber32 seqPerRule3;
-  bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
+  UpdateLossBoundary (dupThresh, segmentSize);
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // The segments SACKed or retransmitted stay so until the scoreboard is
+  // reset, which brings the hint back: skip them once
+  uint32_t i = FindSegment (m_retransHint);
+  while (i < m_sentList.size () && (m_sentList[i]->m_sacked || m_sentList[i]->m_retrans))
+    {
+      ++i;
+    }
+  if (i < m_sentList.size ())
+    {
+      m_retransHint = m_sentList[i]->m_startSeq;
+    }
+  else
+    {
+      m_retransHint = m_firstByteSeq + m_sentSize;
+    }
+
+  // Condition 1.a , 1.b , and 1.c
+  if (i < m_sentList.size ())
     {
-      item = *it;
+      if (IsLost (m_sentList[i]))
+        {
+          *seq = m_sentList[i]->m_startSeq;
+          return true;
+        }
 
-      // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
+      // The segments which follow start above the loss boundary: only the
+      // lost flag, set after a retransmission timeout, makes them lost
+      for (uint32_t j = i + 1; m_lostCount > 0 && j < m_sentList.size (); ++j)
         {
-          if (IsLost (beginOfCurrentPkt, it, dupThresh, segmentSize))
+          const TcpTxItem *item = m_sentList[j];
+          if (item->m_lost && !item->m_sacked && !item->m_retrans)
             {
-              *seq = beginOfCurrentPkt;
+              *seq = item->m_startSeq;
               return true;
             }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
-            {
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
-            }
         }
-
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
     }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -886,9 +985,9 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, uint32_t dupThresh,
    *     (specifically excluding step (1.c)), then one segment of up to
    *     SMSS octets starting with S3 SHOULD be returned.
    */
-  if (isSeqPerRule3Valid)
+  if (isRecovery && i < m_sentList.size ())
     {
-      *seq = seqPerRule3;
+      *seq = m_sentList[i]->m_startSeq;
       return true;
     }
 
@@ -911,53 +1010,26 @@ uint32_t
 TcpTxBuffer::GetRetransmitsCount (void) const
 {
   NS_LOG_FUNCTION (this);
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  uint32_t count = 0;
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
-    {
-      item = *it;
-      if (item->m_retrans)
-        {
-          count++;
-        }
-    }
-  return count;
+  return m_retransCount;
 }
 
 uint32_t
 TcpTxBuffer::BytesInFlight (uint32_t dupThresh, uint32_t segmentSize) const
 {
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  uint32_t size = 0; // "pipe" in RFC
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
-
   // After initializing pipe to zero, the following steps are taken for each
   // octet 'S1' in the sequence space between HighACK and HighData that has not
   // been SACKed:
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
-    {
-      item = *it;
-      if (!item->m_sacked)
-        {
-          // (a) If IsLost (S1) returns false: Pipe is incremented by 1 octet.
-          if (!IsLost (beginOfCurrentPkt, it, dupThresh, segmentSize))
-            {
-              size += item->m_packet->GetSize ();
-            }
-          // (b) If S1 <= HighRxt: Pipe is incremented by 1 octet.
-          // (NOTE: we use the m_retrans flag instead of keeping and updating
-          // another variable). Only if the item is not marked as lost
-          else if (item->m_retrans && !item->m_lost)
-            {
-              size += item->m_packet->GetSize ();
-            }
-        }
-      beginOfCurrentPkt += item->m_packet->GetSize ();
-    }
-
-  return size;
+  // (a) If IsLost (S1) returns false: Pipe is incremented by 1 octet.
+  // (b) If S1 <= HighRxt: Pipe is incremented by 1 octet.
+  // (NOTE: we use the m_retrans flag instead of keeping and updating
+  // another variable). Only if the item is not marked as lost
+  //
+  // The octets neither SACKed nor marked as lost are counted in
+  // m_outstandingBytes; those of them which IsLost, and which are not
+  // retransmitted, are the holes below the loss boundary.
+  UpdateLossBoundary (dupThresh, segmentSize);
+  NS_ASSERT (m_holeBytes <= m_outstandingBytes);
+  return m_outstandingBytes - m_holeBytes;
 }
 
 void
@@ -966,15 +1038,16 @@ TcpTxBuffer::ResetScoreboard ()
   NS_LOG_FUNCTION (this);
 
   PacketList::iterator it;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
 
   for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
-      (*it)->m_sacked = false;
-      beginOfCurrentPkt += (*it)->m_packet->GetSize ();
+      if ((*it)->m_sacked)
+        {
+          RemoveFromScoreboard (*it);
+          (*it)->m_sacked = false;
+          AddToScoreboard (*it);
+        }
     }
-
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
 }
 
 void
@@ -987,6 +1060,7 @@ TcpTxBuffer::ResetSentList (uint32_t keepItems)
   while (m_sentList.size () > keepItems)
     {
       item = m_sentList.back ();
+      RemoveFromScoreboard (item);
       item->m_retrans = item->m_sacked = false;
       m_appList.push_front (item);
       m_sentList.pop_back ();
@@ -995,17 +1069,17 @@ TcpTxBuffer::ResetSentList (uint32_t keepItems)
   if (m_sentList.size () > 0)
     {
       item = m_sentList.back ();
+      RemoveFromScoreboard (item);
       item->m_lost = true;
       item->m_sacked = false;
       item->m_retrans = false;
+      AddToScoreboard (item);
       m_sentSize = item->m_packet->GetSize ();
     }
   else
     {
       m_sentSize = 0;
     }
-
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
 }
 
 void
@@ -1016,6 +1090,7 @@ TcpTxBuffer::ResetLastSegmentSent ()
     {
       TcpTxItem *item = m_sentList.back ();
 
+      RemoveFromScoreboard (item);
       m_sentList.pop_back ();
       m_sentSize -= item->m_packet->GetSize ();
       m_appList.insert (m_appList.begin (), item);
@@ -1031,7 +1106,9 @@ TcpTxBuffer::SetSentListLost ()
 
   for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
+      RemoveFromScoreboard (*it);
       (*it)->m_lost = true;
+      AddToScoreboard (*it);
     }
 }
 
@@ -1054,89 +1131,73 @@ TcpTxBuffer::CraftSackOption (const SequenceNumber32 &seq, uint8_t available) co
 {
   NS_LOG_FUNCTION (this);
   Ptr<TcpOptionSack> sackBlock = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  Ptr<Packet> current;
   TcpTxItem *item;
 
   NS_LOG_INFO ("Crafting a SACK block, available bytes: " << (uint32_t) available <<
                " from seq: " << seq << " buffer starts at seq " << m_firstByteSeq);
 
-  PacketList::const_iterator it;
-  if (m_highestSack.first == m_sentList.end ())
-    {
-      it = m_sentList.begin ();
-    }
-  else
+  // Start after the highest SACKed segment, unless it is the last one
+  uint32_t i = 0;
+  if (!m_sackedRanges.empty ())
     {
-      it = m_highestSack.first;
-      beginOfCurrentPacket = m_highestSack.second;
+      i = FindSegment (m_sackedRanges.rbegin ()->second);
+      if (i == m_sentList.size ())
+        {
+          i = 0;
+        }
     }
 
-  while (it != m_sentList.end ())
+  for (; i < m_sentList.size (); ++i)
     {
-      item = *it;
-      current = item->m_packet;
+      item = m_sentList[i];
 
-      SequenceNumber32 endOfCurrentPacket = beginOfCurrentPacket + current->GetSize ();
+      SequenceNumber32 beginOfCurrentPacket = item->m_startSeq;
+      SequenceNumber32 endOfCurrentPacket = beginOfCurrentPacket + item->m_packet->GetSize ();
 
       // The first segment could not be sacked.. otherwise would be a
       // cumulative ACK :)
-      if (item->m_sacked || it == m_sentList.begin ())
+      if (item->m_sacked || i == 0 || seq > beginOfCurrentPacket)
         {
           NS_LOG_DEBUG ("Analyzing segment: [" << beginOfCurrentPacket <<
                         ";" << endOfCurrentPacket << "], not usable, sacked=" <<
                         item->m_sacked);
-          beginOfCurrentPacket += current->GetSize ();
-        }
-      else if (seq > beginOfCurrentPacket)
-        {
-          NS_LOG_DEBUG ("Analyzing segment: [" << beginOfCurrentPacket <<
-                        ";" << endOfCurrentPacket << "], not usable, sacked=" <<
-                        item->m_sacked);
-          beginOfCurrentPacket += current->GetSize ();
+          continue;
         }
-      else
+
+      // RFC 2018: The first SACK block MUST specify the contiguous
+      // block of data containing the segment which triggered this ACK.
+      // Since we are hand-crafting this, select the first non-sacked block.
+      sackBlock = CreateObject <TcpOptionSack> ();
+      sackBlock->AddSackBlock (TcpOptionSack::SackBlock (beginOfCurrentPacket,
+                                                         endOfCurrentPacket));
+      NS_LOG_DEBUG ("Analyzing segment: [" << beginOfCurrentPacket <<
+                    ";" << endOfCurrentPacket << "] and found to be usable");
+
+      // RFC 2018: The data receiver SHOULD include as many distinct SACK
+      // blocks as possible in the SACK option
+      // The SACK option SHOULD be filled out by repeating the most
+      // recently reported SACK blocks  that are not subsets of a SACK block
+      // already included
+      // This means go backward until we finish space and include already SACKed block
+      while (sackBlock->GetSerializedSize () + 8 < available)
         {
-          // RFC 2018: The first SACK block MUST specify the contiguous
-          // block of data containing the segment which triggered this ACK.
-          // Since we are hand-crafting this, select the first non-sacked block.
-          sackBlock = CreateObject <TcpOptionSack> ();
-          sackBlock->AddSackBlock (TcpOptionSack::SackBlock (beginOfCurrentPacket,
-                                                             endOfCurrentPacket));
-          NS_LOG_DEBUG ("Analyzing segment: [" << beginOfCurrentPacket <<
-                        ";" << endOfCurrentPacket << "] and found to be usable");
-
-          // RFC 2018: The data receiver SHOULD include as many distinct SACK
-          // blocks as possible in the SACK option
-          // The SACK option SHOULD be filled out by repeating the most
-          // recently reported SACK blocks  that are not subsets of a SACK block
-          // already included
-          // This means go backward until we finish space and include already SACKed block
-          while (sackBlock->GetSerializedSize () + 8 < available)
+          if (--i == 0)
             {
-              --it;
-
-              if (it == m_sentList.begin ())
-                {
-                  return sackBlock;
-                }
-
-              item = *it;
-              current = item->m_packet;
-              endOfCurrentPacket = beginOfCurrentPacket;
-              beginOfCurrentPacket -= current->GetSize ();
-              sackBlock->AddSackBlock (TcpOptionSack::SackBlock (beginOfCurrentPacket,
-                                                                 endOfCurrentPacket));
-              NS_LOG_DEBUG ("Filling the option: Adding [" << beginOfCurrentPacket <<
-                            ";" << endOfCurrentPacket << "], available space now : " <<
-                            (uint32_t) (available - sackBlock->GetSerializedSize ()));
-              NS_ASSERT (beginOfCurrentPacket > m_firstByteSeq);
+              return sackBlock;
             }
 
-          return sackBlock;
+          item = m_sentList[i];
+          beginOfCurrentPacket = item->m_startSeq;
+          endOfCurrentPacket = beginOfCurrentPacket + item->m_packet->GetSize ();
+          sackBlock->AddSackBlock (TcpOptionSack::SackBlock (beginOfCurrentPacket,
+                                                             endOfCurrentPacket));
+          NS_LOG_DEBUG ("Filling the option: Adding [" << beginOfCurrentPacket <<
+                        ";" << endOfCurrentPacket << "], available space now : " <<
+                        (uint32_t) (available - sackBlock->GetSerializedSize ()));
+          NS_ASSERT (beginOfCurrentPacket > m_firstByteSeq);
         }
 
-      ++it;
+      return sackBlock;
     }
 
   return sackBlock;
@@ -1158,6 +1219,7 @@ operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf)
          << beginOfCurrentPacket + p->GetSize () << "|" << p->GetSize () << "|";
       (*it)->Print (ss);
       ss << "]";
+      NS_ASSERT ((*it)->m_startSeq == beginOfCurrentPacket);
       sentSize += p->GetSize ();
       beginOfCurrentPacket += p->GetSize ();
     }
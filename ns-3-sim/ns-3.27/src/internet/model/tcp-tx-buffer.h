@@ -22,6 +22,9 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
+#include <deque>
+#include <map>
+
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
@@ -62,6 +65,8 @@ public:
   Time m_lastSent;      //!< Timestamp of the time at which the segment has
                         //   been sent last time
   bool m_sacked;        //!< Indicates if the segment has been SACKed
+  SequenceNumber32 m_startSeq; //!< Sequence number of the first byte, once
+                               //   the segment is in the sent list
 };
 
 /**
@@ -106,18 +111,40 @@ public:
  * documentation) and maintaining the scoreboard is a matter of travelling the
  * list and set the SACK flag on the corresponding segment sent.
  *
- * Inefficiencies
- * --------------
+ * Scoreboard
+ * ----------
+ *
+ * Walking the sent list for each ACK, as the algorithms of RFC 6675 are
+ * written, makes loss recovery quadratic in the number of segments in
+ * flight. Instead, the segments of the sent list are kept in a deque, and
+ * each knows its first sequence number, so that the segment of a sequence
+ * number is found by binary search. The SACKed segments are also kept as a
+ * set of ranges, so that Update skips what was SACKed before, and the flags
+ * of the segments are summed in counters which are updated whenever a
+ * segment of the sent list changes (see AddToScoreboard and
+ * RemoveFromScoreboard).
+ *
+ * IsLost (S) of RFC 6675 only depends on the SACKed segments above S, so
+ * there is a loss boundary: the start of the dupThresh-th SACKed segment
+ * from the highest one (or of the one at which the SACKed bytes exceed
+ * (dupThresh - 1) * SMSS). An unSACKed segment is lost if and only if it
+ * starts before the boundary, or it has the lost flag. The boundary is
+ * found again from the highest SACKed ranges when they change, and the
+ * bytes of the holes below it are counted as it moves, so that
+ * BytesInFlight takes constant time and IsLost logarithmic time. NextSeg
+ * remembers where the segments which could still be retransmitted start.
+ *
+ * Payload
+ * -------
  *
- * The algorithms outlined in RFC 6675 are full of inefficiencies. In
- * particular, traveling all the sent list each time it is needed to compute
- * the bytes in flight is expensive. We try to overcome the issue by
- * maintaining a pointer to the highest sequence SACKed; in this way, we can
- * avoid traveling all the list in some cases. Another option could be keeping
- * a count of each critical value (e.g., the number of packets sacked).
- * However, this would be different from the algorithms in RFC. There are some
- * other possible improvements; if you wish, take a look and try  to add some
- * earlier exit conditions in the loops.
+ * There is no payload-less segment type: the zero-filled payload of
+ * applications such as BulkSend and OnOff is the zero area of Buffer, which
+ * is never stored as real bytes. Splitting it with CreateFragment, and
+ * merging the fragments with AddAtEnd, keeps it virtual even when the
+ * fragments share their data with this buffer, so that only the TCP and IP
+ * headers are real bytes down to the device. A payload is materialized only
+ * when real data is mixed with it, or when the packet is serialized (e.g.,
+ * by a pcap trace or a device which copies the bytes out).
  *
  * \see Size
  * \see SizeFromSequence
@@ -335,18 +362,49 @@ public:
 private:
   friend std::ostream & operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf);
 
-  typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+  typedef std::deque<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+  typedef std::map<SequenceNumber32, SequenceNumber32> SackedRanges; //!< SACKed ranges, from their start to their end
 
   /**
-   * \brief Check if a segment is lost per RFC 6675
-   * \param seq sequence to check
-   * \param segment Iterator pointing at seq
+   * \brief Find a segment of the sent list
+   * \param seq a sequence number
+   * \return the index of the first segment which starts at or after seq
+   */
+  uint32_t FindSegment (const SequenceNumber32 &seq) const;
+
+  /**
+   * \brief Check if a segment of the sent list is lost per RFC 6675
+   *
+   * The loss boundary must be up to date.
+   * \param item the segment
+   * \return true if the segment is supposed to be lost, false otherwise
+   */
+  bool IsLost (const TcpTxItem *item) const;
+
+  /**
+   * \brief Add a segment of the sent list to the scoreboard counters, and
+   * to the SACKed ranges if it is SACKed
+   *
+   * Whenever the flags, the size or the sequence number of a segment of the
+   * sent list change, it must be removed from the scoreboard before, and
+   * added back after.
+   * \param item the segment
+   */
+  void AddToScoreboard (const TcpTxItem *item);
+
+  /**
+   * \brief Remove a segment of the sent list from the scoreboard
+   * \param item the segment
+   */
+  void RemoveFromScoreboard (const TcpTxItem *item);
+
+  /**
+   * \brief Find the loss boundary again if the SACKed ranges changed, and
+   * count the holes below it
    * \param dupThresh dupAck threshold
    * \param segmentSize segment size
-   * \return true if the sequence is supposed to be lost, false otherwise
    */
-  bool IsLost (const SequenceNumber32 &seq, const PacketList::const_iterator &segment, uint32_t dupThresh,
-               uint32_t segmentSize) const;
+  void UpdateLossBoundary (uint32_t dupThresh, uint32_t segmentSize) const;
 
   /**
    * \brief Get a block of data not transmitted yet and move it into SentList
@@ -443,6 +501,9 @@ private:
    * MSS can change, but it is stable, and retransmissions do not happen for
    * each segment).
    *
+   * In the sent list, the search starts from the segment which contains
+   * requestedSeq, and the segments edited are kept in the scoreboard.
+   *
    * \param list List to extract block from
    * \param startingSeq Starting sequence of the list
    * \param numBytes Bytes to extract, starting from requestedSeq
@@ -452,7 +513,7 @@ private:
    */
   TcpTxItem* GetPacketFromList (PacketList &list, const SequenceNumber32 &startingSeq,
                                 uint32_t numBytes, const SequenceNumber32 &requestedSeq,
-                                bool *listEdited) const;
+                                bool *listEdited);
 
   /**
    * \brief Merge two TcpTxItem
@@ -469,7 +530,8 @@ private:
   /**
    * \brief Split one TcpTxItem
    *
-   * Move "size" bytes from t2 into t1, copying all the fields.
+   * Move "size" bytes from t2 into t1, copying all the fields, and advance
+   * the sequence number of t2 past them.
    *
    * \param t1 first item
    * \param t2 second item
@@ -477,13 +539,6 @@ private:
    */
   void SplitItems (TcpTxItem &t1, TcpTxItem &t2, uint32_t size) const;
 
-  /**
-   * \brief Find the highest SACK byte
-   * \return a pair with the highest byte and an iterator inside m_sentList
-   */
-  std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
-  GetHighestSacked () const;
-
   PacketList m_appList;  //!< Buffer for application data
   PacketList m_sentList; //!< Buffer for sent (but not acked) data
   uint32_t m_maxBuffer;  //!< Max number of data bytes in buffer (SND.WND)
@@ -492,8 +547,17 @@ private:
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
 
-  std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
-
+  SackedRanges m_sackedRanges;  //!< Ranges of the SACKed segments of the sent list
+  uint32_t m_retransCount;      //!< Number of segments retransmitted
+  uint32_t m_lostCount;         //!< Number of segments with the lost flag
+  uint32_t m_outstandingBytes;  //!< Bytes neither SACKed nor with the lost flag
+  mutable uint32_t m_holeBytes; //!< Bytes of m_outstandingBytes which start below the
+                                //   loss boundary and are not retransmitted
+  mutable SequenceNumber32 m_lossBoundary; //!< UnSACKed segments which start below it are lost
+  mutable bool m_lossBoundaryValid;        //!< Whether the SACKed ranges did not change since the boundary was found
+  mutable uint32_t m_lossDupThresh;        //!< dupAck threshold of the loss boundary
+  mutable uint32_t m_lossSegmentSize;      //!< Segment size of the loss boundary
+  mutable SequenceNumber32 m_retransHint;  //!< Segments which start below it are SACKed or retransmitted
 };
 
 /**
@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <string>
 #include "ns3/header.h"
+#include "ns3/header-view.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
 
@@ -185,6 +186,64 @@ private:
   bool m_goodChecksum;        //!< Flag to indicate that checksum is correct
 };
 
+/**
+ * \ingroup udp
+ *
+ * \brief Read-only view of a UDP header stored in the buffer of a packet.
+ *
+ * The checksum is not verified.
+ *
+ * \see HeaderView
+ */
+class UdpHeaderView : public HeaderView
+{
+public:
+  /**
+   * \param packet the packet
+   * \param offset the offset of the header from the start of \p packet
+   * \returns true if a UDP header is stored contiguously at \p offset
+   */
+  bool Peek (Ptr<const Packet> packet, uint32_t offset = 0);
+  /**
+   * \returns The source port for this UdpHeader
+   */
+  uint16_t GetSourcePort (void) const;
+  /**
+   * \returns the destination port for this UdpHeader
+   */
+  uint16_t GetDestinationPort (void) const;
+  /**
+   * \returns the size of the payload in bytes
+   */
+  uint16_t GetPayloadSize (void) const;
+
+  static const uint32_t SIZE = 8; //!< size of the header
+};
+
+inline bool
+UdpHeaderView::Peek (Ptr<const Packet> packet, uint32_t offset)
+{
+  return DoPeek (packet, offset, SIZE);
+}
+
+inline uint16_t
+UdpHeaderView::GetSourcePort (void) const
+{
+  return ReadNtohU16 (0);
+}
+
+inline uint16_t
+UdpHeaderView::GetDestinationPort (void) const
+{
+  return ReadNtohU16 (2);
+}
+
+inline uint16_t
+UdpHeaderView::GetPayloadSize (void) const
+{
+  return ReadNtohU16 (4) - SIZE;
+}
+
 } // namespace ns3
 
 #endif /* UDP_HEADER */
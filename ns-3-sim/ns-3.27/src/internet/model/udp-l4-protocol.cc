@@ -24,6 +24,7 @@
 #include "ns3/node.h"
 #include "ns3/boolean.h"
 #include "ns3/object-vector.h"
+#include "ns3/config.h"
 #include "ns3/ipv6.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv6-route.h"
@@ -167,6 +168,7 @@ UdpL4Protocol::CreateSocket (void)
   socket->SetNode (m_node);
   socket->SetUdp (this);
   m_sockets.push_back (socket);
+  Config::InvalidateCache ();
   return socket;
 }
 
@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/arp-cache-helper.h"
+#include "ns3/arp-cache.h"
+#include "ns3/arp-l3-protocol.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/socket.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Fill the ARP caches of three nodes on a shared channel, and send a
+ * packet without any ARP exchange.
+ */
+class ArpCacheHelperTestCase : public TestCase
+{
+public:
+  ArpCacheHelperTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Count the ARP packets received.
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the sender
+   * \param to the destination
+   * \param packetType the type of the packet
+   */
+  void ReceiveArp (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                   const Address &from, const Address &to, NetDevice::PacketType packetType);
+  /**
+   * \brief Send the data.
+   * \param socket the sending socket
+   */
+  void SendData (Ptr<Socket> socket);
+  /**
+   * \brief Receive the data.
+   * \param socket the receiving socket
+   */
+  void ReceiveData (Ptr<Socket> socket);
+
+  uint32_t m_arpPackets;  //!< ARP packets received
+  Time m_received;        //!< Arrival time of the data
+};
+
+ArpCacheHelperTestCase::ArpCacheHelperTestCase ()
+  : TestCase ("Populate the ARP caches of a shared channel"),
+    m_arpPackets (0),
+    m_received (Seconds (0))
+{
+}
+
+void
+ArpCacheHelperTestCase::ReceiveArp (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                    const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  m_arpPackets++;
+}
+
+void
+ArpCacheHelperTestCase::SendData (Ptr<Socket> socket)
+{
+  socket->Send (Create<Packet> (100));
+}
+
+void
+ArpCacheHelperTestCase::ReceiveData (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received = Simulator::Now ();
+    }
+}
+
+void
+ArpCacheHelperTestCase::DoRun (void)
+{
+  // Three nodes on a shared channel, and a fourth one behind a
+  // point-to-point link, which needs no ARP
+  NodeContainer nodes;
+  nodes.Create (4);
+  SimpleNetDeviceHelper shared;
+  shared.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer sharedDevices = shared.Install (NodeContainer (nodes.Get (0), nodes.Get (1), nodes.Get (2)));
+  SimpleNetDeviceHelper link;
+  link.SetNetDevicePointToPointMode (true);
+  NetDeviceContainer linkDevices = link.Install (NodeContainer (nodes.Get (2), nodes.Get (3)));
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer sharedInterfaces = address.Assign (sharedDevices);
+  address.SetBase ("10.1.2.0", "255.255.255.0");
+  address.Assign (linkDevices);
+
+  ArpCacheHelper arp;
+  arp.PopulateArpCache ();
+
+  for (uint32_t i = 0; i < sharedInterfaces.GetN (); ++i)
+    {
+      Ptr<Ipv4L3Protocol> ipv4 = sharedInterfaces.Get (i).first->GetObject<Ipv4L3Protocol> ();
+      Ptr<ArpCache> cache = ipv4->GetInterface (sharedInterfaces.Get (i).second)->GetArpCache ();
+      for (uint32_t j = 0; j < sharedInterfaces.GetN (); ++j)
+        {
+          ArpCache::Entry *entry = cache->Lookup (sharedInterfaces.GetAddress (j));
+          if (i == j)
+            {
+              NS_TEST_ASSERT_MSG_EQ ((entry == 0), true, "A node should not have an entry for itself");
+              continue;
+            }
+          NS_TEST_ASSERT_MSG_EQ ((entry != 0), true, "Missing entry for " << sharedInterfaces.GetAddress (j));
+          NS_TEST_ASSERT_MSG_EQ (entry->IsPermanent (), true, "The entry should be permanent");
+          NS_TEST_ASSERT_MSG_EQ (entry->GetMacAddress (), sharedDevices.Get (j)->GetAddress (),
+                                 "Wrong MAC address for " << sharedInterfaces.GetAddress (j));
+        }
+    }
+  Ptr<Ipv4L3Protocol> ipv4 = nodes.Get (3)->GetObject<Ipv4L3Protocol> ();
+  NS_TEST_ASSERT_MSG_EQ ((ipv4->GetInterface (1)->GetArpCache () == 0), true,
+                         "A point-to-point device has no ARP cache");
+
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      nodes.Get (i)->RegisterProtocolHandler (MakeCallback (&ArpCacheHelperTestCase::ReceiveArp, this),
+                                              ArpL3Protocol::PROT_NUMBER, 0);
+    }
+  Ptr<Socket> receiver = Socket::CreateSocket (nodes.Get (2), UdpSocketFactory::GetTypeId ());
+  receiver->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  receiver->SetRecvCallback (MakeCallback (&ArpCacheHelperTestCase::ReceiveData, this));
+  Ptr<Socket> sender = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  sender->Connect (InetSocketAddress (sharedInterfaces.GetAddress (2), 1234));
+  Simulator::Schedule (Seconds (1), &ArpCacheHelperTestCase::SendData, this, sender);
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_arpPackets, 0, "No ARP packet should be sent");
+  // Sent in a single channel delay, with no ARP exchange before it
+  NS_TEST_ASSERT_MSG_EQ (m_received, Seconds (1) + MilliSeconds (1), "The data should arrive right away");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief the TestSuite for the ArpCacheHelper test case
+ */
+class ArpCacheHelperTestSuite : public TestSuite
+{
+public:
+  ArpCacheHelperTestSuite ()
+    : TestSuite ("arp-cache-helper", UNIT)
+  {
+    AddTestCase (new ArpCacheHelperTestCase, TestCase::QUICK);
+  }
+};
+
+static ArpCacheHelperTestSuite g_arpCacheHelperTestSuite; //!< Static variable for test initialization
@@ -26,7 +26,27 @@
 #include "ns3/global-route-manager-impl.h"
 #include "ns3/candidate-queue.h"
 #include "ns3/simulator.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/global-route-manager.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/global-router-interface.h"
+#include <algorithm>
 #include <cstdlib> // for rand()
+#include <list>
+#include <set>
+#include <sstream>
+#include <vector>
 
 using namespace ns3;
 
@@ -226,6 +246,343 @@ GlobalRouteManagerImplTestCase::DoRun (void)
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the CandidateQueue pops the vertices in the order of
+ * the sorted list it was before: by distance, networks first, and in the
+ * order they were pushed or their distance decreased.
+ */
+class CandidateQueueOrderTestCase : public TestCase
+{
+public:
+  CandidateQueueOrderTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * \param v1 first vertex
+   * \param v2 second vertex
+   * \returns true if v1 is before v2 in the sorted list
+   */
+  static bool Before (const SPFVertex *v1, const SPFVertex *v2);
+};
+
+CandidateQueueOrderTestCase::CandidateQueueOrderTestCase ()
+  : TestCase ("Order of the candidate queue")
+{
+}
+
+bool
+CandidateQueueOrderTestCase::Before (const SPFVertex *v1, const SPFVertex *v2)
+{
+  if (v1->GetDistanceFromRoot () != v2->GetDistanceFromRoot ())
+    {
+      return v1->GetDistanceFromRoot () < v2->GetDistanceFromRoot ();
+    }
+  return v1->GetVertexType () == SPFVertex::VertexNetwork
+         && v2->GetVertexType () == SPFVertex::VertexRouter;
+}
+
+void
+CandidateQueueOrderTestCase::DoRun (void)
+{
+  CandidateQueue candidate;
+  std::list<SPFVertex *> sorted;
+  std::vector<SPFVertex *> queued;
+  uint32_t state = 7;
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      state = state * 1103515245 + 12345;
+      uint32_t r = state >> 8;
+      if (r % 4 == 0 && !sorted.empty ())
+        {
+          SPFVertex *v = candidate.Pop ();
+          NS_TEST_ASSERT_MSG_EQ (v, sorted.front (), "Wrong vertex popped at step " << i);
+          sorted.pop_front ();
+          queued.erase (std::find (queued.begin (), queued.end (), v));
+          delete v;
+        }
+      else if (r % 4 == 1 && !queued.empty ())
+        {
+          // A shorter path to a candidate, as SPFNext finds them
+          SPFVertex *v = queued[(r >> 4) % queued.size ()];
+          if (v->GetDistanceFromRoot () == 0)
+            {
+              continue;
+            }
+          v->SetDistanceFromRoot ((r >> 12) % v->GetDistanceFromRoot ());
+          candidate.Update (v);
+          sorted.sort (&CandidateQueueOrderTestCase::Before);
+        }
+      else
+        {
+          SPFVertex *v = new SPFVertex;
+          v->SetDistanceFromRoot ((r >> 4) % 20);
+          v->SetVertexType ((r >> 12) % 2 ? SPFVertex::VertexRouter : SPFVertex::VertexNetwork);
+          candidate.Push (v);
+          sorted.insert (std::upper_bound (sorted.begin (), sorted.end (), v,
+                                           &CandidateQueueOrderTestCase::Before), v);
+          queued.push_back (v);
+        }
+      NS_TEST_ASSERT_MSG_EQ (candidate.Top (), sorted.empty () ? 0 : sorted.front (),
+                             "Wrong top vertex at step " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (candidate.Size (), sorted.size (), "Wrong number of candidates");
+}
+
+/**
+ * Connect routers by point-to-point links of SimpleNetDevices: every
+ * seventh router is a stub, with a single link, and the others form a ring
+ * with a random chord from each.
+ *
+ * \param nodes the routers
+ * \returns the interfaces of each link
+ */
+static std::vector<Ipv4InterfaceContainer>
+CreateRouters (NodeContainer nodes)
+{
+  uint32_t size = nodes.GetN ();
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+  std::set<std::pair<uint32_t, uint32_t> > links;
+  uint32_t state = 3;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      uint32_t next = (i + 1) % size;
+      if (next % 7 == 0 && i % 7 != 0)
+        {
+          next = (next + 1) % size;
+        }
+      links.insert (std::make_pair (std::min (i, next), std::max (i, next)));
+      state = state * 1103515245 + 12345;
+      uint32_t j = (state >> 8) % size;
+      if (i % 7 != 0 && j % 7 != 0 && j != i)
+        {
+          links.insert (std::make_pair (std::min (i, j), std::max (i, j)));
+        }
+    }
+  std::vector<Ipv4InterfaceContainer> linkInterfaces;
+  for (std::set<std::pair<uint32_t, uint32_t> >::const_iterator i = links.begin (); i != links.end (); i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      NetDeviceContainer devices;
+      Ptr<Node> ends[2] = { nodes.Get (i->first), nodes.Get (i->second) };
+      for (uint32_t e = 0; e < 2; e++)
+        {
+          Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+          device->SetAttribute ("PointToPointMode", BooleanValue (true));
+          device->SetChannel (channel);
+          device->SetAddress (Mac48Address::Allocate ());
+          ends[e]->AddDevice (device);
+          devices.Add (device);
+        }
+      Ipv4InterfaceContainer interfaces = address.Assign (devices);
+      address.NewNetwork ();
+      // Few distinct metrics, so that there are equal-cost paths
+      state = state * 1103515245 + 12345;
+      uint16_t metric = 1 + (state >> 16) % 3;
+      for (uint32_t e = 0; e < 2; e++)
+        {
+          interfaces.Get (e).first->SetMetric (interfaces.Get (e).second, metric);
+        }
+      linkInterfaces.push_back (interfaces);
+    }
+  return linkInterfaces;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the routing tables computed with several threads are
+ * those computed with one, on a random topology with equal-cost paths.
+ */
+class GlobalRoutingThreadsTestCase : public TestCase
+{
+public:
+  GlobalRoutingThreadsTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * \param nodes the routers
+   * \returns the routing tables of the routers
+   */
+  static std::string DumpTables (NodeContainer nodes);
+};
+
+GlobalRoutingThreadsTestCase::GlobalRoutingThreadsTestCase ()
+  : TestCase ("Routing tables computed by several threads")
+{
+}
+
+std::string
+GlobalRoutingThreadsTestCase::DumpTables (NodeContainer nodes)
+{
+  std::ostringstream os;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      os << "Node " << i << std::endl;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          os << *routing->GetRoute (j) << std::endl;
+        }
+    }
+  return os.str ();
+}
+
+void
+GlobalRoutingThreadsTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (60);
+  CreateRouters (nodes);
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::string single = DumpTables (nodes);
+
+  UintegerValue threads;
+  GlobalValue::GetValueByName ("GlobalRoutingThreads", threads);
+  GlobalValue::Bind ("GlobalRoutingThreads", UintegerValue (4));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::string multiple = DumpTables (nodes);
+  GlobalValue::Bind ("GlobalRoutingThreads", threads);
+
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_NE (single.find ("10.0.0.1"), std::string::npos, "Routes should have been computed");
+  NS_TEST_EXPECT_MSG_EQ (multiple, single, "The routing tables should not depend on the number of threads");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the routes updated after links go down, up or change
+ * their metric are those computed from scratch.
+ *
+ * The routes to different destinations may be in another order, but the
+ * routes to each destination must be the same, in the same order.
+ */
+class GlobalRoutingUpdateTestCase : public TestCase
+{
+public:
+  GlobalRoutingUpdateTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * \param nodes the routers
+   * \returns the routing tables of the routers, sorted by destination
+   */
+  static std::string DumpTables (NodeContainer nodes);
+  /**
+   * \param a a route, and its destination
+   * \param b another route, and its destination
+   * \returns true if the destination of a sorts before that of b
+   */
+  static bool BeforeRoute (std::pair<std::pair<uint32_t, uint32_t>, std::string> const &a,
+                           std::pair<std::pair<uint32_t, uint32_t>, std::string> const &b);
+};
+
+GlobalRoutingUpdateTestCase::GlobalRoutingUpdateTestCase ()
+  : TestCase ("Routing tables updated after link changes")
+{
+}
+
+bool
+GlobalRoutingUpdateTestCase::BeforeRoute (std::pair<std::pair<uint32_t, uint32_t>, std::string> const &a,
+                                          std::pair<std::pair<uint32_t, uint32_t>, std::string> const &b)
+{
+  return a.first < b.first;
+}
+
+std::string
+GlobalRoutingUpdateTestCase::DumpTables (NodeContainer nodes)
+{
+  std::ostringstream os;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      std::vector<std::pair<std::pair<uint32_t, uint32_t>, std::string> > routes;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          Ipv4RoutingTableEntry *route = routing->GetRoute (j);
+          std::ostringstream line;
+          line << *route;
+          routes.push_back (std::make_pair (std::make_pair (route->GetDestNetwork ().Get (),
+                                                            route->GetDestNetworkMask ().Get ()),
+                                            line.str ()));
+        }
+      // Keep the order of the routes to each destination
+      std::stable_sort (routes.begin (), routes.end (), &GlobalRoutingUpdateTestCase::BeforeRoute);
+      os << "Node " << i << std::endl;
+      for (uint32_t j = 0; j < routes.size (); j++)
+        {
+          os << routes[j].second << std::endl;
+        }
+    }
+  return os.str ();
+}
+
+void
+GlobalRoutingUpdateTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (60);
+  std::vector<Ipv4InterfaceContainer> links = CreateRouters (nodes);
+
+  uint32_t recomputed = GlobalRouteManager::UpdateRoutes ();
+  NS_TEST_EXPECT_MSG_EQ (recomputed, nodes.GetN (), "The first update should compute every route");
+  uint32_t partial = 0;
+  uint32_t state = 7;
+  for (uint32_t step = 0; step < 30; step++)
+    {
+      // Two changes, each followed by an update, then compare the routes
+      // with those computed from scratch
+      for (uint32_t change = 0; change < 2; change++)
+        {
+          state = state * 1103515245 + 12345;
+          Ipv4InterfaceContainer link = links[(state >> 8) % links.size ()];
+          state = state * 1103515245 + 12345;
+          uint32_t action = (state >> 8) % 4;
+          for (uint32_t e = 0; e < 2; e++)
+            {
+              std::pair<Ptr<Ipv4>, uint32_t> end = link.Get (e);
+              // Sometimes only one end of the link goes down or up
+              bool toggle = action > 1 || (action == 1 && e == 0);
+              if (action == 0)
+                {
+                  end.first->SetMetric (end.second, 1 + (state >> 16) % 3);
+                }
+              else if (toggle && end.first->IsUp (end.second))
+                {
+                  end.first->SetDown (end.second);
+                }
+              else if (toggle)
+                {
+                  end.first->SetUp (end.second);
+                }
+            }
+          if (GlobalRouteManager::UpdateRoutes () < nodes.GetN ())
+            {
+              partial++;
+            }
+        }
+      std::string updated = DumpTables (nodes);
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+      std::string computed = DumpTables (nodes);
+      NS_TEST_ASSERT_MSG_EQ (updated, computed, "Wrong routes after step " << step);
+      // Start again from routes the update knows about
+      GlobalRouteManager::UpdateRoutes ();
+    }
+
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_GT (partial, 30, "Most updates should only compute the routes of a few routers again");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -243,6 +600,9 @@ GlobalRouteManagerImplTestSuite::GlobalRouteManagerImplTestSuite ()
   : TestSuite ("global-route-manager-impl", UNIT)
 {
   AddTestCase (new GlobalRouteManagerImplTestCase (), TestCase::QUICK);
+  AddTestCase (new CandidateQueueOrderTestCase (), TestCase::QUICK);
+  AddTestCase (new GlobalRoutingThreadsTestCase (), TestCase::QUICK);
+  AddTestCase (new GlobalRoutingUpdateTestCase (), TestCase::QUICK);
 }
 
 static GlobalRouteManagerImplTestSuite g_globalRoutingManagerImplTestSuite; //!< Static variable for test initialization
@@ -26,6 +26,7 @@
 #include "ns3/simple-net-device.h"
 #include "ns3/socket.h"
 #include "ns3/boolean.h"
+#include "ns3/global-value.h"
 
 #include "ns3/log.h"
 #include "ns3/node.h"
@@ -36,6 +37,7 @@
 #include "ns3/icmpv4-l4-protocol.h"
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-routing-helper.h"
 
@@ -218,6 +220,217 @@ Ipv4ForwardingTest::DoRun (void)
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 Fast Forwarding Test
+ *
+ * Packets in transit through a router with FastForwarding set must be
+ * forwarded like on the normal path, and the routes the router keeps must
+ * follow the changes of its static routes.
+ */
+class Ipv4FastForwardingTest : public TestCase
+{
+  Ptr<Packet> m_receivedPacket; //!< Received packet
+  uint32_t m_forwarded;         //!< Packets forwarded by the router
+  uint32_t m_ttlExpired;        //!< Packets dropped by the router for their TTL
+
+  /**
+   * \brief Add an interface to a node.
+   * \param node The node.
+   * \param address The address of the interface.
+   * \returns The device of the interface.
+   */
+  Ptr<SimpleNetDevice> AddInterface (Ptr<Node> node, Ipv4Address address);
+  /**
+   * \brief Send data.
+   * \param socket The sending socket.
+   * \param to Destination address.
+   */
+  void DoSendData (Ptr<Socket> socket, Ipv4Address to);
+  /**
+   * \brief Send data and run the simulation.
+   * \param socket The sending socket.
+   * \param to Destination address.
+   */
+  void SendData (Ptr<Socket> socket, Ipv4Address to);
+  /**
+   * \brief Count the packets forwarded by the router.
+   * \param header The IPv4 header.
+   * \param packet The packet.
+   * \param interface The output interface.
+   */
+  void Forward (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface);
+  /**
+   * \brief Count the packets dropped by the router for their TTL.
+   * \param header The IPv4 header.
+   * \param packet The packet.
+   * \param reason The reason of the drop.
+   * \param ipv4 The IPv4 object.
+   * \param interface The interface.
+   */
+  void Drop (const Ipv4Header &header, Ptr<const Packet> packet,
+             Ipv4L3Protocol::DropReason reason, Ptr<Ipv4> ipv4, uint32_t interface);
+
+public:
+  virtual void DoRun (void);
+  Ipv4FastForwardingTest ();
+
+  /**
+   * \brief Receive data.
+   * \param socket The receiving socket.
+   */
+  void ReceivePkt (Ptr<Socket> socket);
+};
+
+Ipv4FastForwardingTest::Ipv4FastForwardingTest ()
+  : TestCase ("IPv4 fast forwarding"),
+    m_forwarded (0),
+    m_ttlExpired (0)
+{
+}
+
+Ptr<SimpleNetDevice>
+Ipv4FastForwardingTest::AddInterface (Ptr<Node> node, Ipv4Address address)
+{
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::ConvertFrom (Mac48Address::Allocate ()));
+  node->AddDevice (device);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  uint32_t netdev_idx = ipv4->AddInterface (device);
+  ipv4->AddAddress (netdev_idx, Ipv4InterfaceAddress (address, Ipv4Mask (0xffff0000U)));
+  ipv4->SetUp (netdev_idx);
+  return device;
+}
+
+void
+Ipv4FastForwardingTest::ReceivePkt (Ptr<Socket> socket)
+{
+  m_receivedPacket = socket->Recv (std::numeric_limits<uint32_t>::max (), 0);
+}
+
+void
+Ipv4FastForwardingTest::Forward (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface)
+{
+  m_forwarded++;
+}
+
+void
+Ipv4FastForwardingTest::Drop (const Ipv4Header &header, Ptr<const Packet> packet,
+                              Ipv4L3Protocol::DropReason reason, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (reason == Ipv4L3Protocol::DROP_TTL_EXPIRED)
+    {
+      m_ttlExpired++;
+    }
+}
+
+void
+Ipv4FastForwardingTest::DoSendData (Ptr<Socket> socket, Ipv4Address to)
+{
+  Address realTo = InetSocketAddress (to, 1234);
+  NS_TEST_EXPECT_MSG_EQ (socket->SendTo (Create<Packet> (123), 0, realTo),
+                         123, "100");
+}
+
+void
+Ipv4FastForwardingTest::SendData (Ptr<Socket> socket, Ipv4Address to)
+{
+  m_receivedPacket = Create<Packet> ();
+  Simulator::ScheduleWithContext (socket->GetNode ()->GetId (), Seconds (0),
+                                  &Ipv4FastForwardingTest::DoSendData, this, socket, to);
+  Simulator::Run ();
+}
+
+void
+Ipv4FastForwardingTest::DoRun (void)
+{
+  // txNode 10.1.0.2 -- 10.1.0.1 fwNode 10.0.0.1 -- 10.0.0.2 rxNode
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  Ptr<Node> rxNode = CreateObject<Node> ();
+  Ptr<Node> fwNode = CreateObject<Node> ();
+  Ptr<Node> txNode = CreateObject<Node> ();
+  internet.Install (NodeContainer (rxNode, fwNode, txNode));
+
+  Ptr<SimpleChannel> channel1 = CreateObject<SimpleChannel> ();
+  AddInterface (rxNode, Ipv4Address ("10.0.0.2"))->SetChannel (channel1);
+  AddInterface (fwNode, Ipv4Address ("10.0.0.1"))->SetChannel (channel1);
+  Ptr<SimpleChannel> channel2 = CreateObject<SimpleChannel> ();
+  AddInterface (fwNode, Ipv4Address ("10.1.0.1"))->SetChannel (channel2);
+  AddInterface (txNode, Ipv4Address ("10.1.0.2"))->SetChannel (channel2);
+  Ipv4RoutingHelper::GetRouting <Ipv4StaticRouting> (txNode->GetObject<Ipv4> ()->GetRoutingProtocol ())
+    ->SetDefaultRoute (Ipv4Address ("10.1.0.1"), 1);
+
+  Ptr<Ipv4L3Protocol> fwIpv4 = fwNode->GetObject<Ipv4L3Protocol> ();
+  fwIpv4->SetAttribute ("FastForwarding", BooleanValue (true));
+  fwIpv4->TraceConnectWithoutContext ("UnicastForward", MakeCallback (&Ipv4FastForwardingTest::Forward, this));
+  fwIpv4->TraceConnectWithoutContext ("Drop", MakeCallback (&Ipv4FastForwardingTest::Drop, this));
+
+  Ptr<Socket> rxSocket = rxNode->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  NS_TEST_EXPECT_MSG_EQ (rxSocket->Bind (InetSocketAddress (Ipv4Address ("10.0.0.2"), 1234)), 0, "trivial");
+  rxSocket->SetIpRecvTtl (true);
+  rxSocket->SetRecvCallback (MakeCallback (&Ipv4FastForwardingTest::ReceivePkt, this));
+  Ptr<Socket> fwSocket = fwNode->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  NS_TEST_EXPECT_MSG_EQ (fwSocket->Bind (InetSocketAddress (Ipv4Address ("10.0.0.1"), 1234)), 0, "trivial");
+  fwSocket->SetRecvCallback (MakeCallback (&Ipv4FastForwardingTest::ReceivePkt, this));
+  Ptr<Socket> txSocket = txNode->GetObject<UdpSocketFactory> ()->CreateSocket ();
+
+  // The first packet finds its route through the routing protocol, the
+  // second one through the forwarding cache
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      SendData (txSocket, Ipv4Address ("10.0.0.2"));
+      NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 123, "IPv4 fast forwarding, packet " << i);
+      SocketIpTtlTag ttl;
+      NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->RemovePacketTag (ttl), true, "The TTL should be received");
+      NS_TEST_EXPECT_MSG_EQ (uint32_t (ttl.GetTtl ()), 63, "The TTL should be decremented once");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded, 2, "The packets should be traced as forwarded");
+
+  // Packets for the router itself are delivered locally
+  SendData (txSocket, Ipv4Address ("10.0.0.1"));
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 123, "Local delivery on the router");
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded, 2, "A local packet should not be forwarded");
+
+  // An expiring TTL falls back to the normal path, which drops the packet
+  txSocket->SetIpTtl (1);
+  SendData (txSocket, Ipv4Address ("10.0.0.2"));
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 0, "A packet with TTL 1 should not be forwarded");
+  NS_TEST_EXPECT_MSG_EQ (m_ttlExpired, 1, "The packet should be dropped for its TTL");
+  txSocket->SetIpTtl (64);
+
+  // A new host route through a missing gateway must replace the cached one
+  Ptr<Ipv4StaticRouting> fwRouting = Ipv4RoutingHelper::GetRouting <Ipv4StaticRouting> (fwIpv4->GetRoutingProtocol ());
+  fwRouting->AddHostRouteTo (Ipv4Address ("10.0.0.2"), Ipv4Address ("10.0.0.3"), 1);
+  SendData (txSocket, Ipv4Address ("10.0.0.2"));
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 0, "The cached route should follow the new host route");
+
+  for (uint32_t i = 0; i < fwRouting->GetNRoutes (); i++)
+    {
+      if (fwRouting->GetRoute (i).GetDest () == Ipv4Address ("10.0.0.2"))
+        {
+          fwRouting->RemoveRoute (i);
+          break;
+        }
+    }
+  SendData (txSocket, Ipv4Address ("10.0.0.2"));
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 123, "The cached route should follow the removed host route");
+
+  // With the checksums enabled, the receiver verifies the checksum the
+  // router updated for the TTL decrement
+  GlobalValue::Bind ("ChecksumEnabled", BooleanValue (true));
+  uint32_t forwarded = m_forwarded;
+  SendData (txSocket, Ipv4Address ("10.0.0.2"));
+  GlobalValue::Bind ("ChecksumEnabled", BooleanValue (false));
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded, forwarded + 1, "The packet should be fast forwarded with checksums");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 123, "The updated checksum should be correct");
+
+  Simulator::Destroy ();
+}
+
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -235,6 +448,7 @@ Ipv4ForwardingTestSuite::Ipv4ForwardingTestSuite ()
   : TestSuite ("ipv4-forwarding", UNIT)
 {
   AddTestCase (new Ipv4ForwardingTest, TestCase::QUICK);
+  AddTestCase (new Ipv4FastForwardingTest, TestCase::QUICK);
 }
 
 static Ipv4ForwardingTestSuite g_ipv4forwardingTestSuite; //!< Static variable for test initialization
@@ -41,6 +41,7 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-route.h"
 #include "ns3/bridge-helper.h"
 
 using namespace ns3;
@@ -1244,6 +1245,155 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting forwarding table test
+ *
+ * Checks that the lookups prefer host routes, then the longest matching
+ * network, then the external routes, that equal-cost routes are picked
+ * in order or at random, and that the forwarding table follows the
+ * routes added and removed.
+ */
+class Ipv4GlobalRoutingFibTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingFibTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Look up a destination.
+   * \param dest The destination.
+   * \param oif The output device, or 0.
+   * \return The route found, or 0.
+   */
+  Ptr<Ipv4Route> Lookup (std::string dest, Ptr<NetDevice> oif = 0);
+
+  Ptr<Ipv4GlobalRouting> m_routing; //!< The routing protocol under test
+};
+
+Ipv4GlobalRoutingFibTestCase::Ipv4GlobalRoutingFibTestCase ()
+  : TestCase ("Global routing forwarding table lookups")
+{
+}
+
+Ptr<Ipv4Route>
+Ipv4GlobalRoutingFibTestCase::Lookup (std::string dest, Ptr<NetDevice> oif)
+{
+  Ipv4Header header;
+  header.SetDestination (Ipv4Address (dest.c_str ()));
+  Socket::SocketErrno err;
+  return m_routing->RouteOutput (0, header, oif, err);
+}
+
+void
+Ipv4GlobalRoutingFibTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      devices.Add (device);
+    }
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("192.168.0.0", "255.255.255.0");
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      ipv4.Assign (NetDeviceContainer (devices.Get (i)));
+      ipv4.NewNetwork ();
+    }
+
+  m_routing = CreateObject<Ipv4GlobalRouting> ();
+  m_routing->SetIpv4 (node->GetObject<Ipv4> ());
+  m_routing->AddHostRouteTo (Ipv4Address ("10.1.2.3"), Ipv4Address ("192.168.3.2"), 4);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("/8"), Ipv4Address ("192.168.0.2"), 1);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("/16"), Ipv4Address ("192.168.1.2"), 2);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.1.2.0"), Ipv4Mask ("/24"), Ipv4Address ("192.168.2.2"), 3);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.1.2.0"), Ipv4Mask ("/24"), Ipv4Address ("192.168.3.2"), 4);
+  m_routing->AddASExternalRouteTo (Ipv4Address ("11.0.0.0"), Ipv4Mask ("/8"), Ipv4Address ("192.168.1.2"), 2);
+
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.2.3")->GetOutputDevice (), devices.Get (3), "Host routes come first");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.2.4")->GetOutputDevice (), devices.Get (2), "The first equal-cost route is used");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.3.1")->GetOutputDevice (), devices.Get (1), "The longest prefix wins");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.2.0.1")->GetOutputDevice (), devices.Get (0), "The shortest prefix matches too");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("11.0.0.1")->GetGateway (), Ipv4Address ("192.168.1.2"), "External routes come last");
+  NS_TEST_EXPECT_MSG_EQ ((Lookup ("12.0.0.1") == 0), true, "No route to an unknown network");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.2.4", devices.Get (3))->GetOutputDevice (), devices.Get (3), "The route of the output device is used");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.2.3", devices.Get (0))->GetOutputDevice (), devices.Get (0), "Shorter prefixes are used for other output devices");
+
+  // The host route is the first route
+  m_routing->RemoveRoute (0);
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.2.3")->GetOutputDevice (), devices.Get (2), "The host route should be removed");
+
+  m_routing->SetAttribute ("RandomEcmpRouting", BooleanValue (true));
+  m_routing->AssignStreams (1);
+  uint32_t counts[2] = { 0, 0 };
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Ptr<NetDevice> device = Lookup ("10.1.2.4")->GetOutputDevice ();
+      counts[0] += device == devices.Get (2);
+      counts[1] += device == devices.Get (3);
+    }
+  NS_TEST_EXPECT_MSG_EQ (counts[0] + counts[1], 100, "Only the equal-cost routes are picked");
+  NS_TEST_EXPECT_MSG_GT (counts[0], 0, "Both equal-cost routes should be picked");
+  NS_TEST_EXPECT_MSG_GT (counts[1], 0, "Both equal-cost routes should be picked");
+  m_routing->SetAttribute ("RandomEcmpRouting", BooleanValue (false));
+
+  // Compare with a search of every route, in a table of many overlapping
+  // prefixes
+  while (m_routing->GetNRoutes () > 0)
+    {
+      m_routing->RemoveRoute (0);
+    }
+  std::vector<uint32_t> prefixes;
+  std::vector<uint32_t> lengths;
+  uint32_t state = 1;
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      state = state * 1103515245 + 12345;
+      uint32_t length = 8 + (state >> 16) % 25;
+      state = state * 1103515245 + 12345;
+      // All in 10.0.0.0/8, so that the prefixes overlap
+      uint32_t prefix = (0x0a000000 | (state >> 8)) & (0xffffffff << (32 - length));
+      prefixes.push_back (prefix);
+      lengths.push_back (length);
+      m_routing->AddNetworkRouteTo (Ipv4Address (prefix), Ipv4Mask (0xffffffff << (32 - length)),
+                                    Ipv4Address (i + 1), 1);
+    }
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      state = state * 1103515245 + 12345;
+      uint32_t dest = i % 2 ? prefixes[i] | (state & ~(0xffffffff << (32 - lengths[i]))) : 0x0a000000 | (state >> 8);
+      uint32_t best = 0;
+      uint32_t bestLength = 0;
+      for (uint32_t j = 0; j < prefixes.size (); j++)
+        {
+          if (lengths[j] > bestLength && (dest & (0xffffffff << (32 - lengths[j]))) == prefixes[j])
+            {
+              best = j + 1;
+              bestLength = lengths[j];
+            }
+        }
+      Ipv4Header header;
+      header.SetDestination (Ipv4Address (dest));
+      Socket::SocketErrno err;
+      Ptr<Ipv4Route> route = m_routing->RouteOutput (0, header, 0, err);
+      uint32_t found = route ? route->GetGateway ().Get () : 0;
+      NS_TEST_EXPECT_MSG_EQ (found, best, "Wrong route to " << Ipv4Address (dest));
+    }
+
+  m_routing->Dispose ();
+  m_routing = 0;
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1417,7 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingFibTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
@@ -265,6 +265,85 @@ Ipv4HeaderTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 Header incremental checksum Test
+ *
+ * Decrement the TTL of headers deserialized with their checksum enabled,
+ * and check that the checksum updated incrementally is the one computed
+ * from scratch, for all the TTLs and a few protocols and addresses.
+ */
+class Ipv4HeaderChecksumTest : public TestCase
+{
+public:
+  Ipv4HeaderChecksumTest ();
+  virtual void DoRun (void);
+};
+
+Ipv4HeaderChecksumTest::Ipv4HeaderChecksumTest ()
+  : TestCase ("IPv4 Header incremental checksum")
+{
+}
+
+void
+Ipv4HeaderChecksumTest::DoRun (void)
+{
+  uint8_t protocols[] = {0, 1, 6, 17, 255};
+  const char *sources[] = {"10.1.1.1", "0.0.0.0", "255.255.255.255", "192.168.254.255"};
+  for (uint32_t a = 0; a < sizeof (sources) / sizeof (sources[0]); a++)
+    {
+      for (uint32_t k = 0; k < sizeof (protocols); k++)
+        {
+          for (uint32_t ttl = 1; ttl < 256; ttl++)
+            {
+              Ipv4Header sent;
+              sent.EnableChecksum ();
+              sent.SetSource (Ipv4Address (sources[a]));
+              sent.SetDestination (Ipv4Address ("10.2.2.2"));
+              sent.SetProtocol (protocols[k]);
+              sent.SetTtl (ttl);
+              sent.SetIdentification (ttl * 257);
+              sent.SetPayloadSize (100);
+              Ptr<Packet> packet = Create<Packet> (100);
+              packet->AddHeader (sent);
+
+              Ipv4Header received;
+              received.EnableChecksum ();
+              packet->RemoveHeader (received);
+              NS_TEST_ASSERT_MSG_EQ (received.IsChecksumOk (), true, "checksum of the header sent");
+              received.DecrementTtl ();
+              NS_TEST_ASSERT_MSG_EQ (received.GetTtl (), ttl - 1, "TTL decremented");
+              packet->AddHeader (received);
+
+              Ipv4Header forwarded;
+              forwarded.EnableChecksum ();
+              packet->RemoveHeader (forwarded);
+              NS_TEST_ASSERT_MSG_EQ (forwarded.IsChecksumOk (), true,
+                                     "checksum updated for TTL " << ttl << " and protocol "
+                                                                 << (uint32_t) protocols[k]);
+            }
+        }
+    }
+
+  // Setting a field after the decrement computes the checksum again
+  Ipv4Header header;
+  header.EnableChecksum ();
+  header.SetTtl (64);
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (header);
+  Ipv4Header received;
+  received.EnableChecksum ();
+  packet->RemoveHeader (received);
+  received.DecrementTtl ();
+  received.SetDestination (Ipv4Address ("10.3.3.3"));
+  packet->AddHeader (received);
+  received.EnableChecksum ();
+  packet->RemoveHeader (received);
+  NS_TEST_ASSERT_MSG_EQ (received.IsChecksumOk (), true, "checksum computed after a field is set");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -277,6 +356,7 @@ public:
   Ipv4HeaderTestSuite () : TestSuite ("ipv4-header", UNIT)
   {
     AddTestCase (new Ipv4HeaderTest, TestCase::QUICK);
+    AddTestCase (new Ipv4HeaderChecksumTest, TestCase::QUICK);
   }
 };
 
@@ -24,6 +24,10 @@
 #include "ns3/tcp-header.h"
 #include "ns3/buffer.h"
 #include "ns3/tcp-option-rfc793.h"
+#include "ns3/tcp-option-ts.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/packet.h"
 
 using namespace ns3;
 
@@ -421,6 +425,111 @@ TcpHeaderFlagsToString::DoRun (void)
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the IPv4, TCP and UDP header views against the headers.
+ */
+class TcpHeaderViewTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param name Test description.
+   */
+  TcpHeaderViewTestCase (std::string name);
+protected:
+  virtual void DoRun (void);
+};
+
+TcpHeaderViewTestCase::TcpHeaderViewTestCase (std::string name) : TestCase (name)
+{
+}
+
+void
+TcpHeaderViewTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable> ();
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      TcpHeader tcp;
+      tcp.SetSourcePort (GET_RANDOM_UINT16 (x));
+      tcp.SetDestinationPort (GET_RANDOM_UINT16 (x));
+      tcp.SetSequenceNumber (SequenceNumber32 (GET_RANDOM_UINT32 (x)));
+      tcp.SetAckNumber (SequenceNumber32 (GET_RANDOM_UINT32 (x)));
+      tcp.SetFlags (GET_RANDOM_UINT6 (x));
+      tcp.SetWindowSize (GET_RANDOM_UINT16 (x));
+      tcp.SetUrgentPointer (GET_RANDOM_UINT16 (x));
+      if (i % 2)
+        {
+          tcp.AppendOption (CreateObject<TcpOptionTS> ());
+        }
+      Ipv4Header ip;
+      ip.SetSource (Ipv4Address (GET_RANDOM_UINT32 (x)));
+      ip.SetDestination (Ipv4Address (GET_RANDOM_UINT32 (x)));
+      ip.SetTtl (GET_RANDOM_UINT8 (x));
+      ip.SetTos (GET_RANDOM_UINT8 (x));
+      ip.SetProtocol (6);
+      ip.SetIdentification (GET_RANDOM_UINT16 (x));
+      ip.SetFragmentOffset (8 * (i % 64));
+      if (i % 3)
+        {
+          ip.SetMoreFragments ();
+        }
+      ip.SetPayloadSize (1000 + tcp.GetSerializedSize ());
+
+      // The payload is a zero area: the headers are still contiguous
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddHeader (tcp);
+      p->AddHeader (ip);
+
+      Ipv4HeaderView ipView;
+      NS_TEST_ASSERT_MSG_EQ (ipView.Peek (p), true, "IPv4 header not contiguous");
+      NS_TEST_EXPECT_MSG_EQ (ipView.GetSerializedSize (), ip.GetSerializedSize (), "header size");
+      NS_TEST_EXPECT_MSG_EQ (ipView.GetSource (), ip.GetSource (), "source");
+      NS_TEST_EXPECT_MSG_EQ (ipView.GetDestination (), ip.GetDestination (), "destination");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) ipView.GetTtl (), (uint32_t) ip.GetTtl (), "ttl");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) ipView.GetTos (), (uint32_t) ip.GetTos (), "tos");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) ipView.GetProtocol (), 6, "protocol");
+      NS_TEST_EXPECT_MSG_EQ (ipView.GetIdentification (), ip.GetIdentification (), "identification");
+      NS_TEST_EXPECT_MSG_EQ (ipView.GetFragmentOffset (), ip.GetFragmentOffset (), "fragment offset");
+      NS_TEST_EXPECT_MSG_EQ (ipView.IsLastFragment (), ip.IsLastFragment (), "last fragment");
+      NS_TEST_EXPECT_MSG_EQ (ipView.IsDontFragment (), ip.IsDontFragment (), "don't fragment");
+      NS_TEST_EXPECT_MSG_EQ (ipView.GetPayloadSize (), ip.GetPayloadSize (), "payload size");
+
+      TcpHeaderView tcpView;
+      NS_TEST_ASSERT_MSG_EQ (tcpView.Peek (p, ipView.GetSerializedSize ()), true, "TCP header not contiguous");
+      NS_TEST_EXPECT_MSG_EQ (tcpView.GetSourcePort (), tcp.GetSourcePort (), "source port");
+      NS_TEST_EXPECT_MSG_EQ (tcpView.GetDestinationPort (), tcp.GetDestinationPort (), "destination port");
+      NS_TEST_EXPECT_MSG_EQ (tcpView.GetSequenceNumber (), tcp.GetSequenceNumber (), "sequence number");
+      NS_TEST_EXPECT_MSG_EQ (tcpView.GetAckNumber (), tcp.GetAckNumber (), "ack number");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) tcpView.GetFlags (), (uint32_t) tcp.GetFlags (), "flags");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) tcpView.GetLength (), (uint32_t) tcp.GetLength (), "length");
+      NS_TEST_EXPECT_MSG_EQ (tcpView.GetWindowSize (), tcp.GetWindowSize (), "window");
+      NS_TEST_EXPECT_MSG_EQ (tcpView.GetUrgentPointer (), tcp.GetUrgentPointer (), "urgent pointer");
+
+      // The payload itself is not stored
+      NS_TEST_EXPECT_MSG_EQ (tcpView.Peek (p, p->GetSize () - 1000), false, "zero area peeked");
+      NS_TEST_EXPECT_MSG_EQ (tcpView.IsValid (), false, "failed peek leaves a valid view");
+    }
+
+  UdpHeader udp;
+  udp.SetSourcePort (1234);
+  udp.SetDestinationPort (4321);
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddHeader (udp);
+  UdpHeaderView udpView;
+  NS_TEST_ASSERT_MSG_EQ (udpView.Peek (p), true, "UDP header not contiguous");
+  NS_TEST_EXPECT_MSG_EQ (udpView.GetSourcePort (), 1234, "source port");
+  NS_TEST_EXPECT_MSG_EQ (udpView.GetDestinationPort (), 4321, "destination port");
+  NS_TEST_EXPECT_MSG_EQ (udpView.GetPayloadSize (), 100, "payload size");
+
+  // Not an IPv4 header
+  Ipv4HeaderView ipView;
+  NS_TEST_EXPECT_MSG_EQ (ipView.Peek (p), false, "UDP header taken for an IPv4 header");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -436,6 +545,7 @@ public:
     AddTestCase (new TcpHeaderGetSetTestCase ("GetSet test cases"), TestCase::QUICK);
     AddTestCase (new TcpHeaderWithRFC793OptionTestCase ("Test for options in RFC 793"), TestCase::QUICK);
     AddTestCase (new TcpHeaderFlagsToString ("Test flags to string function"), TestCase::QUICK);
+    AddTestCase (new TcpHeaderViewTestCase ("Test the header views"), TestCase::QUICK);
   }
 
 };
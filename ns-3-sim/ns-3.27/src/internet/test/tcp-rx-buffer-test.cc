@@ -18,6 +18,8 @@
 #include "ns3/test.h"
 #include "ns3/packet.h"
 #include "ns3/log.h"
+#include "ns3/socket.h"
+#include <cstring>
 
 #include "ns3/tcp-rx-buffer.h"
 
@@ -44,6 +46,14 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+  /**
+   * \brief Test the reassembly of overlapping segments and their delivery.
+   */
+  void TestReassembly ();
+  /**
+   * \brief Test that the packets extracted are independent of the segments.
+   */
+  void TestExtractTags ();
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase ()
@@ -55,6 +65,8 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestReassembly ();
+  TestExtractTags ();
 }
 
 void
@@ -338,6 +350,116 @@ TcpRxBufferTestCase::TestUpdateSACKList ()
                          "SACK list should contain no element");
 }
 
+void
+TcpRxBufferTestCase::TestReassembly ()
+{
+  TcpRxBuffer rxBuf;
+  TcpOptionSack::SackList sackList;
+  TcpHeader h;
+  uint8_t data[1000];
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      data[i] = i % 251;
+    }
+
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+
+  // Two blocks out of order, from 201 to 401 and from 601 to 701
+  h.SetSequenceNumber (SequenceNumber32 (201));
+  rxBuf.Add (Create<Packet> (data + 200, 100), h);
+  h.SetSequenceNumber (SequenceNumber32 (301));
+  rxBuf.Add (Create<Packet> (data + 300, 100), h);
+  h.SetSequenceNumber (SequenceNumber32 (601));
+  rxBuf.Add (Create<Packet> (data + 600, 100), h);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 300, "Three segments should be held");
+
+  // A segment overlapping the head of the first block reports the whole
+  // block it joins
+  h.SetSequenceNumber (SequenceNumber32 (151));
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Add (Create<Packet> (data + 150, 150), h), true,
+                         "The bytes not held should be stored");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 350, "Only the bytes not held should be stored");
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 2, "Two blocks should be reported");
+  NS_TEST_ASSERT_MSG_EQ (sackList.begin ()->first, SequenceNumber32 (151),
+                         "SACK block different than expected");
+  NS_TEST_ASSERT_MSG_EQ (sackList.begin ()->second, SequenceNumber32 (401),
+                         "SACK block different than expected");
+
+  // A segment already held is not stored again
+  h.SetSequenceNumber (SequenceNumber32 (251));
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Add (Create<Packet> (data + 250, 100), h), false,
+                         "Nothing should be stored");
+
+  // A segment embedding the second block replaces it
+  h.SetSequenceNumber (SequenceNumber32 (551));
+  rxBuf.Add (Create<Packet> (data + 550, 200), h);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 450, "The embedded block should be replaced");
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 2, "Two blocks should be reported");
+  NS_TEST_ASSERT_MSG_EQ (sackList.begin ()->first, SequenceNumber32 (551),
+                         "SACK block different than expected");
+  NS_TEST_ASSERT_MSG_EQ (sackList.begin ()->second, SequenceNumber32 (751),
+                         "SACK block different than expected");
+
+  // The head fills the first hole, overlapping the first block
+  h.SetSequenceNumber (SequenceNumber32 (1));
+  rxBuf.Add (Create<Packet> (data, 200), h);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (401),
+                         "Sequence number differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 400, "The first block should be available");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 1, "One block should be left");
+
+  // Extract in two parts, then fill the last hole and extract the rest
+  uint8_t out[1000];
+  Ptr<Packet> p = rxBuf.Extract (100);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 100, "Partial extraction expected");
+  p->CopyData (out, 100);
+  p = rxBuf.Extract (1000);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 300, "The rest of the first block expected");
+  p->CopyData (out + 100, 300);
+  h.SetSequenceNumber (SequenceNumber32 (401));
+  rxBuf.Add (Create<Packet> (data + 400, 150), h);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (751),
+                         "Sequence number differs from expected");
+  p = rxBuf.Extract (1000);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 350, "The second block expected");
+  p->CopyData (out + 400, 350);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 0, "The buffer should be empty");
+  NS_TEST_ASSERT_MSG_EQ (memcmp (out, data, 750), 0, "Data delivered out of order");
+}
+
+void
+TcpRxBufferTestCase::TestExtractTags ()
+{
+  TcpRxBuffer rxBuf;
+  TcpHeader h;
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+
+  SocketPriorityTag priorityTag;
+  priorityTag.SetPriority (3);
+  Ptr<Packet> segment = Create<Packet> (200);
+  segment->AddPacketTag (priorityTag);
+  h.SetSequenceNumber (SequenceNumber32 (1));
+  rxBuf.Add (segment, h);
+
+  // A partial extraction leaves the segment received untouched
+  Ptr<Packet> p = rxBuf.Extract (100);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 100, "Partial extraction expected");
+  NS_TEST_ASSERT_MSG_EQ (segment->GetSize (), 200, "The segment received should not be trimmed");
+  NS_TEST_ASSERT_MSG_EQ (p->PeekPacketTag (priorityTag), false,
+                         "The packet extracted should carry no packet tag");
+  // The caller can tag the packet extracted
+  p->AddPacketTag (priorityTag);
+
+  p = rxBuf.Extract (100);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 100, "The rest of the segment expected");
+  NS_TEST_ASSERT_MSG_EQ (p->PeekPacketTag (priorityTag), false,
+                         "The packet extracted should carry no packet tag");
+  NS_TEST_ASSERT_MSG_EQ (segment->PeekPacketTag (priorityTag), true,
+                         "The segment received should keep its packet tag");
+}
+
 void
 TcpRxBufferTestCase::DoTeardown ()
 {
@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/tcp-state-sampler.h"
+#include "ns3/string.h"
+#include "ns3/log.h"
+
+#include <fstream>
+#include <string>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStateSamplerTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Sample a bulk transfer over a link with a 20 ms RTT, in memory
+ * and streamed to a file.
+ */
+class TcpStateSamplerTestCase : public TestCase
+{
+public:
+  TcpStateSamplerTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Send data until m_totalBytes are sent.
+   * \param socket the sending socket
+   * \param available the space available in the send buffer
+   */
+  void SourceHandleSend (Ptr<Socket> socket, uint32_t available);
+  /**
+   * \brief Accept a connection, and read what it receives.
+   * \param socket the new socket
+   * \param from the address of the peer
+   */
+  void ServerHandleAccept (Ptr<Socket> socket, const Address &from);
+  /**
+   * \brief Read what the server receives.
+   * \param socket the receiving socket
+   */
+  void ServerHandleRecv (Ptr<Socket> socket);
+
+  uint32_t m_totalBytes;  //!< Bytes to send
+  uint32_t m_sentBytes;   //!< Bytes sent so far
+};
+
+TcpStateSamplerTestCase::TcpStateSamplerTestCase ()
+  : TestCase ("Sample the state of the sockets of a bulk transfer"),
+    m_totalBytes (500000),
+    m_sentBytes (0)
+{
+}
+
+void
+TcpStateSamplerTestCase::SourceHandleSend (Ptr<Socket> socket, uint32_t available)
+{
+  while (socket->GetTxAvailable () > 0 && m_sentBytes < m_totalBytes)
+    {
+      uint32_t toSend = std::min (m_totalBytes - m_sentBytes, socket->GetTxAvailable ());
+      int sent = socket->Send (Create<Packet> (toSend));
+      NS_TEST_EXPECT_MSG_EQ ((sent > 0), true, "Error during send");
+      m_sentBytes += sent;
+    }
+}
+
+void
+TcpStateSamplerTestCase::ServerHandleAccept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&TcpStateSamplerTestCase::ServerHandleRecv, this));
+}
+
+void
+TcpStateSamplerTestCase::ServerHandleRecv (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+    }
+}
+
+void
+TcpStateSamplerTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper link;
+  link.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  link.SetChannelAttribute ("Delay", StringValue ("10ms"));
+  NetDeviceContainer devices = link.Install (nodes);
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  uint16_t port = 50000;
+  Ptr<Socket> server = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), port));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&TcpStateSamplerTestCase::ServerHandleAccept, this));
+  Ptr<Socket> source = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  source->SetSendCallback (MakeCallback (&TcpStateSamplerTestCase::SourceHandleSend, this));
+  source->Connect (InetSocketAddress (interfaces.GetAddress (1), port));
+
+  // The same samples, kept in memory and streamed
+  Ptr<TcpStateSampler> sampler = CreateObject<TcpStateSampler> ();
+  sampler->SetAttribute ("Interval", TimeValue (MilliSeconds (10)));
+  sampler->Install (nodes);
+  sampler->Start (Seconds (0));
+  sampler->Stop (Seconds (1));
+  Ptr<TcpStateSampler> streamer = CreateObject<TcpStateSampler> ();
+  streamer->SetAttribute ("Interval", TimeValue (MilliSeconds (10)));
+  streamer->InstallAll ();
+  streamer->Start (Seconds (0));
+  streamer->Stop (Seconds (1));
+  std::string fileName = CreateTempDirFilename ("tcp-state-sampler.csv");
+  streamer->EnableStreaming (fileName);
+
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sentBytes, m_totalBytes, "The transfer did not complete");
+  NS_TEST_ASSERT_MSG_EQ (sampler->GetNFlows (), 2, "Both ends of the connection should be seen");
+
+  const TcpStateSampler::Samples &samples = sampler->GetSamples ();
+  uint32_t sourceRows = 0;
+  uint32_t firstCwnd = 0;
+  uint32_t maxCwnd = 0;
+  for (uint32_t i = 0; i < sampler->GetNRows (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((samples.time[i] <= Seconds (1)), true, "Sample after the stop");
+      if (sampler->GetFlow (samples.flowId[i]).node != 0)
+        {
+          continue;
+        }
+      if (sourceRows++ == 0)
+        {
+          firstCwnd = samples.cWnd[i];
+        }
+      maxCwnd = std::max (maxCwnd, samples.cWnd[i]);
+      // The RTT is the 20 ms of the link, plus the queueing of at most a
+      // receive window of 128 KiB at 10 Mbps
+      if (samples.time[i] > Seconds (0.1) && samples.bytesInFlight[i] > 0)
+        {
+          NS_TEST_ASSERT_MSG_GT_OR_EQ (samples.srtt[i], MilliSeconds (20), "RTT too low");
+          NS_TEST_ASSERT_MSG_LT (samples.srtt[i], MilliSeconds (200), "RTT too high");
+        }
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (samples.bytesInFlight[i], samples.cWnd[i],
+                                   "More in flight than the window");
+      NS_TEST_ASSERT_MSG_EQ (samples.retransmits[i], 0, "Nothing should be retransmitted");
+    }
+  NS_TEST_ASSERT_MSG_GT (sourceRows, 50, "The source should be sampled every 10 ms");
+  NS_TEST_ASSERT_MSG_GT (maxCwnd, firstCwnd, "The window should grow");
+
+  // The streamed file has a line of column names, then the same rows
+  Simulator::Destroy ();
+  std::ifstream file (fileName.c_str ());
+  std::string line;
+  uint32_t lines = 0;
+  while (std::getline (file, line))
+    {
+      lines++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (lines, sampler->GetNRows () + 1, "Rows missing in the streamed file");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief the TestSuite for the TcpStateSampler test case
+ */
+class TcpStateSamplerTestSuite : public TestSuite
+{
+public:
+  TcpStateSamplerTestSuite ()
+    : TestSuite ("tcp-state-sampler", UNIT)
+  {
+    AddTestCase (new TcpStateSamplerTestCase, TestCase::QUICK);
+  }
+};
+
+static TcpStateSamplerTestSuite g_tcpStateSamplerTestSuite; //!< Static variable for test initialization
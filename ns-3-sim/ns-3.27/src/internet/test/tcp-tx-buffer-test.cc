@@ -49,6 +49,8 @@ private:
   void TestNextSeg ();
   /** \brief Test the scoreboard with emulated SACK */
   void TestUpdateScoreboardWithCraftedSACK ();
+  /** \brief Test the pipe and the retransmission count kept by the scoreboard */
+  void TestScoreboardCounters ();
 };
 
 TcpTxBufferTestCase::TcpTxBufferTestCase ()
@@ -82,6 +84,8 @@ TcpTxBufferTestCase::DoRun ()
                        &TcpTxBufferTestCase::TestNextSeg, this);
   Simulator::Schedule (Seconds (0.0),
                        &TcpTxBufferTestCase::TestUpdateScoreboardWithCraftedSACK, this);
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestScoreboardCounters, this);
 
   Simulator::Run ();
   Simulator::Destroy ();
@@ -390,6 +394,76 @@ TcpTxBufferTestCase::TestUpdateScoreboardWithCraftedSACK ()
                          "Data inside the buffer");
 }
 
+void
+TcpTxBufferTestCase::TestScoreboardCounters ()
+{
+  TcpTxBuffer txBuf;
+  SequenceNumber32 ret;
+  uint32_t dupThresh = 3;
+  uint32_t segmentSize = 100;
+  txBuf.SetHeadSequence (SequenceNumber32 (1));
+  txBuf.Add (Create<Packet> (2000));
+
+  // Send ten segments, from 1 to 1001
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      txBuf.CopyFromSequence (segmentSize, SequenceNumber32 (1 + i * segmentSize));
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (dupThresh, segmentSize), 1000,
+                         "All the segments sent should be in flight");
+
+  // One SACKed segment does not make the ones below it lost
+  TcpOptionSack::SackList sackList;
+  sackList.push_back (TcpOptionSack::SackBlock (SequenceNumber32 (201), SequenceNumber32 (301)));
+  txBuf.Update (sackList);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (dupThresh, segmentSize), 900,
+                         "The SACKed segment should have left the network");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (SequenceNumber32 (1), dupThresh, segmentSize), false,
+                         "The head should not be lost yet");
+
+  // Three SACKed segments make the two below them lost
+  sackList.push_back (TcpOptionSack::SackBlock (SequenceNumber32 (401), SequenceNumber32 (601)));
+  txBuf.Update (sackList);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (SequenceNumber32 (1), dupThresh, segmentSize), true,
+                         "The head should be lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (SequenceNumber32 (301), dupThresh, segmentSize), false,
+                         "The segment between the SACKed blocks should not be lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (dupThresh, segmentSize), 500,
+                         "Lost and SACKed segments should have left the network");
+
+  // Retransmit half of the head, then the rest of the hole at once: the
+  // lost segments are split and merged, and go back in flight
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, dupThresh, segmentSize, true), true,
+                         "The head should be retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (ret, SequenceNumber32 (1), "The head should be retransmitted");
+  txBuf.CopyFromSequence (50, ret);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (dupThresh, segmentSize), 550,
+                         "The retransmitted half should be in flight");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetRetransmitsCount (), 1, "One segment retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, dupThresh, segmentSize, true), true,
+                         "The rest of the hole should be retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (ret, SequenceNumber32 (51), "The rest of the hole should be retransmitted");
+  txBuf.CopyFromSequence (150, ret);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (dupThresh, segmentSize), 700,
+                         "The whole hole should be in flight");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetRetransmitsCount (), 2, "Two segments retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, dupThresh, segmentSize, true), true,
+                         "New data should be sent");
+  NS_TEST_ASSERT_MSG_EQ (ret, SequenceNumber32 (1001), "New data should be sent");
+
+  // The cumulative ACK takes the retransmissions and the first SACKed
+  // segment away; the segment left below the SACKed block is not lost
+  txBuf.DiscardUpTo (SequenceNumber32 (301));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetRetransmitsCount (), 0, "No retransmission left");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (dupThresh, segmentSize), 500,
+                         "Only the segments not SACKed should be in flight");
+
+  // Everything acknowledged
+  txBuf.DiscardUpTo (SequenceNumber32 (1001));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (dupThresh, segmentSize), 0,
+                         "Nothing should be in flight");
+}
+
 void
 TcpTxBufferTestCase::TestTransmittedBlock ()
 {
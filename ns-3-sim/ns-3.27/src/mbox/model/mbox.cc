@@ -706,7 +706,7 @@ MyApp::ScheduleTx (void)
   NS_LOG_FUNCTION("  Begin.  ");
   if (m_running)
     {
-      Time tNext (Seconds (m_packetSize * 8 / static_cast<double> (m_dataRate.GetBitRate ())));
+      Time tNext (m_dataRate.CalculateBytesTxTime (m_packetSize));
       m_sendEvent = Simulator::Schedule (tNext, &MyApp::SendPacket, this);
     }
    NS_LOG_FUNCTION("  Over.  ");
@@ -378,6 +378,7 @@ void MiniBox::install (Ptr<Node> node, Ptr<NetDevice> device, HeaderType htype)
     // m_socket = socket;      // assume each node only transmits 1 flow
     string nodeId = to_string (m_node->GetId ());
     m_sktPath = "/NodeList/" + nodeId + "/$ns3::TcpL4Protocol/SocketList/0/";
+    m_sktConfig = Config::ConfigPath (m_sktPath);
     m_hType = htype;
 
     NS_LOG_INFO ("- Path: " << m_sktPath);
@@ -400,12 +401,12 @@ void MiniBox::connect ()
     // trace connect to all the sinks
     m_device->TraceConnectWithoutContext ("MacTx", MakeCallback (&MiniBox::onMacTx, this));
     m_device->TraceConnectWithoutContext ("MacRx", MakeCallback (&MiniBox::onMacRx, this));
-    Config::Connect (m_sktPath + "RTT", MakeCallback(&MiniBox::onRttChange, this));
-    Config::Connect (m_sktPath + "RxAck", MakeCallback(&MiniBox::onRxAck, this));
-    Config::Connect (m_sktPath + "Latency", MakeCallback(&MiniBox::onLatency, this));
+    m_sktConfig.Connect ("RTT", MakeCallback(&MiniBox::onRttChange, this));
+    m_sktConfig.Connect ("RxAck", MakeCallback(&MiniBox::onRxAck, this));
+    m_sktConfig.Connect ("Latency", MakeCallback(&MiniBox::onLatency, this));
 
     // for debug only
-    Config::Connect (m_sktPath + "CongestionWindow", MakeCallback(&MiniBox::onCwnd, this));
+    m_sktConfig.Connect ("CongestionWindow", MakeCallback(&MiniBox::onCwnd, this));
 }
 
 void MiniBox::stop (Time t)
@@ -422,9 +423,9 @@ void MiniBox::disconnect ()
     m_isRunning = false;
     m_device->TraceDisconnectWithoutContext ("MacTx", MakeCallback (&MiniBox::onMacTx, this));
     m_device->TraceDisconnectWithoutContext ("MacRx", MakeCallback (&MiniBox::onMacRx, this));
-    Config::Disconnect (m_sktPath + "RTT", MakeCallback(&MiniBox::onRttChange, this));
-    Config::Disconnect (m_sktPath + "RxAck", MakeCallback(&MiniBox::onRxAck, this));
-    Config::Disconnect (m_sktPath + "Latency", MakeCallback(&MiniBox::onLatency, this));
+    m_sktConfig.Disconnect ("RTT", MakeCallback(&MiniBox::onRttChange, this));
+    m_sktConfig.Disconnect ("RxAck", MakeCallback(&MiniBox::onRxAck, this));
+    m_sktConfig.Disconnect ("Latency", MakeCallback(&MiniBox::onLatency, this));
 }
 
 void MiniBox::onMacTx (Ptr<const Packet> p)
@@ -116,6 +116,7 @@ public:
 private:
     vector<uint32_t> m_id;           // [run id, flow/socket id]
     string m_sktPath;           // socket path
+    Config::ConfigPath m_sktConfig; // parsed socket path, reused by every connect
     string m_devPath;           // device path
     HeaderType m_hType;           // Layer 2 header type
     Ptr<Node> m_node;
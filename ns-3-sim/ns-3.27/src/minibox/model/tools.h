@@ -122,6 +122,8 @@ Ipv4Address getIpDesAddr(Ptr<const Packet> p)   // ip layer information, work fo
 {
   // debug 
   if(is_debug) cout << " Begin get ip des addr. " << endl;
+  Ipv4HeaderView ipV;
+  if(ipV.Peek(p, PppHeaderView::SIZE)) return ipV.GetDestination();      // fast path: no copy nor deserialization
   Ptr<Packet> pcp = p->Copy();
   PppHeader pppH;
   Ipv4Header ipH;
@@ -134,6 +136,8 @@ Ipv4Address getIpSrcAddr(Ptr<const Packet> p)   // ip layer information, work fo
 {
   // debug 
   if(is_debug)  cout << " Begin get ip src addr." << endl;
+  Ipv4HeaderView ipV;
+  if(ipV.Peek(p, PppHeaderView::SIZE)) return ipV.GetSource();
   Ptr<Packet> pcp = p->Copy();
   
   // if(pcp->GetSize() <= 300)
@@ -165,6 +169,10 @@ uint32_t getTcpSize(Ptr <const Packet> p)
 {
   // debug 
   if(is_debug) cout << " Begin get tcp size. " << endl;
+  Ipv4HeaderView ipV;
+  TcpHeaderView tcpV;
+  if(ipV.Peek(p, PppHeaderView::SIZE) && tcpV.Peek(p, PppHeaderView::SIZE + ipV.GetSerializedSize()))
+    return p->GetSize() - PppHeaderView::SIZE - ipV.GetSerializedSize() - tcpV.GetLength() * 4;
   Ptr<Packet> pktCopy = p->Copy();
   PppHeader pppH;
   Ipv4Header ipH;
@@ -179,6 +187,10 @@ uint16_t getTcpFlag(Ptr <const Packet> p)
 {
   // debug 
   if(is_debug) cout << " Begin get tcp flag. " << endl;
+  Ipv4HeaderView ipV;
+  TcpHeaderView tcpV;
+  if(ipV.Peek(p, PppHeaderView::SIZE) && tcpV.Peek(p, PppHeaderView::SIZE + ipV.GetSerializedSize()))
+    return (uint16_t)tcpV.GetFlags();
   Ptr<Packet> pktCopy = p->Copy();
   PppHeader pppH;
   Ipv4Header ipH;
@@ -193,6 +205,10 @@ uint32_t getTcpSequenceNo(Ptr <const Packet> p)
 {
   // debug 
   if(is_debug) cout << " Begin get tcp seq. " << endl;
+  Ipv4HeaderView ipV;
+  TcpHeaderView tcpV;
+  if(ipV.Peek(p, PppHeaderView::SIZE) && tcpV.Peek(p, PppHeaderView::SIZE + ipV.GetSerializedSize()))
+    return tcpV.GetSequenceNumber().GetValue();
   Ptr<Packet> pktCopy = p->Copy();
 
   PppHeader pppH;
@@ -209,6 +225,10 @@ uint32_t getTcpSequenceNoInDrop(Ptr <const Packet> p)
 {
   // debug 
   if(is_debug) cout << " Begin get tcp seq in drop. " << endl;
+  Ipv4HeaderView ipV;
+  TcpHeaderView tcpV;
+  if(ipV.Peek(p) && tcpV.Peek(p, ipV.GetSerializedSize()))
+    return tcpV.GetSequenceNumber().GetValue();
   Ptr<Packet> pktCopy = p->Copy();
   Ipv4Header ipH;
   TcpHeader tcpH;
@@ -222,6 +242,8 @@ uint32_t getTcpSequenceNoInQueue(Ptr <const Packet> p)
 {
   // debug 
   if(is_debug) cout << " Begin get tcp seq in queue. " << endl;
+  TcpHeaderView tcpV;
+  if(tcpV.Peek(p)) return tcpV.GetSequenceNumber().GetValue();
   Ptr<Packet> pktCopy = p->Copy();
   TcpHeader tcpH;
   pktCopy->PeekHeader(tcpH);
@@ -245,6 +267,10 @@ uint32_t getTcpAckNo(Ptr <const Packet> p)
 {
   // debug 
   if(is_debug) cout << " Begin get tcp ack no. " << endl;
+  Ipv4HeaderView ipV;
+  TcpHeaderView tcpV;
+  if(ipV.Peek(p, PppHeaderView::SIZE) && tcpV.Peek(p, PppHeaderView::SIZE + ipV.GetSerializedSize()))
+    return tcpV.GetAckNumber().GetValue();
   Ptr<Packet> pktCopy = p->Copy();
   
   PppHeader pppH;
@@ -261,6 +287,10 @@ uint16_t getTcpWin(Ptr <const Packet> p)
 {
   // debug 
   if(is_debug) cout << " Begin get tcp win. " << endl;
+  Ipv4HeaderView ipV;
+  TcpHeaderView tcpV;
+  if(ipV.Peek(p, PppHeaderView::SIZE) && tcpV.Peek(p, PppHeaderView::SIZE + ipV.GetSerializedSize()))
+    return tcpV.GetWindowSize();
   Ptr<Packet> pktCopy = p->Copy();
   PppHeader pppH;
   Ipv4Header ipH;
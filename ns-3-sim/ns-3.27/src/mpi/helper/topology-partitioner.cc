@@ -0,0 +1,838 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "topology-partitioner.h"
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <queue>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TopologyPartitioner");
+
+namespace {
+
+/** Weighted undirected graph */
+struct Graph
+{
+  /** Neighbour and weight of the edges towards it */
+  typedef std::vector<std::pair<uint32_t, double> > Edges;
+
+  std::vector<double> weight;   //!< Vertex weights
+  std::vector<Edges> adj;       //!< Adjacency lists
+
+  /** \return the number of vertices */
+  uint32_t Size (void) const
+  {
+    return weight.size ();
+  }
+  /** \return the sum of the vertex weights */
+  double Total (void) const
+  {
+    double total = 0;
+    for (uint32_t v = 0; v < weight.size (); ++v)
+      {
+        total += weight[v];
+      }
+    return total;
+  }
+};
+
+/**
+ * Build a graph, merging parallel edges and dropping self loops.
+ * \param weight vertex weights
+ * \param edges the edges, as (a, b) and weight
+ * \return the graph
+ */
+Graph
+MakeGraph (const std::vector<double> &weight,
+           const std::vector<std::pair<std::pair<uint32_t, uint32_t>, double> > &edges)
+{
+  std::vector<std::map<uint32_t, double> > merged (weight.size ());
+  for (uint32_t i = 0; i < edges.size (); ++i)
+    {
+      uint32_t a = edges[i].first.first;
+      uint32_t b = edges[i].first.second;
+      if (a != b)
+        {
+          merged[a][b] += edges[i].second;
+          merged[b][a] += edges[i].second;
+        }
+    }
+  Graph g;
+  g.weight = weight;
+  g.adj.resize (weight.size ());
+  for (uint32_t v = 0; v < weight.size (); ++v)
+    {
+      g.adj[v].assign (merged[v].begin (), merged[v].end ());
+    }
+  return g;
+}
+
+/**
+ * Contract a graph along a heavy edge matching.
+ * \param g the graph
+ * \param maxWeight the largest weight of a coarse vertex
+ * \param map filled with the coarse vertex of every vertex
+ * \return the coarse graph
+ */
+Graph
+Coarsen (const Graph &g, double maxWeight, std::vector<uint32_t> &map)
+{
+  uint32_t n = g.Size ();
+  // Light vertices first, so that they are not left unmatched
+  std::vector<uint32_t> order (n);
+  for (uint32_t v = 0; v < n; ++v)
+    {
+      order[v] = v;
+    }
+  std::stable_sort (order.begin (), order.end (),
+                    [&g] (uint32_t x, uint32_t y) { return g.weight[x] < g.weight[y]; });
+
+  const uint32_t none = std::numeric_limits<uint32_t>::max ();
+  map.assign (n, none);
+  uint32_t coarse = 0;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      uint32_t v = order[i];
+      if (map[v] != none)
+        {
+          continue;
+        }
+      uint32_t best = none;
+      double bestWeight = -1;
+      for (uint32_t j = 0; j < g.adj[v].size (); ++j)
+        {
+          uint32_t u = g.adj[v][j].first;
+          if (map[u] == none && g.adj[v][j].second > bestWeight
+              && g.weight[u] + g.weight[v] <= maxWeight)
+            {
+              best = u;
+              bestWeight = g.adj[v][j].second;
+            }
+        }
+      map[v] = coarse;
+      if (best != none)
+        {
+          map[best] = coarse;
+        }
+      coarse++;
+    }
+
+  std::vector<double> weight (coarse, 0.0);
+  std::vector<std::pair<std::pair<uint32_t, uint32_t>, double> > edges;
+  for (uint32_t v = 0; v < n; ++v)
+    {
+      weight[map[v]] += g.weight[v];
+      for (uint32_t j = 0; j < g.adj[v].size (); ++j)
+        {
+          uint32_t u = g.adj[v][j].first;
+          if (v < u)
+            {
+              edges.push_back (std::make_pair (std::make_pair (map[v], map[u]), g.adj[v][j].second));
+            }
+        }
+    }
+  return MakeGraph (weight, edges);
+}
+
+/**
+ * \param g the graph
+ * \param side side of every vertex
+ * \return the weight of the edges between the two sides
+ */
+double
+CutWeight (const Graph &g, const std::vector<uint8_t> &side)
+{
+  double cut = 0;
+  for (uint32_t v = 0; v < g.Size (); ++v)
+    {
+      for (uint32_t j = 0; j < g.adj[v].size (); ++j)
+        {
+          if (side[v] != side[g.adj[v][j].first])
+            {
+              cut += g.adj[v][j].second;
+            }
+        }
+    }
+  return cut / 2;
+}
+
+/**
+ * \param g the graph
+ * \param side side of every vertex
+ * \param v a vertex
+ * \return the decrease of the cut weight if \p v changes side
+ */
+double
+Gain (const Graph &g, const std::vector<uint8_t> &side, uint32_t v)
+{
+  double gain = 0;
+  for (uint32_t j = 0; j < g.adj[v].size (); ++j)
+    {
+      gain += side[g.adj[v][j].first] != side[v] ? g.adj[v][j].second : -g.adj[v][j].second;
+    }
+  return gain;
+}
+
+/**
+ * Candidate vertex of a priority queue: its key, the vertex, and the
+ * stamp of the vertex when it was pushed.  Entries whose stamp is no
+ * longer the one of the vertex are stale and skipped.
+ */
+struct Candidate
+{
+  double key;       //!< Connection or gain of the vertex
+  uint32_t vertex;  //!< The vertex
+  uint32_t stamp;   //!< Stamp of the vertex when pushed
+
+  /**
+   * \param other another candidate
+   * \return true if \p other comes first: larger key, then smaller vertex
+   */
+  bool operator< (const Candidate &other) const
+  {
+    return key < other.key || (key == other.key && vertex > other.vertex);
+  }
+};
+
+/** Largest key first, then smallest vertex */
+typedef std::priority_queue<Candidate> CandidateQueue;
+
+/**
+ * Grow side 0 from \p seed, always adding the vertex most connected
+ * to it, until it reaches \p target.
+ * \param g the graph
+ * \param seed first vertex of side 0
+ * \param target weight of side 0
+ * \return the side of every vertex
+ */
+std::vector<uint8_t>
+Grow (const Graph &g, uint32_t seed, double target)
+{
+  uint32_t n = g.Size ();
+  std::vector<uint8_t> side (n, 1);
+  std::vector<double> connection (n, 0.0);
+  std::vector<uint32_t> stamp (n, 0);
+  CandidateQueue frontier;
+  // First vertex of side 1, when the region has no frontier
+  uint32_t first = 0;
+  double weight = 0;
+  uint32_t next = seed;
+  while (true)
+    {
+      if (weight + g.weight[next] / 2 > target)
+        {
+          break;
+        }
+      side[next] = 0;
+      stamp[next]++;
+      weight += g.weight[next];
+      for (uint32_t j = 0; j < g.adj[next].size (); ++j)
+        {
+          uint32_t u = g.adj[next][j].first;
+          if (side[u] == 1)
+            {
+              connection[u] += g.adj[next][j].second;
+              Candidate c = { connection[u], u, ++stamp[u] };
+              frontier.push (c);
+            }
+        }
+      // Most connected frontier vertex, or the first vertex left when
+      // the region has no frontier (disconnected graph)
+      while (!frontier.empty () && frontier.top ().stamp != stamp[frontier.top ().vertex])
+        {
+          frontier.pop ();
+        }
+      if (!frontier.empty ())
+        {
+          next = frontier.top ().vertex;
+          continue;
+        }
+      while (first < n && side[first] == 0)
+        {
+          first++;
+        }
+      if (first == n)
+        {
+          break;
+        }
+      next = first;
+    }
+  return side;
+}
+
+/**
+ * Improve a bisection: restore the balance, then move vertices which
+ * reduce the cut weight while the balance allows it.
+ *
+ * The moves restoring the balance are taken from a priority queue of
+ * the gains of the heavy side, updated for the neighbours of each moved
+ * vertex, so that a pass costs O(m log n) rather than O(n^2); only the
+ * moves which overfill the light side, when none fits, scan the vertices.
+ *
+ * \param g the graph
+ * \param side side of every vertex, updated
+ * \param max largest weight of each side
+ */
+void
+Refine (const Graph &g, std::vector<uint8_t> &side, const double max[2])
+{
+  uint32_t n = g.Size ();
+  double w[2] = { 0, 0 };
+  for (uint32_t v = 0; v < n; ++v)
+    {
+      w[side[v]] += g.weight[v];
+    }
+  std::vector<uint32_t> stamp (n, 0);
+
+  for (uint32_t pass = 0; pass < 16; ++pass)
+    {
+      bool moved = false;
+      for (uint8_t heavy = 0; heavy < 2; ++heavy)
+        {
+          uint8_t light = 1 - heavy;
+          if (w[heavy] <= max[heavy])
+            {
+              continue;
+            }
+          CandidateQueue gains;
+          for (uint32_t v = 0; v < n; ++v)
+            {
+              if (side[v] == heavy)
+                {
+                  Candidate c = { Gain (g, side, v), v, ++stamp[v] };
+                  gains.push (c);
+                }
+            }
+          // Each vertex moves at most once
+          while (w[heavy] > max[heavy])
+            {
+              // Best gain among the moves which fit in the light side.
+              // The light side only grows, and the heavy side only
+              // shrinks, so a vertex which does not fit never will.
+              uint32_t best = n;
+              while (!gains.empty () && best == n)
+                {
+                  Candidate top = gains.top ();
+                  gains.pop ();
+                  uint32_t v = top.vertex;
+                  if (top.stamp == stamp[v] && w[heavy] - g.weight[v] > 0
+                      && w[light] + g.weight[v] <= max[light])
+                    {
+                      best = v;
+                    }
+                }
+              if (best == n)
+                {
+                  // Else the move which most reduces the excess
+                  double excess = w[heavy] - max[heavy];
+                  double fallbackExcess = excess;
+                  for (uint32_t v = 0; v < n; ++v)
+                    {
+                      if (side[v] != heavy || w[heavy] - g.weight[v] <= 0)
+                        {
+                          continue;
+                        }
+                      double after = std::max (excess - g.weight[v], w[light] + g.weight[v] - max[light]);
+                      if (after < fallbackExcess)
+                        {
+                          best = v;
+                          fallbackExcess = after;
+                        }
+                    }
+                }
+              if (best == n)
+                {
+                  break;
+                }
+              side[best] = light;
+              stamp[best]++;
+              w[heavy] -= g.weight[best];
+              w[light] += g.weight[best];
+              moved = true;
+              for (uint32_t j = 0; j < g.adj[best].size (); ++j)
+                {
+                  uint32_t u = g.adj[best][j].first;
+                  if (side[u] == heavy)
+                    {
+                      Candidate c = { Gain (g, side, u), u, ++stamp[u] };
+                      gains.push (c);
+                    }
+                }
+            }
+        }
+      for (uint32_t v = 0; v < n; ++v)
+        {
+          uint8_t to = 1 - side[v];
+          // Never empty a side, whatever the gain
+          if (w[to] + g.weight[v] <= max[to] && w[side[v]] - g.weight[v] > 0
+              && Gain (g, side, v) > 0)
+            {
+              w[side[v]] -= g.weight[v];
+              w[to] += g.weight[v];
+              side[v] = to;
+              moved = true;
+            }
+        }
+      if (!moved)
+        {
+          break;
+        }
+    }
+}
+
+/**
+ * Multilevel bisection.
+ * \param g the graph
+ * \param fraction fraction of the weight for side 0
+ * \param imbalance allowed relative excess of each side
+ * \return the side of every vertex
+ */
+std::vector<uint8_t>
+Bisect (const Graph &g, double fraction, double imbalance)
+{
+  double total = g.Total ();
+  double target = total * fraction;
+  double max[2] = { target * (1 + imbalance), (total - target) * (1 + imbalance) };
+
+  // Coarsening
+  std::vector<Graph> levels (1, g);
+  std::vector<std::vector<uint32_t> > maps;
+  double maxWeight = std::min (max[0], max[1]) / 4;
+  while (levels.back ().Size () > 32)
+    {
+      std::vector<uint32_t> map;
+      Graph coarse = Coarsen (levels.back (), maxWeight, map);
+      if (coarse.Size () > levels.back ().Size () * 0.9)
+        {
+          break;
+        }
+      levels.push_back (coarse);
+      maps.push_back (map);
+    }
+
+  // Initial bisection of the coarsest graph: best of a few seeds
+  const Graph &coarsest = levels.back ();
+  std::vector<uint8_t> side;
+  double bestScore = std::numeric_limits<double>::infinity ();
+  uint32_t seeds = std::min<uint32_t> (8, coarsest.Size ());
+  for (uint32_t i = 0; i < seeds; ++i)
+    {
+      std::vector<uint8_t> candidate = Grow (coarsest, i * coarsest.Size () / seeds, target);
+      Refine (coarsest, candidate, max);
+      double w0 = 0;
+      for (uint32_t v = 0; v < coarsest.Size (); ++v)
+        {
+          w0 += candidate[v] == 0 ? coarsest.weight[v] : 0;
+        }
+      double excess = std::max (w0 - max[0], (total - w0) - max[1]);
+      // Balance first, then cut weight
+      double score = excess > 0 ? total + excess * total : CutWeight (coarsest, candidate);
+      if (score < bestScore)
+        {
+          bestScore = score;
+          side = candidate;
+        }
+    }
+
+  // Uncoarsening
+  for (uint32_t level = maps.size (); level > 0; --level)
+    {
+      const std::vector<uint32_t> &map = maps[level - 1];
+      std::vector<uint8_t> fine (map.size ());
+      for (uint32_t v = 0; v < map.size (); ++v)
+        {
+          fine[v] = side[map[v]];
+        }
+      side.swap (fine);
+      Refine (levels[level - 1], side, max);
+    }
+  return side;
+}
+
+/**
+ * Recursive bisection of the vertices \p vertices of \p g into the
+ * parts [\p first, \p first + \p k).
+ * \param g the graph
+ * \param vertices vertices to split
+ * \param first first part
+ * \param k number of parts
+ * \param imbalance allowed relative excess at each bisection
+ * \param part part of every vertex, updated
+ */
+void
+RecursiveBisect (const Graph &g, const std::vector<uint32_t> &vertices, uint32_t first,
+                 uint32_t k, double imbalance, std::vector<uint32_t> &part)
+{
+  if (k == 1 || vertices.size () <= 1)
+    {
+      for (uint32_t i = 0; i < vertices.size (); ++i)
+        {
+          part[vertices[i]] = first;
+        }
+      return;
+    }
+
+  // Induced subgraph
+  std::vector<uint32_t> local (g.Size (), std::numeric_limits<uint32_t>::max ());
+  for (uint32_t i = 0; i < vertices.size (); ++i)
+    {
+      local[vertices[i]] = i;
+    }
+  std::vector<double> weight (vertices.size ());
+  std::vector<std::pair<std::pair<uint32_t, uint32_t>, double> > edges;
+  for (uint32_t i = 0; i < vertices.size (); ++i)
+    {
+      uint32_t v = vertices[i];
+      weight[i] = g.weight[v];
+      for (uint32_t j = 0; j < g.adj[v].size (); ++j)
+        {
+          uint32_t u = local[g.adj[v][j].first];
+          if (u != std::numeric_limits<uint32_t>::max () && i < u)
+            {
+              edges.push_back (std::make_pair (std::make_pair (i, u), g.adj[v][j].second));
+            }
+        }
+    }
+  Graph sub = MakeGraph (weight, edges);
+
+  uint32_t k0 = k / 2;
+  std::vector<uint8_t> side = Bisect (sub, static_cast<double> (k0) / k, imbalance);
+  std::vector<uint32_t> halves[2];
+  for (uint32_t i = 0; i < vertices.size (); ++i)
+    {
+      halves[side[i]].push_back (vertices[i]);
+    }
+  RecursiveBisect (g, halves[0], first, k0, imbalance, part);
+  RecursiveBisect (g, halves[1], first + k0, k - k0, imbalance, part);
+}
+
+/** Union-find root with path halving */
+uint32_t
+Find (std::vector<uint32_t> &parent, uint32_t v)
+{
+  while (parent[v] != v)
+    {
+      parent[v] = parent[parent[v]];
+      v = parent[v];
+    }
+  return v;
+}
+
+} // anonymous namespace
+
+TopologyPartitioner::TopologyPartitioner ()
+  : m_maxImbalance (0.1),
+    m_lookAhead (Time::Max ()),
+    m_imbalance (0),
+    m_cutTraffic (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+TopologyPartitioner::AddNode (double load)
+{
+  NS_LOG_FUNCTION (this << load);
+  m_load.push_back (load);
+  return m_load.size () - 1;
+}
+
+void
+TopologyPartitioner::AddLink (uint32_t a, uint32_t b, Time delay, double traffic)
+{
+  NS_LOG_FUNCTION (this << a << b << delay << traffic);
+  NS_ABORT_MSG_IF (a >= m_load.size () || b >= m_load.size (), "Link to an unknown node");
+  Link link;
+  link.a = a;
+  link.b = b;
+  link.delay = delay.IsStrictlyNegative () ? Time (0) : delay;
+  link.traffic = traffic;
+  m_links.push_back (link);
+}
+
+void
+TopologyPartitioner::AddDemand (uint32_t src, uint32_t dst, double volume)
+{
+  NS_LOG_FUNCTION (this << src << dst << volume);
+  Demand demand;
+  demand.src = src;
+  demand.dst = dst;
+  demand.volume = volume;
+  m_demands.push_back (demand);
+}
+
+void
+TopologyPartitioner::SetImbalance (double imbalance)
+{
+  NS_LOG_FUNCTION (this << imbalance);
+  m_maxImbalance = imbalance;
+}
+
+uint32_t
+TopologyPartitioner::GetNNodes (void) const
+{
+  return m_load.size ();
+}
+
+Time
+TopologyPartitioner::GetLookAhead (void) const
+{
+  return m_lookAhead;
+}
+
+double
+TopologyPartitioner::GetImbalance (void) const
+{
+  return m_imbalance;
+}
+
+double
+TopologyPartitioner::GetCutTraffic (void) const
+{
+  return m_cutTraffic;
+}
+
+std::vector<double>
+TopologyPartitioner::RouteDemands (void) const
+{
+  uint32_t n = m_load.size ();
+  std::vector<double> traffic (m_links.size ());
+  std::vector<std::vector<uint32_t> > incident (n);
+  for (uint32_t i = 0; i < m_links.size (); ++i)
+    {
+      traffic[i] = m_links[i].traffic;
+      incident[m_links[i].a].push_back (i);
+      incident[m_links[i].b].push_back (i);
+    }
+
+  // Demands from the same source share one shortest path tree
+  std::vector<uint32_t> order (m_demands.size ());
+  for (uint32_t i = 0; i < order.size (); ++i)
+    {
+      order[i] = i;
+    }
+  std::stable_sort (order.begin (), order.end (),
+                    [this] (uint32_t x, uint32_t y) { return m_demands[x].src < m_demands[y].src; });
+
+  const uint32_t none = std::numeric_limits<uint32_t>::max ();
+  std::vector<int64_t> dist;
+  std::vector<uint32_t> via;
+  uint32_t source = none;
+  for (uint32_t i = 0; i < order.size (); ++i)
+    {
+      const Demand &demand = m_demands[order[i]];
+      NS_ABORT_MSG_IF (demand.src >= n || demand.dst >= n, "Demand between unknown nodes");
+      if (demand.src != source)
+        {
+          source = demand.src;
+          dist.assign (n, std::numeric_limits<int64_t>::max ());
+          via.assign (n, none);
+          typedef std::pair<int64_t, uint32_t> Entry;
+          std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+          dist[source] = 0;
+          queue.push (Entry (0, source));
+          while (!queue.empty ())
+            {
+              Entry top = queue.top ();
+              queue.pop ();
+              uint32_t v = top.second;
+              if (top.first > dist[v])
+                {
+                  continue;
+                }
+              for (uint32_t j = 0; j < incident[v].size (); ++j)
+                {
+                  const Link &link = m_links[incident[v][j]];
+                  uint32_t u = link.a == v ? link.b : link.a;
+                  int64_t d = dist[v] + link.delay.GetTimeStep ();
+                  if (d < dist[u])
+                    {
+                      dist[u] = d;
+                      via[u] = incident[v][j];
+                      queue.push (Entry (d, u));
+                    }
+                }
+            }
+        }
+      if (via[demand.dst] == none && demand.dst != source)
+        {
+          NS_LOG_WARN ("No path from node " << demand.src << " to node " << demand.dst);
+          continue;
+        }
+      for (uint32_t v = demand.dst; v != source; )
+        {
+          const Link &link = m_links[via[v]];
+          traffic[via[v]] += demand.volume;
+          v = link.a == v ? link.b : link.a;
+        }
+    }
+  return traffic;
+}
+
+double
+TopologyPartitioner::PartitionAt (int64_t threshold, uint32_t systemCount, double imbalance,
+                                  const std::vector<double> &load, const std::vector<double> &traffic,
+                                  std::vector<uint32_t> &part) const
+{
+  uint32_t n = m_load.size ();
+  std::vector<uint32_t> parent (n);
+  for (uint32_t v = 0; v < n; ++v)
+    {
+      parent[v] = v;
+    }
+  for (uint32_t i = 0; i < m_links.size (); ++i)
+    {
+      if (m_links[i].delay.GetTimeStep () < threshold)
+        {
+          parent[Find (parent, m_links[i].a)] = Find (parent, m_links[i].b);
+        }
+    }
+  // Number the contracted vertices in order of first node
+  std::vector<uint32_t> component (n, std::numeric_limits<uint32_t>::max ());
+  std::vector<double> weight;
+  for (uint32_t v = 0; v < n; ++v)
+    {
+      uint32_t root = Find (parent, v);
+      if (component[root] == std::numeric_limits<uint32_t>::max ())
+        {
+          component[root] = weight.size ();
+          weight.push_back (0);
+        }
+      component[v] = component[root];
+      weight[component[v]] += load[v];
+    }
+  // Every link counts, so that the number of cut links is minimised
+  // when there is no traffic estimate
+  std::vector<std::pair<std::pair<uint32_t, uint32_t>, double> > edges;
+  for (uint32_t i = 0; i < m_links.size (); ++i)
+    {
+      edges.push_back (std::make_pair (std::make_pair (component[m_links[i].a], component[m_links[i].b]),
+                                       traffic[i] + 1));
+    }
+  Graph g = MakeGraph (weight, edges);
+  std::vector<uint32_t> vertices (g.Size ());
+  for (uint32_t v = 0; v < g.Size (); ++v)
+    {
+      vertices[v] = v;
+    }
+  std::vector<uint32_t> coarsePart (g.Size (), 0);
+  RecursiveBisect (g, vertices, 0, systemCount, imbalance, coarsePart);
+
+  part.resize (n);
+  std::vector<double> partLoad (systemCount, 0.0);
+  for (uint32_t v = 0; v < n; ++v)
+    {
+      part[v] = coarsePart[component[v]];
+      partLoad[part[v]] += load[v];
+    }
+  // An idle rank is never worth its lookahead
+  if (n >= systemCount && *std::min_element (partLoad.begin (), partLoad.end ()) <= 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  double mean = std::accumulate (load.begin (), load.end (), 0.0) / systemCount;
+  double max = *std::max_element (partLoad.begin (), partLoad.end ());
+  return mean > 0 ? max / mean - 1 : 0;
+}
+
+std::vector<uint32_t>
+TopologyPartitioner::Partition (uint32_t systemCount)
+{
+  NS_LOG_FUNCTION (this << systemCount);
+  NS_ABORT_MSG_IF (systemCount == 0, "Need at least one rank");
+
+  uint32_t n = m_load.size ();
+  std::vector<double> traffic = RouteDemands ();
+  std::vector<double> load (m_load);
+  for (uint32_t i = 0; i < m_links.size (); ++i)
+    {
+      load[m_links[i].a] += traffic[i];
+      load[m_links[i].b] += traffic[i];
+    }
+
+  // Candidate thresholds: links shorter than the threshold are not cut.
+  // The last one, beyond every delay, only splits connected components.
+  std::vector<int64_t> thresholds;
+  for (uint32_t i = 0; i < m_links.size (); ++i)
+    {
+      thresholds.push_back (m_links[i].delay.GetTimeStep ());
+    }
+  std::sort (thresholds.begin (), thresholds.end ());
+  thresholds.erase (std::unique (thresholds.begin (), thresholds.end ()), thresholds.end ());
+  thresholds.push_back (std::numeric_limits<int64_t>::max ());
+
+  // The imbalance of recursive bisection compounds at every level
+  uint32_t depth = 0;
+  while ((1U << depth) < systemCount)
+    {
+      depth++;
+    }
+  double levelImbalance = depth > 0 ? std::pow (1 + m_maxImbalance, 1.0 / depth) - 1 : 0;
+
+  // Largest feasible threshold, by bisection over the candidates. The
+  // smallest one cuts any link, and is kept even if it is unbalanced.
+  std::vector<uint32_t> best;
+  double bestImbalance = PartitionAt (thresholds[0], systemCount, levelImbalance, load, traffic, best);
+  if (bestImbalance <= m_maxImbalance + 1e-9)
+    {
+      uint32_t lo = 0;
+      uint32_t hi = thresholds.size () - 1;
+      while (lo < hi)
+        {
+          uint32_t mid = (lo + hi + 1) / 2;
+          std::vector<uint32_t> part;
+          double imbalance = PartitionAt (thresholds[mid], systemCount, levelImbalance, load, traffic, part);
+          if (imbalance <= m_maxImbalance + 1e-9)
+            {
+              lo = mid;
+              best.swap (part);
+              bestImbalance = imbalance;
+            }
+          else
+            {
+              hi = mid - 1;
+            }
+        }
+    }
+
+  m_imbalance = bestImbalance;
+  m_lookAhead = Time::Max ();
+  m_cutTraffic = 0;
+  for (uint32_t i = 0; i < m_links.size (); ++i)
+    {
+      if (best[m_links[i].a] != best[m_links[i].b])
+        {
+          m_lookAhead = std::min (m_lookAhead, m_links[i].delay);
+          m_cutTraffic += traffic[i];
+        }
+    }
+  NS_LOG_INFO ("Partitioned " << n << " nodes into " << systemCount << " ranks: lookahead "
+                              << m_lookAhead << ", imbalance " << m_imbalance
+                              << ", cut traffic " << m_cutTraffic);
+  return best;
+}
+
+} // namespace ns3
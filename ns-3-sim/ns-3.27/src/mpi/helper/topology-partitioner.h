@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_TOPOLOGY_PARTITIONER_H
+#define NS3_TOPOLOGY_PARTITIONER_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Assign the nodes of a topology to parallel ranks.
+ *
+ * The topology is described before any node is created: AddNode () for
+ * each node, AddLink () for each point-to-point link, and optionally
+ * AddDemand () for the expected traffic between two nodes.  Partition ()
+ * then returns the system id of every node, to be passed to the Node
+ * constructor.
+ *
+ * Two quantities decide the speed of a parallel run:
+ * - the lookahead, which is the smallest delay of the links between
+ *   ranks.  Links shorter than a threshold are never cut; the threshold
+ *   is the largest link delay for which a balanced partition exists;
+ * - the balance of the event load.  The load of a node is its own load
+ *   plus the traffic of its links; the load of every rank must stay
+ *   within SetImbalance () of the mean.
+ *
+ * Among the partitions with this lookahead, the cut traffic, i.e. the
+ * number of packets sent between ranks, is minimised by a multilevel
+ * recursive bisection: the graph is coarsened by heavy edge matching,
+ * bisected by greedy graph growing and refined at every level on the
+ * way back.  The result only depends on the order in which nodes and
+ * links were added, so every rank computes the same partition.
+ */
+class TopologyPartitioner
+{
+public:
+  TopologyPartitioner ();
+
+  /**
+   * \param load expected event load of the node itself, e.g. the packet
+   *        rate of its applications
+   * \return the index of the node, in the order of the calls
+   */
+  uint32_t AddNode (double load = 1.0);
+  /**
+   * \param a index of a node
+   * \param b index of another node
+   * \param delay propagation delay of the link
+   * \param traffic expected packet rate of the link
+   */
+  void AddLink (uint32_t a, uint32_t b, Time delay, double traffic = 0.0);
+  /**
+   * Add \p volume to the traffic of every link of the smallest delay path
+   * between two nodes.  May be called before the nodes and links are
+   * added; the path is computed by Partition ().
+   *
+   * \param src index of the source node
+   * \param dst index of the destination node
+   * \param volume expected packet rate between them
+   */
+  void AddDemand (uint32_t src, uint32_t dst, double volume);
+  /**
+   * \param imbalance maximum relative excess of the load of a rank over
+   *        the mean load, 0.1 by default
+   */
+  void SetImbalance (double imbalance);
+
+  /**
+   * \param systemCount number of ranks
+   * \return the system id of every node, by index
+   */
+  std::vector<uint32_t> Partition (uint32_t systemCount);
+
+  /**
+   * \return the number of nodes
+   */
+  uint32_t GetNNodes (void) const;
+  /**
+   * \return the smallest delay of the links cut by the last Partition (),
+   *         or Time::Max () if no link is cut
+   */
+  Time GetLookAhead (void) const;
+  /**
+   * \return the relative excess of the most loaded rank over the mean
+   *         load in the last Partition ()
+   */
+  double GetImbalance (void) const;
+  /**
+   * \return the traffic of the links cut by the last Partition ()
+   */
+  double GetCutTraffic (void) const;
+
+private:
+  /** A point-to-point link */
+  struct Link
+  {
+    uint32_t a;        //!< First node
+    uint32_t b;        //!< Second node
+    Time delay;        //!< Propagation delay
+    double traffic;    //!< Expected packet rate
+  };
+  /** An expected traffic between two nodes */
+  struct Demand
+  {
+    uint32_t src;      //!< Source node
+    uint32_t dst;      //!< Destination node
+    double volume;     //!< Expected packet rate
+  };
+
+  /**
+   * \return the traffic of every link, with the demands routed
+   */
+  std::vector<double> RouteDemands (void) const;
+  /**
+   * Partition with the links shorter than \p threshold kept inside the
+   * ranks.
+   * \param threshold smallest delay of a cut link, in time steps
+   * \param systemCount number of ranks
+   * \param imbalance allowed relative excess at each bisection
+   * \param load load of every node
+   * \param traffic traffic of every link
+   * \param part filled with the rank of every node
+   * \return the relative excess of the most loaded rank over the mean
+   */
+  double PartitionAt (int64_t threshold, uint32_t systemCount, double imbalance,
+                      const std::vector<double> &load, const std::vector<double> &traffic,
+                      std::vector<uint32_t> &part) const;
+
+  std::vector<double> m_load;     //!< Own load of every node
+  std::vector<Link> m_links;      //!< Links
+  std::vector<Demand> m_demands;  //!< Traffic demands
+  double m_maxImbalance;          //!< Allowed load imbalance
+  Time m_lookAhead;               //!< Lookahead of the last partition
+  double m_imbalance;             //!< Imbalance of the last partition
+  double m_cutTraffic;            //!< Cut traffic of the last partition
+};
+
+} // namespace ns3
+
+#endif /* NS3_TOPOLOGY_PARTITIONER_H */
@@ -131,6 +131,16 @@ private:
   virtual void DoDispose (void);
   void CalculateLookAhead (void);
   bool IsLocalFinished (void) const;
+  /**
+   * Receive the packets sent by the other tasks
+   */
+  void ReceiveMessages (void);
+  /**
+   * Exchange the LBTS message of this task with all the others into
+   * m_pLBTS
+   * \param nextTime time of the next local event
+   */
+  void AllGatherLbts (const Time &nextTime);
 
   void ProcessOneEvent (void);
   uint64_t NextTs (void) const;
@@ -154,6 +164,7 @@ private:
   uint32_t     m_systemCount; // MPI Size
   Time         m_grantedTime; // Last LBTS
   static Time  m_lookAhead;   // Lookahead value
+  bool         m_sharedMemory; // Tasks are SharedMemoryInterface ranks
 
 };
 
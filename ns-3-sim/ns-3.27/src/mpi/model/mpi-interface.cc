@@ -27,6 +27,7 @@
 
 #include "null-message-mpi-interface.h"
 #include "granted-time-window-mpi-interface.h"
+#include "shared-memory-interface.h"
 
 namespace ns3 {
 
@@ -108,6 +109,15 @@ MpiInterface::Enable (int* pargc, char*** pargv)
   g_parallelCommunicationInterface->Enable (pargc, pargv);
 }
 
+void
+MpiInterface::EnableSharedMemory (uint32_t systemCount, uint32_t ringSize)
+{
+  GlobalValue::Bind ("SimulatorImplementationType",
+                     StringValue ("ns3::DistributedSimulatorImpl"));
+  g_parallelCommunicationInterface = new SharedMemoryInterface (systemCount, ringSize);
+  g_parallelCommunicationInterface->Enable (0, 0);
+}
+
 void
 MpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t node, uint32_t dev)
 {
@@ -80,6 +80,21 @@ public:
    * Enable is invoked.
    */
   static void Enable (int* pargc, char*** pargv);
+  /**
+   * \param systemCount number of ranks
+   * \param ringSize size in bytes of the packet ring from one rank to
+   *        another
+   *
+   * \brief Sets up parallel communication between \p systemCount ranks
+   * of this machine, without MPI.
+   *
+   * Forks the calling process into \p systemCount ranks which exchange
+   * packets through shared memory (see SharedMemoryInterface), and
+   * selects ns3::DistributedSimulatorImpl.  Returns in every rank, with
+   * GetSystemId () set to the rank, so it must be called before the
+   * simulator is first used and the topology is built, like Enable ().
+   */
+  static void EnableSharedMemory (uint32_t systemCount, uint32_t ringSize = 1 << 20);
   /**
    * Terminates the parallel environment.
    * This function must be called after Destroy ()
@@ -0,0 +1,468 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+#include "shared-memory-interface.h"
+#include "mpi-receiver.h"
+
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SharedMemoryInterface");
+
+namespace {
+
+/** Size of the control block, one cache line */
+const size_t CONTROL_SIZE = 64;
+/** Size of the AllGather slot of one rank */
+const size_t SLOT_SIZE = 64;
+/** Size of the record header: length, rx time, node and device */
+const uint32_t RECORD_HEADER = 4 + 8 + 4 + 4;
+
+/**
+ * Copy \p n bytes from position \p pos of a ring, wrapping at its end
+ * \param data ring data
+ * \param ringSize size of the ring data
+ * \param pos position in the ring stream
+ * \param dst destination buffer
+ * \param n number of bytes
+ */
+void
+CopyFromRing (const uint8_t *data, uint32_t ringSize, uint64_t pos, uint8_t *dst, uint32_t n)
+{
+  uint32_t offset = pos % ringSize;
+  uint32_t first = std::min (n, ringSize - offset);
+  std::memcpy (dst, data + offset, first);
+  std::memcpy (dst + first, data, n - first);
+}
+
+} // anonymous namespace
+
+struct SharedMemoryInterface::Control
+{
+  uint32_t count;       //!< Ranks waiting in the current barrier
+  uint32_t generation;  //!< Number of completed barriers
+};
+
+struct SharedMemoryInterface::Ring
+{
+  uint64_t head;        //!< Bytes read, written by the receiver only
+  uint8_t  pad1[56];    //!< Keep head and tail on separate cache lines
+  uint64_t tail;        //!< Bytes written, written by the sender only
+  uint8_t  pad2[56];    //!< Data starts on its own cache line
+};
+
+uint32_t SharedMemoryInterface::m_sid = 0;
+uint32_t SharedMemoryInterface::m_size = 1;
+uint32_t SharedMemoryInterface::m_ringSize = 0;
+bool     SharedMemoryInterface::m_enabled = false;
+uint32_t SharedMemoryInterface::m_rxCount = 0;
+uint32_t SharedMemoryInterface::m_txCount = 0;
+uint8_t* SharedMemoryInterface::m_memory = 0;
+size_t   SharedMemoryInterface::m_memorySize = 0;
+SharedMemoryInterface::Control* SharedMemoryInterface::m_control = 0;
+uint32_t SharedMemoryInterface::m_gathers = 0;
+std::vector<pid_t> SharedMemoryInterface::m_pids;
+std::vector<std::deque<std::vector<uint8_t> > > SharedMemoryInterface::m_pendingTx;
+
+TypeId
+SharedMemoryInterface::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SharedMemoryInterface")
+    .SetParent<Object> ()
+    .SetGroupName ("Mpi")
+  ;
+  return tid;
+}
+
+SharedMemoryInterface::SharedMemoryInterface (uint32_t size, uint32_t ringSize)
+{
+  NS_LOG_FUNCTION (this << size << ringSize);
+  NS_ABORT_MSG_IF (size == 0, "Need at least one rank");
+  NS_ABORT_MSG_IF (m_enabled, "Shared memory ranks already enabled");
+  m_size = size;
+  // Keep every ring on its own cache lines
+  m_ringSize = (ringSize + 63) & ~63U;
+  NS_ABORT_MSG_IF (m_ringSize < 2048, "Ring size " << ringSize << " cannot hold a packet");
+}
+
+void
+SharedMemoryInterface::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  m_pendingTx.clear ();
+}
+
+uint32_t
+SharedMemoryInterface::GetSystemId ()
+{
+  return m_sid;
+}
+
+uint32_t
+SharedMemoryInterface::GetSize ()
+{
+  return m_size;
+}
+
+bool
+SharedMemoryInterface::IsEnabled ()
+{
+  return m_enabled;
+}
+
+bool
+SharedMemoryInterface::IsActive ()
+{
+  return m_enabled;
+}
+
+uint32_t
+SharedMemoryInterface::GetRxCount ()
+{
+  return m_rxCount;
+}
+
+uint32_t
+SharedMemoryInterface::GetTxCount ()
+{
+  return m_txCount;
+}
+
+void
+SharedMemoryInterface::Enable (int* pargc, char*** pargv)
+{
+  NS_LOG_FUNCTION (this << pargc << pargv);
+
+  m_memorySize = CONTROL_SIZE + 2 * m_size * SLOT_SIZE
+    + static_cast<size_t> (m_size) * m_size * (sizeof (Ring) + m_ringSize);
+  // Pages are only backed once written: rings between ranks which never
+  // exchange packets cost nothing
+  void *memory = mmap (0, m_memorySize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (memory == MAP_FAILED)
+    {
+      NS_FATAL_ERROR ("SharedMemoryInterface::Enable(): mmap() of " << m_memorySize
+                      << " bytes failed: " << std::strerror (errno));
+    }
+  m_memory = static_cast<uint8_t *> (memory);
+  m_control = reinterpret_cast<Control *> (m_memory);
+  m_sid = 0;
+  m_rxCount = 0;
+  m_txCount = 0;
+  m_gathers = 0;
+  m_pendingTx.assign (m_size, std::deque<std::vector<uint8_t> > ());
+  m_pids.assign (m_size, 0);
+  m_pids[0] = getpid ();
+
+  // Anything still buffered would otherwise be written by every rank
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::clog.flush ();
+  std::fflush (0);
+
+  for (uint32_t rank = 1; rank < m_size; ++rank)
+    {
+      pid_t pid = fork ();
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("SharedMemoryInterface::Enable(): fork() failed: " << std::strerror (errno));
+        }
+      if (pid == 0)
+        {
+#ifdef __linux__
+          // Do not outlive rank 0, which aborts if any rank dies
+          prctl (PR_SET_PDEATHSIG, SIGKILL);
+#endif
+          m_sid = rank;
+          break;
+        }
+      m_pids[rank] = pid;
+    }
+  m_enabled = true;
+  NS_LOG_INFO ("Rank " << m_sid << " of " << m_size << " is pid " << getpid ());
+}
+
+SharedMemoryInterface::Ring*
+SharedMemoryInterface::GetRing (uint32_t src, uint32_t dst)
+{
+  size_t offset = CONTROL_SIZE + 2 * m_size * SLOT_SIZE
+    + (static_cast<size_t> (src) * m_size + dst) * (sizeof (Ring) + m_ringSize);
+  return reinterpret_cast<Ring *> (m_memory + offset);
+}
+
+bool
+SharedMemoryInterface::Write (uint32_t dst, const std::vector<uint8_t> &record)
+{
+  Ring *ring = GetRing (m_sid, dst);
+  uint64_t tail = ring->tail;
+  uint64_t head = __atomic_load_n (&ring->head, __ATOMIC_ACQUIRE);
+  uint32_t size = record.size ();
+  if (m_ringSize - (tail - head) < size)
+    {
+      return false;
+    }
+  uint8_t *data = reinterpret_cast<uint8_t *> (ring + 1);
+  uint32_t offset = tail % m_ringSize;
+  uint32_t first = std::min (size, m_ringSize - offset);
+  std::memcpy (data + offset, &record[0], first);
+  std::memcpy (data, &record[0] + first, size - first);
+  __atomic_store_n (&ring->tail, tail + size, __ATOMIC_RELEASE);
+  return true;
+}
+
+void
+SharedMemoryInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t node, uint32_t dev)
+{
+  NS_LOG_FUNCTION (this << p << rxTime.GetTimeStep () << node << dev);
+
+  uint32_t serializedSize = p->GetSerializedSize ();
+  uint32_t length = RECORD_HEADER - 4 + serializedSize;
+  std::vector<uint8_t> record (4 + length);
+  NS_ABORT_MSG_IF (record.size () > m_ringSize, "Packet of " << serializedSize
+                   << " bytes does not fit in a ring of " << m_ringSize << " bytes");
+
+  // Length, then the time, dest node and dest device
+  int64_t t = rxTime.GetInteger ();
+  uint8_t *pData = &record[0];
+  std::memcpy (pData, &length, 4);
+  std::memcpy (pData + 4, &t, 8);
+  std::memcpy (pData + 12, &node, 4);
+  std::memcpy (pData + 16, &dev, 4);
+  // Serialize the packet
+  p->Serialize (pData + RECORD_HEADER, serializedSize);
+
+  uint32_t dst = NodeList::GetNode (node)->GetSystemId ();
+  NS_ASSERT (dst < m_size && dst != m_sid);
+  // Keep the order of the records to one rank
+  if (!m_pendingTx[dst].empty () || !Write (dst, record))
+    {
+      NS_LOG_LOGIC ("Ring to rank " << dst << " is full");
+      m_pendingTx[dst].push_back (record);
+    }
+  m_txCount++;
+}
+
+void
+SharedMemoryInterface::FlushPending ()
+{
+  for (uint32_t dst = 0; dst < m_size; ++dst)
+    {
+      std::deque<std::vector<uint8_t> > &pending = m_pendingTx[dst];
+      while (!pending.empty () && Write (dst, pending.front ()))
+        {
+          pending.pop_front ();
+        }
+    }
+}
+
+void
+SharedMemoryInterface::Deliver (const uint8_t *record, uint32_t size)
+{
+  int64_t time;
+  uint32_t node;
+  uint32_t dev;
+  std::memcpy (&time, record, 8);
+  std::memcpy (&node, record + 8, 4);
+  std::memcpy (&dev, record + 12, 4);
+  Time rxTime (time);
+
+  Ptr<Packet> p = Create<Packet> (record + RECORD_HEADER - 4, size - (RECORD_HEADER - 4), true);
+
+  // Find the correct node/device to schedule receive event
+  Ptr<Node> pNode = NodeList::GetNode (node);
+  Ptr<MpiReceiver> pMpiRec = 0;
+  uint32_t nDevices = pNode->GetNDevices ();
+  for (uint32_t i = 0; i < nDevices; ++i)
+    {
+      Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
+      if (pThisDev->GetIfIndex () == dev)
+        {
+          pMpiRec = pThisDev->GetObject<MpiReceiver> ();
+          break;
+        }
+    }
+
+  NS_ASSERT (pNode && pMpiRec);
+
+  // Schedule the rx event
+  Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
+                                  &MpiReceiver::Receive, pMpiRec, p);
+  m_rxCount++;
+}
+
+void
+SharedMemoryInterface::ReceiveMessages ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  FlushPending ();
+  // Every rank has finished its window: the rings hold all it has sent
+  Barrier ();
+
+  std::vector<uint8_t> record;
+  for (uint32_t src = 0; src < m_size; ++src)
+    {
+      if (src == m_sid)
+        {
+          continue;
+        }
+      Ring *ring = GetRing (src, m_sid);
+      const uint8_t *data = reinterpret_cast<const uint8_t *> (ring + 1);
+      uint64_t head = ring->head;
+      uint64_t tail = __atomic_load_n (&ring->tail, __ATOMIC_ACQUIRE);
+      while (head < tail)
+        {
+          uint32_t length;
+          CopyFromRing (data, m_ringSize, head, reinterpret_cast<uint8_t *> (&length), 4);
+          record.resize (length);
+          CopyFromRing (data, m_ringSize, head + 4, &record[0], length);
+          head += 4 + length;
+          Deliver (&record[0], length);
+        }
+      __atomic_store_n (&ring->head, head, __ATOMIC_RELEASE);
+    }
+}
+
+void
+SharedMemoryInterface::AllGather (const void *sendbuf, void *recvbuf, uint32_t size)
+{
+  NS_LOG_FUNCTION (sendbuf << recvbuf << size);
+  NS_ASSERT (size <= SLOT_SIZE);
+
+  // Two banks of slots: the bank of this call is only written again two
+  // calls later, after a barrier which every rank reaches once it has
+  // read this call's slots
+  uint8_t *bank = m_memory + CONTROL_SIZE + (m_gathers++ % 2) * m_size * SLOT_SIZE;
+  std::memcpy (bank + m_sid * SLOT_SIZE, sendbuf, size);
+  Barrier ();
+  uint8_t *out = static_cast<uint8_t *> (recvbuf);
+  for (uint32_t i = 0; i < m_size; ++i)
+    {
+      std::memcpy (out + i * size, bank + i * SLOT_SIZE, size);
+    }
+}
+
+void
+SharedMemoryInterface::Barrier ()
+{
+  uint32_t generation = __atomic_load_n (&m_control->generation, __ATOMIC_ACQUIRE);
+  if (__atomic_add_fetch (&m_control->count, 1, __ATOMIC_ACQ_REL) == m_size)
+    {
+      // Last one in releases the others
+      __atomic_store_n (&m_control->count, 0, __ATOMIC_RELAXED);
+      __atomic_store_n (&m_control->generation, generation + 1, __ATOMIC_RELEASE);
+      return;
+    }
+  uint32_t spins = 0;
+  while (__atomic_load_n (&m_control->generation, __ATOMIC_ACQUIRE) == generation)
+    {
+      if (++spins < 64)
+        {
+          continue;
+        }
+      // More ranks than free cores: let the others reach the barrier
+      sched_yield ();
+      if (m_sid == 0 && spins % 1024 == 0)
+        {
+          CheckRanks ();
+          if (__atomic_load_n (&m_control->generation, __ATOMIC_ACQUIRE) != generation)
+            {
+              break;
+            }
+        }
+    }
+}
+
+void
+SharedMemoryInterface::CheckRanks ()
+{
+  for (uint32_t rank = 1; rank < m_size; ++rank)
+    {
+      siginfo_t info;
+      std::memset (&info, 0, sizeof (info));
+      // Leave the status for Disable ()
+      if (waitid (P_PID, m_pids[rank], &info, WEXITED | WNOHANG | WNOWAIT) == 0
+          && info.si_pid == m_pids[rank])
+        {
+          // A rank which passed the barrier can exit before this one
+          // noticed; only a rank which never arrived is a failure
+          uint32_t count = __atomic_load_n (&m_control->count, __ATOMIC_ACQUIRE);
+          if (count != 0)
+            {
+              NS_FATAL_ERROR ("Rank " << rank << " (pid " << m_pids[rank]
+                              << ") exited during the simulation");
+            }
+        }
+    }
+}
+
+void
+SharedMemoryInterface::Disable ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  NS_ABORT_MSG_IF (!m_enabled, "Cannot disable shared memory ranks without enabling them first");
+
+  if (m_sid == 0)
+    {
+      for (uint32_t rank = 1; rank < m_size; ++rank)
+        {
+          int status;
+          while (waitpid (m_pids[rank], &status, 0) < 0)
+            {
+              if (errno != EINTR)
+                {
+                  NS_FATAL_ERROR ("SharedMemoryInterface::Disable(): waitpid() failed: " << std::strerror (errno));
+                }
+            }
+          if (!WIFEXITED (status))
+            {
+              NS_FATAL_ERROR ("Rank " << rank << " did not exit normally");
+            }
+          if (WEXITSTATUS (status) != 0)
+            {
+              NS_LOG_WARN ("Rank " << rank << " exited with status " << WEXITSTATUS (status));
+            }
+        }
+    }
+  munmap (m_memory, m_memorySize);
+  m_memory = 0;
+  m_control = 0;
+  m_pids.clear ();
+  m_enabled = false;
+}
+
+} // namespace ns3
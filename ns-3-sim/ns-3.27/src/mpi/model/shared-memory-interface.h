@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_SHARED_MEMORY_INTERFACE_H
+#define NS3_SHARED_MEMORY_INTERFACE_H
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+#include <sys/types.h>
+
+#include "ns3/nstime.h"
+
+#include "parallel-communication-interface.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Parallel communication between the ranks of one machine,
+ * without MPI.
+ *
+ * Enable () forks the calling process into GetSize () ranks, so, as with
+ * MPI, every rank runs the same program and builds the same topology,
+ * and only the nodes whose system id is the rank of the process are
+ * simulated there.  The ranks share an anonymous memory mapping which
+ * holds:
+ * - one single producer, single consumer ring buffer per ordered pair of
+ *   ranks.  A rank sending a packet to a node of another rank writes it
+ *   to the ring of that pair without any lock, and the receiver only
+ *   reads its rings at the end of each time window;
+ * - a barrier and the slots used to exchange the LBTS messages of the
+ *   granted time window algorithm of DistributedSimulatorImpl.
+ *
+ * Incoming rings are read after a barrier which all ranks reach once
+ * their window is complete, and in increasing rank order, so the events
+ * scheduled for received packets, and the order of events with equal
+ * timestamps, are the same on every run.
+ *
+ * Runs are therefore repeatable, but not bit-identical to a sequential
+ * run of the same program: packet uids and the order of events with equal
+ * timestamps on different ranks can differ.  The ranks are processes
+ * rather than threads, since the objects of one process cannot be shared
+ * between threads.
+ *
+ * A packet which does not fit in its ring is kept by the sender and
+ * written at the next synchronisation; the transmit and receive counts
+ * then differ and DistributedSimulatorImpl does not advance the granted
+ * time until it has been delivered.
+ */
+class SharedMemoryInterface : public ParallelCommunicationInterface, Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  /**
+   * \param size number of ranks
+   * \param ringSize size in bytes of the ring from one rank to another
+   */
+  SharedMemoryInterface (uint32_t size, uint32_t ringSize);
+
+  /**
+   * Delete the packets which are still waiting for ring space
+   */
+  virtual void Destroy ();
+  /**
+   * \return rank of this process
+   */
+  virtual uint32_t GetSystemId ();
+  /**
+   * \return number of ranks
+   */
+  virtual uint32_t GetSize ();
+  /**
+   * \return true once the ranks have been created
+   */
+  virtual bool IsEnabled ();
+  /**
+   * \param pargc number of command line arguments (unused)
+   * \param pargv command line arguments (unused)
+   *
+   * Maps the shared memory and forks the other ranks.  Returns in every
+   * rank.
+   */
+  virtual void Enable (int* pargc, char*** pargv);
+  /**
+   * Unmaps the shared memory.  In rank 0, first waits for the other
+   * ranks to exit.
+   * This function must be called after Destroy ()
+   */
+  virtual void Disable ();
+  /**
+   * \param p packet to send
+   * \param rxTime received time at destination node
+   * \param node destination node
+   * \param dev destination device
+   *
+   * Serialize a packet into the ring towards the rank of the destination
+   * node.
+   */
+  virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
+
+  /**
+   * \return true if the ranks of this process are created by this class
+   */
+  static bool IsActive ();
+  /**
+   * Wait for every rank to reach the end of its time window, then
+   * schedule the packets received from all ranks.
+   */
+  static void ReceiveMessages ();
+  /**
+   * Gather \p size bytes from every rank into \p recvbuf, ordered by
+   * rank, like MPI_Allgather.  \p size is at most 64.
+   *
+   * \param sendbuf data of this rank
+   * \param recvbuf GetSize () * \p size bytes
+   * \param size size of the data of each rank
+   */
+  static void AllGather (const void *sendbuf, void *recvbuf, uint32_t size);
+  /**
+   * \return received count in packets
+   */
+  static uint32_t GetRxCount ();
+  /**
+   * \return transmitted count in packets
+   */
+  static uint32_t GetTxCount ();
+
+private:
+  /** Control block at the start of the mapping */
+  struct Control;
+  /** Ring buffer from one rank to another */
+  struct Ring;
+
+  /** Wait for all the ranks */
+  static void Barrier ();
+  /**
+   * Abort if another rank died: the survivors would wait for it forever
+   */
+  static void CheckRanks ();
+  /**
+   * \param src sending rank
+   * \param dst receiving rank
+   * \return the ring from \p src to \p dst
+   */
+  static Ring* GetRing (uint32_t src, uint32_t dst);
+  /**
+   * Write a record into the ring towards \p dst
+   * \param dst destination rank
+   * \param record serialized record
+   * \return false if there is no space for it
+   */
+  static bool Write (uint32_t dst, const std::vector<uint8_t> &record);
+  /**
+   * Write the records waiting for ring space, in order
+   */
+  static void FlushPending ();
+  /**
+   * Schedule the reception of one record
+   * \param record serialized record
+   * \param size size of the record
+   */
+  static void Deliver (const uint8_t *record, uint32_t size);
+
+  static uint32_t m_sid;
+  static uint32_t m_size;
+  static uint32_t m_ringSize;
+  static bool     m_enabled;
+
+  // Total packets received
+  static uint32_t m_rxCount;
+
+  // Total packets sent
+  static uint32_t m_txCount;
+
+  // Shared mapping
+  static uint8_t* m_memory;
+  static size_t   m_memorySize;
+  static Control* m_control;
+
+  // Number of AllGather calls, selects the slot bank
+  static uint32_t m_gathers;
+
+  // Process id of every rank
+  static std::vector<pid_t> m_pids;
+
+  // Records waiting for ring space, per destination rank
+  static std::vector<std::deque<std::vector<uint8_t> > > m_pendingTx;
+};
+
+} // namespace ns3
+
+#endif /* NS3_SHARED_MEMORY_INTERFACE_H */
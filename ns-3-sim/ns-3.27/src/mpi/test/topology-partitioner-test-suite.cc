@@ -0,0 +1,251 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/topology-partitioner.h"
+#include "ns3/nstime.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi-tests
+ *
+ * Two rings of nodes joined by long links must be split along the long
+ * links.
+ */
+class TopologyPartitionerClustersTestCase : public TestCase
+{
+public:
+  TopologyPartitionerClustersTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TopologyPartitionerClustersTestCase::TopologyPartitionerClustersTestCase ()
+  : TestCase ("Cut the long links between two clusters")
+{
+}
+
+void
+TopologyPartitionerClustersTestCase::DoRun (void)
+{
+  const uint32_t ring = 8;
+  TopologyPartitioner partitioner;
+  for (uint32_t i = 0; i < 2 * ring; i++)
+    {
+      partitioner.AddNode ();
+    }
+  for (uint32_t c = 0; c < 2; c++)
+    {
+      for (uint32_t i = 0; i < ring; i++)
+        {
+          partitioner.AddLink (c * ring + i, c * ring + (i + 1) % ring, MilliSeconds (1));
+        }
+    }
+  partitioner.AddLink (0, ring, MilliSeconds (10));
+  partitioner.AddLink (ring / 2, ring + ring / 2, MilliSeconds (20));
+
+  std::vector<uint32_t> part = partitioner.Partition (2);
+  NS_TEST_ASSERT_MSG_EQ (part.size (), 2 * ring, "one system id per node");
+  for (uint32_t i = 0; i < 2 * ring; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (part[i], part[(i / ring) * ring], "node " << i << " split from its ring");
+    }
+  NS_TEST_EXPECT_MSG_NE (part[0], part[ring], "rings on the same rank");
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetLookAhead (), MilliSeconds (10), "lookahead");
+  NS_TEST_EXPECT_MSG_EQ_TOL (partitioner.GetImbalance (), 0, 1e-9, "imbalance");
+
+  // Same input, same partition
+  NS_TEST_EXPECT_MSG_EQ ((partitioner.Partition (2) == part), true, "not deterministic");
+}
+
+/**
+ * \ingroup mpi-tests
+ *
+ * A long link whose cut would unbalance the ranks must be kept, and the
+ * lookahead lowered instead.
+ */
+class TopologyPartitionerBalanceTestCase : public TestCase
+{
+public:
+  TopologyPartitionerBalanceTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TopologyPartitionerBalanceTestCase::TopologyPartitionerBalanceTestCase ()
+  : TestCase ("Balance the load before the lookahead")
+{
+}
+
+void
+TopologyPartitionerBalanceTestCase::DoRun (void)
+{
+  // Chain of 10 nodes; only the first link is long
+  TopologyPartitioner partitioner;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      partitioner.AddNode ();
+    }
+  partitioner.AddLink (0, 1, MilliSeconds (50));
+  for (uint32_t i = 1; i < 9; i++)
+    {
+      partitioner.AddLink (i, i + 1, MilliSeconds (1));
+    }
+  partitioner.Partition (2);
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetLookAhead (), MilliSeconds (1), "lookahead");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (partitioner.GetImbalance (), 0.1, "imbalance");
+
+  // With a loose balance, the long link is the best cut
+  partitioner.SetImbalance (9);
+  partitioner.Partition (2);
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetLookAhead (), MilliSeconds (50), "loose lookahead");
+}
+
+/**
+ * \ingroup mpi-tests
+ *
+ * Partition a grid into 4 ranks, with and without traffic demands.
+ */
+class TopologyPartitionerGridTestCase : public TestCase
+{
+public:
+  TopologyPartitionerGridTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TopologyPartitionerGridTestCase::TopologyPartitionerGridTestCase ()
+  : TestCase ("Balanced partition of a grid")
+{
+}
+
+void
+TopologyPartitionerGridTestCase::DoRun (void)
+{
+  const uint32_t side = 12;
+  TopologyPartitioner partitioner;
+  for (uint32_t i = 0; i < side * side; i++)
+    {
+      partitioner.AddNode ();
+    }
+  for (uint32_t y = 0; y < side; y++)
+    {
+      for (uint32_t x = 0; x < side; x++)
+        {
+          if (x + 1 < side)
+            {
+              partitioner.AddLink (y * side + x, y * side + x + 1, MilliSeconds (2));
+            }
+          if (y + 1 < side)
+            {
+              partitioner.AddLink (y * side + x, (y + 1) * side + x, MilliSeconds (2));
+            }
+        }
+    }
+
+  std::vector<uint32_t> part = partitioner.Partition (4);
+  for (uint32_t i = 0; i < part.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_LT (part[i], 4, "system id out of range");
+    }
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (partitioner.GetImbalance (), 0.1, "imbalance");
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetLookAhead (), MilliSeconds (2), "lookahead");
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetCutTraffic (), 0, "no traffic was given");
+
+  // Heavy traffic along the first row loads its nodes, which must then
+  // be spread over the ranks
+  partitioner.AddDemand (0, side - 1, 100);
+  part = partitioner.Partition (4);
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (partitioner.GetImbalance (), 0.1, "imbalance with traffic");
+  std::vector<double> rowLoad (4, 0.0);
+  for (uint32_t x = 0; x < side; x++)
+    {
+      rowLoad[part[x]] += 1;
+    }
+  uint32_t ranksOnRow = 0;
+  for (uint32_t r = 0; r < 4; r++)
+    {
+      ranksOnRow += rowLoad[r] > 0 ? 1 : 0;
+    }
+  NS_TEST_EXPECT_MSG_GT (ranksOnRow, 1, "loaded row on a single rank");
+}
+
+/**
+ * \ingroup mpi-tests
+ *
+ * Partition a large star.  Its leaves cannot be matched with each other,
+ * so the bisections grow and balance the whole graph: neither may scan
+ * the vertices at each step.
+ */
+class TopologyPartitionerStarTestCase : public TestCase
+{
+public:
+  TopologyPartitionerStarTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TopologyPartitionerStarTestCase::TopologyPartitionerStarTestCase ()
+  : TestCase ("Balanced partition of a large star")
+{
+}
+
+void
+TopologyPartitionerStarTestCase::DoRun (void)
+{
+  const uint32_t leaves = 20000;
+  TopologyPartitioner partitioner;
+  uint32_t hub = partitioner.AddNode ();
+  for (uint32_t i = 0; i < leaves; i++)
+    {
+      uint32_t leaf = partitioner.AddNode (1 + i % 5);
+      partitioner.AddLink (hub, leaf, MilliSeconds (1 + i % 3));
+    }
+
+  std::vector<uint32_t> part = partitioner.Partition (8);
+  std::vector<uint32_t> count (8, 0);
+  for (uint32_t i = 0; i < part.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_LT (part[i], 8, "system id out of range");
+      count[part[i]]++;
+    }
+  for (uint32_t r = 0; r < 8; r++)
+    {
+      NS_TEST_EXPECT_MSG_GT (count[r], 0, "idle rank");
+    }
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (partitioner.GetImbalance (), 0.1, "imbalance");
+}
+
+/**
+ * \ingroup mpi-tests
+ *
+ * \brief TopologyPartitioner TestSuite
+ */
+class TopologyPartitionerTestSuite : public TestSuite
+{
+public:
+  TopologyPartitionerTestSuite ()
+    : TestSuite ("topology-partitioner", UNIT)
+  {
+    AddTestCase (new TopologyPartitionerClustersTestCase (), TestCase::QUICK);
+    AddTestCase (new TopologyPartitionerBalanceTestCase (), TestCase::QUICK);
+    AddTestCase (new TopologyPartitionerGridTestCase (), TestCase::QUICK);
+    AddTestCase (new TopologyPartitionerStarTestCase (), TestCase::QUICK);
+  }
+};
+
+static TopologyPartitionerTestSuite g_topologyPartitionerTestSuite; //!< Static variable for test initialization
@@ -25,8 +25,6 @@
 #include <ostream>
 #include "ns3/assert.h"
 
-#define BUFFER_FREE_LIST 1
-
 namespace ns3 {
 
 /**
@@ -500,6 +498,18 @@ private:
    */
   uint8_t const*PeekData (void) const;
 
+  /**
+   * \param start offset from the start of the buffer
+   * \param size number of bytes
+   * \return a pointer to the \p size bytes at offset \p start, or 0 if
+   *         they are not all stored before the zero area of the buffer
+   *
+   * Unlike PeekData, this method never turns the zero area into real
+   * bytes: it is meant for the inspection of headers in place.  The
+   * returned pointer is valid until the buffer is modified.
+   */
+  inline uint8_t const*PeekContiguousData (uint32_t start, uint32_t size) const;
+
   /**
    * \param start size to reserve
    *
@@ -789,19 +799,6 @@ private:
    * instance from the start of m_data->m_data
    */
   uint32_t m_end;
-
-#ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
-#endif
 };
 
 } // namespace ns3
@@ -1065,6 +1062,16 @@ Buffer::GetSize (void) const
   return m_end - m_start;
 }
 
+uint8_t const*
+Buffer::PeekContiguousData (uint32_t start, uint32_t size) const
+{
+  if (start + size > m_zeroAreaStart - m_start)
+    {
+      return 0;
+    }
+  return m_data->m_data + m_start + start;
+}
+
 Buffer::Iterator 
 Buffer::Begin (void) const
 {
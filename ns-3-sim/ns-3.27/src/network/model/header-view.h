@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef HEADER_VIEW_H
+#define HEADER_VIEW_H
+
+#include "packet.h"
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Base class of the read-only views of fixed-size headers.
+ *
+ * Packet::PeekHeader deserializes a whole Header object through a
+ * Buffer::Iterator and virtual calls, even when the caller reads a single
+ * field.  A header view instead points to the bytes of a header inside
+ * the contiguous part of the buffer of a packet, as returned by
+ * Packet::PeekContiguousData, and its subclasses decode each field on
+ * demand with inline, non-virtual accessors.  The packet metadata and
+ * the buffer are left untouched.
+ *
+ * Peeking fails when the bytes of the header are not all stored in the
+ * contiguous part of the buffer, for instance when they fall in the
+ * zero-filled area of a packet created with a payload size only.  Callers
+ * then fall back to Packet::PeekHeader:
+ *
+ * \code
+ *   Ipv4HeaderView view;
+ *   if (view.Peek (packet, 2))
+ *     {
+ *       destination = view.GetDestination ();
+ *     }
+ *   else
+ *     {
+ *       ...  // remove the PppHeader and peek an Ipv4Header
+ *     }
+ * \endcode
+ *
+ * A view is valid until the packet it was peeked from is modified.
+ */
+class HeaderView
+{
+public:
+  HeaderView ();
+  /**
+   * \returns true if the last call to Peek succeeded
+   */
+  bool IsValid (void) const;
+
+protected:
+  /**
+   * \param packet the packet
+   * \param offset the offset of the header from the start of \p packet
+   * \param size the size of the header
+   * \returns true if the \p size bytes at \p offset are contiguous
+   */
+  bool DoPeek (Ptr<const Packet> packet, uint32_t offset, uint32_t size);
+  /**
+   * \param offset offset in the header
+   * \returns the byte at \p offset
+   */
+  uint8_t ReadU8 (uint32_t offset) const;
+  /**
+   * \param offset offset in the header
+   * \returns the 16-bit value in network order at \p offset
+   */
+  uint16_t ReadNtohU16 (uint32_t offset) const;
+  /**
+   * \param offset offset in the header
+   * \returns the 32-bit value in network order at \p offset
+   */
+  uint32_t ReadNtohU32 (uint32_t offset) const;
+
+  uint8_t const *m_data;  //!< the first byte of the header, or 0
+};
+
+} // namespace ns3
+
+namespace ns3 {
+
+inline
+HeaderView::HeaderView ()
+  : m_data (0)
+{
+}
+
+inline bool
+HeaderView::IsValid (void) const
+{
+  return m_data != 0;
+}
+
+inline bool
+HeaderView::DoPeek (Ptr<const Packet> packet, uint32_t offset, uint32_t size)
+{
+  m_data = packet->PeekContiguousData (offset, size);
+  return m_data != 0;
+}
+
+inline uint8_t
+HeaderView::ReadU8 (uint32_t offset) const
+{
+  return m_data[offset];
+}
+
+inline uint16_t
+HeaderView::ReadNtohU16 (uint32_t offset) const
+{
+  return (static_cast<uint16_t> (m_data[offset]) << 8) | m_data[offset + 1];
+}
+
+inline uint32_t
+HeaderView::ReadNtohU32 (uint32_t offset) const
+{
+  return (static_cast<uint32_t> (m_data[offset]) << 24)
+         | (static_cast<uint32_t> (m_data[offset + 1]) << 16)
+         | (static_cast<uint32_t> (m_data[offset + 2]) << 8)
+         | m_data[offset + 3];
+}
+
+} // namespace ns3
+
+#endif /* HEADER_VIEW_H */
@@ -168,6 +168,7 @@ NodeListPriv::DoDispose (void)
       *i = 0;
     }
   m_nodes.erase (m_nodes.begin (), m_nodes.end ());
+  Config::InvalidateCache ();
   Object::DoDispose ();
 }
 
@@ -178,6 +179,7 @@ NodeListPriv::Add (Ptr<Node> node)
   NS_LOG_FUNCTION (this << node);
   uint32_t index = m_nodes.size ();
   m_nodes.push_back (node);
+  Config::InvalidateCache ();
   Simulator::ScheduleWithContext (index, TimeStep (0), &Node::Initialize, node);
   return index;
 
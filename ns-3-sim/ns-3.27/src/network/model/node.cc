@@ -30,6 +30,7 @@
 #include "ns3/assert.h"
 #include "ns3/global-value.h"
 #include "ns3/boolean.h"
+#include "ns3/config.h"
 #include "ns3/simulator.h"
 
 namespace ns3 {
@@ -133,6 +134,7 @@ Node::AddDevice (Ptr<NetDevice> device)
   device->SetNode (this);
   device->SetIfIndex (index);
   device->SetReceiveCallback (MakeCallback (&Node::NonPromiscReceiveFromDevice, this));
+  Config::InvalidateCache ();
   Simulator::ScheduleWithContext (GetId (), Seconds (0.0), 
                                   &NetDevice::Initialize, device);
   NotifyDeviceAdded (device);
@@ -160,6 +162,7 @@ Node::AddApplication (Ptr<Application> application)
   uint32_t index = m_applications.size ();
   m_applications.push_back (application);
   application->SetNode (this);
+  Config::InvalidateCache ();
   Simulator::ScheduleWithContext (GetId (), Seconds (0.0), 
                                   &Application::Initialize, application);
   return index;
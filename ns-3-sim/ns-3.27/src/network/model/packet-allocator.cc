@@ -0,0 +1,347 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-allocator.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include <cstdlib>
+#include <new>
+#include <stdlib.h>
+
+namespace {
+
+/// Block sizes of the size classes, two per power of two
+const std::size_t g_classSize[] = {
+  32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096
+};
+/// Number of size classes
+const uint32_t g_classN = sizeof (g_classSize) / sizeof (g_classSize[0]);
+/// Size of a slab
+const std::size_t g_slabSize = 65536;
+/// Size of the header of a slab, which keeps the blocks 16-byte aligned
+const std::size_t g_slabHeader = 16;
+
+/// A free block
+struct FreeBlock
+{
+  FreeBlock *next;      //!< Next free block of the same class
+};
+/// The header of a slab, which starts at a multiple of g_slabSize
+struct Slab
+{
+  Slab *next;           //!< Next slab
+  uint32_t sizeClass;   //!< Size class of the blocks of the slab
+  uint32_t freeBlocks;  //!< Free blocks of the slab, counted by Trim ()
+};
+
+/*
+ * The state of the allocator is made of plain data, zero-initialized
+ * before any constructor runs and never destroyed, so packets can be
+ * created and destroyed by the static constructors and destructors of
+ * any compilation unit.
+ */
+FreeBlock *g_free[g_classN];  //!< Free list of every size class
+Slab *g_slabs;                //!< All the slabs
+uint64_t g_slabBytes;         //!< Bytes held in slabs
+bool g_disabled;              //!< Whether blocks are served by operator new
+/// Statistics of every pool
+ns3::PacketAllocator::Stats g_stats[ns3::PacketAllocator::POOL_N];
+
+/**
+ * \param size a block size
+ * \returns the size class of \p size, or g_classN if it is too large
+ */
+inline uint32_t
+GetClass (std::size_t size)
+{
+  uint32_t c = 0;
+  while (c < g_classN && g_classSize[c] < size)
+    {
+      c++;
+    }
+  return c;
+}
+
+/**
+ * \returns the number of blocks in use in all the pools
+ */
+uint64_t
+GetLive (void)
+{
+  uint64_t live = 0;
+  for (uint32_t i = 0; i < ns3::PacketAllocator::POOL_N; i++)
+    {
+      live += g_stats[i].live;
+    }
+  return live;
+}
+
+/**
+ * \param block a block of a slab
+ * \returns the slab of \p block
+ */
+inline Slab *
+GetSlab (void *block)
+{
+  return reinterpret_cast<Slab *> (reinterpret_cast<uintptr_t> (block) & ~(uintptr_t (g_slabSize) - 1));
+}
+
+/**
+ * \param slab a slab whose free blocks are counted
+ * \returns whether no block of \p slab is in use
+ */
+inline bool
+IsUnused (const Slab *slab)
+{
+  return slab->freeBlocks == (g_slabSize - g_slabHeader) / g_classSize[slab->sizeClass];
+}
+
+/**
+ * Carve a new slab into free blocks of a size class
+ * \param c the size class
+ */
+void
+Refill (uint32_t c)
+{
+  // Slabs are aligned on their size, to find the slab of a block
+  void *aligned;
+  if (posix_memalign (&aligned, g_slabSize, g_slabSize) != 0)
+    {
+      throw std::bad_alloc ();
+    }
+  uint8_t *memory = static_cast<uint8_t *> (aligned);
+  Slab *slab = reinterpret_cast<Slab *> (memory);
+  slab->next = g_slabs;
+  slab->sizeClass = c;
+  slab->freeBlocks = 0;
+  g_slabs = slab;
+  g_slabBytes += g_slabSize;
+
+  std::size_t size = g_classSize[c];
+  for (std::size_t offset = g_slabHeader; offset + size <= g_slabSize; offset += size)
+    {
+      FreeBlock *block = reinterpret_cast<FreeBlock *> (memory + offset);
+      block->next = g_free[c];
+      g_free[c] = block;
+    }
+}
+
+/**
+ * Release the slabs at exit, if no block is in use anymore.
+ */
+struct SlabRelease
+{
+  ~SlabRelease ()
+  {
+    if (GetLive () != 0)
+      {
+        // Blocks still referenced by other static objects: keep them valid
+        return;
+      }
+    while (g_slabs != 0)
+      {
+        Slab *next = g_slabs->next;
+        std::free (g_slabs);
+        g_slabs = next;
+      }
+    for (uint32_t c = 0; c < g_classN; c++)
+      {
+        g_free[c] = 0;
+      }
+    g_slabBytes = 0;
+    // Blocks allocated by later static destructors are not pooled
+    g_disabled = true;
+  }
+} g_slabRelease; //!< Releases the slabs at exit
+
+} // anonymous namespace
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacketAllocator");
+
+void *
+PacketAllocator::Allocate (enum Pool pool, std::size_t size)
+{
+  struct Stats &stats = g_stats[pool];
+  uint32_t c = GetClass (size);
+  void *block;
+  if (c == g_classN)
+    {
+      block = ::operator new (size);
+    }
+  else if (g_disabled)
+    {
+      size = g_classSize[c];
+      block = ::operator new (size);
+    }
+  else
+    {
+      size = g_classSize[c];
+      if (g_free[c] == 0)
+        {
+          Refill (c);
+        }
+      FreeBlock *free = g_free[c];
+      g_free[c] = free->next;
+      block = free;
+    }
+  stats.live++;
+  stats.allocations++;
+  stats.bytes += size;
+  if (stats.live > stats.peak)
+    {
+      stats.peak = stats.live;
+    }
+  return block;
+}
+
+void
+PacketAllocator::Deallocate (enum Pool pool, void *p, std::size_t size)
+{
+  struct Stats &stats = g_stats[pool];
+  NS_ASSERT (stats.live > 0);
+  uint32_t c = GetClass (size);
+  if (c == g_classN)
+    {
+      ::operator delete (p);
+    }
+  else if (g_disabled)
+    {
+      size = g_classSize[c];
+      ::operator delete (p);
+    }
+  else
+    {
+      size = g_classSize[c];
+      FreeBlock *block = static_cast<FreeBlock *> (p);
+      block->next = g_free[c];
+      g_free[c] = block;
+    }
+  stats.live--;
+  stats.bytes -= size;
+}
+
+std::size_t
+PacketAllocator::GetCapacity (std::size_t size)
+{
+  uint32_t c = GetClass (size);
+  return c == g_classN ? size : g_classSize[c];
+}
+
+struct PacketAllocator::Stats
+PacketAllocator::GetStats (enum Pool pool)
+{
+  NS_LOG_FUNCTION (pool);
+  NS_ASSERT (pool < POOL_N);
+  return g_stats[pool];
+}
+
+std::string
+PacketAllocator::GetPoolName (enum Pool pool)
+{
+  NS_LOG_FUNCTION (pool);
+  switch (pool)
+    {
+    case PACKET:
+      return "Packet";
+    case BUFFER_DATA:
+      return "BufferData";
+    case METADATA:
+      return "PacketMetadata";
+    case BYTE_TAGS:
+      return "ByteTagList";
+    case PACKET_TAGS:
+      return "PacketTagList";
+    default:
+      break;
+    }
+  return "";
+}
+
+uint64_t
+PacketAllocator::GetSlabBytes (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return g_slabBytes;
+}
+
+uint64_t
+PacketAllocator::Trim (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  // Count the free blocks of every slab
+  for (Slab *slab = g_slabs; slab != 0; slab = slab->next)
+    {
+      slab->freeBlocks = 0;
+    }
+  for (uint32_t c = 0; c < g_classN; c++)
+    {
+      for (FreeBlock *block = g_free[c]; block != 0; block = block->next)
+        {
+          GetSlab (block)->freeBlocks++;
+        }
+    }
+
+  // Unlink the blocks of the unused slabs from the free lists
+  for (uint32_t c = 0; c < g_classN; c++)
+    {
+      FreeBlock **link = &g_free[c];
+      while (*link != 0)
+        {
+          if (IsUnused (GetSlab (*link)))
+            {
+              *link = (*link)->next;
+            }
+          else
+            {
+              link = &(*link)->next;
+            }
+        }
+    }
+
+  // and release those slabs
+  uint64_t released = 0;
+  Slab **link = &g_slabs;
+  while (*link != 0)
+    {
+      Slab *slab = *link;
+      if (IsUnused (slab))
+        {
+          *link = slab->next;
+          std::free (slab);
+          released += g_slabSize;
+        }
+      else
+        {
+          link = &slab->next;
+        }
+    }
+  g_slabBytes -= released;
+  NS_LOG_LOGIC ("Released " << released << " bytes, " << g_slabBytes << " bytes left in slabs");
+  return released;
+}
+
+void
+PacketAllocator::SetEnabled (bool enabled)
+{
+  NS_LOG_FUNCTION (enabled);
+  NS_ABORT_MSG_IF (GetLive () != 0, "PacketAllocator::SetEnabled called while packets are alive");
+  g_disabled = !enabled;
+}
+
+} // namespace ns3
@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PACKET_ALLOCATOR_H
+#define PACKET_ALLOCATOR_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Slab allocator shared by the Packet class and the data blocks
+ * of its Buffer, PacketMetadata, ByteTagList and PacketTagList.
+ *
+ * Every packet creation used to call malloc for the Packet object and
+ * for each of the blocks it references, and free for each of them when
+ * the packet is destroyed; Buffer, PacketMetadata and ByteTagList kept
+ * their own free lists of at most 1000 blocks of the largest size seen.
+ *
+ * Blocks are now served from size classes, two per power of two from 32
+ * to 4096 bytes.  Each class keeps a free list of blocks carved out of
+ * 64 KiB slabs, so allocating and releasing a block only pushes or pops
+ * a list head.  Larger blocks are allocated with operator new.
+ *
+ * Slabs are not given back as their blocks are released, so the memory
+ * reached at the peak of a burst of traffic stays allocated: call Trim ()
+ * to release the slabs of which no block is in use, e.g. between the
+ * phases of a simulation.  The slabs left are released at exit when no
+ * block is in use anymore.
+ *
+ * The blocks of each client are counted in a Pool, whose statistics can
+ * be read with GetStats ().
+ *
+ * The allocator is not thread-safe, like the Packet class itself.
+ */
+class PacketAllocator
+{
+public:
+  /** The clients of the allocator */
+  enum Pool
+  {
+    PACKET = 0,      //!< Packet objects
+    BUFFER_DATA,     //!< Buffer::Data
+    METADATA,        //!< PacketMetadata::Data
+    BYTE_TAGS,       //!< ByteTagList data
+    PACKET_TAGS,     //!< PacketTagList::TagData
+    POOL_N           //!< Number of pools
+  };
+
+  /** Statistics of a pool */
+  struct Stats
+  {
+    uint64_t live;          //!< Blocks in use
+    uint64_t peak;          //!< Largest number of blocks in use
+    uint64_t allocations;   //!< Blocks allocated since the start
+    uint64_t bytes;         //!< Bytes in use, rounded to the size classes
+  };
+
+  /**
+   * \param pool the client of the block
+   * \param size the size of the block in bytes
+   * \returns a block of at least GetCapacity (\p size) bytes, aligned for
+   *          any type
+   */
+  static void * Allocate (enum Pool pool, std::size_t size);
+  /**
+   * \param pool the client of the block, as given to Allocate ()
+   * \param p the block
+   * \param size the size given to Allocate (), or any size between it and
+   *        the capacity of the block
+   */
+  static void Deallocate (enum Pool pool, void *p, std::size_t size);
+  /**
+   * \param size a block size in bytes
+   * \returns the number of bytes which can be used in a block allocated
+   *          for \p size bytes
+   */
+  static std::size_t GetCapacity (std::size_t size);
+
+  /**
+   * \param pool a pool
+   * \returns the statistics of \p pool
+   */
+  static struct Stats GetStats (enum Pool pool);
+  /**
+   * \param pool a pool
+   * \returns the name of \p pool
+   */
+  static std::string GetPoolName (enum Pool pool);
+  /**
+   * \returns the number of bytes held in slabs, used or not
+   */
+  static uint64_t GetSlabBytes (void);
+  /**
+   * Release the slabs of which no block is in use.
+   *
+   * This walks every free block, so it is meant to be called once in a
+   * while, not for every packet.
+   *
+   * \returns the number of bytes released
+   */
+  static uint64_t Trim (void);
+  /**
+   * Serve every block with operator new, e.g. to compare with the
+   * allocator or to run under valgrind.
+   *
+   * \param enabled whether blocks are served from the slabs
+   *
+   * Must be called while no block is in use, i.e. before the first
+   * packet is created.
+   */
+  static void SetEnabled (bool enabled);
+};
+
+} // namespace ns3
+
+#endif /* PACKET_ALLOCATOR_H */
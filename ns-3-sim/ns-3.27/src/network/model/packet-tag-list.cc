@@ -24,6 +24,7 @@
 */
 
 #include "packet-tag-list.h"
+#include "packet-allocator.h"
 #include "tag-buffer.h"
 #include "tag.h"
 #include "ns3/fatal-error.h"
@@ -43,7 +44,8 @@ PacketTagList::CreateTagData (size_t dataSize)
                  << " exceeds maximum "
                  << std::numeric_limits<decltype(TagData::size)>::max () );
 
-  void * p = std::malloc (sizeof (TagData) + dataSize - 1);
+  void * p = PacketAllocator::Allocate (PacketAllocator::PACKET_TAGS,
+                                       sizeof (TagData) + dataSize - 1);
   // The matching frees are in RemoveAll and RemoveWriter
 
   TagData * tag = new (p) TagData;
@@ -51,6 +53,14 @@ PacketTagList::CreateTagData (size_t dataSize)
   return tag;
 }
 
+void
+PacketTagList::DestroyTagData (TagData * tag)
+{
+  size_t size = sizeof (TagData) + tag->size - 1;
+  tag->~TagData ();
+  PacketAllocator::Deallocate (PacketAllocator::PACKET_TAGS, tag, size);
+}
+
 bool
 PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 {
@@ -194,8 +204,7 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
   if (preMerge)
     {
       // found tid before first merge, so delete cur
-      cur->~TagData ();
-      std::free (cur);
+      DestroyTagData (cur);
     }
   else
     {
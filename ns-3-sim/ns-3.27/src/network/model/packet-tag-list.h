@@ -228,6 +228,13 @@ private:
    */
   static
   TagData * CreateTagData (size_t dataSize);
+  /**
+   * Destruct and free a TagData struct allocated by CreateTagData.
+   *
+   * \param [in] tag The TagData object.
+   */
+  static
+  void DestroyTagData (TagData * tag);
   
   /**
    * Typedef of method function pointer for copy-on-write operations
@@ -341,15 +348,13 @@ PacketTagList::RemoveAll (void)
         }
       if (prev != 0) 
         {
-          prev->~TagData ();
-          std::free (prev);
+          DestroyTagData (prev);
         }
       prev = cur;
     }
   if (prev != 0) 
     {
-      prev->~TagData ();
-      std::free (prev);
+      DestroyTagData (prev);
     }
   m_next = 0;
 }
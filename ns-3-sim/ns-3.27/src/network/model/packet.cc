@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "packet.h"
+#include "packet-allocator.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -126,6 +127,18 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+void *
+Packet::operator new (size_t size)
+{
+  return PacketAllocator::Allocate (PacketAllocator::PACKET, size);
+}
+
+void
+Packet::operator delete (void *p, size_t size)
+{
+  PacketAllocator::Deallocate (PacketAllocator::PACKET, p, size);
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
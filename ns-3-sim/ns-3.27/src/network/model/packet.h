@@ -232,6 +232,19 @@ class Packet : public SimpleRefCount<Packet>
 {
 public:
 
+  /**
+   * \brief Allocate a packet from the PacketAllocator.
+   * \param size the size of the object
+   * \returns the memory for the packet
+   */
+  static void * operator new (size_t size);
+  /**
+   * \brief Return the memory of a packet to the PacketAllocator.
+   * \param p the memory of the packet
+   * \param size the size of the object
+   */
+  static void operator delete (void *p, size_t size);
+
   /**
    * \brief Create an empty packet with a new uid (as returned
    * by getUid).
@@ -417,6 +430,21 @@ public:
    */
   void CopyData (std::ostream *os, uint32_t size) const;
 
+  /**
+   * \brief Get a pointer to bytes of the packet stored contiguously.
+   *
+   * \param offset offset from the start of the packet
+   * \param size number of bytes
+   * \returns a pointer to the \p size bytes at \p offset, or 0 if they
+   *          are not all stored contiguously, e.g., because they are part
+   *          of a zero-filled payload.
+   *
+   * Neither the buffer nor the metadata of the packet are modified, and
+   * the returned pointer is valid until the packet is modified.  See HeaderView
+   * for typed accessors on top of this method.
+   */
+  inline uint8_t const *PeekContiguousData (uint32_t offset, uint32_t size) const;
+
   /**
    * \brief performs a COW copy of the packet.
    *
@@ -798,6 +826,12 @@ Packet::GetSize (void) const
   return m_buffer.GetSize ();
 }
 
+uint8_t const *
+Packet::PeekContiguousData (uint32_t offset, uint32_t size) const
+{
+  return m_buffer.PeekContiguousData (offset, size);
+}
+
 } // namespace ns3
 
 #endif /* PACKET_H */
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/packet.h"
+#include "ns3/network-config.h"
+#include "ns3/pcap-file-wrapper.h"
+#include "ns3/sll-header.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that a file written by the background thread of PcapFileWrapper
+ * is the file written by PcapFile, with a ring buffer small enough for
+ * records to wrap around it and to be larger than it.
+ */
+class AsyncPcapWriterTestCase : public TestCase
+{
+public:
+  /**
+   * \param snapLen the snapshot length of the files
+   * \param gzip whether to compress the file written asynchronously
+   */
+  AsyncPcapWriterTestCase (uint32_t snapLen, bool gzip);
+  virtual void DoRun (void);
+private:
+  /**
+   * Write the test packets.
+   * \param filename the name of the file
+   * \param asynchronous whether to write from the background thread
+   * \param gzip whether to compress the file
+   */
+  void WriteFile (std::string filename, bool asynchronous, bool gzip);
+  /**
+   * \param filename the name of the file
+   * \param gzip whether the file is compressed
+   * \returns the bytes of the file
+   */
+  std::vector<char> ReadFile (std::string filename, bool gzip);
+
+  uint32_t m_snapLen; //!< the snapshot length of the files
+  bool m_gzip;        //!< whether to compress the file written asynchronously
+};
+
+AsyncPcapWriterTestCase::AsyncPcapWriterTestCase (uint32_t snapLen, bool gzip)
+  : TestCase ("Check the file written by the background thread"),
+    m_snapLen (snapLen),
+    m_gzip (gzip)
+{
+}
+
+void
+AsyncPcapWriterTestCase::WriteFile (std::string filename, bool asynchronous, bool gzip)
+{
+  Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
+  file->SetAttribute ("Asynchronous", BooleanValue (asynchronous));
+  file->SetAttribute ("BufferSize", UintegerValue (4096));
+  file->SetAttribute ("Compression", EnumValue (gzip ? PcapFileWrapper::GZIP : PcapFileWrapper::NONE));
+  file->Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (file->Fail (), false, "Could not open " << filename);
+  file->Init (1, m_snapLen);
+
+  uint8_t data[6000];
+  for (uint32_t i = 0; i < sizeof (data); i++)
+    {
+      data[i] = i * 7;
+    }
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      uint32_t size = (i * 397) % sizeof (data);
+      Ptr<Packet> p = Create<Packet> (data, size);
+      p->AddAtEnd (Create<Packet> (i % 50));
+      switch (i % 3)
+        {
+        case 0:
+          file->Write (MicroSeconds (i * 1001), p);
+          break;
+        case 1:
+          file->Write (MicroSeconds (i * 1001), data, size);
+          break;
+        default:
+          {
+            SllHeader header;
+            header.SetArpType (i);
+            file->Write (MicroSeconds (i * 1001), header, p);
+          }
+          break;
+        }
+    }
+  file->Close ();
+  NS_TEST_EXPECT_MSG_EQ (file->Fail (), false, "Could not write " << filename);
+}
+
+std::vector<char>
+AsyncPcapWriterTestCase::ReadFile (std::string filename, bool gzip)
+{
+  std::vector<char> bytes;
+  if (gzip)
+    {
+#ifdef HAVE_ZLIB
+      gzFile file = gzopen (filename.c_str (), "rb");
+      char buffer[4096];
+      int n;
+      while (file != 0 && (n = gzread (file, buffer, sizeof (buffer))) > 0)
+        {
+          bytes.insert (bytes.end (), buffer, buffer + n);
+        }
+      if (file != 0)
+        {
+          gzclose (file);
+        }
+#endif
+      return bytes;
+    }
+  std::ifstream file (filename.c_str (), std::ios::binary);
+  bytes.assign (std::istreambuf_iterator<char> (file), std::istreambuf_iterator<char> ());
+  return bytes;
+}
+
+void
+AsyncPcapWriterTestCase::DoRun (void)
+{
+  std::ostringstream name;
+  name << "async-" << m_snapLen << (m_gzip ? ".pcap.gz" : ".pcap");
+  std::string syncFilename = CreateTempDirFilename ("sync.pcap");
+  std::string asyncFilename = CreateTempDirFilename (name.str ());
+
+  WriteFile (syncFilename, false, false);
+  WriteFile (asyncFilename, true, m_gzip);
+
+  std::vector<char> expected = ReadFile (syncFilename, false);
+  std::vector<char> actual = ReadFile (asyncFilename, m_gzip);
+  NS_TEST_ASSERT_MSG_GT (expected.size (), 24, "The reference file has no record");
+  NS_TEST_ASSERT_MSG_EQ (actual.size (), expected.size (), "The files have different sizes");
+  NS_TEST_EXPECT_MSG_EQ ((actual == expected), true, "The files have different contents");
+
+  std::remove (syncFilename.c_str ());
+  std::remove (asyncFilename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Asynchronous pcap writer TestSuite
+ */
+class AsyncPcapWriterTestSuite : public TestSuite
+{
+public:
+  AsyncPcapWriterTestSuite ()
+    : TestSuite ("async-pcap-writer", UNIT)
+  {
+    AddTestCase (new AsyncPcapWriterTestCase (65535, false), TestCase::QUICK);
+    AddTestCase (new AsyncPcapWriterTestCase (100, false), TestCase::QUICK);
+#ifdef HAVE_ZLIB
+    AddTestCase (new AsyncPcapWriterTestCase (65535, true), TestCase::QUICK);
+#endif
+  }
+};
+
+static AsyncPcapWriterTestSuite g_asyncPcapWriterTestSuite; //!< Static variable for test initialization
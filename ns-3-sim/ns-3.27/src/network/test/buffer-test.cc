@@ -376,6 +376,22 @@ BufferTest::DoRun (void)
   val2 <<= 8;
   val2 |= i.ReadU8 ();
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
+
+  // Merging fragments of a zero-filled buffer, as the TCP buffers do,
+  // must not turn the zero areas into real bytes.
+  buffer = Buffer (3000);
+  buffer.AddAtStart (2);
+  i = buffer.Begin ();
+  i.WriteU8 (0x1);
+  i.WriteU8 (0x2);
+  frag0 = buffer.CreateFragment (0, 1002);
+  frag1 = buffer.CreateFragment (1002, 2000);
+  frag0.AddAtEnd (frag1);
+  NS_TEST_ASSERT_MSG_EQ (frag0.GetSize (), 3002, "Bad merged size");
+  NS_TEST_ASSERT_MSG_EQ ((frag0.PeekContiguousData (0, 2) != 0), true, "Real bytes lost");
+  NS_TEST_ASSERT_MSG_EQ ((frag0.PeekContiguousData (0, 3) == 0), true, "Zero area materialized");
+  ENSURE_WRITTEN_BYTES (frag0, 4, 0x1, 0x2, 0x00, 0x00);
+  NS_TEST_ASSERT_MSG_EQ ((buffer.PeekContiguousData (0, 3) == 0), true, "Shared buffer modified");
 }
 
 /**
@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the integer transmission time computation of DataRate against
+ * the exact value and against the former double based computation.
+ */
+class DataRateTxTimeTestCase : public TestCase
+{
+public:
+  DataRateTxTimeTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Check the tx time of \p bytes at \p rate.
+   * \param rate the data rate
+   * \param bytes the number of bytes
+   */
+  void Check (const DataRate &rate, uint32_t bytes);
+};
+
+DataRateTxTimeTestCase::DataRateTxTimeTestCase ()
+  : TestCase ("Integer transmission time of DataRate")
+{
+}
+
+void
+DataRateTxTimeTestCase::Check (const DataRate &rate, uint32_t bytes)
+{
+  uint64_t bps = rate.GetBitRate ();
+  uint64_t bits = static_cast<uint64_t> (bytes) * 8;
+  int64_t steps = rate.CalculateBytesTxTime (bytes).GetTimeStep ();
+
+  // The result is the exact value truncated to the nanosecond:
+  // steps * bps <= bits * 1e9 < (steps + 1) * bps
+  uint64_t exact = bits * 1000000000;
+  NS_TEST_EXPECT_MSG_EQ ((steps * bps <= exact), true,
+                         "tx time of " << bytes << "B at " << rate << " too large");
+  NS_TEST_EXPECT_MSG_EQ ((exact < (steps + 1) * bps), true,
+                         "tx time of " << bytes << "B at " << rate << " too small");
+
+  // The double based computation truncates an approximation of the same
+  // value, so it is never more than one step away
+  int64_t legacy = Seconds (static_cast<double> (bits) / bps).GetTimeStep ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (steps, legacy, 1,
+                             "tx time of " << bytes << "B at " << rate << " differs from Seconds (double)");
+
+  NS_TEST_EXPECT_MSG_EQ (rate.CalculateBitsTxTime (bytes * 8), rate.CalculateBytesTxTime (bytes),
+                         "bit and byte tx times disagree");
+}
+
+void
+DataRateTxTimeTestCase::DoRun (void)
+{
+  const char *rates[] = { "56kbps", "1Mbps", "5.5Mbps", "10Mbps", "33Mbps", "100Mbps",
+                          "200Mbps", "1Gbps", "1Gib/s", "10Gbps", "25Gbps", "40Gbps",
+                          "100Gbps", "32768b/s", "7bps" };
+  for (uint32_t i = 0; i < sizeof (rates) / sizeof (rates[0]); i++)
+    {
+      DataRate rate (rates[i]);
+      for (uint32_t bytes = 0; bytes <= 2000; bytes++)
+        {
+          Check (rate, bytes);
+        }
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("1Gbps").CalculateBytesTxTime (1500), NanoSeconds (12000),
+                         "1500B at 1Gbps should take exactly 12us");
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("8bps").CalculateBytesTxTime (3), Seconds (3),
+                         "3B at 8bps should take exactly 3s");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the picoseconds per byte of DataRate, and that DataRateTxTimeCache
+ * returns the times DataRate computes as sizes and rates change.
+ */
+class DataRateTxTimeCacheTestCase : public TestCase
+{
+public:
+  DataRateTxTimeCacheTestCase ();
+  virtual void DoRun (void);
+};
+
+DataRateTxTimeCacheTestCase::DataRateTxTimeCacheTestCase ()
+  : TestCase ("Picoseconds per byte and transmission time cache")
+{
+}
+
+void
+DataRateTxTimeCacheTestCase::DoRun (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("10Gbps").GetPicoSecondsPerByte (), 800, "10Gbps");
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("40Gbps").GetPicoSecondsPerByte (), 200, "40Gbps");
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("100Gbps").GetPicoSecondsPerByte (), 80, "100Gbps");
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("32768b/s").GetPicoSecondsPerByte (), 244140625, "32768b/s");
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("7bps").GetPicoSecondsPerByte (), 0, "not an integer");
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("1kbps").GetPicoSecondsPerByte (), 0, "too large for 32 bit sizes");
+  NS_TEST_EXPECT_MSG_EQ (DataRate ().GetPicoSecondsPerByte (), 0, "no rate");
+
+  // 64B at 100Gbps take 5.12ns, truncated to the nanosecond
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("100Gbps").CalculateBytesTxTime (64), NanoSeconds (5),
+                         "64B at 100Gbps");
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("100Gbps").CalculateBytesTxTime (1500), NanoSeconds (120),
+                         "1500B at 100Gbps");
+  NS_TEST_EXPECT_MSG_EQ (DataRate ("40Gbps").CalculateBytesTxTime (0xffffffff),
+                         NanoSeconds (858993459), "4GiB at 40Gbps");
+
+  const char *rates[] = { "1Mbps", "10Gbps", "7bps", "10Gbps" };
+  const uint32_t sizes[] = { 1500, 40, 0, 1500, 576, 9000, 40, 1, 1500, 64, 64 };
+  DataRateTxTimeCache cache;
+  for (uint32_t i = 0; i < sizeof (rates) / sizeof (rates[0]); i++)
+    {
+      DataRate rate (rates[i]);
+      for (uint32_t j = 0; j < sizeof (sizes) / sizeof (sizes[0]); j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (cache.Get (rate, sizes[j]), rate.CalculateBytesTxTime (sizes[j]),
+                                 sizes[j] << "B at " << rate);
+        }
+    }
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief DataRate TestSuite
+ */
+class DataRateTestSuite : public TestSuite
+{
+public:
+  DataRateTestSuite ()
+    : TestSuite ("data-rate", UNIT)
+  {
+    AddTestCase (new DataRateTxTimeTestCase (), TestCase::QUICK);
+    AddTestCase (new DataRateTxTimeCacheTestCase (), TestCase::QUICK);
+  }
+};
+
+static DataRateTestSuite g_dataRateTestSuite; //!< Static variable for test initialization
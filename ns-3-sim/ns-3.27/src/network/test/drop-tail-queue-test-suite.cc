@@ -19,6 +19,9 @@
 #include "ns3/test.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/uinteger.h"
+#include <vector>
+#include <iterator>
+#include <algorithm>
 
 using namespace ns3;
 
@@ -83,6 +86,207 @@ DropTailQueueTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ ((packet == 0), true, "There are really no packets in there");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * FIFO queue giving access to the positions of the items, as the
+ * subclasses of Queue do.
+ */
+class RingTestQueue : public Queue<Packet>
+{
+public:
+  virtual bool Enqueue (Ptr<Packet> item)
+  {
+    return DoEnqueue (Tail (), item);
+  }
+  virtual Ptr<Packet> Dequeue (void)
+  {
+    return DoDequeue (Head ());
+  }
+  virtual Ptr<Packet> Remove (void)
+  {
+    return DoRemove (Head ());
+  }
+  virtual Ptr<const Packet> Peek (void) const
+  {
+    return DoPeek (Head ());
+  }
+  /**
+   * Remove the packets whose uid is a multiple of \p n, the way
+   * WifiMacQueue drops stale packets while browsing the queue.
+   * \param n the modulo
+   * \returns the number of packets removed
+   */
+  uint32_t RemoveMultiples (uint32_t n)
+  {
+    uint32_t removed = 0;
+    for (auto it = Head (); it != Tail (); )
+      {
+        if ((*it)->GetUid () % n == 0)
+          {
+            auto curr = it++;
+            DoRemove (curr);
+            removed++;
+          }
+        else
+          {
+            it++;
+          }
+      }
+    return removed;
+  }
+  /**
+   * \param item the packet to insert at the head of the queue
+   * \returns true on success
+   */
+  bool PushFront (Ptr<Packet> item)
+  {
+    return DoEnqueue (Head (), item);
+  }
+  /**
+   * \param item the packet to insert after the first packet of the queue
+   * \returns true on success
+   */
+  bool InsertSecond (Ptr<Packet> item)
+  {
+    auto it = Head ();
+    return DoEnqueue (++it, item);
+  }
+  /**
+   * \returns the number of packets, counted with the standard algorithms
+   */
+  uint32_t GetDistance (void) const
+  {
+    return std::distance (Head (), Tail ());
+  }
+  /**
+   * \param p a packet
+   * \returns true if the packet holds 50 bytes or more
+   */
+  static bool IsLarge (const Ptr<Packet> &p)
+  {
+    return p->GetSize () >= 50;
+  }
+  /**
+   * \returns the number of packets of 50 bytes or more
+   */
+  uint32_t CountLarge (void) const
+  {
+    return std::count_if (Head (), Tail (), &RingTestQueue::IsLarge);
+  }
+  /**
+   * \returns the uids of the packets, from the head of the queue
+   */
+  std::vector<uint64_t> GetUids (void) const
+  {
+    std::vector<uint64_t> uids;
+    for (auto it = Head (); it != Tail (); ++it)
+      {
+        uids.push_back ((*it)->GetUid ());
+      }
+    return uids;
+  }
+};
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Wrap around, grow, remove items from the middle of and insert items in
+ * the ring buffer of a queue.
+ */
+class QueueRingTestCase : public TestCase
+{
+public:
+  QueueRingTestCase ();
+  virtual void DoRun (void);
+};
+
+QueueRingTestCase::QueueRingTestCase ()
+  : TestCase ("Check the ring buffer of the queue")
+{
+}
+
+void
+QueueRingTestCase::DoRun (void)
+{
+  Ptr<RingTestQueue> queue = CreateObject<RingTestQueue> ();
+  queue->SetAttribute ("MaxPackets", UintegerValue (1000));
+
+  // Wrap around many times with a few packets queued
+  std::vector<uint64_t> expected;
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (i);
+      queue->Enqueue (p);
+      expected.push_back (p->GetUid ());
+      if (i >= 5)
+        {
+          NS_TEST_ASSERT_MSG_EQ (queue->Dequeue ()->GetUid (), expected[i - 5], "FIFO order");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 5, "packets left");
+  queue->Flush ();
+  NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty (), true, "flushed");
+
+  // Grow the ring, then drop a third of the packets while browsing it
+  uint32_t flushed = queue->GetTotalDroppedPacketsAfterDequeue ();
+  expected.clear ();
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (i);
+      queue->Enqueue (p);
+      expected.push_back (p->GetUid ());
+    }
+  uint32_t removed = queue->RemoveMultiples (3);
+  std::vector<uint64_t> kept;
+  for (uint32_t i = 0; i < expected.size (); i++)
+    {
+      if (expected[i] % 3 != 0)
+        {
+          kept.push_back (expected[i]);
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (removed, expected.size () - kept.size (), "removed packets");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), kept.size (), "packets left");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPacketsAfterDequeue () - flushed, removed, "drops");
+  NS_TEST_EXPECT_MSG_EQ ((queue->GetUids () == kept), true, "holes are skipped");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetDistance (), kept.size (), "std::distance skips the holes");
+  uint32_t larger = 0;
+  for (uint32_t i = 50; i < expected.size (); i++)
+    {
+      larger += (expected[i] % 3 != 0);
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->CountLarge (), larger, "std::count_if skips the holes");
+
+  // Enqueue enough packets to compact the holes away
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (i);
+      queue->Enqueue (p);
+      kept.push_back (p->GetUid ());
+    }
+  NS_TEST_EXPECT_MSG_EQ ((queue->GetUids () == kept), true, "order after compaction");
+
+  // Insert at the head and after the head
+  Ptr<Packet> first = Create<Packet> (1);
+  Ptr<Packet> second = Create<Packet> (2);
+  queue->PushFront (first);
+  queue->InsertSecond (second);
+  kept.insert (kept.begin (), second->GetUid ());
+  kept.insert (kept.begin (), first->GetUid ());
+  NS_TEST_EXPECT_MSG_EQ ((queue->GetUids () == kept), true, "order after insertion");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), kept.size (), "packets after insertion");
+
+  for (uint32_t i = 0; i < kept.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (queue->Dequeue ()->GetUid (), kept[i], "dequeue order");
+    }
+  NS_TEST_EXPECT_MSG_EQ ((queue->Dequeue () == 0), true, "empty queue");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 0, "no bytes left");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -96,6 +300,7 @@ public:
     : TestSuite ("drop-tail-queue", UNIT)
   {
     AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new QueueRingTestCase (), TestCase::QUICK);
   }
 };
 
@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/pcap-file.h"
+#include "ns3/mapped-pcap-file.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that MappedPcapFile reads the records written by PcapFile, in
+ * both byte orders and both timestamp resolutions.
+ */
+class MappedPcapFileTestCase : public TestCase
+{
+public:
+  /**
+   * \param swapMode whether to write the file in the other byte order
+   * \param nanosecMode whether to write nanosecond timestamps
+   */
+  MappedPcapFileTestCase (bool swapMode, bool nanosecMode);
+  virtual void DoRun (void);
+private:
+  bool m_swapMode;    //!< whether to write the file in the other byte order
+  bool m_nanosecMode; //!< whether to write nanosecond timestamps
+};
+
+MappedPcapFileTestCase::MappedPcapFileTestCase (bool swapMode, bool nanosecMode)
+  : TestCase ("Check the records of a pcap file"),
+    m_swapMode (swapMode),
+    m_nanosecMode (nanosecMode)
+{
+}
+
+void
+MappedPcapFileTestCase::DoRun (void)
+{
+  std::ostringstream name;
+  name << "mapped-" << m_swapMode << m_nanosecMode << ".pcap";
+  std::string filename = CreateTempDirFilename (name.str ());
+  uint32_t snapLen = 1000;
+  uint8_t data[1500];
+  for (uint32_t i = 0; i < sizeof (data); i++)
+    {
+      data[i] = i * 13;
+    }
+
+  PcapFile writer;
+  writer.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (writer.Fail (), false, "Could not open " << filename);
+  writer.Init (101, snapLen, PcapFile::ZONE_DEFAULT, m_swapMode, m_nanosecMode);
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      writer.Write (i, i * 1001, data, (i * 97) % sizeof (data));
+    }
+  writer.Close ();
+
+  MappedPcapFile file;
+  file.Open (filename);
+  NS_TEST_ASSERT_MSG_EQ (file.Fail (), false, "Could not map " << filename);
+  NS_TEST_EXPECT_MSG_EQ (file.IsPcapNg (), false, "A pcap file is not a pcapng file");
+  for (uint32_t pass = 0; pass < 2; pass++)
+    {
+      MappedPcapFile::Record record;
+      for (uint32_t i = 0; i < 100; i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (file.Read (record), true, "Missing record " << i);
+          uint32_t size = (i * 97) % sizeof (data);
+          uint64_t time = i * UINT64_C (1000000000) + i * 1001 * (m_nanosecMode ? 1 : 1000);
+          NS_TEST_EXPECT_MSG_EQ (record.time, time, "Wrong timestamp of record " << i);
+          NS_TEST_EXPECT_MSG_EQ (record.dataLinkType, 101, "Wrong data link type");
+          NS_TEST_EXPECT_MSG_EQ (record.origLen, size, "Wrong size of record " << i);
+          NS_TEST_EXPECT_MSG_EQ (record.inclLen, std::min (size, snapLen), "Wrong captured size of record " << i);
+          NS_TEST_EXPECT_MSG_EQ (std::memcmp (record.data, data, record.inclLen), 0, "Wrong bytes in record " << i);
+        }
+      NS_TEST_EXPECT_MSG_EQ (file.Read (record), false, "Too many records");
+      NS_TEST_EXPECT_MSG_EQ (file.Eof (), true, "The whole file should have been read");
+      file.Rewind ();
+    }
+  file.Close ();
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that MappedPcapFile reads the packets of a pcapng file with the
+ * data link type and timestamp resolution of their interface.
+ */
+class MappedPcapNgFileTestCase : public TestCase
+{
+public:
+  MappedPcapNgFileTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * \param value the value to append, little endian
+   */
+  void Add32 (uint32_t value);
+  /**
+   * \param value the value to append, little endian
+   */
+  void Add16 (uint16_t value);
+  /**
+   * Append a section header block.
+   */
+  void AddSection (void);
+  /**
+   * Append an interface description block.
+   * \param dataLinkType the data link type of the interface
+   * \param tsresol the timestamp resolution option, or 0xff to omit it
+   */
+  void AddInterface (uint16_t dataLinkType, uint8_t tsresol);
+  /**
+   * Append an enhanced packet block.
+   * \param interface the interface of the packet
+   * \param ts the timestamp, in the units of the interface
+   * \param size the size of the packet
+   */
+  void AddPacket (uint32_t interface, uint64_t ts, uint32_t size);
+
+  std::vector<uint8_t> m_file; //!< the bytes of the file
+};
+
+MappedPcapNgFileTestCase::MappedPcapNgFileTestCase ()
+  : TestCase ("Check the packets of a pcapng file")
+{
+}
+
+void
+MappedPcapNgFileTestCase::Add32 (uint32_t value)
+{
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      m_file.push_back ((value >> (8 * i)) & 0xff);
+    }
+}
+
+void
+MappedPcapNgFileTestCase::Add16 (uint16_t value)
+{
+  m_file.push_back (value & 0xff);
+  m_file.push_back (value >> 8);
+}
+
+void
+MappedPcapNgFileTestCase::AddSection (void)
+{
+  Add32 (0x0a0d0d0a);
+  Add32 (28);
+  Add32 (0x1a2b3c4d);
+  Add16 (1);
+  Add16 (0);
+  Add32 (0xffffffff);
+  Add32 (0xffffffff);
+  Add32 (28);
+}
+
+void
+MappedPcapNgFileTestCase::AddInterface (uint16_t dataLinkType, uint8_t tsresol)
+{
+  uint32_t length = tsresol == 0xff ? 20 : 32;
+  Add32 (1);
+  Add32 (length);
+  Add16 (dataLinkType);
+  Add16 (0);
+  Add32 (65535);
+  if (tsresol != 0xff)
+    {
+      Add16 (9);
+      Add16 (1);
+      Add32 (tsresol);
+      Add32 (0);
+    }
+  Add32 (length);
+}
+
+void
+MappedPcapNgFileTestCase::AddPacket (uint32_t interface, uint64_t ts, uint32_t size)
+{
+  uint32_t padded = (size + 3) & ~3;
+  Add32 (6);
+  Add32 (32 + padded);
+  Add32 (interface);
+  Add32 (ts >> 32);
+  Add32 (ts & 0xffffffff);
+  Add32 (size);
+  Add32 (size + 10);
+  for (uint32_t i = 0; i < padded; i++)
+    {
+      m_file.push_back (i < size ? size : 0);
+    }
+  Add32 (32 + padded);
+}
+
+void
+MappedPcapNgFileTestCase::DoRun (void)
+{
+  AddSection ();
+  AddInterface (101, 9);
+  AddInterface (1, 0xff);
+  AddPacket (1, 1500000, 5);
+  AddPacket (0, 2000000001, 8);
+  // An interface statistics block, which is skipped
+  Add32 (5);
+  Add32 (24);
+  Add32 (0);
+  Add32 (0);
+  Add32 (0);
+  Add32 (24);
+  // A packet of an interface which does not exist
+  AddPacket (2, 0, 3);
+  // A new section starts again from interface 0
+  AddSection ();
+  AddInterface (113, 0x80 | 20);
+  AddPacket (0, (UINT64_C (3) << 20) | (1 << 19), 2);
+
+  std::string filename = CreateTempDirFilename ("mapped.pcapng");
+  std::ofstream out (filename.c_str (), std::ios::binary);
+  out.write (reinterpret_cast<const char *> (&m_file[0]), m_file.size ());
+  out.close ();
+
+  MappedPcapFile file;
+  file.Open (filename);
+  NS_TEST_ASSERT_MSG_EQ (file.Fail (), false, "Could not map " << filename);
+  NS_TEST_EXPECT_MSG_EQ (file.IsPcapNg (), true, "The file is a pcapng file");
+
+  MappedPcapFile::Record record;
+  NS_TEST_ASSERT_MSG_EQ (file.Read (record), true, "Missing first packet");
+  NS_TEST_EXPECT_MSG_EQ (record.time, UINT64_C (1500000000), "Microsecond timestamps by default");
+  NS_TEST_EXPECT_MSG_EQ (record.dataLinkType, 1, "Wrong data link type of the first packet");
+  NS_TEST_EXPECT_MSG_EQ (record.inclLen, 5, "Wrong captured size of the first packet");
+  NS_TEST_EXPECT_MSG_EQ (record.origLen, 15, "Wrong size of the first packet");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.data[4], 5, "Wrong bytes in the first packet");
+
+  NS_TEST_ASSERT_MSG_EQ (file.Read (record), true, "Missing second packet");
+  NS_TEST_EXPECT_MSG_EQ (record.time, UINT64_C (2000000001), "Nanosecond timestamps");
+  NS_TEST_EXPECT_MSG_EQ (record.dataLinkType, 101, "Wrong data link type of the second packet");
+  NS_TEST_EXPECT_MSG_EQ (record.inclLen, 8, "Wrong captured size of the second packet");
+
+  NS_TEST_ASSERT_MSG_EQ (file.Read (record), true, "Missing third packet");
+  NS_TEST_EXPECT_MSG_EQ (record.time, UINT64_C (3500000000), "Binary timestamps");
+  NS_TEST_EXPECT_MSG_EQ (record.dataLinkType, 113, "Wrong data link type of the third packet");
+  NS_TEST_EXPECT_MSG_EQ (record.inclLen, 2, "Wrong captured size of the third packet");
+
+  NS_TEST_EXPECT_MSG_EQ (file.Read (record), false, "Too many packets");
+  file.Close ();
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief MappedPcapFile TestSuite
+ */
+class MappedPcapFileTestSuite : public TestSuite
+{
+public:
+  MappedPcapFileTestSuite ()
+    : TestSuite ("mapped-pcap-file", UNIT)
+  {
+    AddTestCase (new MappedPcapFileTestCase (false, false), TestCase::QUICK);
+    AddTestCase (new MappedPcapFileTestCase (true, false), TestCase::QUICK);
+    AddTestCase (new MappedPcapFileTestCase (false, true), TestCase::QUICK);
+    AddTestCase (new MappedPcapFileTestCase (true, true), TestCase::QUICK);
+    AddTestCase (new MappedPcapNgFileTestCase (), TestCase::QUICK);
+  }
+};
+
+static MappedPcapFileTestSuite g_mappedPcapFileTestSuite; //!< Static variable for test initialization
@@ -19,6 +19,8 @@
  */
 #include "ns3/packet.h"
 #include "ns3/packet-tag-list.h"
+#include "ns3/packet-allocator.h"
+#include "ns3/ethernet-header.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
 #include <limits>     // std:numeric_limits
@@ -26,7 +28,9 @@
 #include <cstdarg>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 #include <ctime>
+#include <cstring>
 
 using namespace ns3;
 
@@ -1035,6 +1039,166 @@ PacketTagListTest::DoRun (void)
     
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * PacketAllocator unit tests.
+ */
+class PacketAllocatorTest : public TestCase
+{
+public:
+  PacketAllocatorTest ();
+private:
+  void DoRun (void);
+};
+
+PacketAllocatorTest::PacketAllocatorTest ()
+  : TestCase ("PacketAllocator")
+{
+}
+
+void
+PacketAllocatorTest::DoRun (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (PacketAllocator::GetCapacity (1), 32, "smallest class");
+  NS_TEST_EXPECT_MSG_EQ (PacketAllocator::GetCapacity (33), 48, "two classes per power of two");
+  NS_TEST_EXPECT_MSG_EQ (PacketAllocator::GetCapacity (4096), 4096, "largest class");
+  NS_TEST_EXPECT_MSG_EQ (PacketAllocator::GetCapacity (5000), 5000, "not pooled");
+
+  // Blocks are reused in last in, first out order
+  void *a = PacketAllocator::Allocate (PacketAllocator::BUFFER_DATA, 100);
+  PacketAllocator::Deallocate (PacketAllocator::BUFFER_DATA, a, 100);
+  void *b = PacketAllocator::Allocate (PacketAllocator::BUFFER_DATA, 120);
+  NS_TEST_EXPECT_MSG_EQ (a, b, "block of the same class not reused");
+  PacketAllocator::Deallocate (PacketAllocator::BUFFER_DATA, b, 120);
+  void *large = PacketAllocator::Allocate (PacketAllocator::BUFFER_DATA, 10000);
+  PacketAllocator::Deallocate (PacketAllocator::BUFFER_DATA, large, 10000);
+
+  PacketAllocator::Stats before[PacketAllocator::POOL_N];
+  for (uint32_t i = 0; i < PacketAllocator::POOL_N; i++)
+    {
+      before[i] = PacketAllocator::GetStats (PacketAllocator::Pool (i));
+    }
+  {
+    std::vector<Ptr<Packet> > packets;
+    for (uint32_t i = 0; i < 100; i++)
+      {
+        Ptr<Packet> p = Create<Packet> (1000);
+        p->AddHeader (ATestHeader<10> ());
+        p->AddPacketTag (ATestTag<1> ());
+        p->AddByteTag (ATestTag<2> ());
+        packets.push_back (p);
+      }
+    // Copies share the data blocks
+    Ptr<Packet> copy = packets[0]->Copy ();
+
+    PacketAllocator::Stats stats = PacketAllocator::GetStats (PacketAllocator::PACKET);
+    NS_TEST_EXPECT_MSG_EQ (stats.live - before[PacketAllocator::PACKET].live, 101, "live packets");
+    NS_TEST_EXPECT_MSG_GT_OR_EQ (stats.peak, stats.live, "peak below live");
+    NS_TEST_EXPECT_MSG_EQ (stats.allocations - before[PacketAllocator::PACKET].allocations, 101, "packet allocations");
+    stats = PacketAllocator::GetStats (PacketAllocator::BUFFER_DATA);
+    NS_TEST_EXPECT_MSG_EQ (stats.live - before[PacketAllocator::BUFFER_DATA].live, 100, "live buffers");
+    stats = PacketAllocator::GetStats (PacketAllocator::PACKET_TAGS);
+    NS_TEST_EXPECT_MSG_EQ (stats.live - before[PacketAllocator::PACKET_TAGS].live, 100, "live packet tags");
+    stats = PacketAllocator::GetStats (PacketAllocator::BYTE_TAGS);
+    NS_TEST_EXPECT_MSG_EQ (stats.live - before[PacketAllocator::BYTE_TAGS].live, 100, "live byte tags");
+    NS_TEST_EXPECT_MSG_GT (PacketAllocator::GetSlabBytes (), 0, "no slab");
+  }
+  for (uint32_t i = 0; i < PacketAllocator::POOL_N; i++)
+    {
+      PacketAllocator::Stats stats = PacketAllocator::GetStats (PacketAllocator::Pool (i));
+      NS_TEST_EXPECT_MSG_EQ (stats.live, before[i].live,
+                             PacketAllocator::GetPoolName (PacketAllocator::Pool (i)) << " blocks leaked");
+      NS_TEST_EXPECT_MSG_EQ (stats.bytes, before[i].bytes,
+                             PacketAllocator::GetPoolName (PacketAllocator::Pool (i)) << " bytes leaked");
+    }
+
+  // The slabs of a burst are released by Trim, except those still in use
+  PacketAllocator::Trim ();
+  uint64_t slabBytes = PacketAllocator::GetSlabBytes ();
+  std::vector<void *> burst;
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      burst.push_back (PacketAllocator::Allocate (PacketAllocator::BUFFER_DATA, 3000));
+    }
+  NS_TEST_EXPECT_MSG_GT (PacketAllocator::GetSlabBytes (), slabBytes, "burst without new slabs");
+  void *kept = burst.back ();
+  burst.pop_back ();
+  for (uint32_t i = 0; i < burst.size (); i++)
+    {
+      PacketAllocator::Deallocate (PacketAllocator::BUFFER_DATA, burst[i], 3000);
+    }
+  uint64_t released = PacketAllocator::Trim ();
+  NS_TEST_EXPECT_MSG_GT (released, 0, "no slab released");
+  NS_TEST_EXPECT_MSG_EQ (PacketAllocator::GetSlabBytes (), slabBytes + 65536, "only the slab in use should be kept");
+  NS_TEST_EXPECT_MSG_EQ (PacketAllocator::Trim (), 0, "nothing left to release");
+  std::memset (kept, 0xff, 3000);
+  void *reused = PacketAllocator::Allocate (PacketAllocator::BUFFER_DATA, 3000);
+  NS_TEST_EXPECT_MSG_EQ (PacketAllocator::GetSlabBytes (), slabBytes + 65536, "free block of the kept slab not reused");
+  PacketAllocator::Deallocate (PacketAllocator::BUFFER_DATA, reused, 3000);
+  PacketAllocator::Deallocate (PacketAllocator::BUFFER_DATA, kept, 3000);
+  NS_TEST_EXPECT_MSG_EQ (PacketAllocator::Trim (), 65536, "the last slab should be released");
+  NS_TEST_EXPECT_MSG_EQ (PacketAllocator::GetSlabBytes (), slabBytes, "slabs left after the burst");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet::PeekContiguousData and the header views.
+ */
+class PacketPeekContiguousTest : public TestCase
+{
+public:
+  PacketPeekContiguousTest ();
+private:
+  void DoRun (void);
+};
+
+PacketPeekContiguousTest::PacketPeekContiguousTest ()
+  : TestCase ("PeekContiguousData")
+{
+}
+
+void
+PacketPeekContiguousTest::DoRun (void)
+{
+  EthernetHeader header (false);
+  header.SetSource (Mac48Address ("00:00:00:00:00:01"));
+  header.SetDestination (Mac48Address ("00:00:00:00:00:02"));
+  header.SetLengthType (0x0800);
+
+  Ptr<Packet> p = Create<Packet> (100);
+  NS_TEST_EXPECT_MSG_EQ ((p->PeekContiguousData (0, 1) == 0), true, "zero area is not contiguous");
+  p->AddHeader (header);
+  NS_TEST_EXPECT_MSG_EQ ((p->PeekContiguousData (0, 14) != 0), true, "header is contiguous");
+  NS_TEST_EXPECT_MSG_EQ ((p->PeekContiguousData (0, 15) == 0), true, "header and zero area");
+  NS_TEST_EXPECT_MSG_EQ ((p->PeekContiguousData (10, 4) != 0), true, "end of header");
+
+  EthernetHeaderView view;
+  NS_TEST_ASSERT_MSG_EQ (view.Peek (p), true, "ethernet header not contiguous");
+  NS_TEST_EXPECT_MSG_EQ (view.GetSource (), header.GetSource (), "source");
+  NS_TEST_EXPECT_MSG_EQ (view.GetDestination (), header.GetDestination (), "destination");
+  NS_TEST_EXPECT_MSG_EQ (view.GetLengthType (), 0x0800, "length/type");
+
+  // Peeking neither copies the buffer nor changes the metadata
+  std::ostringstream before, after;
+  p->Print (before);
+  Ptr<Packet> copy = p->Copy ();
+  view.Peek (copy);
+  copy->Print (after);
+  NS_TEST_EXPECT_MSG_EQ (before.str (), after.str (), "metadata changed");
+
+  // Real payload bytes are contiguous too
+  uint8_t bytes[16] = {1, 2, 3, 4};
+  Ptr<Packet> real = Create<Packet> (bytes, sizeof (bytes));
+  uint8_t const *data = real->PeekContiguousData (2, 2);
+  NS_TEST_ASSERT_MSG_EQ ((data != 0), true, "real bytes not contiguous");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) data[0], 3, "wrong offset");
+  NS_TEST_EXPECT_MSG_EQ ((real->PeekContiguousData (8, 9) == 0), true, "past the end");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1052,6 +1216,8 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketAllocatorTest, TestCase::QUICK);
+  AddTestCase (new PacketPeekContiguousTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
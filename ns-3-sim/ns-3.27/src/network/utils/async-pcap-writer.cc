@@ -0,0 +1,438 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/callback.h"
+#include "ns3/network-config.h"
+#include "ns3/packet.h"
+#include "ns3/header.h"
+#include "ns3/buffer.h"
+#include "async-pcap-writer.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AsyncPcapWriter");
+
+namespace {
+
+const uint32_t MAGIC = 0xa1b2c3d4;     //!< Magic number of microsecond timestamps
+const uint32_t NS_MAGIC = 0xa1b23c4d;  //!< Magic number of nanosecond timestamps
+const uint16_t VERSION_MAJOR = 2;      //!< Major version of the pcap file format
+const uint16_t VERSION_MINOR = 4;      //!< Minor version of the pcap file format
+const uint32_t FILE_HEADER_SIZE = 24;  //!< Size of the pcap file header
+const uint32_t RECORD_HEADER_SIZE = 16; //!< Size of a pcap record header
+const uint64_t POLL_NS = 1000000;      //!< Longest wait before the offsets are checked again
+
+/**
+ * \param buffer where to write
+ * \param data the value to write, little endian
+ * \returns the byte after the value
+ */
+uint8_t *
+WriteLsb32 (uint8_t *buffer, uint32_t data)
+{
+  buffer[0] = data & 0xff;
+  buffer[1] = (data >> 8) & 0xff;
+  buffer[2] = (data >> 16) & 0xff;
+  buffer[3] = (data >> 24) & 0xff;
+  return buffer + 4;
+}
+
+/**
+ * \param buffer where to write
+ * \param data the value to write, little endian
+ * \returns the byte after the value
+ */
+uint8_t *
+WriteLsb16 (uint8_t *buffer, uint16_t data)
+{
+  buffer[0] = data & 0xff;
+  buffer[1] = (data >> 8) & 0xff;
+  return buffer + 2;
+}
+
+} // anonymous namespace
+
+AsyncPcapWriter::AsyncPcapWriter (uint32_t bufferSize)
+  : m_record (0),
+    m_head (0),
+    m_tail (0),
+    m_stop (false),
+    m_file (0),
+    m_gzip (false),
+    m_fail (false),
+    m_magic (0),
+    m_snapLen (0),
+    m_dataLinkType (0),
+    m_timeZoneCorrection (0)
+{
+  NS_LOG_FUNCTION (this << bufferSize);
+  uint32_t size = 4096;
+  while (size < bufferSize && size < 0x80000000U)
+    {
+      size <<= 1;
+    }
+  m_ring.resize (size);
+}
+
+AsyncPcapWriter::~AsyncPcapWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+AsyncPcapWriter::Open (std::string const &filename, bool gzip)
+{
+  NS_LOG_FUNCTION (this << filename << gzip);
+  NS_ASSERT_MSG (m_file == 0, "AsyncPcapWriter::Open(): the file is already open");
+  m_gzip = gzip;
+  m_head = 0;
+  m_tail = 0;
+  m_stop = false;
+  m_fail = false;
+  if (gzip)
+    {
+#ifdef HAVE_ZLIB
+      // The fastest level: compression must keep up with the simulation
+      m_file = gzopen (filename.c_str (), "wb1");
+#else
+      NS_FATAL_ERROR ("AsyncPcapWriter::Open(): gzip compression requires zlib");
+#endif
+    }
+  else
+    {
+      m_file = std::fopen (filename.c_str (), "wb");
+    }
+  if (m_file == 0)
+    {
+      m_fail = true;
+      return;
+    }
+  m_thread = Create<SystemThread> (MakeCallback (&AsyncPcapWriter::Run, this));
+  m_thread->Start ();
+}
+
+void
+AsyncPcapWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_file == 0)
+    {
+      return;
+    }
+  m_mutex.Lock ();
+  m_stop = true;
+  m_mutex.Unlock ();
+  m_dataReady.Signal ();
+  m_thread->Join ();
+  m_thread = 0;
+  if (m_gzip)
+    {
+#ifdef HAVE_ZLIB
+      if (gzclose (static_cast<gzFile> (m_file)) != Z_OK)
+        {
+          m_fail = true;
+        }
+#endif
+    }
+  else if (std::fclose (static_cast<std::FILE *> (m_file)) != 0)
+    {
+      m_fail = true;
+    }
+  m_file = 0;
+}
+
+bool
+AsyncPcapWriter::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  CriticalSection cs (m_mutex);
+  return m_fail;
+}
+
+void
+AsyncPcapWriter::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrection,
+                       bool nanosecMode)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << snapLen << timeZoneCorrection << nanosecMode);
+  m_magic = nanosecMode ? NS_MAGIC : MAGIC;
+  m_snapLen = snapLen;
+  m_dataLinkType = dataLinkType;
+  m_timeZoneCorrection = timeZoneCorrection;
+  if (m_file == 0)
+    {
+      return;
+    }
+  uint8_t *buffer = Reserve (FILE_HEADER_SIZE);
+  buffer = WriteLsb32 (buffer, m_magic);
+  buffer = WriteLsb16 (buffer, VERSION_MAJOR);
+  buffer = WriteLsb16 (buffer, VERSION_MINOR);
+  buffer = WriteLsb32 (buffer, m_timeZoneCorrection);
+  buffer = WriteLsb32 (buffer, 0);
+  buffer = WriteLsb32 (buffer, m_snapLen);
+  WriteLsb32 (buffer, m_dataLinkType);
+  Commit (FILE_HEADER_SIZE);
+}
+
+void
+AsyncPcapWriter::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
+  if (m_file == 0)
+    {
+      return;
+    }
+  uint32_t totalLen = p->GetSize ();
+  uint32_t inclLen = std::min (totalLen, m_snapLen);
+  uint8_t *buffer = BeginRecord (tsSec, tsUsec, totalLen, inclLen);
+  p->CopyData (buffer, inclLen);
+  Commit (RECORD_HEADER_SIZE + inclLen);
+}
+
+void
+AsyncPcapWriter::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << tsSec << tsUsec << &header << p);
+  if (m_file == 0)
+    {
+      return;
+    }
+  uint32_t headerSize = header.GetSerializedSize ();
+  uint32_t totalLen = headerSize + p->GetSize ();
+  uint32_t inclLen = std::min (totalLen, m_snapLen);
+  uint8_t *buffer = BeginRecord (tsSec, tsUsec, totalLen, inclLen);
+
+  Buffer headerBuffer;
+  headerBuffer.AddAtStart (headerSize);
+  header.Serialize (headerBuffer.Begin ());
+  uint32_t toCopy = std::min (headerSize, inclLen);
+  headerBuffer.CopyData (buffer, toCopy);
+  p->CopyData (buffer + toCopy, inclLen - toCopy);
+  Commit (RECORD_HEADER_SIZE + inclLen);
+}
+
+void
+AsyncPcapWriter::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const *data, uint32_t totalLen)
+{
+  NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
+  if (m_file == 0)
+    {
+      return;
+    }
+  uint32_t inclLen = std::min (totalLen, m_snapLen);
+  uint8_t *buffer = BeginRecord (tsSec, tsUsec, totalLen, inclLen);
+  std::memcpy (buffer, data, inclLen);
+  Commit (RECORD_HEADER_SIZE + inclLen);
+}
+
+uint32_t
+AsyncPcapWriter::GetMagic (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_magic;
+}
+
+uint16_t
+AsyncPcapWriter::GetVersionMajor (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return VERSION_MAJOR;
+}
+
+uint16_t
+AsyncPcapWriter::GetVersionMinor (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return VERSION_MINOR;
+}
+
+uint32_t
+AsyncPcapWriter::GetSigFigs (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 0;
+}
+
+bool
+AsyncPcapWriter::IsNanoSecMode (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_magic == NS_MAGIC;
+}
+
+uint32_t
+AsyncPcapWriter::GetSnapLen (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_snapLen;
+}
+
+uint32_t
+AsyncPcapWriter::GetDataLinkType (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_dataLinkType;
+}
+
+int32_t
+AsyncPcapWriter::GetTimeZoneOffset (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_timeZoneCorrection;
+}
+
+uint8_t *
+AsyncPcapWriter::BeginRecord (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen, uint32_t inclLen)
+{
+  uint8_t *buffer = Reserve (RECORD_HEADER_SIZE + inclLen);
+  buffer = WriteLsb32 (buffer, tsSec);
+  buffer = WriteLsb32 (buffer, tsUsec);
+  buffer = WriteLsb32 (buffer, inclLen);
+  return WriteLsb32 (buffer, totalLen);
+}
+
+uint8_t *
+AsyncPcapWriter::Reserve (uint32_t size)
+{
+  uint64_t capacity = m_ring.size ();
+  if (size <= capacity)
+    {
+      m_mutex.Lock ();
+      while (capacity - (m_tail - m_head) < size)
+        {
+          // The background thread is late: wait for it rather than drop
+          m_mutex.Unlock ();
+          m_spaceReady.TimedWait (POLL_NS);
+          m_mutex.Lock ();
+        }
+      uint64_t offset = m_tail & (capacity - 1);
+      m_mutex.Unlock ();
+      if (offset + size <= capacity)
+        {
+          // Only the simulation thread moves m_tail, so the bytes past it
+          // are ours until Commit publishes them.
+          m_record = &m_ring[offset];
+          return m_record;
+        }
+    }
+  // The record wraps around the ring buffer, or is larger than it
+  m_scratch.resize (size);
+  m_record = &m_scratch[0];
+  return m_record;
+}
+
+void
+AsyncPcapWriter::Commit (uint32_t size)
+{
+  if (m_scratch.empty () || m_record != &m_scratch[0])
+    {
+      m_mutex.Lock ();
+      m_tail += size;
+      m_mutex.Unlock ();
+      m_dataReady.Signal ();
+      return;
+    }
+  uint64_t capacity = m_ring.size ();
+  uint8_t const *data = m_record;
+  while (size > 0)
+    {
+      m_mutex.Lock ();
+      while (m_tail - m_head == capacity)
+        {
+          m_mutex.Unlock ();
+          m_spaceReady.TimedWait (POLL_NS);
+          m_mutex.Lock ();
+        }
+      uint64_t offset = m_tail & (capacity - 1);
+      uint64_t room = capacity - (m_tail - m_head);
+      m_mutex.Unlock ();
+      uint32_t n = std::min<uint64_t> (std::min<uint64_t> (size, room), capacity - offset);
+      std::memcpy (&m_ring[offset], data, n);
+      data += n;
+      size -= n;
+      m_mutex.Lock ();
+      m_tail += n;
+      m_mutex.Unlock ();
+      m_dataReady.Signal ();
+    }
+}
+
+void
+AsyncPcapWriter::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t capacity = m_ring.size ();
+  while (true)
+    {
+      m_mutex.Lock ();
+      uint64_t head = m_head;
+      uint64_t tail = m_tail;
+      bool stop = m_stop;
+      m_mutex.Unlock ();
+      if (head == tail)
+        {
+          if (stop)
+            {
+              break;
+            }
+          m_dataReady.TimedWait (POLL_NS);
+          continue;
+        }
+      // Write the published bytes up to the end of the ring buffer, then
+      // give them back to the simulation thread.
+      uint64_t offset = head & (capacity - 1);
+      uint64_t n = std::min (tail - head, capacity - offset);
+      WriteFile (&m_ring[offset], n);
+      m_mutex.Lock ();
+      m_head = head + n;
+      m_mutex.Unlock ();
+      m_spaceReady.Signal ();
+    }
+}
+
+void
+AsyncPcapWriter::WriteFile (uint8_t const *data, uint32_t size)
+{
+  bool ok;
+  if (m_gzip)
+    {
+#ifdef HAVE_ZLIB
+      ok = gzwrite (static_cast<gzFile> (m_file), data, size) == static_cast<int> (size);
+#else
+      ok = false;
+#endif
+    }
+  else
+    {
+      ok = std::fwrite (data, 1, size, static_cast<std::FILE *> (m_file)) == size;
+    }
+  if (!ok)
+    {
+      CriticalSection cs (m_mutex);
+      m_fail = true;
+    }
+}
+
+} // namespace ns3
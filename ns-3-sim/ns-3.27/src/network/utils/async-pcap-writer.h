@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ASYNC_PCAP_WRITER_H
+#define ASYNC_PCAP_WRITER_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/system-mutex.h"
+#include "ns3/system-condition.h"
+#include "ns3/system-thread.h"
+
+namespace ns3 {
+
+class Packet;
+class Header;
+
+/**
+ * \ingroup network
+ *
+ * \brief Write a pcap file from a background thread.
+ *
+ * The records are formatted by the simulation thread into a ring buffer,
+ * which costs a copy of the captured bytes of each packet, at most the
+ * snapshot length.  A background thread drains the ring buffer into the
+ * file, optionally through a gzip stream.  When the ring buffer is full,
+ * the simulation thread waits for the background thread: no record is
+ * ever dropped.
+ *
+ * The file written is byte for byte the one PcapFile would write with the
+ * same arguments, little endian on every host.
+ */
+class AsyncPcapWriter
+{
+public:
+  /**
+   * \param bufferSize the size of the ring buffer, rounded up to a power
+   *        of two
+   */
+  AsyncPcapWriter (uint32_t bufferSize);
+  ~AsyncPcapWriter ();
+
+  /**
+   * Create the file and start the background thread.
+   *
+   * \param filename the name of the file
+   * \param gzip whether to compress the file with gzip, which requires zlib
+   */
+  void Open (std::string const &filename, bool gzip);
+  /**
+   * Write the records left in the ring buffer, stop the background thread
+   * and close the file.
+   */
+  void Close (void);
+  /**
+   * \returns true if the file could not be created or written
+   */
+  bool Fail (void) const;
+  /**
+   * Write the pcap file header.
+   *
+   * \param dataLinkType the data link type of the records
+   * \param snapLen the maximum number of bytes captured per packet
+   * \param timeZoneCorrection the time zone offset of the timestamps
+   * \param nanosecMode whether the timestamps are in nanoseconds
+   */
+  void Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrection,
+             bool nanosecMode);
+  /**
+   * \param tsSec the seconds part of the timestamp
+   * \param tsUsec the sub-second part of the timestamp
+   * \param p the packet
+   */
+  void Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p);
+  /**
+   * \param tsSec the seconds part of the timestamp
+   * \param tsUsec the sub-second part of the timestamp
+   * \param header a header to write before the packet
+   * \param p the packet
+   */
+  void Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<const Packet> p);
+  /**
+   * \param tsSec the seconds part of the timestamp
+   * \param tsUsec the sub-second part of the timestamp
+   * \param data the bytes of the packet
+   * \param totalLen the number of bytes of the packet
+   */
+  void Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const *data, uint32_t totalLen);
+
+  /**
+   * \returns the magic number of the file
+   */
+  uint32_t GetMagic (void) const;
+  /**
+   * \returns the major version of the file format
+   */
+  uint16_t GetVersionMajor (void) const;
+  /**
+   * \returns the minor version of the file format
+   */
+  uint16_t GetVersionMinor (void) const;
+  /**
+   * \returns the accuracy of the timestamps of the file
+   */
+  uint32_t GetSigFigs (void) const;
+  /**
+   * \returns true if the timestamps are in nanoseconds
+   */
+  bool IsNanoSecMode (void) const;
+  /**
+   * \returns the snapshot length of the file
+   */
+  uint32_t GetSnapLen (void) const;
+  /**
+   * \returns the data link type of the file
+   */
+  uint32_t GetDataLinkType (void) const;
+  /**
+   * \returns the time zone offset of the file
+   */
+  int32_t GetTimeZoneOffset (void) const;
+
+private:
+  /**
+   * Make room for a record in the ring buffer.
+   * \param size the size of the record
+   * \returns where to format the record
+   */
+  uint8_t *Reserve (uint32_t size);
+  /**
+   * Publish the record formatted at the address returned by Reserve.
+   * \param size the size of the record
+   */
+  void Commit (uint32_t size);
+  /**
+   * Format the header of a record.
+   * \param tsSec the seconds part of the timestamp
+   * \param tsUsec the sub-second part of the timestamp
+   * \param totalLen the size of the packet
+   * \param inclLen the number of bytes captured
+   * \returns where to write the captured bytes
+   */
+  uint8_t *BeginRecord (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen, uint32_t inclLen);
+  /// Body of the background thread
+  void Run (void);
+  /**
+   * Write bytes to the file, from the background thread.
+   * \param data the bytes
+   * \param size the number of bytes
+   */
+  void WriteFile (uint8_t const *data, uint32_t size);
+
+  std::vector<uint8_t> m_ring;     //!< the ring buffer
+  std::vector<uint8_t> m_scratch;  //!< a record which wraps around the ring buffer
+  uint8_t *m_record;               //!< where the current record is formatted
+  uint64_t m_head;                 //!< offset of the first byte to write, guarded by m_mutex
+  uint64_t m_tail;                 //!< offset past the last record, guarded by m_mutex
+  bool m_stop;                     //!< whether the thread must stop, guarded by m_mutex
+  mutable SystemMutex m_mutex;     //!< guards the offsets shared with the thread
+  SystemCondition m_dataReady;     //!< records were published
+  SystemCondition m_spaceReady;    //!< records were written to the file
+  Ptr<SystemThread> m_thread;      //!< the background thread
+  void *m_file;                    //!< the FILE or gzFile
+  bool m_gzip;                     //!< whether m_file is a gzFile
+  bool m_fail;                     //!< whether an error occurred
+  uint32_t m_magic;                //!< the magic number of the file
+  uint32_t m_snapLen;              //!< the snapshot length of the file
+  uint32_t m_dataLinkType;         //!< the data link type of the file
+  int32_t m_timeZoneCorrection;    //!< the time zone offset of the file
+};
+
+} // namespace ns3
+
+#endif /* ASYNC_PCAP_WRITER_H */
@@ -22,6 +22,7 @@
 #include "ns3/nstime.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include <limits>
 
 namespace ns3 {
   
@@ -184,14 +185,92 @@ DataRate::DoParse (const std::string s, uint64_t *v)
   return true;
 }
 
+namespace {
+
+/**
+ * \param bps a data rate in bits per second
+ * \return the picoseconds per byte of the rate, see
+ * DataRate::GetPicoSecondsPerByte
+ */
+uint64_t
+PicoSecondsPerByte (uint64_t bps)
+{
+  const uint64_t psBitsPerSecond = UINT64_C (8000000000000);
+  if (bps == 0 || psBitsPerSecond % bps != 0)
+    {
+      return 0;
+    }
+  uint64_t psPerByte = psBitsPerSecond / bps;
+  return psPerByte <= std::numeric_limits<uint32_t>::max () ? psPerByte : 0;
+}
+
+/**
+ * \param a a positive integer
+ * \param b a positive integer
+ * \return the greatest common divisor of a and b
+ */
+uint64_t
+Gcd (uint64_t a, uint64_t b)
+{
+  while (b != 0)
+    {
+      uint64_t r = a % b;
+      a = b;
+      b = r;
+    }
+  return a;
+}
+
+/**
+ * The picoseconds per time step of the last time resolution seen by
+ * DataRate::CalculateBytesTxTime, so that it is checked once rather than
+ * for every packet.
+ */
+struct PsPerStepCache
+{
+  int64_t stepsPerSecond; //!< time steps per second the entry is for
+  uint64_t psPerStep;     //!< picoseconds per time step, or 0
+};
+
+/// The picoseconds per time step of the current time resolution
+PsPerStepCache g_psPerStep = { 0, 0 };
+
+/**
+ * \return the picoseconds per time step of the current time resolution,
+ * or 0 if the resolution is not a multiple of the picosecond
+ */
+uint64_t
+GetPicoSecondsPerStep (void)
+{
+  int64_t stepsPerSecond = Time::GetStepsPerSecond ();
+  if (stepsPerSecond != g_psPerStep.stepsPerSecond)
+    {
+      const int64_t psPerSecond = INT64_C (1000000000000);
+      g_psPerStep.stepsPerSecond = stepsPerSecond;
+      if (stepsPerSecond <= 0 || psPerSecond % stepsPerSecond != 0)
+        {
+          g_psPerStep.psPerStep = 0;
+        }
+      else
+        {
+          g_psPerStep.psPerStep = psPerSecond / stepsPerSecond;
+        }
+    }
+  return g_psPerStep.psPerStep;
+}
+
+} // anonymous namespace
+
 DataRate::DataRate ()
-  : m_bps (0)
+  : m_bps (0),
+    m_psPerByte (0)
 {
   NS_LOG_FUNCTION (this);
 }
 
 DataRate::DataRate(uint64_t bps)
-  : m_bps (bps)
+  : m_bps (bps),
+    m_psPerByte (PicoSecondsPerByte (bps))
 {
   NS_LOG_FUNCTION (this << bps);
 }
@@ -235,14 +314,49 @@ double DataRate::CalculateTxTime (uint32_t bytes) const
 Time DataRate::CalculateBytesTxTime (uint32_t bytes) const
 {
   NS_LOG_FUNCTION (this << bytes);
-  // \todo avoid to use double (if possible).
-  return Seconds (static_cast<double>(bytes)*8/m_bps);
+  // bytes * m_psPerByte picoseconds are exactly the transmission time, so
+  // truncating them to the time resolution gives the same result as
+  // DoCalculateTxTime, with a single division.
+  uint64_t psPerStep = m_psPerByte != 0 ? GetPicoSecondsPerStep () : 0;
+  if (psPerStep != 0)
+    {
+      return TimeStep (bytes * m_psPerByte / psPerStep);
+    }
+  return DoCalculateTxTime (static_cast<uint64_t> (bytes) * 8);
 }
 
 Time DataRate::CalculateBitsTxTime (uint32_t bits) const
 {
   NS_LOG_FUNCTION (this << bits);
-  // \todo avoid to use double (if possible).
+  uint64_t psPerStep = m_psPerByte != 0 ? GetPicoSecondsPerStep () : 0;
+  if (psPerStep != 0)
+    {
+      return TimeStep (bits * m_psPerByte / (8 * psPerStep));
+    }
+  return DoCalculateTxTime (bits);
+}
+
+Time DataRate::DoCalculateTxTime (uint64_t bits) const
+{
+  // Integer division in time steps, truncated like the former
+  // Seconds (bits / m_bps) but exact: bits * stepsPerSecond / m_bps,
+  // split into quotient and remainder so the product cannot overflow.
+  // Both terms of the fraction are first divided by their greatest
+  // common divisor, so that rates above 18Gbps stay exact at the
+  // nanosecond resolution.
+  int64_t stepsPerSecond = Time::GetStepsPerSecond ();
+  if (m_bps != 0 && stepsPerSecond > 0)
+    {
+      uint64_t divisor = Gcd (m_bps, stepsPerSecond);
+      uint64_t bps = m_bps / divisor;
+      uint64_t steps = stepsPerSecond / divisor;
+      if (bps <= std::numeric_limits<uint64_t>::max () / steps)
+        {
+          uint64_t quotient = bits / bps;
+          uint64_t remainder = bits % bps;
+          return TimeStep (quotient * steps + remainder * steps / bps);
+        }
+    }
   return Seconds (static_cast<double>(bits)/m_bps);
 }
 
@@ -252,6 +366,12 @@ uint64_t DataRate::GetBitRate () const
   return m_bps;
 }
 
+uint64_t DataRate::GetPicoSecondsPerByte () const
+{
+  NS_LOG_FUNCTION (this);
+  return m_psPerByte;
+}
+
 DataRate::DataRate (std::string rate)
 {
   NS_LOG_FUNCTION (this << rate);
@@ -260,6 +380,39 @@ DataRate::DataRate (std::string rate)
     {
       NS_FATAL_ERROR ("Could not parse rate: "<<rate);
     }
+  m_psPerByte = PicoSecondsPerByte (m_bps);
+}
+
+DataRateTxTimeCache::DataRateTxTimeCache ()
+  : m_bps (0),
+    m_next (0)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < SIZE; i++)
+    {
+      m_bytes[i] = 0;
+    }
+}
+
+Time
+DataRateTxTimeCache::DoGet (const DataRate &rate, uint32_t bytes)
+{
+  NS_LOG_FUNCTION (this << rate << bytes);
+  if (rate.GetBitRate () != m_bps)
+    {
+      m_bps = rate.GetBitRate ();
+      for (uint32_t i = 0; i < SIZE; i++)
+        {
+          m_bytes[i] = 0;
+          m_times[i] = Time ();
+        }
+      m_next = 0;
+    }
+  Time time = rate.CalculateBytesTxTime (bytes);
+  m_bytes[m_next] = bytes;
+  m_times[m_next] = time;
+  m_next = (m_next + 1) % SIZE;
+  return time;
 }
 
 /* For printing of data rate */
@@ -197,6 +197,17 @@ public:
    */
   uint64_t GetBitRate () const;
 
+  /**
+   * Get the time to transmit a byte, when it is an integer number of
+   * picoseconds small enough for the time of any uint32_t number of bytes
+   * to fit in 64 bits.  This holds for the usual rates, from a few kbps
+   * to 100Gbps and beyond, and lets CalculateBytesTxTime multiply rather
+   * than divide.
+   *
+   * \return The picoseconds per byte, or 0
+   */
+  uint64_t GetPicoSecondsPerByte () const;
+
 private:
 
   /**
@@ -215,12 +226,76 @@ private:
    */
   static bool DoParse (const std::string s, uint64_t *v);
 
+  /**
+   * \brief Calculate transmission time with integer arithmetic
+   *
+   * \param [in] bits The number of bits for which to calculate
+   * \return The transmission time, truncated to the current time resolution
+   */
+  Time DoCalculateTxTime (uint64_t bits) const;
+
   // Uses DoParse
   friend std::istream &operator >> (std::istream &is, DataRate &rate);
   
   uint64_t m_bps; //!< data rate [bps]
+  uint64_t m_psPerByte; //!< picoseconds per byte, or 0, see GetPicoSecondsPerByte
 };
 
+/**
+ * \ingroup network
+ * \brief The transmission times of the last packet sizes sent at a DataRate.
+ *
+ * A device keeps one such cache to look up the time of the packet sizes
+ * it sends most, e.g. full segments and acknowledgements, rather than
+ * compute it for every packet.  The cache is emptied when the rate
+ * changes.
+ */
+class DataRateTxTimeCache
+{
+public:
+  DataRateTxTimeCache ();
+
+  /**
+   * \param rate the data rate
+   * \param bytes the number of bytes
+   * \return rate.CalculateBytesTxTime (bytes)
+   */
+  Time Get (const DataRate &rate, uint32_t bytes);
+
+private:
+  /**
+   * Compute and keep the time of a size which is not in the cache.
+   * \param rate the data rate
+   * \param bytes the number of bytes
+   * \return rate.CalculateBytesTxTime (bytes)
+   */
+  Time DoGet (const DataRate &rate, uint32_t bytes);
+
+  static const uint32_t SIZE = 4; //!< number of sizes kept
+
+  uint64_t m_bps;           //!< rate the times were computed at
+  uint32_t m_next;          //!< entry to replace on the next miss
+  uint32_t m_bytes[SIZE];   //!< sizes kept, 0 in the unused entries
+  Time m_times[SIZE];       //!< times of the sizes kept
+};
+
+inline Time
+DataRateTxTimeCache::Get (const DataRate &rate, uint32_t bytes)
+{
+  // 0 bytes take no time at any rate, so empty entries need no flag
+  if (rate.GetBitRate () == m_bps)
+    {
+      for (uint32_t i = 0; i < SIZE; i++)
+        {
+          if (m_bytes[i] == bytes)
+            {
+              return m_times[i];
+            }
+        }
+    }
+  return DoGet (rate, bytes);
+}
+
 /**
  * \brief Stream insertion operator.
  *
@@ -22,6 +22,7 @@
 #define ETHERNET_HEADER_H
 
 #include "ns3/header.h"
+#include "ns3/header-view.h"
 #include <string>
 #include "ns3/mac48-address.h"
 
@@ -130,6 +131,67 @@ private:
   Mac48Address m_destination;   //!< Destination address
 };
 
+/**
+ * \ingroup network
+ *
+ * \brief Read-only view of an ethernet header without preamble stored in
+ * the buffer of a packet.
+ *
+ * \see HeaderView
+ */
+class EthernetHeaderView : public HeaderView
+{
+public:
+  /**
+   * \param packet the packet
+   * \param offset the offset of the header from the start of \p packet
+   * \returns true if an ethernet header is stored contiguously at \p offset
+   */
+  bool Peek (Ptr<const Packet> packet, uint32_t offset = 0);
+  /**
+   * \return The source address of this packet
+   */
+  Mac48Address GetSource (void) const;
+  /**
+   * \return The destination address of this packet
+   */
+  Mac48Address GetDestination (void) const;
+  /**
+   * \return The type/length field of this packet
+   */
+  uint16_t GetLengthType (void) const;
+
+  static const uint32_t SIZE = 14; //!< size of the header
+};
+
+inline bool
+EthernetHeaderView::Peek (Ptr<const Packet> packet, uint32_t offset)
+{
+  return DoPeek (packet, offset, SIZE);
+}
+
+inline Mac48Address
+EthernetHeaderView::GetSource (void) const
+{
+  Mac48Address address;
+  address.CopyFrom (m_data + 6);
+  return address;
+}
+
+inline Mac48Address
+EthernetHeaderView::GetDestination (void) const
+{
+  Mac48Address address;
+  address.CopyFrom (m_data);
+  return address;
+}
+
+inline uint16_t
+EthernetHeaderView::GetLengthType (void) const
+{
+  return ReadNtohU16 (12);
+}
+
 } // namespace ns3
 
 
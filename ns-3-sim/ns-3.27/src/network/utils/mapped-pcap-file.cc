@@ -0,0 +1,427 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ns3/log.h"
+#include "mapped-pcap-file.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MappedPcapFile");
+
+namespace {
+
+const uint32_t MAGIC = 0xa1b2c3d4;            //!< Magic number of microsecond timestamps
+const uint32_t SWAPPED_MAGIC = 0xd4c3b2a1;    //!< Magic number of microsecond timestamps, swapped
+const uint32_t NS_MAGIC = 0xa1b23c4d;         //!< Magic number of nanosecond timestamps
+const uint32_t NS_SWAPPED_MAGIC = 0x4d3cb2a1; //!< Magic number of nanosecond timestamps, swapped
+const uint32_t PCAP_HEADER_SIZE = 24;         //!< Size of the pcap file header
+const uint32_t PCAP_RECORD_SIZE = 16;         //!< Size of a pcap record header
+
+const uint32_t NG_SECTION_HEADER = 0x0a0d0d0a;  //!< Type of a pcapng section header block
+const uint32_t NG_INTERFACE = 1;                //!< Type of a pcapng interface description block
+const uint32_t NG_PACKET = 2;                   //!< Type of an obsolete pcapng packet block
+const uint32_t NG_ENHANCED_PACKET = 6;          //!< Type of a pcapng enhanced packet block
+const uint32_t NG_BYTE_ORDER_MAGIC = 0x1a2b3c4d; //!< Byte order magic of a pcapng section
+const uint32_t NG_SWAPPED_BYTE_ORDER_MAGIC = 0x4d3c2b1a; //!< Byte order magic, swapped
+const uint16_t NG_OPTION_END = 0;               //!< Last option of a block
+const uint16_t NG_OPTION_TSRESOL = 9;           //!< Timestamp resolution option of an interface
+
+/**
+ * \param exponent the exponent
+ * \returns 10 to the power exponent
+ */
+uint64_t
+PowerOfTen (uint8_t exponent)
+{
+  uint64_t value = 1;
+  for (uint8_t i = 0; i < exponent; i++)
+    {
+      value *= 10;
+    }
+  return value;
+}
+
+} // anonymous namespace
+
+MappedPcapFile::MappedPcapFile ()
+  : m_data (0),
+    m_size (0),
+    m_offset (0),
+    m_first (0),
+    m_fail (false),
+    m_eof (false),
+    m_swap (false),
+    m_pcapNg (false),
+    m_nanosecMode (false),
+    m_dataLinkType (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MappedPcapFile::~MappedPcapFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+MappedPcapFile::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+  m_fail = true;
+  m_eof = false;
+
+  int fd = open (filename.c_str (), O_RDONLY);
+  if (fd == -1)
+    {
+      NS_LOG_LOGIC ("Could not open " << filename);
+      return;
+    }
+  struct stat st;
+  if (fstat (fd, &st) == -1 || st.st_size < 4)
+    {
+      close (fd);
+      return;
+    }
+  void *data = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps a reference to the file
+  close (fd);
+  if (data == MAP_FAILED)
+    {
+      NS_LOG_LOGIC ("Could not map " << filename);
+      return;
+    }
+  // Records are read in order, so let the kernel read ahead and drop the
+  // pages behind
+  madvise (data, st.st_size, MADV_SEQUENTIAL);
+  m_data = static_cast<uint8_t const *> (data);
+  m_size = st.st_size;
+
+  uint32_t magic;
+  std::memcpy (&magic, m_data, 4);
+  if (magic == NG_SECTION_HEADER)
+    {
+      m_pcapNg = true;
+      m_first = 0;
+      m_offset = 0;
+      m_fail = !ReadSectionHeader ();
+      m_offset = m_first;
+    }
+  else
+    {
+      m_pcapNg = false;
+      m_fail = !ReadPcapHeader ();
+      m_offset = m_first;
+    }
+}
+
+void
+MappedPcapFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_data != 0)
+    {
+      munmap (const_cast<uint8_t *> (m_data), m_size);
+    }
+  m_data = 0;
+  m_size = 0;
+  m_offset = 0;
+  m_first = 0;
+  m_interfaces.clear ();
+}
+
+bool
+MappedPcapFile::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_fail;
+}
+
+bool
+MappedPcapFile::Eof (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_eof;
+}
+
+void
+MappedPcapFile::Rewind (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_offset = m_first;
+  m_eof = false;
+}
+
+bool
+MappedPcapFile::Read (Record &record)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_fail || m_eof)
+    {
+      return false;
+    }
+  bool found = m_pcapNg ? ReadPcapNgRecord (record) : ReadPcapRecord (record);
+  m_eof = !found;
+  return found;
+}
+
+bool
+MappedPcapFile::IsPcapNg (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_pcapNg;
+}
+
+uint64_t
+MappedPcapFile::GetSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_size;
+}
+
+uint16_t
+MappedPcapFile::ReadU16 (uint64_t offset) const
+{
+  uint16_t value;
+  std::memcpy (&value, m_data + offset, 2);
+  if (m_swap)
+    {
+      value = (value >> 8) | (value << 8);
+    }
+  return value;
+}
+
+uint32_t
+MappedPcapFile::ReadU32 (uint64_t offset) const
+{
+  uint32_t value;
+  std::memcpy (&value, m_data + offset, 4);
+  if (m_swap)
+    {
+      value = ((value >> 24) & 0xff) | ((value >> 8) & 0xff00)
+        | ((value << 8) & 0xff0000) | (value << 24);
+    }
+  return value;
+}
+
+bool
+MappedPcapFile::ReadPcapHeader (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_size < PCAP_HEADER_SIZE)
+    {
+      return false;
+    }
+  uint32_t magic;
+  std::memcpy (&magic, m_data, 4);
+  switch (magic)
+    {
+    case MAGIC:
+      m_swap = false;
+      m_nanosecMode = false;
+      break;
+    case SWAPPED_MAGIC:
+      m_swap = true;
+      m_nanosecMode = false;
+      break;
+    case NS_MAGIC:
+      m_swap = false;
+      m_nanosecMode = true;
+      break;
+    case NS_SWAPPED_MAGIC:
+      m_swap = true;
+      m_nanosecMode = true;
+      break;
+    default:
+      NS_LOG_LOGIC ("Not a pcap file, magic " << std::hex << magic);
+      return false;
+    }
+  m_dataLinkType = ReadU32 (20);
+  m_first = PCAP_HEADER_SIZE;
+  return true;
+}
+
+bool
+MappedPcapFile::ReadPcapRecord (Record &record)
+{
+  if (m_offset + PCAP_RECORD_SIZE > m_size)
+    {
+      return false;
+    }
+  uint32_t tsSec = ReadU32 (m_offset);
+  uint32_t tsFrac = ReadU32 (m_offset + 4);
+  record.inclLen = ReadU32 (m_offset + 8);
+  record.origLen = ReadU32 (m_offset + 12);
+  if (m_offset + PCAP_RECORD_SIZE + record.inclLen > m_size)
+    {
+      NS_LOG_LOGIC ("Truncated record at offset " << m_offset);
+      return false;
+    }
+  record.time = tsSec * UINT64_C (1000000000) + (m_nanosecMode ? tsFrac : tsFrac * UINT64_C (1000));
+  record.dataLinkType = m_dataLinkType;
+  record.data = m_data + m_offset + PCAP_RECORD_SIZE;
+  m_offset += PCAP_RECORD_SIZE + record.inclLen;
+  return true;
+}
+
+bool
+MappedPcapFile::ReadSectionHeader (void)
+{
+  NS_LOG_FUNCTION (this << m_offset);
+  if (m_offset + 28 > m_size)
+    {
+      return false;
+    }
+  uint32_t magic;
+  std::memcpy (&magic, m_data + m_offset + 8, 4);
+  if (magic == NG_BYTE_ORDER_MAGIC)
+    {
+      m_swap = false;
+    }
+  else if (magic == NG_SWAPPED_BYTE_ORDER_MAGIC)
+    {
+      m_swap = true;
+    }
+  else
+    {
+      return false;
+    }
+  uint32_t length = ReadU32 (m_offset + 4);
+  if (length < 28 || length % 4 != 0 || m_offset + length > m_size)
+    {
+      return false;
+    }
+  // Interface numbers are local to a section
+  m_interfaces.clear ();
+  m_offset += length;
+  return true;
+}
+
+void
+MappedPcapFile::ReadInterface (uint64_t offset, uint32_t length)
+{
+  NS_LOG_FUNCTION (this << offset << length);
+  Interface interface;
+  interface.dataLinkType = 0;
+  interface.decimal = true;
+  interface.resolution = 6;
+  if (length >= 20)
+    {
+      interface.dataLinkType = ReadU16 (offset + 8);
+      uint64_t option = offset + 16;
+      uint64_t end = offset + length - 4;
+      while (option + 4 <= end)
+        {
+          uint16_t code = ReadU16 (option);
+          uint16_t size = ReadU16 (option + 2);
+          if (code == NG_OPTION_END || option + 4 + size > end)
+            {
+              break;
+            }
+          if (code == NG_OPTION_TSRESOL && size >= 1)
+            {
+              uint8_t resolution = m_data[option + 4];
+              interface.decimal = (resolution & 0x80) == 0;
+              interface.resolution = resolution & 0x7f;
+            }
+          option += 4 + ((size + 3) & ~3);
+        }
+    }
+  m_interfaces.push_back (interface);
+}
+
+uint64_t
+MappedPcapFile::ConvertTime (Interface const &interface, uint32_t high, uint32_t low) const
+{
+  uint64_t ts = (static_cast<uint64_t> (high) << 32) | low;
+  if (interface.decimal)
+    {
+      if (interface.resolution <= 9)
+        {
+          return ts * PowerOfTen (9 - interface.resolution);
+        }
+      return ts / PowerOfTen (interface.resolution - 9);
+    }
+  uint8_t shift = std::min<uint8_t> (interface.resolution, 63);
+  uint64_t seconds = ts >> shift;
+  uint64_t fraction = ts & ((UINT64_C (1) << shift) - 1);
+  if (shift > 32)
+    {
+      // Keep 32 bits of the fraction so that it can be scaled to nanoseconds
+      fraction >>= shift - 32;
+      shift = 32;
+    }
+  return seconds * UINT64_C (1000000000) + ((fraction * UINT64_C (1000000000)) >> shift);
+}
+
+bool
+MappedPcapFile::ReadPcapNgRecord (Record &record)
+{
+  while (m_offset + 12 <= m_size)
+    {
+      uint32_t type = ReadU32 (m_offset);
+      if (type == NG_SECTION_HEADER)
+        {
+          if (!ReadSectionHeader ())
+            {
+              return false;
+            }
+          continue;
+        }
+      uint32_t length = ReadU32 (m_offset + 4);
+      if (length < 12 || length % 4 != 0 || m_offset + length > m_size)
+        {
+          NS_LOG_LOGIC ("Invalid block at offset " << m_offset);
+          return false;
+        }
+      uint64_t block = m_offset;
+      m_offset += length;
+      if (type == NG_INTERFACE)
+        {
+          ReadInterface (block, length);
+          continue;
+        }
+      if ((type != NG_ENHANCED_PACKET && type != NG_PACKET) || length < 32)
+        {
+          continue;
+        }
+      // Both packet blocks share their layout, but for the width of the
+      // interface number
+      uint32_t id = type == NG_ENHANCED_PACKET ? ReadU32 (block + 8) : ReadU16 (block + 8);
+      record.inclLen = ReadU32 (block + 20);
+      record.origLen = ReadU32 (block + 24);
+      if (id >= m_interfaces.size () || record.inclLen > length - 32)
+        {
+          NS_LOG_LOGIC ("Skipping invalid packet block at offset " << block);
+          continue;
+        }
+      Interface const &interface = m_interfaces[id];
+      record.time = ConvertTime (interface, ReadU32 (block + 12), ReadU32 (block + 16));
+      record.dataLinkType = interface.dataLinkType;
+      record.data = m_data + block + 28;
+      return true;
+    }
+  return false;
+}
+
+} // namespace ns3
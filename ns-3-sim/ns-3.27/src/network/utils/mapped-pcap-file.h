@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MAPPED_PCAP_FILE_H
+#define MAPPED_PCAP_FILE_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Read a pcap or pcapng file mapped in memory.
+ *
+ * Unlike PcapFile, which copies each record into a buffer of the caller,
+ * the records returned point into the mapping of the file: reading a
+ * record copies nothing, and only the pages actually touched are loaded,
+ * whatever the size of the file.  Both byte orders and both timestamp
+ * resolutions of the pcap format are supported.  In pcapng files, the
+ * enhanced packet blocks and the obsolete packet blocks are returned, with
+ * the data link type and the timestamp resolution of their interface;
+ * the other blocks are skipped.
+ */
+class MappedPcapFile
+{
+public:
+  /// A packet of the file
+  struct Record
+  {
+    uint64_t time;          //!< timestamp, in nanoseconds
+    uint32_t dataLinkType;  //!< data link type of the packet
+    uint32_t inclLen;       //!< number of bytes captured
+    uint32_t origLen;       //!< size of the packet
+    uint8_t const *data;    //!< captured bytes, valid until the file is closed
+  };
+
+  MappedPcapFile ();
+  ~MappedPcapFile ();
+
+  /**
+   * Map a file in memory and read its header.
+   *
+   * \param filename the name of the file
+   */
+  void Open (std::string const &filename);
+  /**
+   * Unmap the file.  The records returned become invalid.
+   */
+  void Close (void);
+  /**
+   * \returns true if the file could not be mapped, or is not a pcap or
+   *          pcapng file
+   */
+  bool Fail (void) const;
+  /**
+   * \returns true if the last call to Read found no more record
+   */
+  bool Eof (void) const;
+  /**
+   * Go back to the first record of the file.
+   */
+  void Rewind (void);
+  /**
+   * Read the next record of the file.
+   *
+   * \param record the record read
+   * \returns false at the end of the file, or if the file is truncated
+   *          or invalid
+   */
+  bool Read (Record &record);
+
+  /**
+   * \returns true if the file is a pcapng file
+   */
+  bool IsPcapNg (void) const;
+  /**
+   * \returns the size of the file
+   */
+  uint64_t GetSize (void) const;
+
+private:
+  /// An interface of a pcapng file
+  struct Interface
+  {
+    uint32_t dataLinkType;  //!< data link type of the interface
+    bool decimal;           //!< whether the timestamps are in 10^-resolution s, else 2^-resolution s
+    uint8_t resolution;     //!< exponent of the unit of the timestamps
+  };
+
+  /**
+   * \param offset an offset in the file
+   * \returns the 16 bit value at offset, in the byte order of the file
+   */
+  uint16_t ReadU16 (uint64_t offset) const;
+  /**
+   * \param offset an offset in the file
+   * \returns the 32 bit value at offset, in the byte order of the file
+   */
+  uint32_t ReadU32 (uint64_t offset) const;
+  /**
+   * Read the file header of a pcap file.
+   * \returns false if the file is not a pcap file
+   */
+  bool ReadPcapHeader (void);
+  /**
+   * Read the record at m_offset of a pcap file.
+   * \param record the record read
+   * \returns false at the end of the file
+   */
+  bool ReadPcapRecord (Record &record);
+  /**
+   * Read blocks from m_offset of a pcapng file up to the next packet.
+   * \param record the record read
+   * \returns false at the end of the file
+   */
+  bool ReadPcapNgRecord (Record &record);
+  /**
+   * Read the section header block at m_offset of a pcapng file.
+   * \returns false if the block is invalid
+   */
+  bool ReadSectionHeader (void);
+  /**
+   * Read an interface description block of a pcapng file.
+   * \param offset the offset of the block
+   * \param length the length of the block
+   */
+  void ReadInterface (uint64_t offset, uint32_t length);
+  /**
+   * \param interface the interface of the packet
+   * \param high the high 32 bits of the timestamp
+   * \param low the low 32 bits of the timestamp
+   * \returns the timestamp in nanoseconds
+   */
+  uint64_t ConvertTime (Interface const &interface, uint32_t high, uint32_t low) const;
+
+  uint8_t const *m_data;   //!< the mapping of the file
+  uint64_t m_size;         //!< the size of the file
+  uint64_t m_offset;       //!< the offset of the next record or block
+  uint64_t m_first;        //!< the offset of the first record or block
+  bool m_fail;             //!< whether the file is invalid
+  bool m_eof;              //!< whether the last read found no record
+  bool m_swap;             //!< whether the byte order of the file is not the one of the host
+  bool m_pcapNg;           //!< whether the file is a pcapng file
+  bool m_nanosecMode;      //!< whether the timestamps of a pcap file are in nanoseconds
+  uint32_t m_dataLinkType; //!< the data link type of a pcap file
+  std::vector<Interface> m_interfaces; //!< the interfaces of the current pcapng section
+};
+
+} // namespace ns3
+
+#endif /* MAPPED_PCAP_FILE_H */
@@ -21,7 +21,12 @@
 #include "ns3/uinteger.h"
 #include "ns3/buffer.h"
 #include "ns3/header.h"
+#include "ns3/enum.h"
+#include "ns3/core-config.h"
 #include "pcap-file-wrapper.h"
+#ifdef HAVE_PTHREAD_H
+#include "async-pcap-writer.h"
+#endif
 
 namespace ns3 {
 
@@ -46,12 +51,30 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("Asynchronous",
+                   "Whether files opened for writing only are written by a background thread. "
+                   "Ignored if threads are not supported.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_asynchronous),
+                   MakeBooleanChecker ())
+    .AddAttribute ("BufferSize",
+                   "Size in bytes of the buffer between the simulation and the background thread",
+                   UintegerValue (4 << 20),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Compression",
+                   "Compression of the files written by the background thread",
+                   EnumValue (PcapFileWrapper::NONE),
+                   MakeEnumAccessor (&PcapFileWrapper::m_compression),
+                   MakeEnumChecker (PcapFileWrapper::NONE, "None",
+                                    PcapFileWrapper::GZIP, "Gzip"))
   ;
   return tid;
 }
 
 
 PcapFileWrapper::PcapFileWrapper ()
+  : m_writer (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -66,6 +89,12 @@ bool
 PcapFileWrapper::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_writer != 0)
+    {
+      return m_writer->Fail ();
+    }
+#endif
   return m_file.Fail ();
 }
 
@@ -86,6 +115,15 @@ void
 PcapFileWrapper::Close (void)
 {
   NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_writer != 0)
+    {
+      m_writer->Close ();
+      delete m_writer;
+      m_writer = 0;
+      return;
+    }
+#endif
   m_file.Close ();
 }
 
@@ -93,6 +131,19 @@ void
 PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
   NS_LOG_FUNCTION (this << filename << mode);
+#ifdef HAVE_PTHREAD_H
+  if (m_writer != 0)
+    {
+      Close ();
+    }
+  if (m_asynchronous
+      && (mode & std::ios::out) && !(mode & (std::ios::in | std::ios::app)))
+    {
+      m_writer = new AsyncPcapWriter (m_bufferSize);
+      m_writer->Open (filename, m_compression == GZIP);
+      return;
+    }
+#endif
   m_file.Open (filename, mode);
 }
 
@@ -105,6 +156,17 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
   // a snaplen, we use the one provided.
   //
   NS_LOG_FUNCTION (this << dataLinkType << snapLen << tzCorrection);
+#ifdef HAVE_PTHREAD_H
+  if (m_writer != 0)
+    {
+      if (snapLen == std::numeric_limits<uint32_t>::max ())
+        {
+          snapLen = m_snapLen;
+        }
+      m_writer->Init (dataLinkType, snapLen, tzCorrection, m_nanosecMode);
+      return;
+    }
+#endif
   if (snapLen != std::numeric_limits<uint32_t>::max ())
     {
       m_file.Init (dataLinkType, snapLen, tzCorrection, false, m_nanosecMode);
@@ -116,63 +178,78 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
 }
 
 void
-PcapFileWrapper::Write (Time t, Ptr<const Packet> p)
+PcapFileWrapper::SplitTime (Time t, uint32_t &s, uint32_t &frac)
 {
-  NS_LOG_FUNCTION (this << t << p);
-  if (m_file.IsNanoSecMode())
+  bool nanosecMode = m_file.IsNanoSecMode ();
+#ifdef HAVE_PTHREAD_H
+  if (m_writer != 0)
+    {
+      nanosecMode = m_writer->IsNanoSecMode ();
+    }
+#endif
+  if (nanosecMode)
     {
       uint64_t current = t.GetNanoSeconds ();
-      uint64_t s       = current / 1000000000;
-      uint64_t ns      = current % 1000000000;
-      m_file.Write (s, ns, p);
+      s    = current / 1000000000;
+      frac = current % 1000000000;
     }
   else
     {
       uint64_t current = t.GetMicroSeconds ();
-      uint64_t s       = current / 1000000;
-      uint64_t us      = current % 1000000;
-      m_file.Write (s, us, p);
+      s    = current / 1000000;
+      frac = current % 1000000;
     }
 }
 
 void
-PcapFileWrapper::Write (Time t, const Header &header, Ptr<const Packet> p)
+PcapFileWrapper::Write (Time t, Ptr<const Packet> p)
 {
-  NS_LOG_FUNCTION (this << t << &header << p);
-  if (m_file.IsNanoSecMode())
+  NS_LOG_FUNCTION (this << t << p);
+  uint32_t s;
+  uint32_t frac;
+  SplitTime (t, s, frac);
+#ifdef HAVE_PTHREAD_H
+  if (m_writer != 0)
     {
-      uint64_t current = t.GetNanoSeconds ();
-      uint64_t s       = current / 1000000000;
-      uint64_t ns      = current % 1000000000;
-      m_file.Write (s, ns, header, p);
+      m_writer->Write (s, frac, p);
+      return;
     }
-  else
+#endif
+  m_file.Write (s, frac, p);
+}
+
+void
+PcapFileWrapper::Write (Time t, const Header &header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << t << &header << p);
+  uint32_t s;
+  uint32_t frac;
+  SplitTime (t, s, frac);
+#ifdef HAVE_PTHREAD_H
+  if (m_writer != 0)
     {
-      uint64_t current = t.GetMicroSeconds ();
-      uint64_t s       = current / 1000000;
-      uint64_t us      = current % 1000000;
-      m_file.Write (s, us, header, p);
+      m_writer->Write (s, frac, header, p);
+      return;
     }
+#endif
+  m_file.Write (s, frac, header, p);
 }
 
 void
 PcapFileWrapper::Write (Time t, uint8_t const *buffer, uint32_t length)
 {
   NS_LOG_FUNCTION (this << t << &buffer << length);
-  if (m_file.IsNanoSecMode())
+  uint32_t s;
+  uint32_t frac;
+  SplitTime (t, s, frac);
+#ifdef HAVE_PTHREAD_H
+  if (m_writer != 0)
     {
-      uint64_t current = t.GetNanoSeconds ();
-      uint64_t s       = current / 1000000000;
-      uint64_t ns      = current % 1000000000;
-      m_file.Write (s, ns, buffer, length);
-    }
-  else
-    {
-      uint64_t current = t.GetMicroSeconds ();
-      uint64_t s       = current / 1000000;
-      uint64_t us      = current % 1000000;
-      m_file.Write (s, us, buffer, length);
+      m_writer->Write (s, frac, buffer, length);
+      return;
     }
+#endif
+  m_file.Write (s, frac, buffer, length);
 }
 
 Ptr<Packet> 
@@ -211,6 +288,12 @@ uint32_t
 PcapFileWrapper::GetMagic (void)
 {
   NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_writer != 0)
+    {
+      return m_writer->GetMagic ();
+    }
+#endif
   return m_file.GetMagic ();
 }
 
@@ -218,6 +301,12 @@ uint16_t
 PcapFileWrapper::GetVersionMajor (void)
 {
   NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_writer != 0)
+    {
+      return m_writer->GetVersionMajor ();
+    }
+#endif
   return m_file.GetVersionMajor ();
 }
 
@@ -225,6 +314,12 @@ uint16_t
 PcapFileWrapper::GetVersionMinor (void)
 {
   NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_writer != 0)
+    {
+      return m_writer->GetVersionMinor ();
+    }
+#endif
   return m_file.GetVersionMinor ();
 }
 
@@ -232,6 +327,12 @@ int32_t
 PcapFileWrapper::GetTimeZoneOffset (void)
 {
   NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_writer != 0)
+    {
+      return m_writer->GetTimeZoneOffset ();
+    }
+#endif
   return m_file.GetTimeZoneOffset ();
 }
 
@@ -239,6 +340,12 @@ uint32_t
 PcapFileWrapper::GetSigFigs (void)
 {
   NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_writer != 0)
+    {
+      return m_writer->GetSigFigs ();
+    }
+#endif
   return m_file.GetSigFigs ();
 }
 
@@ -246,6 +353,12 @@ uint32_t
 PcapFileWrapper::GetSnapLen (void)
 {
   NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_writer != 0)
+    {
+      return m_writer->GetSnapLen ();
+    }
+#endif
   return m_file.GetSnapLen ();
 }
 
@@ -253,6 +366,12 @@ uint32_t
 PcapFileWrapper::GetDataLinkType (void)
 {
   NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_writer != 0)
+    {
+      return m_writer->GetDataLinkType ();
+    }
+#endif
   return m_file.GetDataLinkType ();
 }
 
@@ -30,11 +30,18 @@
 
 namespace ns3 {
 
+class AsyncPcapWriter;
+
 /**
  * A class that wraps a PcapFile as an ns3::Object and provides a higher-layer
  * ns-3 interface to the low-level public methods of PcapFile.  Users are
  * encouraged to use this object instead of class ns3::PcapFile in ns-3
  * public APIs.
+ *
+ * When the "Asynchronous" attribute is set, a file opened for writing only
+ * is written by an AsyncPcapWriter: the simulation thread copies each record
+ * into a ring buffer of "BufferSize" bytes, and a background thread writes
+ * the ring buffer to the file, compressed if "Compression" asks for it.
  */
 class PcapFileWrapper : public Object
 {
@@ -220,8 +227,28 @@ public:
    */ 
   uint32_t GetDataLinkType (void);
 
+  /// Compression of the files written asynchronously
+  enum Compression
+  {
+    NONE,  //!< plain pcap file
+    GZIP   //!< gzip stream, which requires zlib
+  };
+
 private:
+  /**
+   * Split a timestamp in the units of the file.
+   *
+   * \param t the timestamp
+   * \param s the seconds part of the timestamp
+   * \param frac the sub-second part of the timestamp
+   */
+  void SplitTime (Time t, uint32_t &s, uint32_t &frac);
+
   PcapFile m_file; //!< Pcap file
+  AsyncPcapWriter *m_writer; //!< Writer of the file, if asynchronous
+  bool     m_asynchronous; //!< Whether to write the files from a background thread
+  uint32_t m_bufferSize; //!< Size of the ring buffer of the background thread
+  enum Compression m_compression; //!< Compression of the files written asynchronously
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
 };
@@ -32,6 +32,9 @@
 #include <string>
 #include <sstream>
 #include <list>
+#include <vector>
+#include <iterator>
+#include <cstddef>
 
 namespace ns3 {
 
@@ -263,6 +266,13 @@ private:
  * GetSize () method (e.g., Packet, QueueDiscItem, etc.). Subclasses need to
  * implement the DoEnqueue, DoDequeue, DoRemove and DoPeek methods.
  *
+ * The items are stored in a ring buffer, whose size is a power of two and
+ * which grows as needed up to the maximum size of the queue, so that
+ * enqueuing and dequeuing an item at either end of the queue does not
+ * allocate memory.  An item removed from the middle of the queue leaves a
+ * hole in the ring, which iterators skip; holes are reclaimed when they
+ * reach the head of the queue, or compacted away when the ring is full.
+ *
  * Users of the Queue template class usually hold a queue through a smart pointer,
  * hence forward declaration is recommended to avoid pulling the implementation
  * of the templates included in this file. Thus, do not include queue.h but add
@@ -320,15 +330,75 @@ public:
    */
   void Flush (void);
 
-protected:
-
-  /// Const iterator.
-  typedef typename std::list<Ptr<Item> >::const_iterator ConstIterator;
+  /**
+   * \brief Const iterator over the items in the queue.
+   *
+   * An iterator refers to an item by its sequence number in the ring.
+   * Removing an item leaves valid the iterators which refer to the other
+   * items, as with a std::list.  Enqueuing an item invalidates all the
+   * iterators.
+   */
+  class ConstIterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category; //!< iterator category
+    typedef Ptr<Item> value_type;                        //!< type of the items
+    typedef std::ptrdiff_t difference_type;              //!< distance between iterators
+    typedef const Ptr<Item> *pointer;                    //!< pointer to an item
+    typedef const Ptr<Item> &reference;                  //!< reference to an item
+
+    ConstIterator ();
+    /**
+     * \returns the item
+     */
+    const Ptr<Item> & operator* (void) const;
+    /**
+     * \returns a pointer to the item
+     */
+    const Ptr<Item> * operator-> (void) const;
+    /**
+     * Move to the next item
+     * \returns this iterator
+     */
+    ConstIterator & operator++ (void);
+    /**
+     * Move to the next item
+     * \returns a copy of this iterator before the increment
+     */
+    ConstIterator operator++ (int);
+    /**
+     * \param o another iterator
+     * \returns true if both iterators refer to the same item
+     */
+    bool operator== (const ConstIterator &o) const;
+    /**
+     * \param o another iterator
+     * \returns true if the iterators refer to different items
+     */
+    bool operator!= (const ConstIterator &o) const;
+
+  private:
+    friend class Queue<Item>;
+    /**
+     * Move past the holes, if the iterator refers to one
+     */
+    void SkipHoles (void);
+    /**
+     * \param queue the queue
+     * \param seq the sequence number of the item
+     */
+    ConstIterator (const Queue<Item> *queue, uint64_t seq);
+
+    const Queue<Item> *m_queue;   //!< the queue
+    const Ptr<Item> *m_ring;      //!< the ring of the queue
+    uint64_t m_mask;              //!< the size of the ring minus one
+    uint64_t m_seq;               //!< the sequence number of the item
+  };
 
   /**
    * \brief Get a const iterator which refers to the first item in the queue.
    *
-   * Subclasses can browse the items in the queue by using an iterator
+   * The items in the queue can be browsed by using an iterator
    *
    * \code
    *   for (auto i = Head (); i != Tail (); ++i)
@@ -337,6 +407,9 @@ protected:
    *     }
    * \endcode
    *
+   * The first item is the next one dequeued by the FIFO queues, such as
+   * DropTailQueue.
+   *
    * \returns a const iterator which refers to the first item in the queue.
    */
   ConstIterator Head (void) const;
@@ -344,7 +417,7 @@ protected:
   /**
    * \brief Get a const iterator which indicates past-the-last item in the queue.
    *
-   * Subclasses can browse the items in the queue by using an iterator
+   * The items in the queue can be browsed by using an iterator
    *
    * \code
    *   for (auto i = Head (); i != Tail (); ++i)
@@ -357,6 +430,8 @@ protected:
    */
   ConstIterator Tail (void) const;
 
+protected:
+
   /**
    * Push an item in the queue
    * \param pos the position where the item is inserted
@@ -407,7 +482,34 @@ protected:
   void DropAfterDequeue (Ptr<Item> item);
 
 private:
-  std::list<Ptr<Item> > m_packets;          //!< the items in the queue
+  /**
+   * \param seq a sequence number between m_head and m_tail
+   * \returns the slot of the ring holding the item with sequence number \p seq
+   */
+  Ptr<Item> & Slot (uint64_t seq);
+  /**
+   * \param seq a sequence number between m_head and m_tail
+   * \returns the slot of the ring holding the item with sequence number \p seq
+   */
+  const Ptr<Item> & Slot (uint64_t seq) const;
+  /**
+   * Make room for one more item in the ring, by compacting the holes away
+   * or by doubling the size of the ring.
+   * \param pos the sequence number of an insertion point, updated to
+   *        refer to the same point in the new ring
+   */
+  void Reserve (uint64_t &pos);
+  /**
+   * Take an item out of the ring.
+   * \param pos the position of the item
+   * \returns the item
+   */
+  Ptr<Item> Extract (ConstIterator pos);
+
+  std::vector<Ptr<Item> > m_ring;           //!< the items in the queue, and the holes
+  uint64_t m_head;                          //!< sequence number of the first item
+  uint64_t m_tail;                          //!< sequence number past the last item
+  uint32_t m_holes;                         //!< number of holes between m_head and m_tail
   NS_LOG_TEMPLATE_DECLARE;                  //!< the log component
 
   /// Traced callback: fired when a packet is enqueued
@@ -456,7 +558,10 @@ Queue<Item>::GetTypeId (void)
 
 template <typename Item>
 Queue<Item>::Queue ()
-  : NS_LOG_TEMPLATE_DEFINE ("Queue")
+  : m_head (0),
+    m_tail (0),
+    m_holes (0),
+    NS_LOG_TEMPLATE_DEFINE ("Queue")
 {
 }
 
@@ -485,7 +590,37 @@ Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
       return false;
     }
 
-  m_packets.insert (pos, item);
+  uint64_t seq = pos.m_seq;
+  if (seq == m_tail)
+    {
+      // Holes at the tail are reclaimed before appending
+      while (m_holes > 0 && Slot (m_tail - 1) == 0)
+        {
+          m_tail--;
+          m_holes--;
+        }
+      seq = m_tail;
+    }
+  Reserve (seq);
+
+  if (seq == m_tail)
+    {
+      Slot (m_tail++) = item;
+    }
+  else if (seq == m_head)
+    {
+      Slot (--m_head) = item;
+    }
+  else
+    {
+      // Rare insertion in the middle: shift the end of the queue
+      for (uint64_t s = m_tail; s != seq; s--)
+        {
+          Slot (s) = Slot (s - 1);
+        }
+      m_tail++;
+      Slot (seq) = item;
+    }
 
   uint32_t size = item->GetSize ();
   m_nBytes += size;
@@ -512,8 +647,7 @@ Queue<Item>::DoDequeue (ConstIterator pos)
       return 0;
     }
 
-  Ptr<Item> item = *pos;
-  m_packets.erase (pos);
+  Ptr<Item> item = Extract (pos);
 
   if (item != 0)
     {
@@ -541,8 +675,7 @@ Queue<Item>::DoRemove (ConstIterator pos)
       return 0;
     }
 
-  Ptr<Item> item = *pos;
-  m_packets.erase (pos);
+  Ptr<Item> item = Extract (pos);
 
   if (item != 0)
     {
@@ -590,13 +723,167 @@ Queue<Item>::DoPeek (ConstIterator pos) const
 template <typename Item>
 typename Queue<Item>::ConstIterator Queue<Item>::Head (void) const
 {
-  return m_packets.cbegin ();
+  return ConstIterator (this, m_head);
 }
 
 template <typename Item>
 typename Queue<Item>::ConstIterator Queue<Item>::Tail (void) const
 {
-  return m_packets.cend ();
+  return ConstIterator (this, m_tail);
+}
+
+template <typename Item>
+Ptr<Item> &
+Queue<Item>::Slot (uint64_t seq)
+{
+  return m_ring[seq & (m_ring.size () - 1)];
+}
+
+template <typename Item>
+const Ptr<Item> &
+Queue<Item>::Slot (uint64_t seq) const
+{
+  return m_ring[seq & (m_ring.size () - 1)];
+}
+
+template <typename Item>
+void
+Queue<Item>::Reserve (uint64_t &pos)
+{
+  if (m_tail - m_head < m_ring.size ())
+    {
+      return;
+    }
+  std::size_t size = m_ring.size ();
+  if (m_holes == 0 || m_holes < size / 4)
+    {
+      size = std::max<std::size_t> (2 * size, 16);
+    }
+  NS_LOG_LOGIC ("Ring of " << m_ring.size () << " slots full, " << m_holes <<
+                " holes: moving to " << size << " slots");
+
+  std::vector<Ptr<Item> > ring (size);
+  uint64_t seq = m_head;
+  uint64_t newPos = m_head;
+  for (uint64_t s = m_head; s != m_tail; s++)
+    {
+      if (s == pos)
+        {
+          newPos = seq;
+        }
+      if (Slot (s) != 0)
+        {
+          ring[seq++ & (size - 1)] = Slot (s);
+        }
+    }
+  if (pos == m_tail)
+    {
+      newPos = seq;
+    }
+  m_ring.swap (ring);
+  m_tail = seq;
+  m_holes = 0;
+  pos = newPos;
+}
+
+template <typename Item>
+Ptr<Item>
+Queue<Item>::Extract (ConstIterator pos)
+{
+  NS_ASSERT (pos.m_seq != m_tail);
+  Ptr<Item> item = Slot (pos.m_seq);
+  Slot (pos.m_seq) = 0;
+  if (pos.m_seq == m_head)
+    {
+      m_head++;
+      while (m_holes > 0 && Slot (m_head) == 0)
+        {
+          m_head++;
+          m_holes--;
+        }
+    }
+  else
+    {
+      m_holes++;
+    }
+  return item;
+}
+
+template <typename Item>
+Queue<Item>::ConstIterator::ConstIterator ()
+  : m_queue (0),
+    m_ring (0),
+    m_mask (0),
+    m_seq (0)
+{
+}
+
+template <typename Item>
+Queue<Item>::ConstIterator::ConstIterator (const Queue<Item> *queue, uint64_t seq)
+  : m_queue (queue),
+    m_ring (queue->m_ring.data ()),
+    m_mask (queue->m_ring.size () - 1),
+    m_seq (seq)
+{
+}
+
+template <typename Item>
+const Ptr<Item> &
+Queue<Item>::ConstIterator::operator* (void) const
+{
+  return m_ring[m_seq & m_mask];
+}
+
+template <typename Item>
+const Ptr<Item> *
+Queue<Item>::ConstIterator::operator-> (void) const
+{
+  return &m_ring[m_seq & m_mask];
+}
+
+template <typename Item>
+inline typename Queue<Item>::ConstIterator &
+Queue<Item>::ConstIterator::operator++ (void)
+{
+  m_seq++;
+  if (m_queue->m_holes > 0)
+    {
+      SkipHoles ();
+    }
+  return *this;
+}
+
+template <typename Item>
+void
+Queue<Item>::ConstIterator::SkipHoles (void)
+{
+  while (m_seq != m_queue->m_tail && m_ring[m_seq & m_mask] == 0)
+    {
+      m_seq++;
+    }
+}
+
+template <typename Item>
+typename Queue<Item>::ConstIterator
+Queue<Item>::ConstIterator::operator++ (int)
+{
+  ConstIterator copy = *this;
+  ++(*this);
+  return copy;
+}
+
+template <typename Item>
+bool
+Queue<Item>::ConstIterator::operator== (const ConstIterator &o) const
+{
+  return m_seq == o.m_seq && m_queue == o.m_queue;
+}
+
+template <typename Item>
+bool
+Queue<Item>::ConstIterator::operator!= (const ConstIterator &o) const
+{
+  return !(*this == o);
 }
 
 template <typename Item>
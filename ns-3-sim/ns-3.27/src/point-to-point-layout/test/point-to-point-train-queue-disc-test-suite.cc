@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/point-to-point-dumbbell.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/queue-disc.h"
+#include "ns3/socket.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/udp-socket-factory.h"
+
+using namespace ns3;
+
+/**
+ * The packets sent and dropped by the bottleneck of a dumbbell, in the
+ * order they are sent
+ */
+struct TrainQueueDiscResult
+{
+  std::vector<Time> txTimes;    //!< Times the packets start transmitting
+  std::vector<Time> sniffTimes; //!< Times the packets are sniffed
+  std::vector<Time> rxTimes;    //!< Times the packets are received
+  std::vector<Time> dropTimes;  //!< Times the queue disc dropped packets
+};
+
+/**
+ * \ingroup point-to-point-layout
+ * \ingroup tests
+ *
+ * This class checks that the packet trains of the bottleneck of a
+ * dumbbell, behind a queue disc, leave the device queue, are sniffed,
+ * transmitted and received at the same times as packets sent one by one,
+ * and that the queue disc drops the same packets at the same times.
+ */
+class PointToPointTrainQueueDiscTestCase : public TestCase
+{
+public:
+  /**
+   * \param trainLength the TrainLength of the bottleneck
+   * \param interval the time between two packets sent
+   */
+  PointToPointTrainQueueDiscTestCase (uint32_t trainLength, Time interval);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Send 100 packets through the bottleneck of a dumbbell.
+   * \param trainLength the TrainLength of the bottleneck
+   * \return the times of the packets transmitted and received, and the drops
+   */
+  TrainQueueDiscResult Run (uint32_t trainLength);
+
+  /**
+   * Send a packet, and schedule the next one.
+   * \param socket the sending socket
+   * \param count the number of packets left to send
+   */
+  void Send (Ptr<Socket> socket, uint32_t count);
+
+  /**
+   * Record the start of the transmission of a packet.
+   * \param p the packet
+   */
+  void PhyTxBegin (Ptr<const Packet> p);
+
+  /**
+   * Record a packet sniffed.
+   * \param p the packet
+   */
+  void Sniffer (Ptr<const Packet> p);
+
+  /**
+   * Record a packet received.
+   * \param p the packet
+   */
+  void MacRx (Ptr<const Packet> p);
+
+  /**
+   * Record a packet dropped by the queue disc.
+   * \param item the packet
+   */
+  void Drop (Ptr<const QueueDiscItem> item);
+
+  uint32_t m_trainLength;          //!< TrainLength compared to 1
+  Time m_interval;                 //!< Time between two packets sent
+  TrainQueueDiscResult m_result;   //!< Result of the current run
+};
+
+PointToPointTrainQueueDiscTestCase::PointToPointTrainQueueDiscTestCase (uint32_t trainLength, Time interval)
+  : TestCase ("Compare the packet trains of a bottleneck behind a queue disc to single packets"),
+    m_trainLength (trainLength),
+    m_interval (interval)
+{
+}
+
+void
+PointToPointTrainQueueDiscTestCase::Send (Ptr<Socket> socket, uint32_t count)
+{
+  socket->Send (Create<Packet> (1000));
+  if (count > 1)
+    {
+      Simulator::Schedule (m_interval, &PointToPointTrainQueueDiscTestCase::Send, this, socket, count - 1);
+    }
+}
+
+void
+PointToPointTrainQueueDiscTestCase::PhyTxBegin (Ptr<const Packet> p)
+{
+  m_result.txTimes.push_back (Simulator::Now ());
+}
+
+void
+PointToPointTrainQueueDiscTestCase::Sniffer (Ptr<const Packet> p)
+{
+  m_result.sniffTimes.push_back (Simulator::Now ());
+}
+
+void
+PointToPointTrainQueueDiscTestCase::MacRx (Ptr<const Packet> p)
+{
+  m_result.rxTimes.push_back (Simulator::Now ());
+}
+
+void
+PointToPointTrainQueueDiscTestCase::Drop (Ptr<const QueueDiscItem> item)
+{
+  m_result.dropTimes.push_back (Simulator::Now ());
+}
+
+TrainQueueDiscResult
+PointToPointTrainQueueDiscTestCase::Run (uint32_t trainLength)
+{
+  m_result = TrainQueueDiscResult ();
+
+  PointToPointHelper leaf;
+  leaf.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  leaf.SetChannelAttribute ("Delay", StringValue ("1us"));
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue ("8Mbps"));
+  bottleneck.SetDeviceAttribute ("TrainLength", UintegerValue (trainLength));
+  bottleneck.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  bottleneck.SetQueue ("ns3::DropTailQueue<Packet>", "MaxPackets", UintegerValue (5));
+  PointToPointDumbbellHelper dumbbell (1, leaf, 1, leaf, bottleneck);
+
+  InternetStackHelper internet;
+  dumbbell.InstallStack (internet);
+  // The bottleneck is the first device of the routers
+  Ptr<NetDevice> tx = dumbbell.GetLeft ()->GetDevice (0);
+  Ptr<NetDevice> rx = dumbbell.GetRight ()->GetDevice (0);
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::PfifoFastQueueDisc", "Limit", UintegerValue (10));
+  QueueDiscContainer queueDiscs = tch.Install (tx);
+  dumbbell.AssignIpv4Addresses (Ipv4AddressHelper ("10.1.1.0", "255.255.255.0"),
+                                Ipv4AddressHelper ("10.2.1.0", "255.255.255.0"),
+                                Ipv4AddressHelper ("10.3.1.0", "255.255.255.0"));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  tx->TraceConnectWithoutContext ("PhyTxBegin",
+                                  MakeCallback (&PointToPointTrainQueueDiscTestCase::PhyTxBegin, this));
+  tx->TraceConnectWithoutContext ("Sniffer",
+                                  MakeCallback (&PointToPointTrainQueueDiscTestCase::Sniffer, this));
+  rx->TraceConnectWithoutContext ("MacRx",
+                                  MakeCallback (&PointToPointTrainQueueDiscTestCase::MacRx, this));
+  queueDiscs.Get (0)->TraceConnectWithoutContext ("Drop",
+                                                  MakeCallback (&PointToPointTrainQueueDiscTestCase::Drop, this));
+
+  // A receiver, so that no ICMP error comes back through the bottleneck
+  Ptr<Socket> sink = Socket::CreateSocket (dumbbell.GetRight (0), UdpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  Ptr<Socket> socket = Socket::CreateSocket (dumbbell.GetLeft (0), UdpSocketFactory::GetTypeId ());
+  socket->Connect (InetSocketAddress (dumbbell.GetRightIpv4Address (0), 9));
+  Simulator::Schedule (Seconds (1), &PointToPointTrainQueueDiscTestCase::Send, this, socket, 100);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return m_result;
+}
+
+void
+PointToPointTrainQueueDiscTestCase::DoRun (void)
+{
+  TrainQueueDiscResult single = Run (1);
+  TrainQueueDiscResult train = Run (m_trainLength);
+
+  NS_TEST_ASSERT_MSG_EQ (single.txTimes.size () + single.dropTimes.size (), 100,
+                         "every packet should be sent or dropped");
+  NS_TEST_ASSERT_MSG_EQ (single.rxTimes.size (), single.txTimes.size (), "every packet sent should be received");
+  NS_TEST_ASSERT_MSG_EQ (single.sniffTimes.size (), single.txTimes.size (), "every packet sent should be sniffed");
+  if (m_interval >= MicroSeconds (1030))
+    {
+      NS_TEST_ASSERT_MSG_EQ (single.dropTimes.size (), 0, "the queue disc should not overflow");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_NE (single.dropTimes.size (), 0, "the queue disc should overflow");
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (train.txTimes.size (), single.txTimes.size (), "trains should send the same packets");
+  NS_TEST_ASSERT_MSG_EQ (train.sniffTimes.size (), single.sniffTimes.size (), "trains should sniff the same packets");
+  NS_TEST_ASSERT_MSG_EQ (train.rxTimes.size (), single.rxTimes.size (), "trains should deliver the same packets");
+  NS_TEST_ASSERT_MSG_EQ (train.dropTimes.size (), single.dropTimes.size (), "trains should drop the same packets");
+  for (uint32_t i = 0; i < single.txTimes.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (train.txTimes[i], single.txTimes[i], "packet " << i << " started transmitting at the wrong time");
+      NS_TEST_EXPECT_MSG_EQ (train.sniffTimes[i], single.sniffTimes[i], "packet " << i << " sniffed at the wrong time");
+      NS_TEST_EXPECT_MSG_EQ (train.sniffTimes[i], train.txTimes[i], "packet " << i << " should be sniffed when it starts");
+      NS_TEST_EXPECT_MSG_EQ (train.rxTimes[i], single.rxTimes[i], "packet " << i << " received at the wrong time");
+    }
+  for (uint32_t i = 0; i < single.dropTimes.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (train.dropTimes[i], single.dropTimes[i], "drop " << i << " at the wrong time");
+    }
+}
+
+/**
+ * \ingroup point-to-point-layout
+ * \ingroup tests
+ *
+ * Point-to-point packet trains behind a queue disc TestSuite
+ */
+class PointToPointTrainQueueDiscTestSuite : public TestSuite
+{
+public:
+  PointToPointTrainQueueDiscTestSuite ();
+};
+
+PointToPointTrainQueueDiscTestSuite::PointToPointTrainQueueDiscTestSuite ()
+  : TestSuite ("point-to-point-train-queue-disc", SYSTEM)
+{
+  // 1000 bytes of payload take 1030us at 8Mbps with the headers
+  AddTestCase (new PointToPointTrainQueueDiscTestCase (4, MicroSeconds (1200)), TestCase::QUICK);
+  AddTestCase (new PointToPointTrainQueueDiscTestCase (4, MicroSeconds (700)), TestCase::QUICK);
+}
+
+static PointToPointTrainQueueDiscTestSuite pointToPointTrainQueueDiscTestSuite; //!< Static variable for test initialization
@@ -97,9 +97,24 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
+  //
+  // The receiver strips the header of the packet in place, so the packet
+  // itself can only be handed over if the transmitter is done with it
+  // when it arrives.  Its TransmitComplete event is scheduled first, so
+  // it runs first at equal times.
+  //
+  Ptr<Packet> rx;
+  if (src->IsZeroCopy () && src->GetInterframeGap () <= m_delay)
+    {
+      rx = ConstCast<Packet> (p);
+    }
+  else
+    {
+      rx = p->Copy ();
+    }
   Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
                                   txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p->Copy ());
+                                  m_link[wire].m_dst, rx);
 
   // Call the tx anim callback on the net device
   m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
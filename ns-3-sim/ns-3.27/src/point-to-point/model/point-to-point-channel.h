@@ -75,7 +75,9 @@ public:
    * \brief Transmit a packet over this channel
    * \param p Packet to transmit
    * \param src Source PointToPointNetDevice
-   * \param txTime Transmit time to apply
+   * \param txTime Time from now until the last bit of the packet leaves
+   * the source, i.e. its transmit time, plus the time it waits behind the
+   * packets before it in a train
    * \returns true if successful (currently always true)
    */
   virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src, Time txTime);
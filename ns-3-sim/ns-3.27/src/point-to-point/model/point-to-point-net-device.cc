@@ -25,6 +25,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
 #include "ns3/net-device-queue-interface.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
@@ -68,6 +69,23 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("ZeroCopy",
+                   "Hand the packets transmitted to the peer device without "
+                   "copying them.  The upper layers must not modify a packet "
+                   "once sent.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointNetDevice::m_zeroCopy),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TrainLength",
+                   "The largest number of back-to-back packets of the queue "
+                   "handed to the channel at once.  The packets of a train "
+                   "are transmitted and received at their exact times, and "
+                   "leave the device queue and fire their hooks when they "
+                   "start transmitting, as with 1, which hands every packet "
+                   "over when it starts.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_trainLength),
+                   MakeUintegerChecker<uint32_t> (1))
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -176,6 +194,8 @@ PointToPointNetDevice::GetTypeId (void)
 PointToPointNetDevice::PointToPointNetDevice () 
   :
     m_txMachineState (READY),
+    m_zeroCopy (false),
+    m_trainLength (1),
     m_channel (0),
     m_linkUp (false),
     m_currentPkt (0)
@@ -268,6 +288,18 @@ PointToPointNetDevice::SetInterframeGap (Time t)
   m_tInterframeGap = t;
 }
 
+Time
+PointToPointNetDevice::GetInterframeGap (void) const
+{
+  return m_tInterframeGap;
+}
+
+bool
+PointToPointNetDevice::IsZeroCopy (void) const
+{
+  return m_zeroCopy;
+}
+
 bool
 PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
 {
@@ -281,10 +313,14 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   //
   NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
   m_txMachineState = BUSY;
+  if (m_trainLength > 1 && !m_queue->IsEmpty ())
+    {
+      return TransmitTrain (p);
+    }
   m_currentPkt = p;
   m_phyTxBeginTrace (m_currentPkt);
 
-  Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+  Time txTime = m_txTimeCache.Get (m_bps, p->GetSize ());
   Time txCompleteTime = txTime + m_tInterframeGap;
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
@@ -298,6 +334,65 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   return result;
 }
 
+bool
+PointToPointNetDevice::TransmitTrain (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  //
+  // Each packet starts when the previous one and its interframe gap are
+  // done.  The channel schedules the reception of a packet the time it is
+  // given after now, plus its delay, so the packets of the train are given
+  // the time their last bit leaves the device.  The next packets stay in
+  // the queue until they start, as if they were sent one by one: the
+  // event of their slot dequeues them and fires their hooks.
+  //
+  m_phyTxBeginTrace (p);
+  Time end = m_txTimeCache.Get (m_bps, p->GetSize ());
+  bool result = m_channel->TransmitStart (p, this, end);
+  if (result == false)
+    {
+      m_phyTxDropTrace (p);
+    }
+  Ptr<Packet> previous = p;
+  Time start = end + m_tInterframeGap;
+  uint32_t n = 1;
+  for (Queue<Packet>::ConstIterator i = m_queue->Head ();
+       i != m_queue->Tail () && n < m_trainLength; ++i, ++n)
+    {
+      p = *i;
+      NS_LOG_LOGIC ("UID is " << p->GetUid () << ", " << n << " in train");
+      end = start + m_txTimeCache.Get (m_bps, p->GetSize ());
+      bool sent = m_channel->TransmitStart (p, this, end);
+      Simulator::Schedule (start, &PointToPointNetDevice::TransmitTrainSlot,
+                           this, previous, p, !sent);
+      previous = p;
+      start = end + m_tInterframeGap;
+    }
+
+  // TransmitComplete fires the PhyTxEnd hook of the last packet
+  m_currentPkt = previous;
+  NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << start.GetSeconds () << "sec");
+  Simulator::Schedule (start, &PointToPointNetDevice::TransmitComplete, this);
+  return result;
+}
+
+void
+PointToPointNetDevice::TransmitTrainSlot (Ptr<Packet> previous, Ptr<Packet> p, bool dropped)
+{
+  NS_LOG_FUNCTION (this << previous << p << dropped);
+  m_phyTxEndTrace (previous);
+  Ptr<Packet> item = m_queue->Dequeue ();
+  NS_ASSERT_MSG (item == p, "The packets of a train must leave the device queue in order");
+  m_snifferTrace (p);
+  m_promiscSnifferTrace (p);
+  m_phyTxBeginTrace (p);
+  if (dropped)
+    {
+      m_phyTxDropTrace (p);
+    }
+}
+
 void
 PointToPointNetDevice::TransmitComplete (void)
 {
@@ -391,9 +486,13 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
 
       //
       // Trace sinks will expect complete packets, not packets without some of the
-      // headers.
+      // headers.  Only copy the packet if someone is listening.
       //
-      Ptr<Packet> originalPacket = packet->Copy ();
+      Ptr<Packet> originalPacket;
+      if (!m_macPromiscRxTrace.IsEmpty () || !m_macRxTrace.IsEmpty ())
+        {
+          originalPacket = packet->Copy ();
+        }
 
       //
       // Strip off the point-to-point protocol header and forward this packet
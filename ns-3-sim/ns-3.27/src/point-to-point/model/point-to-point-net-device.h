@@ -103,6 +103,24 @@ public:
    */
   void SetInterframeGap (Time t);
 
+  /**
+   * \returns the interframe gap used to separate packets
+   */
+  Time GetInterframeGap (void) const;
+
+  /**
+   * Whether the channel may hand the packets this device transmits to the
+   * peer device itself rather than a copy.
+   *
+   * The peer strips the PPP header of the packet it receives, so the
+   * packet is handed over only if the device is done with it by then, i.e.
+   * if the interframe gap is not longer than the delay of the channel.
+   * The upper layers must not modify a packet once they have sent it.
+   *
+   * \returns true if the ZeroCopy attribute is set
+   */
+  bool IsZeroCopy (void) const;
+
   /**
    * Attach the device to a channel.
    *
@@ -277,6 +295,36 @@ private:
    */
   bool TransmitStart (Ptr<Packet> p);
 
+  /**
+   * Start sending a train of back-to-back packets down the wire.
+   *
+   * The packet given and up to TrainLength - 1 packets of the queue are
+   * handed to the channel at once, each with the time its last bit leaves
+   * the device, so that they are received at the same times as if they
+   * were sent one by one.  A single event completes the whole train.
+   *
+   * The next packets of the train stay in the device queue until they
+   * start transmitting, when an event per packet dequeues them and fires
+   * their sniffer and PhyTx hooks, so that the queueing delays and drops
+   * of the device queue and of a queue disc are those of TrainLength 1.
+   * The device queue must be FIFO.
+   *
+   * \param p the first packet of the train
+   * \returns true if the first packet was sent, false on failure
+   */
+  bool TransmitTrain (Ptr<Packet> p);
+
+  /**
+   * Dequeue a packet of a train when its transmission starts, and fire
+   * its hooks and the PhyTxEnd hook of the previous packet, which is then
+   * done.
+   *
+   * \param previous the previous packet of the train
+   * \param p the packet starting
+   * \param dropped whether the channel refused p
+   */
+  void TransmitTrainSlot (Ptr<Packet> previous, Ptr<Packet> p, bool dropped);
+
   /**
    * Stop Sending a Packet Down the Wire and Begin the Interframe Gap.
    *
@@ -317,6 +365,21 @@ private:
    */
   Time           m_tInterframeGap;
 
+  /**
+   * Whether the packets transmitted are handed to the peer without a copy
+   */
+  bool           m_zeroCopy;
+
+  /**
+   * The largest number of queued packets transmitted from one event
+   */
+  uint32_t       m_trainLength;
+
+  /**
+   * The transmission times of the last packet sizes sent
+   */
+  DataRateTxTimeCache m_txTimeCache;
+
   /**
    * The PointToPointChannel to which this PointToPointNetDevice has been
    * attached.
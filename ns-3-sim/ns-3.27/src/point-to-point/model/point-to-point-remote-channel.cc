@@ -67,13 +67,14 @@ PointToPointRemoteChannel::TransmitStart (
   uint32_t wire = src == GetSource (0) ? 0 : 1;
   Ptr<PointToPointNetDevice> dst = GetDestination (wire);
 
-#ifdef NS3_MPI
+  if (!MpiInterface::IsEnabled ())
+    {
+      NS_FATAL_ERROR ("Can't use a remote channel without MPI or shared memory ranks enabled");
+    }
+
   // Calculate the rxTime (absolute)
   Time rxTime = Simulator::Now () + txTime + GetDelay ();
   MpiInterface::SendPacket (p->Copy (), rxTime, dst->GetNode ()->GetId (), dst->GetIfIndex ());
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
   return true;
 }
 
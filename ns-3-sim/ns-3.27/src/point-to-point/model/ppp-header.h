@@ -20,6 +20,7 @@
 #define PPP_HEADER_H
 
 #include "ns3/header.h"
+#include "ns3/header-view.h"
 
 namespace ns3 {
 
@@ -105,6 +106,42 @@ private:
   uint16_t m_protocol;
 };
 
+/**
+ * \ingroup point-to-point
+ *
+ * \brief Read-only view of a PPP header stored in the buffer of a packet.
+ *
+ * \see HeaderView
+ */
+class PppHeaderView : public HeaderView
+{
+public:
+  /**
+   * \param packet the packet
+   * \param offset the offset of the header from the start of \p packet
+   * \returns true if a PPP header is stored contiguously at \p offset
+   */
+  bool Peek (Ptr<const Packet> packet, uint32_t offset = 0);
+  /**
+   * \return the protocol type being carried
+   */
+  uint16_t GetProtocol (void) const;
+
+  static const uint32_t SIZE = 2; //!< size of the header
+};
+
+inline bool
+PppHeaderView::Peek (Ptr<const Packet> packet, uint32_t offset)
+{
+  return DoPeek (packet, offset, SIZE);
+}
+
+inline uint16_t
+PppHeaderView::GetProtocol (void) const
+{
+  return ReadNtohU16 (0);
+}
+
 } // namespace ns3
 
 
@@ -24,6 +24,14 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/node-container.h"
+#include <unistd.h>
 
 using namespace ns3;
 
@@ -101,6 +109,467 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test of a PointToPointRemoteChannel between shared memory ranks
+ *
+ * Rank 0 sends packets over a remote channel to a node of rank 1, which
+ * sends each of them back, and checks the time of every round trip.
+ */
+class PointToPointRemoteTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointRemoteTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send one packet to the device specified
+   *
+   * \param device NetDevice to send to
+   */
+  void SendOnePacket (Ptr<NetDevice> device);
+
+  /**
+   * \brief Receive callback: rank 1 sends the packet back, rank 0 records
+   * the time
+   *
+   * \param device receiving device
+   * \param p received packet
+   * \param protocol protocol number
+   * \param from sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  uint32_t m_rank;              //!< Rank of this process
+  std::vector<Time> m_rxTimes;  //!< Times of the returned packets
+};
+
+PointToPointRemoteTest::PointToPointRemoteTest ()
+  : TestCase ("PointToPoint remote channel between shared memory ranks")
+{
+}
+
+void
+PointToPointRemoteTest::SendOnePacket (Ptr<NetDevice> device)
+{
+  Ptr<Packet> p = Create<Packet> (1000);
+  device->Send (p, device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointRemoteTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
+                                 uint16_t protocol, const Address &from)
+{
+  if (m_rank == 1)
+    {
+      device->Send (p->Copy (), device->GetBroadcast (), protocol);
+    }
+  else
+    {
+      m_rxTimes.push_back (Simulator::Now ());
+    }
+  return true;
+}
+
+void
+PointToPointRemoteTest::DoRun (void)
+{
+  MpiInterface::EnableSharedMemory (2);
+  m_rank = MpiInterface::GetSystemId ();
+
+  Ptr<Node> a = CreateObject<Node> (0);
+  Ptr<Node> b = CreateObject<Node> (1);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("8Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer devices = p2p.Install (a, b);
+  devices.Get (m_rank)->SetReceiveCallback (MakeCallback (&PointToPointRemoteTest::Receive, this));
+
+  if (m_rank == 0)
+    {
+      for (uint32_t i = 0; i < 5; i++)
+        {
+          Simulator::Schedule (MilliSeconds (10 * i), &PointToPointRemoteTest::SendOnePacket,
+                               this, devices.Get (0));
+        }
+    }
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  MpiInterface::Disable ();
+  if (m_rank != 0)
+    {
+      _exit (0);
+    }
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+
+  // 1002 bytes with the PPP header take 1002us at 8Mbps, each way
+  NS_TEST_ASSERT_MSG_EQ (m_rxTimes.size (), 5, "every packet should come back");
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_rxTimes[i], MilliSeconds (10 * i) + MicroSeconds (4004),
+                             "round trip " << i);
+    }
+}
+
+/**
+ * \brief Test that runs between shared memory ranks are repeatable
+ *
+ * Both ranks send packets of various sizes to each other at the same
+ * times, and rank 1 also sends back those of rank 0, so packets queue
+ * behind each other on both sides.  The run is done twice, and rank 0
+ * checks that it receives the same packets at the same times.
+ */
+class PointToPointRemoteRepeatTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointRemoteRepeatTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /// Arrival time and size of the packets received by rank 0
+  typedef std::vector<std::pair<Time, uint32_t> > Arrivals;
+
+  /**
+   * \brief Run the simulation once over two shared memory ranks
+   *
+   * \returns the packets received by rank 0; rank 1 exits instead
+   */
+  Arrivals RunOnce (void);
+
+  /**
+   * \brief Send one packet to the device specified
+   *
+   * \param device NetDevice to send to
+   * \param size size of the packet
+   */
+  void SendOnePacket (Ptr<NetDevice> device, uint32_t size);
+
+  /**
+   * \brief Receive callback: rank 1 sends the packets of rank 0 back,
+   * rank 0 records them
+   *
+   * \param device receiving device
+   * \param p received packet
+   * \param protocol protocol number
+   * \param from sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  uint32_t m_rank;       //!< Rank of this process
+  Arrivals m_arrivals;   //!< Packets received by rank 0
+};
+
+PointToPointRemoteRepeatTest::PointToPointRemoteRepeatTest ()
+  : TestCase ("PointToPoint remote channel runs are repeatable")
+{
+}
+
+void
+PointToPointRemoteRepeatTest::SendOnePacket (Ptr<NetDevice> device, uint32_t size)
+{
+  device->Send (Create<Packet> (size), device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointRemoteRepeatTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
+                                       uint16_t protocol, const Address &from)
+{
+  if (m_rank == 1)
+    {
+      // The packets of rank 0 are odd-sized
+      if (p->GetSize () % 2)
+        {
+          device->Send (p->Copy (), device->GetBroadcast (), protocol);
+        }
+    }
+  else
+    {
+      m_arrivals.push_back (std::make_pair (Simulator::Now (), p->GetSize ()));
+    }
+  return true;
+}
+
+PointToPointRemoteRepeatTest::Arrivals
+PointToPointRemoteRepeatTest::RunOnce (void)
+{
+  m_arrivals.clear ();
+  MpiInterface::EnableSharedMemory (2);
+  m_rank = MpiInterface::GetSystemId ();
+
+  Ptr<Node> a = CreateObject<Node> (0);
+  Ptr<Node> b = CreateObject<Node> (1);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("8Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer devices = p2p.Install (a, b);
+  Ptr<NetDevice> device = devices.Get (m_rank);
+  device->SetReceiveCallback (MakeCallback (&PointToPointRemoteRepeatTest::Receive, this));
+
+  // Sent faster than the link rate, so that packets wait in the queues
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      uint32_t size = 100 + 37 * (i % 11);
+      size += (size % 2) == (m_rank == 0 ? 0 : 1);
+      Simulator::Schedule (MicroSeconds (250 * i), &PointToPointRemoteRepeatTest::SendOnePacket,
+                           this, device, size);
+    }
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  MpiInterface::Disable ();
+  if (m_rank != 0)
+    {
+      _exit (0);
+    }
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  return m_arrivals;
+}
+
+void
+PointToPointRemoteRepeatTest::DoRun (void)
+{
+  Arrivals first = RunOnce ();
+  Arrivals second = RunOnce ();
+
+  // 40 packets from rank 1 and 40 sent back
+  NS_TEST_ASSERT_MSG_EQ (first.size (), 80, "every packet should arrive");
+  NS_TEST_ASSERT_MSG_EQ (second.size (), first.size (), "both runs should receive as many packets");
+  for (uint32_t i = 0; i < first.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (second[i].first, first[i].first, "arrival time of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (second[i].second, first[i].second, "size of packet " << i);
+    }
+}
+
+/**
+ * \brief Test of the ZeroCopy mode of PointToPointNetDevice
+ *
+ * It sends packets back to back over a PointToPointChannel, and checks
+ * that they arrive on time, with the header stripped, and that the
+ * packet transmitted is handed over only if the interframe gap is not
+ * longer than the delay of the channel.
+ */
+class PointToPointZeroCopyTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   *
+   * \param interframeGap interframe gap of the transmitting device
+   * \param handedOver whether the packets should be handed over
+   */
+  PointToPointZeroCopyTest (Time interframeGap, bool handedOver);
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Record a packet at the end of its transmission
+   *
+   * \param p transmitted packet
+   */
+  void PhyTxEnd (Ptr<const Packet> p);
+
+  /**
+   * \brief Receive callback: record the packet received
+   *
+   * \param device receiving device
+   * \param p received packet
+   * \param protocol protocol number
+   * \param from sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  Time m_interframeGap;                      //!< Interframe gap of the transmitter
+  bool m_handedOver;                         //!< Whether packets should be handed over
+  std::vector<const Packet *> m_txPackets;   //!< Packets transmitted
+  std::vector<uint32_t> m_txSizes;           //!< Sizes of the packets transmitted
+  std::vector<const Packet *> m_rxPackets;   //!< Packets received
+  std::vector<uint32_t> m_rxSizes;           //!< Sizes of the packets received
+  std::vector<Time> m_rxTimes;               //!< Times of the packets received
+};
+
+PointToPointZeroCopyTest::PointToPointZeroCopyTest (Time interframeGap, bool handedOver)
+  : TestCase ("PointToPoint zero copy transmission"),
+    m_interframeGap (interframeGap),
+    m_handedOver (handedOver)
+{
+}
+
+void
+PointToPointZeroCopyTest::PhyTxEnd (Ptr<const Packet> p)
+{
+  m_txPackets.push_back (PeekPointer (p));
+  m_txSizes.push_back (p->GetSize ());
+}
+
+bool
+PointToPointZeroCopyTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
+                                   uint16_t protocol, const Address &from)
+{
+  m_rxPackets.push_back (PeekPointer (p));
+  m_rxSizes.push_back (p->GetSize ());
+  m_rxTimes.push_back (Simulator::Now ());
+  return true;
+}
+
+void
+PointToPointZeroCopyTest::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("8Mbps"));
+  p2p.SetDeviceAttribute ("ZeroCopy", BooleanValue (true));
+  p2p.SetDeviceAttribute ("InterframeGap", TimeValue (m_interframeGap));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer devices = p2p.Install (nodes);
+  devices.Get (0)->TraceConnectWithoutContext ("PhyTxEnd",
+                                               MakeCallback (&PointToPointZeroCopyTest::PhyTxEnd, this));
+  devices.Get (1)->SetReceiveCallback (MakeCallback (&PointToPointZeroCopyTest::Receive, this));
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      devices.Get (0)->Send (Create<Packet> (1000), devices.Get (0)->GetBroadcast (), 0x800);
+    }
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_rxTimes.size (), 3, "every packet should be received");
+  NS_TEST_ASSERT_MSG_EQ (m_txPackets.size (), 3, "every packet should be transmitted");
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      // 1002 bytes with the PPP header take 1002us at 8Mbps
+      Time rx = MicroSeconds (1002 * (i + 1)) + m_interframeGap * i + MilliSeconds (1);
+      NS_TEST_EXPECT_MSG_EQ (m_rxTimes[i], rx, "packet " << i << " received at the wrong time");
+      NS_TEST_EXPECT_MSG_EQ (m_txSizes[i], 1002, "the transmitter should see the PPP header");
+      NS_TEST_EXPECT_MSG_EQ (m_rxSizes[i], 1000, "the receiver should strip the PPP header");
+      NS_TEST_EXPECT_MSG_EQ ((m_txPackets[i] == m_rxPackets[i]), m_handedOver,
+                             "packet " << i << " handed over or copied wrongly");
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Test of the packet trains of PointToPointNetDevice
+ *
+ * It queues packets back to back on a device, and checks that they
+ * start transmitting and are received at the same times whatever the
+ * length of the trains.
+ */
+class PointToPointTrainTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   *
+   * \param trainLength the TrainLength of the transmitting device
+   */
+  PointToPointTrainTest (uint32_t trainLength);
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Record the start of the transmission of a packet
+   *
+   * \param p transmitted packet
+   */
+  void PhyTxBegin (Ptr<const Packet> p);
+
+  /**
+   * \brief Receive callback: record the time of the packet received
+   *
+   * \param device receiving device
+   * \param p received packet
+   * \param protocol protocol number
+   * \param from sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  uint32_t m_trainLength;          //!< TrainLength of the transmitter
+  std::vector<Time> m_txTimes;     //!< Times the packets start transmitting
+  std::vector<Time> m_rxTimes;     //!< Times of the packets received
+};
+
+PointToPointTrainTest::PointToPointTrainTest (uint32_t trainLength)
+  : TestCase ("PointToPoint packet trains"),
+    m_trainLength (trainLength)
+{
+}
+
+void
+PointToPointTrainTest::PhyTxBegin (Ptr<const Packet> p)
+{
+  m_txTimes.push_back (Simulator::Now ());
+}
+
+bool
+PointToPointTrainTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
+                                uint16_t protocol, const Address &from)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+  return true;
+}
+
+void
+PointToPointTrainTest::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("8Mbps"));
+  p2p.SetDeviceAttribute ("TrainLength", UintegerValue (m_trainLength));
+  p2p.SetDeviceAttribute ("InterframeGap", StringValue ("10us"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer devices = p2p.Install (nodes);
+  devices.Get (0)->TraceConnectWithoutContext ("PhyTxBegin",
+                                               MakeCallback (&PointToPointTrainTest::PhyTxBegin, this));
+  devices.Get (1)->SetReceiveCallback (MakeCallback (&PointToPointTrainTest::Receive, this));
+
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      devices.Get (0)->Send (Create<Packet> (1000), devices.Get (0)->GetBroadcast (), 0x800);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_rxTimes.size (), 10, "every packet should be received");
+  NS_TEST_ASSERT_MSG_EQ (m_txTimes.size (), 10, "every packet should be transmitted");
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      // 1002 bytes with the PPP header take 1002us at 8Mbps
+      Time rx = MicroSeconds (1002 * (i + 1) + 10 * i) + MilliSeconds (1);
+      NS_TEST_EXPECT_MSG_EQ (m_rxTimes[i], rx, "packet " << i << " received at the wrong time");
+      NS_TEST_EXPECT_MSG_EQ (m_txTimes[i], MicroSeconds (1012 * i),
+                             "packet " << i << " started transmitting at the wrong time");
+    }
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -117,6 +586,13 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointRemoteTest, TestCase::QUICK);
+  AddTestCase (new PointToPointRemoteRepeatTest, TestCase::QUICK);
+  AddTestCase (new PointToPointZeroCopyTest (Seconds (0), true), TestCase::QUICK);
+  AddTestCase (new PointToPointZeroCopyTest (MilliSeconds (1), true), TestCase::QUICK);
+  AddTestCase (new PointToPointZeroCopyTest (MilliSeconds (2), false), TestCase::QUICK);
+  AddTestCase (new PointToPointTrainTest (1), TestCase::QUICK);
+  AddTestCase (new PointToPointTrainTest (4), TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
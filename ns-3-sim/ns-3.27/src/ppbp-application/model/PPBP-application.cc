@@ -220,14 +220,12 @@ namespace ns3 {
 	{
 		NS_LOG_FUNCTION_NOARGS ();
 		uint32_t bits = (m_pktSize + 30) * 8;
-		Time nextTime(Seconds (bits / 
-							   static_cast<double>(m_cbrRate.GetBitRate())));
+		Time nextTime(m_cbrRate.CalculateBitsTxTime (bits));
 		
 		if (m_activebursts != 0)
 		{
 			m_offPeriod = false;
-			double data_rate = (double) nextTime.GetSeconds() / m_activebursts;
-			m_sendEvent = Simulator::Schedule(Seconds(data_rate),&PPBPApplication::SendPacket, this);
+			m_sendEvent = Simulator::Schedule(nextTime / m_activebursts,&PPBPApplication::SendPacket, this);
 		}
 		else
 		{
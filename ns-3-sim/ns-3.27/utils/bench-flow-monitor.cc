@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the wall clock time of a point-to-point dumbbell
+// carrying many UDP flows, with and without a FlowMonitor on every node,
+// and can write the FlowMonitor results in XML, and periodic snapshots.
+// Sample usage:  ./waf --run 'bench-flow-monitor --leaves=8 --flows=64'
+//                ./waf --run 'bench-flow-monitor --monitor=0'
+//                ./waf --run 'bench-flow-monitor --xml=flowmon.xml'
+//                ./waf --run 'bench-flow-monitor --snapshots=flowmon.csv --interval=0.1'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/point-to-point-layout-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/flow-monitor-module.h"
+#include <algorithm>
+#include <iostream>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  uint32_t leaves = 8;
+  uint32_t flows = 64;
+  double stop = 10;
+  bool monitor = true;
+  std::string xml = "";
+  std::string snapshots = "";
+  double interval = 0.1;
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the FlowMonitor through a point-to-point dumbbell");
+  cmd.AddValue ("leaves", "number of leaves on each side", leaves);
+  cmd.AddValue ("flows", "number of UDP flows from each left leaf", flows);
+  cmd.AddValue ("stop", "simulated time in seconds", stop);
+  cmd.AddValue ("monitor", "install a FlowMonitor on every node", monitor);
+  cmd.AddValue ("xml", "file to write the FlowMonitor results to", xml);
+  cmd.AddValue ("snapshots", "file to write the FlowMonitor snapshots to", snapshots);
+  cmd.AddValue ("interval", "time between snapshots in seconds", interval);
+  cmd.Parse (argc, argv);
+
+  PointToPointHelper leaf;
+  leaf.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  leaf.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  bottleneck.SetChannelAttribute ("Delay", StringValue ("10ms"));
+  PointToPointDumbbellHelper dumbbell (leaves, leaf, leaves, leaf, bottleneck);
+
+  InternetStackHelper stack;
+  dumbbell.InstallStack (stack);
+  dumbbell.AssignIpv4Addresses (Ipv4AddressHelper ("10.1.0.0", "255.255.255.0"),
+                                Ipv4AddressHelper ("10.2.0.0", "255.255.255.0"),
+                                Ipv4AddressHelper ("10.3.0.0", "255.255.255.0"));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  // Each leaf sends its share of 90 Mbps on each of its flows, to
+  // consecutive ports of the leaf across
+  ApplicationContainer sources;
+  for (uint32_t i = 0; i < leaves; i++)
+    {
+      for (uint32_t j = 0; j < flows; j++)
+        {
+          uint16_t port = 9 + j;
+          Address remote (InetSocketAddress (dumbbell.GetRightIpv4Address (i), port));
+          PacketSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+          sink.Install (dumbbell.GetRight (i));
+          OnOffHelper source ("ns3::UdpSocketFactory", remote);
+          source.SetConstantRate (DataRate (90000000 / flows), 1000);
+          sources.Add (source.Install (dumbbell.GetLeft (i)));
+        }
+    }
+  sources.Start (Seconds (0.1));
+
+  FlowMonitorHelper flowmon;
+  if (monitor)
+    {
+      flowmon.InstallAll ();
+      if (!snapshots.empty ())
+        {
+          flowmon.GetMonitor ()->EnableSnapshots (snapshots, Seconds (interval));
+        }
+    }
+  Simulator::Stop (Seconds (stop));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  uint64_t elapsedMs = std::max<uint64_t> (clock.End (), 1);
+
+  std::cout << (monitor ? "FlowMonitor" : "no FlowMonitor")
+            << ", " << leaves * flows << " flows, " << stop << " s simulated, "
+            << elapsedMs << " ms elapsed" << std::endl;
+  if (monitor)
+    {
+      Ptr<FlowMonitor> m = flowmon.GetMonitor ();
+      m->CheckForLostPackets ();
+      m->DisableSnapshots ();
+      uint64_t rxPackets = 0;
+      FlowMonitor::FlowStatsContainer const &stats = m->GetFlowStats ();
+      for (FlowMonitor::FlowStatsContainerCI i = stats.begin (); i != stats.end (); i++)
+        {
+          rxPackets += i->second.rxPackets;
+        }
+      std::cout << stats.size () << " flows seen, " << rxPackets << " packets received, "
+                << rxPackets * 1000 / elapsedMs << " packets/s" << std::endl;
+      if (!xml.empty ())
+        {
+          flowmon.SerializeToXmlFile (xml, true, true);
+        }
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,368 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the route lookups per second of Ipv4GlobalRouting
+// for tables of 10 routes up to 'max-routes' routes, one /30 per link as
+// on FNSS topologies, with 'n' lookups of random destinations per size.
+// With 'nodes' set, it also measures the time to populate and recompute
+// the routing tables of a random topology of that many routers, and can
+// write the tables to a file to compare runs.  The topology is a ring with
+// random chords, or a Waxman topology grown as BRITE's router-level model
+// does.  With 'failures' set, it then measures the time to update the
+// routes after a random link goes down, and again once it is back up.
+// Sample usage:  ./waf --run 'bench-global-routing --n=1000000 --max-routes=100000'
+//                ./waf --run 'bench-global-routing --nodes=500 --tables=tables.txt'
+//                ./waf --run 'bench-global-routing --nodes=1000 --topology=waxman --failures=20'
+
+#include "ns3/command-line.h"
+#include "ns3/boolean.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/global-route-manager.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <set>
+#include <cmath>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+/// Sink for the benchmark results, so the loops are not optimized away
+static uint64_t g_sink = 0;
+
+/**
+ * Fill a table of routes and look up random destinations in it.
+ *
+ * \param ipv4 the IPv4 stack of the router, with 4 interfaces
+ * \param size the number of routes
+ * \param n the number of lookups
+ */
+static void
+BenchLookups (Ptr<Ipv4> ipv4, uint32_t size, uint32_t n)
+{
+  Ptr<Ipv4GlobalRouting> routing = CreateObject<Ipv4GlobalRouting> ();
+  routing->SetIpv4 (ipv4);
+  uint32_t base = Ipv4Address ("10.0.0.0").Get ();
+  for (uint32_t i = 0; i < size; i++)
+    {
+      uint32_t interface = 1 + i % 4;
+      Ipv4Address gateway (Ipv4Address ("192.168.0.2").Get () + ((interface - 1) << 8));
+      routing->AddNetworkRouteTo (Ipv4Address (base + 4 * i), Ipv4Mask ("/30"), gateway, interface);
+    }
+
+  std::vector<Ipv4Header> headers (1024);
+  uint32_t state = 12345;
+  for (uint32_t i = 0; i < headers.size (); i++)
+    {
+      state = state * 1103515245 + 12345;
+      headers[i].SetDestination (Ipv4Address (base + 4 * ((state >> 8) % size) + 1));
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Socket::SocketErrno err;
+      Ptr<Ipv4Route> route = routing->RouteOutput (0, headers[i % headers.size ()], 0, err);
+      g_sink += route->GetGateway ().Get ();
+    }
+  uint64_t ms = clock.End ();
+  std::cout << size << " routes: "
+            << n * 1000.0 / std::max<uint64_t> (ms, 1) << " lookups/s ("
+            << ms << " ms elapsed)" << std::endl;
+  routing->Dispose ();
+}
+
+/**
+ * \param state the state of the pseudo-random numbers
+ * \returns a pseudo-random number in [0, 1)
+ */
+static double
+Uniform (uint32_t &state)
+{
+  state = state * 1103515245 + 12345;
+  return (state >> 8) / 16777216.0;
+}
+
+/**
+ * Connect two nodes by a point-to-point link of SimpleNetDevices.
+ *
+ * \param nodes the nodes
+ * \param address the helper to number the link
+ * \param state the state of the pseudo-random metrics
+ * \returns the interfaces of the link
+ */
+static Ipv4InterfaceContainer
+Connect (NodeContainer nodes, Ipv4AddressHelper &address, uint32_t &state)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAttribute ("PointToPointMode", BooleanValue (true));
+      device->SetChannel (channel);
+      device->SetAddress (Mac48Address::Allocate ());
+      nodes.Get (i)->AddDevice (device);
+      devices.Add (device);
+    }
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+  address.NewNetwork ();
+  // Few distinct metrics, so that there are equal-cost paths
+  state = state * 1103515245 + 12345;
+  uint16_t metric = 1 + (state >> 16) % 3;
+  for (uint32_t i = 0; i < interfaces.GetN (); i++)
+    {
+      std::pair<Ptr<Ipv4>, uint32_t> interface = interfaces.Get (i);
+      interface.first->SetMetric (interface.second, metric);
+    }
+  return interfaces;
+}
+
+/**
+ * Choose the links of a Waxman topology, grown one router at a time as in
+ * the router-level Waxman model of BRITE: routers are placed uniformly in
+ * a square, and each new router links to two of the previous ones, each
+ * accepted with probability alpha * exp (-d / (beta * L)), where d is
+ * their distance and L the largest distance in the square.
+ *
+ * \param size the number of routers
+ * \param state the state of the pseudo-random numbers
+ * \returns the pairs of routers to link
+ */
+static std::set<std::pair<uint32_t, uint32_t> >
+WaxmanLinks (uint32_t size, uint32_t &state)
+{
+  const double side = 1000;
+  const double alpha = 0.15;
+  const double beta = 0.2;
+  const uint32_t m = 2;
+  std::vector<double> x (size);
+  std::vector<double> y (size);
+  std::set<std::pair<uint32_t, uint32_t> > links;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      x[i] = side * Uniform (state);
+      y[i] = side * Uniform (state);
+      if (i <= m)
+        {
+          for (uint32_t j = 0; j < i; j++)
+            {
+              links.insert (std::make_pair (j, i));
+            }
+          continue;
+        }
+      uint32_t added = 0;
+      while (added < m)
+        {
+          uint32_t j = std::min (static_cast<uint32_t> (i * Uniform (state)), i - 1);
+          double d = std::sqrt ((x[i] - x[j]) * (x[i] - x[j]) + (y[i] - y[j]) * (y[i] - y[j]));
+          if (Uniform (state) < alpha * std::exp (-d / (beta * side * std::sqrt (2.0)))
+              && links.insert (std::make_pair (j, i)).second)
+            {
+              added++;
+            }
+        }
+    }
+  return links;
+}
+
+/**
+ * Update the routes, and report the time it took.
+ *
+ * \param what the change the routes are updated after
+ * \returns the time to update the routes, in milliseconds
+ */
+static uint64_t
+BenchUpdate (std::string what)
+{
+  SystemWallClockMs clock;
+  clock.Start ();
+  uint32_t recomputed = GlobalRouteManager::UpdateRoutes ();
+  uint64_t ms = clock.End ();
+  std::cout << "  " << what << ": update " << ms << " ms, "
+            << recomputed << " routers computed again or repaired" << std::endl;
+  return ms;
+}
+
+/**
+ * Build a random topology of routers, and time the computation of their
+ * routing tables, and their updates after link failures.
+ *
+ * \param size the number of routers
+ * \param topology the kind of topology, "ring" or "waxman"
+ * \param failures the number of link failures
+ * \param tables the file to write the routing tables to, or empty
+ */
+static void
+BenchPopulate (uint32_t size, std::string topology, uint32_t failures, std::string tables)
+{
+  NodeContainer nodes;
+  nodes.Create (size);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+  uint32_t state = 1;
+  std::vector<Ipv4InterfaceContainer> links;
+  if (topology == "waxman")
+    {
+      std::set<std::pair<uint32_t, uint32_t> > pairs = WaxmanLinks (size, state);
+      for (std::set<std::pair<uint32_t, uint32_t> >::const_iterator i = pairs.begin (); i != pairs.end (); i++)
+        {
+          links.push_back (Connect (NodeContainer (nodes.Get (i->first), nodes.Get (i->second)), address, state));
+        }
+    }
+  else
+    {
+      for (uint32_t i = 0; i < size; i++)
+        {
+          // A ring, and a random chord from every router
+          links.push_back (Connect (NodeContainer (nodes.Get (i), nodes.Get ((i + 1) % size)), address, state));
+          state = state * 1103515245 + 12345;
+          uint32_t j = (state >> 8) % size;
+          if (j != i && j != (i + 1) % size && (j + 1) % size != i)
+            {
+              links.push_back (Connect (NodeContainer (nodes.Get (i), nodes.Get (j)), address, state));
+            }
+        }
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  uint64_t ms = clock.End ();
+  std::cout << size << " routers: populate " << ms << " ms";
+  clock.Start ();
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  uint64_t databaseMs = clock.End ();
+  clock.Start ();
+  GlobalRouteManager::InitializeRoutes ();
+  ms = clock.End ();
+  std::cout << ", recompute " << databaseMs + ms << " ms (LSDB "
+            << databaseMs << " ms, SPF " << ms << " ms), "
+            << links.size () << " links" << std::endl;
+
+  if (failures > 0)
+    {
+      BenchUpdate ("first");
+      uint64_t total = 0;
+      for (uint32_t f = 0; f < failures; f++)
+        {
+          Ipv4InterfaceContainer link = links[static_cast<uint32_t> (Uniform (state) * links.size ())];
+          std::ostringstream what;
+          what << "link " << link.GetAddress (0) << " - " << link.GetAddress (1);
+          for (uint32_t e = 0; e < 2; e++)
+            {
+              link.Get (e).first->SetDown (link.Get (e).second);
+            }
+          total += BenchUpdate (what.str () + " down");
+          for (uint32_t e = 0; e < 2; e++)
+            {
+              link.Get (e).first->SetUp (link.Get (e).second);
+            }
+          total += BenchUpdate (what.str () + " up");
+        }
+      std::cout << size << " routers: " << total / (2.0 * failures)
+                << " ms per update after a link change" << std::endl;
+    }
+
+  if (!tables.empty ())
+    {
+      std::ofstream out (tables.c_str ());
+      for (uint32_t i = 0; i < nodes.GetN (); i++)
+        {
+          Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+          out << "Node " << i << std::endl;
+          for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+            {
+              out << *routing->GetRoute (j) << std::endl;
+            }
+        }
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t maxRoutes = 100000;
+  uint32_t nodes = 0;
+  std::string tables;
+  std::string topology = "ring";
+  uint32_t failures = 0;
+  CommandLine cmd;
+  cmd.Usage ("Benchmark Ipv4GlobalRouting lookups and route computation");
+  cmd.AddValue ("n", "number of lookups per table size", n);
+  cmd.AddValue ("max-routes", "largest number of routes", maxRoutes);
+  cmd.AddValue ("nodes", "number of routers of the topology to compute routes for", nodes);
+  cmd.AddValue ("tables", "file to write the computed routing tables to", tables);
+  cmd.AddValue ("topology", "topology of the routers: ring or waxman", topology);
+  cmd.AddValue ("failures", "number of link failures to update the routes after", failures);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 && nodes == 0)
+    {
+      std::cerr << "Error-- number of lookups or of routers must be specified " <<
+        "by command-line argument --n=(number of lookups) or --nodes=(number of routers)" << std::endl;
+      exit (1);
+    }
+  if (nodes > 0)
+    {
+      BenchPopulate (nodes, topology, failures, tables);
+    }
+  if (n == 0)
+    {
+      return 0;
+    }
+
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ipv4AddressHelper address;
+  address.SetBase ("192.168.0.0", "255.255.255.0");
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetChannel (CreateObject<SimpleChannel> ());
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      address.Assign (NetDeviceContainer (device));
+      address.NewNetwork ();
+    }
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+
+  for (uint32_t size = 10; size <= maxRoutes; size *= 10)
+    {
+      BenchLookups (ipv4, size, n);
+    }
+
+  // Keep the sink alive
+  return g_sink == 42 ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the packets forwarded per second by transit
+// routers: 'n' UDP packets of 'size' bytes are sent from a host through a
+// chain of 'routers' routers to another host, over point-to-point links
+// with global routing.  With 'fast' set, the routers use the
+// FastForwarding path of Ipv4L3Protocol.
+// Sample usage:  ./waf --run 'bench-ipv4-forwarding --routers=10 --n=100000'
+//                ./waf --run 'bench-ipv4-forwarding --routers=10 --n=100000 --fast=1'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include <iostream>
+
+using namespace ns3;
+
+/// Packets received by the destination host
+static uint64_t g_received = 0;
+
+/**
+ * Send the packets, one every 'interval'
+ * \param socket the sending socket
+ * \param size the size of the packets
+ * \param n the number of packets left to send
+ * \param interval the time between packets
+ */
+static void
+SendPackets (Ptr<Socket> socket, uint32_t size, uint32_t n, Time interval)
+{
+  socket->Send (Create<Packet> (size));
+  if (n > 1)
+    {
+      Simulator::Schedule (interval, &SendPackets, socket, size, n - 1, interval);
+    }
+}
+
+/**
+ * Read what the destination host receives
+ * \param socket the receiving socket
+ */
+static void
+ReceivePackets (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      g_received++;
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t routers = 10;
+  uint32_t n = 100000;
+  uint32_t size = 1000;
+  bool fast = false;
+  CommandLine cmd;
+  cmd.AddValue ("routers", "number of routers between the hosts", routers);
+  cmd.AddValue ("n", "number of packets sent", n);
+  cmd.AddValue ("size", "size of the packets in bytes", size);
+  cmd.AddValue ("fast", "use the fast forwarding path on the routers", fast);
+  cmd.Parse (argc, argv);
+
+  NodeContainer hosts;
+  hosts.Create (2);
+  NodeContainer transit;
+  transit.Create (routers);
+  NodeContainer chain;
+  chain.Add (hosts.Get (0));
+  chain.Add (transit);
+  chain.Add (hosts.Get (1));
+
+  InternetStackHelper stack;
+  stack.Install (hosts);
+  stack.Install (transit);
+  if (fast)
+    {
+      for (uint32_t i = 0; i < routers; i++)
+        {
+          transit.Get (i)->GetObject<Ipv4L3Protocol> ()->SetAttribute ("FastForwarding",
+                                                                      BooleanValue (true));
+        }
+    }
+
+  PointToPointHelper link;
+  link.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  link.SetChannelAttribute ("Delay", StringValue ("10us"));
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+  Ipv4InterfaceContainer last;
+  for (uint32_t i = 0; i + 1 < chain.GetN (); i++)
+    {
+      last = address.Assign (link.Install (chain.Get (i), chain.Get (i + 1)));
+      address.NewNetwork ();
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  uint16_t port = 9;
+  Ptr<Socket> sink = Socket::CreateSocket (hosts.Get (1), UdpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), port));
+  sink->SetRecvCallback (MakeCallback (&ReceivePackets));
+  Ptr<Socket> source = Socket::CreateSocket (hosts.Get (0), UdpSocketFactory::GetTypeId ());
+  source->Connect (InetSocketAddress (last.GetAddress (1), port));
+  // One packet every 2 us, a fifth of the link rate for 1000 bytes
+  Simulator::Schedule (Seconds (1), &SendPackets, source, size, n, MicroSeconds (2));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  uint64_t elapsedMs = std::max<uint64_t> (clock.End (), 1);
+  std::cout << routers << " routers, " << g_received << " of " << n << " packets received, "
+            << elapsedMs << " ms elapsed, "
+            << g_received * routers / (elapsedMs / 1000.0) << " packets forwarded/s"
+            << (fast ? " (fast forwarding)" : "") << std::endl;
+  Simulator::Destroy ();
+  return 0;
+}
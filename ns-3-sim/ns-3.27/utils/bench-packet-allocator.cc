@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the number of packets per second of wall clock
+// time carried through a point-to-point dumbbell, with the packets and
+// their data served by the PacketAllocator slabs or by operator new,
+// and prints the statistics of the allocator pools.
+// Sample usage:  ./waf --run 'bench-packet-allocator --leaves=8 --stop=10'
+//                ./waf --run 'bench-packet-allocator --pool=0'
+//                ./waf --run 'bench-packet-allocator --ns3::PointToPointNetDevice::ZeroCopy=1'
+//                ./waf --run 'bench-packet-allocator --ns3::PointToPointNetDevice::TrainLength=8'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/point-to-point-layout-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/packet-allocator.h"
+#include <iostream>
+#include <iomanip>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  uint32_t leaves = 8;
+  double stop = 10;
+  bool pool = true;
+  bool tcp = false;
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the packet allocator through a point-to-point dumbbell");
+  cmd.AddValue ("leaves", "number of leaves on each side", leaves);
+  cmd.AddValue ("stop", "simulated time in seconds", stop);
+  cmd.AddValue ("pool", "serve packets from the allocator slabs", pool);
+  cmd.AddValue ("tcp", "use bulk TCP flows instead of UDP on/off flows", tcp);
+  cmd.Parse (argc, argv);
+
+  PacketAllocator::SetEnabled (pool);
+
+  PointToPointHelper leaf;
+  leaf.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  leaf.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  bottleneck.SetChannelAttribute ("Delay", StringValue ("10ms"));
+  PointToPointDumbbellHelper dumbbell (leaves, leaf, leaves, leaf, bottleneck);
+
+  InternetStackHelper stack;
+  dumbbell.InstallStack (stack);
+  dumbbell.AssignIpv4Addresses (Ipv4AddressHelper ("10.1.0.0", "255.255.255.0"),
+                                Ipv4AddressHelper ("10.2.0.0", "255.255.255.0"),
+                                Ipv4AddressHelper ("10.3.0.0", "255.255.255.0"));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  std::string factory = tcp ? "ns3::TcpSocketFactory" : "ns3::UdpSocketFactory";
+  ApplicationContainer sinks;
+  ApplicationContainer sources;
+  for (uint32_t i = 0; i < leaves; i++)
+    {
+      uint16_t port = 9;
+      Address remote (InetSocketAddress (dumbbell.GetRightIpv4Address (i), port));
+      PacketSinkHelper sink (factory, InetSocketAddress (Ipv4Address::GetAny (), port));
+      sinks.Add (sink.Install (dumbbell.GetRight (i)));
+      if (tcp)
+        {
+          BulkSendHelper source (factory, remote);
+          source.SetAttribute ("SendSize", UintegerValue (1448));
+          sources.Add (source.Install (dumbbell.GetLeft (i)));
+        }
+      else
+        {
+          OnOffHelper source (factory, remote);
+          source.SetConstantRate (DataRate ("90Mbps"), 1000);
+          sources.Add (source.Install (dumbbell.GetLeft (i)));
+        }
+    }
+  sources.Start (Seconds (0.1));
+  Simulator::Stop (Seconds (stop));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  uint64_t elapsedMs = std::max<uint64_t> (clock.End (), 1);
+
+  uint64_t rxBytes = 0;
+  for (uint32_t i = 0; i < sinks.GetN (); i++)
+    {
+      rxBytes += DynamicCast<PacketSink> (sinks.Get (i))->GetTotalRx ();
+    }
+  uint64_t packets = PacketAllocator::GetStats (PacketAllocator::PACKET).allocations;
+
+  std::cout << (pool ? "slab allocator" : "operator new")
+            << ", " << leaves << " flows, " << stop << " s simulated, "
+            << elapsedMs << " ms elapsed" << std::endl;
+  std::cout << packets * 1000 / elapsedMs << " packets/s created, "
+            << rxBytes * 1000 / elapsedMs << " bytes/s received" << std::endl;
+  std::cout << std::setw (16) << "pool" << std::setw (12) << "live"
+            << std::setw (12) << "peak" << std::setw (14) << "allocations" << std::endl;
+  for (uint32_t i = 0; i < PacketAllocator::POOL_N; i++)
+    {
+      PacketAllocator::Pool p = PacketAllocator::Pool (i);
+      PacketAllocator::Stats stats = PacketAllocator::GetStats (p);
+      std::cout << std::setw (16) << PacketAllocator::GetPoolName (p)
+                << std::setw (12) << stats.live
+                << std::setw (12) << stats.peak
+                << std::setw (14) << stats.allocations << std::endl;
+    }
+  std::cout << PacketAllocator::GetSlabBytes () << " bytes in slabs" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
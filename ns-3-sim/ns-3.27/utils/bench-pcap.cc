@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the time the simulation thread
+// spends writing pcap files, synchronously or through the background
+// thread of PcapFileWrapper, for various numbers of packets 'n' of
+// 'size' bytes captured up to 'snaplen' bytes
+// Sample usage:  ./waf --run 'bench-pcap --n=1000000 --size=1500'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/pcap-file-wrapper.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/network-config.h"
+#include "ns3/core-config.h"
+#include <iostream>
+#include <cstdio>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+/// Size of the packets written
+static uint32_t g_size = 1500;
+/// Snapshot length of the files
+static uint32_t g_snapLen = 65535;
+/// Name of the file written
+static std::string g_filename = "bench-pcap.pcap";
+
+static void
+runBench (uint32_t n, bool asynchronous, bool gzip, char const *name)
+{
+  Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
+  file->SetAttribute ("Asynchronous", BooleanValue (asynchronous));
+  file->SetAttribute ("Compression", EnumValue (gzip ? PcapFileWrapper::GZIP : PcapFileWrapper::NONE));
+  Ptr<Packet> p = Create<Packet> (g_size);
+
+  SystemWallClockMs time;
+  time.Start ();
+  file->Open (g_filename, std::ios::out);
+  file->Init (1, g_snapLen);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      file->Write (MicroSeconds (i), p);
+    }
+  uint64_t writeMs = time.End ();
+  time.Start ();
+  file->Close ();
+  uint64_t closeMs = time.End ();
+  std::remove (g_filename.c_str ());
+
+  double ops = n;
+  ops *= 1000;
+  ops /= std::max<uint64_t> (writeMs, 1);
+  std::cout << ops << " packets/s"
+            << " (" << writeMs << " ms writing, " << closeMs << " ms closing)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the synchronous and asynchronous pcap writers");
+  cmd.AddValue ("n", "number of packets", n);
+  cmd.AddValue ("size", "size of the packets", g_size);
+  cmd.AddValue ("snaplen", "snapshot length of the files", g_snapLen);
+  cmd.AddValue ("file", "name of the file written", g_filename);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of packets must be specified " <<
+        "by command-line argument --n=(number of packets)" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-pcap with n=" << n << " size=" << g_size
+            << " snaplen=" << g_snapLen << std::endl;
+
+  runBench (n, false, false, "PcapFile");
+#ifdef HAVE_PTHREAD_H
+  runBench (n, true, false, "background thread");
+#ifdef HAVE_ZLIB
+  runBench (n, true, true, "background thread, gzip");
+#endif
+#endif
+
+  return 0;
+}
@@ -0,0 +1,226 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the ring buffer of Queue against
+// the std::list the items used to be stored in, for various numbers of
+// iterations 'n' and queue backlogs 'backlog'
+// Sample usage:  ./waf --run 'bench-queue --n=10000000 --backlog=100'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/uinteger.h"
+#include <iostream>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+#include <list>
+
+using namespace ns3;
+
+/// Number of packets kept in the queues
+static uint32_t g_backlog = 100;
+/// Sink for the benchmark results, so the loops are not optimized away
+static uint64_t g_sink = 0;
+
+/**
+ * FIFO queue dropping the packets whose uid is a multiple of a given
+ * number while browsing the queue, the way WifiMacQueue drops stale packets.
+ */
+class BenchQueue : public Queue<Packet>
+{
+public:
+  virtual bool Enqueue (Ptr<Packet> item)
+  {
+    return DoEnqueue (Tail (), item);
+  }
+  virtual Ptr<Packet> Dequeue (void)
+  {
+    return DoDequeue (Head ());
+  }
+  virtual Ptr<Packet> Remove (void)
+  {
+    return DoRemove (Head ());
+  }
+  virtual Ptr<const Packet> Peek (void) const
+  {
+    return DoPeek (Head ());
+  }
+  /**
+   * \param n the modulo
+   */
+  void RemoveMultiples (uint32_t n)
+  {
+    for (auto it = Head (); it != Tail (); )
+      {
+        if ((*it)->GetUid () % n == 0)
+          {
+            auto curr = it++;
+            DoRemove (curr);
+          }
+        else
+          {
+            it++;
+          }
+      }
+  }
+};
+
+static Ptr<BenchQueue>
+createQueue (void)
+{
+  Ptr<BenchQueue> queue = CreateObject<BenchQueue> ();
+  queue->SetAttribute ("MaxPackets", UintegerValue (g_backlog + 1));
+  return queue;
+}
+
+static void
+benchRing (uint32_t n)
+{
+  Ptr<BenchQueue> queue = createQueue ();
+  Ptr<Packet> p = Create<Packet> (1000);
+  for (uint32_t i = 0; i < g_backlog; i++)
+    {
+      queue->Enqueue (p);
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      queue->Enqueue (p);
+      g_sink += queue->Dequeue ()->GetSize ();
+    }
+}
+
+static void
+benchList (uint32_t n)
+{
+  // The storage and byte accounting of the former Queue implementation
+  std::list<Ptr<Packet> > packets;
+  uint64_t bytes = 0;
+  Ptr<Packet> p = Create<Packet> (1000);
+  for (uint32_t i = 0; i < g_backlog; i++)
+    {
+      packets.push_back (p);
+      bytes += p->GetSize ();
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      packets.push_back (p);
+      bytes += p->GetSize ();
+      Ptr<Packet> item = packets.front ();
+      packets.pop_front ();
+      bytes -= item->GetSize ();
+      g_sink += item->GetSize ();
+    }
+  g_sink += bytes;
+}
+
+static void
+benchRingRemove (uint32_t n)
+{
+  Ptr<BenchQueue> queue = createQueue ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      queue->Enqueue (Create<Packet> (100));
+      if (queue->GetNPackets () == g_backlog)
+        {
+          queue->RemoveMultiples (7);
+          g_sink += queue->Dequeue ()->GetSize ();
+        }
+    }
+}
+
+static void
+benchListRemove (uint32_t n)
+{
+  std::list<Ptr<Packet> > packets;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      packets.push_back (Create<Packet> (100));
+      if (packets.size () == g_backlog)
+        {
+          for (auto it = packets.begin (); it != packets.end (); )
+            {
+              if ((*it)->GetUid () % 7 == 0)
+                {
+                  it = packets.erase (it);
+                }
+              else
+                {
+                  it++;
+                }
+            }
+          g_sink += packets.front ()->GetSize ();
+          packets.pop_front ();
+        }
+    }
+}
+
+static uint64_t
+runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  (*bench) (n);
+  uint64_t deltaMs = time.End ();
+  return deltaMs;
+}
+
+
+static void
+runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      uint64_t delay = runBenchOneIteration(bench, n);
+      minDelay = std::min(minDelay, delay);
+    }
+  double ops = n;
+  ops *= 1000;
+  ops /= std::max<uint64_t> (minDelay, 1);
+  std::cout << ops << " packets/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t minIterations = 1;
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the ring buffer of Queue against a std::list");
+  cmd.AddValue ("n", "number of iterations", n);
+  cmd.AddValue ("backlog", "number of packets kept in the queue", g_backlog);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 || g_backlog == 0)
+    {
+      std::cerr << "Error-- number of iterations must be specified " <<
+        "by command-line argument --n=(number of iterations)" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-queue with n=" << n << " backlog=" << g_backlog << std::endl;
+
+  runBench (&benchRing, n, minIterations, "Queue enqueue/dequeue");
+  runBench (&benchList, n, minIterations, "std::list push/pop");
+  runBench (&benchRingRemove, n, minIterations, "Queue with removals while browsing");
+  runBench (&benchListRemove, n, minIterations, "std::list with removals while browsing");
+
+  // Keep the sink alive
+  return g_sink == 42 ? 1 : 0;
+}
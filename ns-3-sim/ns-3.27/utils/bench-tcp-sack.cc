@@ -0,0 +1,372 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the time the TcpTxBuffer scoreboard takes to
+// recover a window of segments with SACK, for windows from 'min-window'
+// up to 'max-window' segments, by replaying on the buffer alone the ACKs
+// of a receiver that misses one segment in 'loss-every'.  With 'receiver'
+// set, it measures the TcpRxBuffer of that receiver instead, fed with the
+// same window and then the retransmissions.  With 'simulate' set, it
+// measures the wall clock time of a bulk TCP transfer through a 10 Gbps
+// point-to-point link with a 100 ms RTT and random losses; 'states' then
+// records the congestion window and RTT of the flows in a file, either
+// from the trace sources of the sockets or with a TcpStateSampler.
+// Sample usage:  ./waf --run 'bench-tcp-sack --max-window=65536'
+//                ./waf --run 'bench-tcp-sack --loss-every=10'
+//                ./waf --run 'bench-tcp-sack --receiver=1'
+//                ./waf --run 'bench-tcp-sack --simulate=1 --loss=0.0001 --stop=5'
+//                ./waf --run 'bench-tcp-sack --simulate=1 --flows=100 --states=trace'
+//                ./waf --run 'bench-tcp-sack --simulate=1 --flows=100 --states=sampler'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-rx-buffer.h"
+#include "ns3/tcp-state-sampler.h"
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+using namespace ns3;
+
+/// Blocks of contiguous data held by the receiver above its cumulative ACK
+typedef std::map<SequenceNumber32, SequenceNumber32> Blocks;
+
+/**
+ * Add a segment to the blocks of the receiver, merging it with its
+ * neighbours.
+ * \returns the block that holds the segment
+ */
+static Blocks::iterator
+Receive (Blocks &blocks, SequenceNumber32 start, SequenceNumber32 end)
+{
+  Blocks::iterator next = blocks.upper_bound (start);
+  if (next != blocks.begin ())
+    {
+      Blocks::iterator prev = next;
+      --prev;
+      if (prev->second >= start)
+        {
+          start = prev->first;
+          end = std::max (end, prev->second);
+          blocks.erase (prev);
+        }
+    }
+  while (next != blocks.end () && next->first <= end)
+    {
+      end = std::max (end, next->second);
+      blocks.erase (next++);
+    }
+  return blocks.insert (std::make_pair (start, end)).first;
+}
+
+/**
+ * Send a window of segments from a TcpTxBuffer, lose one in lossEvery,
+ * and recover as TcpSocketBase does with SACK: on each ACK, update the
+ * scoreboard and send what NextSeg returns while the pipe is below half
+ * the window.  Every segment sent during recovery arrives.
+ * \returns the number of ACKs processed
+ */
+static uint32_t
+RecoverWindow (uint32_t window, uint32_t lossEvery, uint32_t segmentSize)
+{
+  const uint32_t dupThresh = 3;
+  Ptr<TcpTxBuffer> txBuffer = CreateObject<TcpTxBuffer> ();
+  txBuffer->SetMaxBufferSize (2 * window * segmentSize);
+  txBuffer->SetHeadSequence (SequenceNumber32 (1));
+  txBuffer->Add (Create<Packet> (2 * window * segmentSize));
+
+  std::deque<SequenceNumber32> arrivals;
+  SequenceNumber32 next;
+  for (uint32_t i = 0; i < window; i++)
+    {
+      txBuffer->NextSeg (&next, dupThresh, segmentSize, false);
+      txBuffer->CopyFromSequence (segmentSize, next);
+      if (i % lossEvery != lossEvery / 2)
+        {
+          arrivals.push_back (next);
+        }
+    }
+
+  Blocks blocks;
+  SequenceNumber32 ack (1);
+  SequenceNumber32 end = ack + window * segmentSize;
+  uint32_t cwnd = window / 2 * segmentSize;
+  uint32_t acks = 0;
+  while (ack < end && !arrivals.empty ())
+    {
+      SequenceNumber32 seq = arrivals.front ();
+      arrivals.pop_front ();
+
+      // The receiver reports the block holding the segment first, then
+      // the highest ones
+      TcpOptionSack::SackList sackList;
+      if (seq >= ack)
+        {
+          Blocks::iterator held = Receive (blocks, seq, seq + segmentSize);
+          if (held->first == ack)
+            {
+              ack = held->second;
+              blocks.erase (held);
+            }
+          else
+            {
+              sackList.push_back (*held);
+            }
+          for (Blocks::reverse_iterator i = blocks.rbegin ();
+               i != blocks.rend () && sackList.size () < 3; ++i)
+            {
+              if (sackList.empty () || i->first != sackList.front ().first)
+                {
+                  sackList.push_back (*i);
+                }
+            }
+        }
+
+      acks++;
+      if (ack > txBuffer->HeadSequence ())
+        {
+          txBuffer->DiscardUpTo (ack);
+        }
+      if (!sackList.empty ())
+        {
+          txBuffer->Update (sackList);
+        }
+      while (txBuffer->BytesInFlight (dupThresh, segmentSize) + segmentSize <= cwnd
+             && txBuffer->NextSeg (&next, dupThresh, segmentSize, true)
+             && next < end)
+        {
+          txBuffer->CopyFromSequence (segmentSize, next);
+          arrivals.push_back (next);
+        }
+    }
+  return acks;
+}
+
+/**
+ * Feed a TcpRxBuffer with a window of segments missing one in lossEvery,
+ * then with the segments missing, as TcpSocketBase does, and let the
+ * application read the data as soon as it is in sequence.
+ * \returns the number of segments received
+ */
+static uint32_t
+ReassembleWindow (uint32_t window, uint32_t lossEvery, uint32_t segmentSize)
+{
+  Ptr<TcpRxBuffer> rxBuffer = CreateObject<TcpRxBuffer> ();
+  rxBuffer->SetMaxBufferSize (window * segmentSize);
+  rxBuffer->SetNextRxSequence (SequenceNumber32 (1));
+
+  uint32_t received = 0;
+  TcpHeader header;
+  for (uint32_t pass = 0; pass < 2; pass++)
+    {
+      for (uint32_t i = 0; i < window; i++)
+        {
+          if ((i % lossEvery == lossEvery / 2) == (pass == 0))
+            {
+              continue;
+            }
+          header.SetSequenceNumber (SequenceNumber32 (1 + i * segmentSize));
+          rxBuffer->Add (Create<Packet> (segmentSize), header);
+          rxBuffer->GetSackList ();
+          received++;
+          if (rxBuffer->Available () > 0)
+            {
+              rxBuffer->Extract (rxBuffer->Available ());
+            }
+        }
+    }
+  NS_ABORT_MSG_UNLESS (rxBuffer->NextRxSequence () == SequenceNumber32 (1 + window * segmentSize),
+                       "The window was not reassembled");
+  return received;
+}
+
+/// File the trace sinks write the states to
+static std::ofstream g_states;
+
+/**
+ * Write a change of congestion window
+ * \param context the socket
+ * \param oldValue the previous window
+ * \param newValue the new window
+ */
+static void
+CwndChange (std::string context, uint32_t oldValue, uint32_t newValue)
+{
+  g_states << Simulator::Now ().GetSeconds () << "," << context << ",cwnd," << newValue << "\n";
+}
+
+/**
+ * Write a new RTT sample
+ * \param context the socket
+ * \param oldValue the previous RTT
+ * \param newValue the new RTT
+ */
+static void
+RttChange (std::string context, Time oldValue, Time newValue)
+{
+  g_states << Simulator::Now ().GetSeconds () << "," << context << ",rtt," << newValue.GetSeconds () << "\n";
+}
+
+/// Connect the trace sinks to the sockets
+static void
+ConnectTraces (void)
+{
+  Config::Connect ("/NodeList/*/$ns3::TcpL4Protocol/SocketList/*/CongestionWindow",
+                   MakeCallback (&CwndChange));
+  Config::Connect ("/NodeList/*/$ns3::TcpL4Protocol/SocketList/*/RTT",
+                   MakeCallback (&RttChange));
+}
+
+/**
+ * Run bulk TCP transfers through a 10 Gbps point-to-point link with a
+ * 100 ms RTT that loses a fraction of the data segments, and record the
+ * state of their sockets as asked: "trace", "sampler" or "" for none.
+ */
+static void
+Simulate (double loss, double stop, uint32_t buffer, uint32_t segmentSize,
+          uint32_t flows, std::string states)
+{
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (buffer));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (buffer));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (segmentSize));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper link;
+  link.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  link.SetChannelAttribute ("Delay", StringValue ("50ms"));
+  link.SetQueue ("ns3::DropTailQueue<Packet>", "MaxPackets", UintegerValue (100000));
+  NetDeviceContainer devices = link.Install (nodes);
+  Ptr<RateErrorModel> errors = CreateObject<RateErrorModel> ();
+  errors->SetAttribute ("ErrorRate", DoubleValue (loss));
+  errors->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+  devices.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (errors));
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  ApplicationContainer sinks;
+  for (uint32_t i = 0; i < flows; i++)
+    {
+      uint16_t port = 9 + i;
+      BulkSendHelper source ("ns3::TcpSocketFactory",
+                             InetSocketAddress (interfaces.GetAddress (1), port));
+      source.Install (nodes.Get (0));
+      PacketSinkHelper sink ("ns3::TcpSocketFactory",
+                             InetSocketAddress (Ipv4Address::GetAny (), port));
+      sinks.Add (sink.Install (nodes.Get (1)));
+    }
+
+  Ptr<TcpStateSampler> sampler;
+  if (states == "trace")
+    {
+      g_states.open ("bench-tcp-sack-states.csv");
+      // The sockets exist once the applications have started
+      Simulator::Schedule (MilliSeconds (1), &ConnectTraces);
+    }
+  else if (states == "sampler")
+    {
+      sampler = CreateObject<TcpStateSampler> ();
+      sampler->SetAttribute ("Interval", TimeValue (MilliSeconds (10)));
+      sampler->InstallAll ();
+      sampler->EnableStreaming ("bench-tcp-sack-states.csv");
+      sampler->Start (Seconds (0));
+    }
+  Simulator::Stop (Seconds (stop));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  uint64_t elapsedMs = std::max<uint64_t> (clock.End (), 1);
+
+  uint64_t rx = 0;
+  for (uint32_t i = 0; i < flows; i++)
+    {
+      rx += DynamicCast<PacketSink> (sinks.Get (i))->GetTotalRx ();
+    }
+  std::cout << flows << " flows, loss " << loss << ", " << buffer << " bytes of buffer, "
+            << stop << " s simulated, " << elapsedMs << " ms elapsed, "
+            << rx * 8 / stop / 1e6 << " Mbps of goodput" << std::endl;
+  if (sampler != 0)
+    {
+      sampler->Dispose ();
+    }
+  g_states.close ();
+  Simulator::Destroy ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t minWindow = 1024;
+  uint32_t maxWindow = 65536;
+  uint32_t lossEvery = 100;
+  uint32_t segmentSize = 1448;
+  bool receiver = false;
+  bool simulate = false;
+  double loss = 0.0001;
+  double stop = 5;
+  uint32_t buffer = 4096 * 1024;
+  uint32_t flows = 1;
+  std::string states = "";
+  CommandLine cmd;
+  cmd.Usage ("Benchmark SACK loss recovery in the TcpTxBuffer scoreboard");
+  cmd.AddValue ("min-window", "smallest window, in segments", minWindow);
+  cmd.AddValue ("max-window", "largest window, in segments", maxWindow);
+  cmd.AddValue ("loss-every", "lose one segment of the window in this many", lossEvery);
+  cmd.AddValue ("segment-size", "segment size in bytes", segmentSize);
+  cmd.AddValue ("receiver", "measure the receive buffer instead", receiver);
+  cmd.AddValue ("simulate", "simulate a bulk transfer instead", simulate);
+  cmd.AddValue ("loss", "fraction of data segments lost in the simulation", loss);
+  cmd.AddValue ("stop", "simulated time in seconds", stop);
+  cmd.AddValue ("buffer", "socket buffer size in bytes in the simulation", buffer);
+  cmd.AddValue ("flows", "number of flows in the simulation", flows);
+  cmd.AddValue ("states", "record the socket states in the simulation, with 'trace' or 'sampler'", states);
+  cmd.Parse (argc, argv);
+
+  if (simulate)
+    {
+      Simulate (loss, stop, buffer, segmentSize, flows, states);
+      return 0;
+    }
+
+  for (uint32_t window = minWindow; window <= maxWindow; window *= 4)
+    {
+      SystemWallClockMs clock;
+      clock.Start ();
+      if (receiver)
+        {
+          uint32_t segments = ReassembleWindow (window, lossEvery, segmentSize);
+          uint64_t elapsedMs = std::max<uint64_t> (clock.End (), 1);
+          std::cout << "window " << window << " segments, " << segments << " received, "
+                    << elapsedMs << " ms elapsed, "
+                    << elapsedMs * 1000.0 / segments << " us/segment" << std::endl;
+          continue;
+        }
+      uint32_t acks = RecoverWindow (window, lossEvery, segmentSize);
+      uint64_t elapsedMs = std::max<uint64_t> (clock.End (), 1);
+      std::cout << "window " << window << " segments, " << acks << " ACKs, "
+                << elapsedMs << " ms elapsed, "
+                << elapsedMs * 1000.0 / acks << " us/ACK" << std::endl;
+    }
+  return 0;
+}
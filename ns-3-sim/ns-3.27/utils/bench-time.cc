@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the Time conversions found on
+// per-packet paths, comparing the int64x64_t based conversions with the
+// integer fast path and the transmission time cache of the devices, for
+// various numbers of iterations 'n'
+// Sample usage:  ./waf --run 'bench-time --n=10000000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include <iostream>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/// Sink for the benchmark results, so the loops are not optimized away
+static int64_t g_sink = 0;
+/// Sink for the floating point benchmark results
+static double g_sinkDouble = 0;
+
+/// Packet sizes cycled through by the tx time benchmarks
+static const uint32_t g_sizes[] = { 40, 52, 576, 1448, 1500, 1518 };
+/// Number of entries in g_sizes
+static const uint32_t g_nSizes = sizeof (g_sizes) / sizeof (g_sizes[0]);
+
+static void
+benchTxTimeDouble (uint32_t n)
+{
+  DataRate rate ("10Gbps");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint32_t bytes = g_sizes[i % g_nSizes];
+      // The conversion DataRate::CalculateBytesTxTime used to do
+      Time t = Seconds (static_cast<double> (bytes) * 8 / rate.GetBitRate ());
+      g_sink += t.GetTimeStep ();
+    }
+}
+
+static void
+benchTxTimeInteger (uint32_t n)
+{
+  DataRate rate ("10Gbps");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Time t = rate.CalculateBytesTxTime (g_sizes[i % g_nSizes]);
+      g_sink += t.GetTimeStep ();
+    }
+}
+
+static void
+benchTxTimeCache (uint32_t n)
+{
+  DataRate rate ("10Gbps");
+  DataRateTxTimeCache cache;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      // Two sizes, like full segments and acknowledgements
+      Time t = cache.Get (rate, g_sizes[(i % 2) * 4]);
+      g_sink += t.GetTimeStep ();
+    }
+}
+
+static void
+benchSecondsDouble (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_sink += Seconds (0.001).GetTimeStep ();
+    }
+}
+
+static void
+benchSecondsLiteral (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_sink += Time (SecondsLiteral (0.001)).GetTimeStep ();
+    }
+}
+
+static void
+benchGetSeconds (uint32_t n)
+{
+  Time t = MilliSeconds (37);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_sinkDouble += (t + NanoSeconds (i)).GetSeconds ();
+    }
+}
+
+static uint64_t
+runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  (*bench) (n);
+  uint64_t deltaMs = time.End ();
+  return deltaMs;
+}
+
+
+static void
+runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      uint64_t delay = runBenchOneIteration(bench, n);
+      minDelay = std::min(minDelay, delay);
+    }
+  double ops = n;
+  ops *= 1000;
+  ops /= std::max<uint64_t> (minDelay, 1);
+  std::cout << ops << " conversions/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t minIterations = 1;
+  CommandLine cmd;
+  cmd.Usage ("Benchmark Time conversions");
+  cmd.AddValue ("n", "number of iterations", n);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of iterations must be specified " <<
+        "by command-line argument --n=(number of iterations)" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-time with n=" << n << std::endl;
+
+  runBench (&benchTxTimeDouble, n, minIterations, "Tx time through Seconds (double)");
+  runBench (&benchTxTimeInteger, n, minIterations, "Tx time through DataRate integer arithmetic");
+  runBench (&benchTxTimeCache, n, minIterations, "Tx time through DataRateTxTimeCache");
+  runBench (&benchSecondsDouble, n, minIterations, "Seconds (double) constant");
+  runBench (&benchSecondsLiteral, n, minIterations, "SecondsLiteral constant");
+  runBench (&benchGetSeconds, n, minIterations, "Time::GetSeconds");
+
+  // Keep the sinks alive
+  return (g_sink == 42 && g_sinkDouble == 42) ? 1 : 0;
+}